@@ -65,6 +65,71 @@ REGEXKIT_EXTERN NSRange RKConvertUTF8ToUTF16RangeForString(NSString *string, NSR
  @discussion Used to convert the character index values from Foundations native UTF16 string encoding to PCREs native UTF8 encoding.
 */
 REGEXKIT_EXTERN NSRange RKConvertUTF16ToUTF8RangeForString(NSString *string, NSRange range);
+
+/*!
+ @typedef    RKReplaceContext
+ @tocgroup   Functions Replacement Callbacks
+ @abstract   An opaque reference to the state of a match being replaced by a @link RKReplaceFunction RKReplaceFunction @/link or @link RKReplaceBlock RKReplaceBlock @/link.
+ @discussion A @link RKReplaceContext RKReplaceContext @/link is only valid for the duration of the callback it is passed to.
+*/
+typedef struct replaceContext RKReplaceContext;
+/*!
+ @typedef    RKReplaceFunction
+ @tocgroup   Functions Replacement Callbacks
+ @abstract   A function that appends the replacement text for a match to <span class="argument">replaceContext</span>.
+ @discussion Anything the function appends with @link RKReplaceContextAppendString RKReplaceContextAppendString @/link, @link RKReplaceContextAppendCapture RKReplaceContextAppendCapture @/link, or @link RKReplaceContextAppendUTF8Characters RKReplaceContextAppendUTF8Characters @/link replaces the matched text.  Appending nothing removes the match.
+ @result     Return <span class="code">YES</span> to continue with the next match, or <span class="code">NO</span> to stop and leave the remaining matches unchanged.
+*/
+typedef BOOL (*RKReplaceFunction)(RKReplaceContext *replaceContext, void *info);
+#ifdef __BLOCKS__
+/*!
+ @typedef    RKReplaceBlock
+ @tocgroup   Functions Replacement Callbacks
+ @abstract   The block equivalent of a @link RKReplaceFunction RKReplaceFunction @/link.
+*/
+typedef BOOL (^RKReplaceBlock)(RKReplaceContext *replaceContext);
+#endif // __BLOCKS__
+/*!
+ @function   RKReplaceContextCaptureCount
+ @tocgroup   Functions Replacement Callbacks
+ @abstract   Returns the number of captures, including the entire match at index <span class="code">0</span>, of the regular expression being replaced.
+*/
+REGEXKIT_EXTERN RKUInteger RKReplaceContextCaptureCount(RKReplaceContext *replaceContext);
+/*!
+ @function   RKReplaceContextRangeOfCapture
+ @tocgroup   Functions Replacement Callbacks
+ @abstract   Returns the range of <span class="argument">capture</span> in the character indexes of the string being replaced, or <span class="code">{@link NSNotFound NSNotFound@/link, 0}</span> if <span class="argument">capture</span> did not participate in the match.
+ @discussion The range is only converted from the UTF8 byte indexes used for matching when it is requested.
+*/
+REGEXKIT_EXTERN NSRange RKReplaceContextRangeOfCapture(RKReplaceContext *replaceContext, const RKUInteger capture);
+/*!
+ @function   RKReplaceContextSubstringOfCapture
+ @tocgroup   Functions Replacement Callbacks
+ @abstract   Returns an autoreleased @link RKSubstring RKSubstring @/link of the text matched by <span class="argument">capture</span>, or <span class="code">nil</span> if <span class="argument">capture</span> did not participate in the match.
+*/
+REGEXKIT_EXTERN RKSubstring *RKReplaceContextSubstringOfCapture(RKReplaceContext *replaceContext, const RKUInteger capture);
+/*!
+ @function   RKReplaceContextAppendString
+ @tocgroup   Functions Replacement Callbacks
+ @abstract   Appends <span class="argument">string</span> to the replacement text of the current match.
+ @result     Returns <span class="code">NO</span> if memory for the replaced string could not be allocated or <span class="argument">string</span> could not be converted to UTF8, otherwise <span class="code">YES</span>.  After a failure the replace stops and returns <span class="code">NULL</span>.
+*/
+REGEXKIT_EXTERN BOOL RKReplaceContextAppendString(RKReplaceContext *replaceContext, NSString *string);
+/*!
+ @function   RKReplaceContextAppendCapture
+ @tocgroup   Functions Replacement Callbacks
+ @abstract   Appends the text matched by <span class="argument">capture</span> to the replacement text of the current match.  Appends nothing if <span class="argument">capture</span> did not participate in the match.
+ @discussion The text is copied directly from the string being replaced without creating any objects.
+ @result     Returns <span class="code">NO</span> if memory for the replaced string could not be allocated, otherwise <span class="code">YES</span>.
+*/
+REGEXKIT_EXTERN BOOL RKReplaceContextAppendCapture(RKReplaceContext *replaceContext, const RKUInteger capture);
+/*!
+ @function   RKReplaceContextAppendUTF8Characters
+ @tocgroup   Functions Replacement Callbacks
+ @abstract   Appends <span class="argument">length</span> bytes of the UTF8 encoded <span class="argument">characters</span> to the replacement text of the current match.
+ @result     Returns <span class="code">NO</span> if memory for the replaced string could not be allocated, otherwise <span class="code">YES</span>.
+*/
+REGEXKIT_EXTERN BOOL RKReplaceContextAppendUTF8Characters(RKReplaceContext *replaceContext, const char *characters, const RKUInteger length);
   
 /*!
  @category    NSString (RegexKitAdditions)
@@ -78,6 +143,7 @@ REGEXKIT_EXTERN NSRange RKConvertUTF16ToUTF8RangeForString(NSString *string, NSR
  @group Enumerating Matches
  @group Identifying Matches
  @group Creating Temporary Strings from Match Results
+ @group Dividing Strings
  @group Search and Replace
 */
 
@@ -200,6 +266,46 @@ NSString *subjectString = &#64;"Convert this value: 0xb1223dd8";
 */
 - (BOOL)isMatchedByRegex:(id)aRegex inRange:(const NSRange)range;
 - (BOOL)isMatchedByRegex:(id)aRegex inRange:(const NSRange)range error:(NSError **)error;
+/*!
+ @method     componentsSeparatedByRegex:
+ @tocgroup   NSString Dividing Strings
+ @abstract   Returns an array containing the substrings of the receiver that have been divided by matches of <span class="argument">aRegex</span>.
+ @discussion Equivalent to @link NSString(RegexKitAdditions)/componentsSeparatedByRegex:inRange:limit:options:concurrent:error: componentsSeparatedByRegex:inRange:limit:options:concurrent:error: @/link with the entire range of the receiver, no limit, @link RKSplitNoOptions RKSplitNoOptions @/link, and without concurrency.
+*/
+- (NSArray *)componentsSeparatedByRegex:(id)aRegex;
+/*!
+ @method     componentsSeparatedByRegex:limit:options:
+ @tocgroup   NSString Dividing Strings
+ @abstract   Returns an array containing at most <span class="argument">limit</span> substrings of the receiver that have been divided by matches of <span class="argument">aRegex</span>.
+ @discussion Equivalent to @link NSString(RegexKitAdditions)/componentsSeparatedByRegex:inRange:limit:options:concurrent:error: componentsSeparatedByRegex:inRange:limit:options:concurrent:error: @/link with the entire range of the receiver and without concurrency.
+*/
+- (NSArray *)componentsSeparatedByRegex:(id)aRegex limit:(const RKUInteger)limit options:(const RKSplitOption)options;
+/*!
+ @method     componentsSeparatedByRegex:inRange:limit:options:concurrent:error:
+ @tocgroup   NSString Dividing Strings
+ @abstract   Returns an array containing the substrings within <span class="argument">range</span> of the receiver that have been divided by matches of <span class="argument">aRegex</span>.
+ @param      range The range of the receiver to divide.
+ @param      limit The maximum number of components to return, or <span class="code">0</span> for no limit.  Once <span class="argument">limit</span> <span class="code">- 1</span> components have been found, the last component is the remainder of <span class="argument">range</span>, including any separators it contains.
+ @param      options A mask of @link RKSplitOption RKSplitOption @/link options.
+ @param      concurrent If <span class="code">YES</span>, large ranges are divided in to chunks that are searched for separators by the threads of the @link RKThreadPool RKThreadPool @/link.
+ @param      error An optional parameter that if set and an error occurs, will contain a @link NSError NSError @/link object that describes the problem.  This may be set to <span class="code">NULL</span> if information about any errors is not required.
+ @result     Returns an autoreleased @link NSArray NSArray @/link of the components, or <span class="code">NULL</span> if an error occurred.
+ @discussion Each search for a separator begins where the previous separator ended.  The text of the captures of <span class="argument">aRegex</span> are not included in the components.  An empty match at the beginning of a component is skipped, so a regular expression that can only match the empty string divides the receiver in to its individual characters.
+ @discussion The components are created directly from the UTF8 conversion of the receiver without creating an intermediate match object for each separator.  If <span class="argument">options</span> contains @link RKSplitSubstringComponents RKSplitSubstringComponents @/link, the components are @link RKSubstring RKSubstring @/link objects that do not copy the characters of the receiver.
+ @discussion A <span class="argument">concurrent</span> division returns the same components as a sequential division, with the exception of a regular expression that contains assertions, such as lookahead, that examine text more than 128K bytes past the start of a separator.  Concurrency is not used for a regular expression that contains <span class="regex">\G</span>, or for ranges smaller than 256K bytes.
+ @seealso    @link NSString(RegexKitAdditions)/rangesOfComponentsSeparatedByRegex:inRange:limit:options:count:concurrent:error: - rangesOfComponentsSeparatedByRegex:inRange:limit:options:count:concurrent:error: @/link
+*/
+- (NSArray *)componentsSeparatedByRegex:(id)aRegex inRange:(const NSRange)range limit:(const RKUInteger)limit options:(const RKSplitOption)options concurrent:(const BOOL)concurrent error:(NSError **)error;
+/*!
+ @method     rangesOfComponentsSeparatedByRegex:inRange:limit:options:count:concurrent:error:
+ @tocgroup   NSString Dividing Strings
+ @abstract   Returns the ranges of the substrings within <span class="argument">range</span> of the receiver that have been divided by matches of <span class="argument">aRegex</span>.
+ @param      count Set to the number of ranges returned.  Must not be <span class="code">NULL</span>.
+ @result     Returns a pointer to an array of <span class="argument">count</span> @link NSRange NSRange @/link structures in the receivers character indexes, or <span class="code">NULL</span> if an error occurred.
+ @discussion Divides the receiver exactly as @link NSString(RegexKitAdditions)/componentsSeparatedByRegex:inRange:limit:options:concurrent:error: componentsSeparatedByRegex:inRange:limit:options:concurrent:error: @/link does, but does not create any objects for the components.  The @link RKSplitSubstringComponents RKSplitSubstringComponents @/link option is ignored.
+ <div class="box important"><div class="table"><div class="row"><div class="label cell">Important:</div><div class="message cell">The returned pointer is to an autoreleased buffer that will be freed when the current @link NSAutoreleasePool NSAutoreleasePool @/link is released.</div></div></div></div>
+*/
+- (NSRange *)rangesOfComponentsSeparatedByRegex:(id)aRegex inRange:(const NSRange)range limit:(const RKUInteger)limit options:(const RKSplitOption)options count:(RKUInteger *)count concurrent:(const BOOL)concurrent error:(NSError **)error;
 /*!
  @method     matchEnumeratorWithRegex:
  @tocgroup   NSString Enumerating Matches
@@ -347,6 +453,29 @@ NSString *subjectString = &#64;"Convert this value: 0xb1223dd8";
 
 - (NSString *)stringByMatching:(id)aRegex inRange:(const NSRange)range replace:(const RKUInteger)count withReferenceFormat:(NSString * const)referenceFormatString arguments:(va_list)argList;
 - (NSString *)stringByMatching:(id)aRegex inRange:(const NSRange)range replace:(const RKUInteger)count error:(NSError **)error withReferenceFormat:(NSString * const)referenceFormatString arguments:(va_list)argList;
+/*!
+ @method     stringByMatching:replace:usingFunction:info:
+ @tocgroup   NSString Search and Replace
+ @abstract   Returns a new @link NSString NSString @/link containing the results of replacing up to <span class="argument">count</span> matches of <span class="argument">aRegex</span> in the receiver with the text appended by <span class="argument">function</span>.
+ @param      count The maximum number of replacements to perform, or @link RKReplaceAll RKReplaceAll @/link to replace all matches.
+ @param      function The @link RKReplaceFunction RKReplaceFunction @/link that is called with a @link RKReplaceContext RKReplaceContext @/link for each match.
+ @param      info A pointer that is passed unmodified to <span class="argument">function</span>.
+ @discussion Performs the matches with the same single pass loop as @link NSString(RegexKitAdditions)/stringByMatching:replace:withReferenceString: stringByMatching:replace:withReferenceString: @/link, appending the text between matches and the replacement text directly to the replaced string.  Nothing is converted or created for a match unless <span class="argument">function</span> requests it.
+ @discussion If <span class="argument">aRegex</span> does not match the receiver, an immutable copy of the receiver is returned.
+ @discussion If appending the replacement text for a match fails, <span class="code">NULL</span> is returned and <span class="argument">error</span>, if supplied, describes the failure.
+*/
+- (NSString *)stringByMatching:(id)aRegex replace:(const RKUInteger)count usingFunction:(RKReplaceFunction)function info:(void *)info;
+- (NSString *)stringByMatching:(id)aRegex inRange:(const NSRange)range replace:(const RKUInteger)count usingFunction:(RKReplaceFunction)function info:(void *)info error:(NSError **)error;
+#ifdef __BLOCKS__
+/*!
+ @method     stringByMatching:replace:usingBlock:
+ @tocgroup   NSString Search and Replace
+ @abstract   Returns a new @link NSString NSString @/link containing the results of replacing up to <span class="argument">count</span> matches of <span class="argument">aRegex</span> in the receiver with the text appended by <span class="argument">block</span>.
+ @discussion The block equivalent of @link NSString(RegexKitAdditions)/stringByMatching:replace:usingFunction:info: stringByMatching:replace:usingFunction:info: @/link.  Only available when compiled with a compiler that supports blocks.
+*/
+- (NSString *)stringByMatching:(id)aRegex replace:(const RKUInteger)count usingBlock:(RKReplaceBlock)block;
+- (NSString *)stringByMatching:(id)aRegex inRange:(const NSRange)range replace:(const RKUInteger)count usingBlock:(RKReplaceBlock)block error:(NSError **)error;
+#endif // __BLOCKS__
 
 @end
 
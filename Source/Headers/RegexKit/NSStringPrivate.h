@@ -45,6 +45,8 @@ extern "C" {
 #ifndef _REGEXKIT_NSSTRINGPRIVATE_H_
 #define _REGEXKIT_NSSTRINGPRIVATE_H_ 1
 
+@class RKCaptureExtractor, RKSubstring;
+
 #ifdef    USE_CORE_FOUNDATION
 #define RKStringBufferEncoding CFStringEncoding
 #define RKUTF8StringEncoding   kCFStringEncodingUTF8
@@ -127,11 +129,38 @@ enum {
 
 typedef RKUInteger RKCaptureExtractOptions;
 
+// A capture reference, such as ${date:@d}, with the capture resolved to its index and the conversion identified.  format points
+// in to the characters of the capture reference it was parsed from, which must remain valid as long as the parsed reference is used.
+
+enum {
+  RKCaptureConversionString    = 0,
+  RKCaptureConversionScanf     = 1,
+  RKCaptureConversionDate      = 2,
+  RKCaptureConversionNumber    = 3,
+  RKCaptureConversionSubstring = 4
+};
+
+typedef int RKCaptureConversionType;
+
+struct parsedCaptureReference {
+                      RKUInteger              captureIndex;
+                      RKCaptureConversionType conversion;
+                      char                    numberStyle;  // The NSNumber conversion option character, or 0 for the default style.
+  RK_STRONG_REF const char * RK_C99(restrict) format;
+                      RKUInteger              formatLength;
+};
+
+typedef struct parsedCaptureReference RKParsedCaptureReference;
+
 /*************** Match and replace operations ***************/
 
 // Used in NSString to perform match and replace operations.  Kept here to keep things tidy.
 
 #define RK_DEFAULT_STACK_INSTRUCTIONS (64)
+#define RK_DEFAULT_STACK_OUTPUT_SIZE  (1024)
+#define RK_MAX_IN_PLACE_EDITS         (64)
+#define RK_MAX_IN_PLACE_RESIZES       (8)
+#define RK_CASE_CONVERSION_BUFFER_SIZE (256)
 
 #define OP_STOP                 0
 #define OP_COPY_CAPTUREINDEX    1
@@ -150,13 +179,7 @@ struct referenceInstruction {
                       NSRange                 range;
 };
 
-struct copyInstruction {
-  RK_STRONG_REF const void * RK_C99(restrict) ptr;
-                      RKUInteger              length;
-};
-
 typedef struct referenceInstruction RKReferenceInstruction;
-typedef struct copyInstruction      RKCopyInstruction;
 
 struct referenceInstructionsBuffer {
                 RKUInteger                                length, capacity;
@@ -165,26 +188,80 @@ struct referenceInstructionsBuffer {
                 BOOL                                      isValid;
 };
 
-struct copyInstructionsBuffer {
-                RKUInteger                           length, capacity, copiedLength;
-  RK_STRONG_REF RKCopyInstruction * RK_C99(restrict) instructions;
-  RK_STRONG_REF NSMutableData     * RK_C99(restrict) mutableData;
-                BOOL                                 isValid;
+// The replaced string is written directly in to bytes as each match is processed.  bytes starts out as a caller supplied buffer
+// (usually on the stack) and is moved to a malloc() allocation that grows geometrically once it is full.  If mutableData is not
+// NULL, it is the caller supplied destination and everything is appended to it instead.
+struct outputBuffer {
+                RKUInteger                       length, capacity;
+  RK_STRONG_REF char          * RK_C99(restrict) bytes;
+  RK_STRONG_REF NSMutableData * RK_C99(restrict) mutableData;
+                BOOL                             isHeapAllocated, isValid;
+};
+
+// A single replacement made directly to a NSMutableString.  range is in UTF16 characters, and the replacement is the expansionLength
+// bytes at expansionLocation of the buffer all of the expansions were written to.
+struct stringEdit {
+  NSRange    range;
+  RKUInteger expansionLocation, expansionLength;
+};
+
+// The state passed to a RKReplaceFunction for each match.  matchRanges are in UTF8 bytes, and are only converted to UTF16 when the
+// function asks for them.  utf8Anchor and utf16Anchor carry the conversion forward from match to match.  An append that fails marks
+// outputBuffer as no longer valid, and sets error when the reason is something other than running out of memory.
+struct replaceContext {
+                RKRegex        * RK_C99(restrict) regex;
+  RK_STRONG_REF RKStringBuffer * RK_C99(restrict) stringBuffer;
+  RK_STRONG_REF NSRange        * RK_C99(restrict) matchRanges;
+                RKUInteger                        captureCount, utf8Anchor, utf16Anchor;
+  RK_STRONG_REF struct outputBuffer * RK_C99(restrict) outputBuffer;
+                NSError                          *error;
 };
 
 typedef struct referenceInstructionsBuffer RKReferenceInstructionsBuffer;
-typedef struct copyInstructionsBuffer      RKCopyInstructionsBuffer;
+typedef struct outputBuffer                RKOutputBuffer;
+typedef struct stringEdit                  RKStringEdit;
 
 #define RKMakeReferenceInstructionsBuffer(length, capacity, instructions, mutableData) ((RKReferenceInstructionsBuffer){length, capacity, instructions, mutableData, YES})
-#define RKMakeCopyInstructionsBuffer(length, capacity, copiedLength, instructions, mutableData) ((RKCopyInstructionsBuffer){length, capacity, copiedLength, instructions, mutableData, YES})
+#define RKMakeOutputBuffer(bytes, capacity, mutableData) ((RKOutputBuffer){0, capacity, bytes, mutableData, NO, YES})
 
 /*************** End match and replace operations ***************/
 
+/*************** Fixed format date conversion ***************/
+
+// Used by the @d capture conversion to parse ISO-8601 / RFC-3339, syslog, and Apache common log format timestamps without
+// taking NSStringRKExtensionsNSDateLock.  prefixLength is the number of characters up to and including the minute, which is
+// the key for the per thread cache of recently converted timestamps.  A year of 0 means the current year (syslog).
+
+#define RK_DATE_LOCAL_TIME_ZONE   (INT32_MAX)
+#define RK_DATE_REFERENCE_EPOCH   (978307200.0)
+
+struct fixedFormatDate {
+  int            year, month, day, hour, minute, second;
+  NSTimeInterval fraction;
+  int32_t        secondsFromGMT;
+  RKUInteger     prefixLength;
+};
+
+typedef struct fixedFormatDate RKFixedFormatDate;
+
+/*************** End fixed format date conversion ***************/
+
 
 NSString     *RKStringFromReferenceString(id self, const SEL _cmd, RKRegex * const RK_C99(restrict) regex, RK_STRONG_REF const NSRange * const RK_C99(restrict) matchRanges, RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) matchStringBuffer, RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) referenceStringBuffer) RK_ATTRIBUTES(malloc, used, visibility("hidden"));
 NSString     *RKStringFromReferenceStringX(id self, const SEL _cmd, RKRegex * const RK_C99(restrict) regex, RK_STRONG_REF const NSRange * const RK_C99(restrict) matchRanges, RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) matchStringBuffer, RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) referenceStringBuffer, NSError **error) RK_ATTRIBUTES(malloc, used, visibility("hidden"));
 BOOL          RKExtractCapturesFromMatchesWithKeyArguments(id self, const SEL _cmd, RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) stringBuffer, RKRegex * const RK_C99(restrict) regex, RK_STRONG_REF const NSRange * const RK_C99(restrict) matchRanges, const RKCaptureExtractOptions captureExtractOptions, NSString * const firstKey, va_list useVarArgsList) RK_ATTRIBUTES(used, visibility("hidden"));
 BOOL          RKExtractCapturesFromMatchesWithKeyArgumentsX(id self, const SEL _cmd, RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) stringBuffer, RKRegex * const RK_C99(restrict) regex, RK_STRONG_REF const NSRange * const RK_C99(restrict) matchRanges, const RKCaptureExtractOptions captureExtractOptions, NSString * const firstKey, va_list useVarArgsList, NSError **error) RK_ATTRIBUTES(used, visibility("hidden"));
+BOOL          RKCompileReferenceStringX(id self, const SEL _cmd, RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) referenceStringBuffer, RKRegex * const RK_C99(restrict) regex, RK_STRONG_REF RKReferenceInstructionsBuffer * const RK_C99(restrict) instructionBuffer, NSError **error) RK_ATTRIBUTES(used, visibility("hidden"));
+BOOL          RKMatchAndApplyReferenceInstructionsX(id self, const SEL _cmd, RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) searchStringBuffer, const NSRange searchRange, const RKUInteger count, RKRegex * const RK_C99(restrict) regex, RK_STRONG_REF const RKReferenceInstructionsBuffer * const RK_C99(restrict) referenceInstructionsBuffer, const BOOL expandOrReplace, RK_STRONG_REF RKOutputBuffer * const RK_C99(restrict) outputBuffer, RK_STRONG_REF RKUInteger * const RK_C99(restrict) matchedCountPtr, NSError **error) RK_ATTRIBUTES(used, visibility("hidden"));
+void          RKReleaseOutputBuffer(RK_STRONG_REF RKOutputBuffer * const RK_C99(restrict) outputBuffer) RK_ATTRIBUTES(used, visibility("hidden"));
+NSString     *RKStringByApplyingReferenceInstructionsX(id self, const SEL _cmd, NSString * const RK_C99(restrict) searchString, RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) searchStringBuffer, const NSRange searchRange, const RKUInteger count, RKRegex * const RK_C99(restrict) regex, RK_STRONG_REF const RKReferenceInstructionsBuffer * const RK_C99(restrict) referenceInstructionsBuffer, const BOOL expandOrReplace, RK_STRONG_REF RKUInteger * const RK_C99(restrict) matchedCountPtr, NSError **error) RK_ATTRIBUTES(used, visibility("hidden"));
+RKCaptureExtractor             *RKCaptureExtractorForKeys(RKRegex * const regex, NSString ** const RK_C99(restrict) keyStrings, const RKUInteger count, const RKCaptureExtractOptions captureExtractOptions) RK_ATTRIBUTES(used, visibility("hidden"), nonnull(1));
+const RKParsedCaptureReference *RKCaptureExtractorParsedReferences(RKCaptureExtractor * const self) RK_ATTRIBUTES(used, visibility("hidden"), nonnull(1));
+BOOL          RKParseCaptureReferenceX(id self, const SEL _cmd, RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) referenceBuffer, RKRegex * const RK_C99(restrict) regex, const RKCaptureExtractOptions captureExtractOptions, RK_STRONG_REF RKParsedCaptureReference * const RK_C99(restrict) parsedCaptureReference, NSError **error) RK_ATTRIBUTES(used, visibility("hidden"));
+BOOL          RKExtractCapturesFromMatchesWithKeysAndPointers(id self, const SEL _cmd, RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) stringBuffer, RKRegex * const RK_C99(restrict) regex, RK_STRONG_REF const NSRange * const RK_C99(restrict) matchRanges, NSString ** const RK_C99(restrict) keyStrings, RK_STRONG_REF const RKParsedCaptureReference * const RK_C99(restrict) parsedCaptureReferences, RK_STRONG_REF void *** const RK_C99(restrict) keyConversionPointers, const RKUInteger count, const RKCaptureExtractOptions captureExtractOptions, NSError **error) RK_ATTRIBUTES(used, visibility("hidden"));
+BOOL          RKConvertNumericCharacters(RK_STRONG_REF const char * const RK_C99(restrict) characters, const RKUInteger length, RK_STRONG_REF const char * const RK_C99(restrict) format, const RKUInteger formatLength, RK_STRONG_REF void * const RK_C99(restrict) conversionPtr) RK_ATTRIBUTES(used, visibility("hidden"));
+BOOL          RKTimeIntervalFromFixedFormatCharacters(RK_STRONG_REF const char * const RK_C99(restrict) characters, const RKUInteger length, RK_STRONG_REF NSTimeInterval * const RK_C99(restrict) timeInterval, NSTimeZone ** const RK_C99(restrict) timeZonePtr) RK_ATTRIBUTES(used, visibility("hidden"));
+RKSubstring  *RKSubstringCreateWithStringBuffer(RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) stringBuffer, const NSRange range) RK_ATTRIBUTES(malloc, used, visibility("hidden"), nonnull(1));
 
 #endif _REGEXKIT_NSSTRINGPRIVATE_H_
   
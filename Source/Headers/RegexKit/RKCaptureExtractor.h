@@ -0,0 +1,152 @@
+//
+//  RKCaptureExtractor.h
+//  RegexKit
+//  http://regexkit.sourceforge.net/
+//
+
+/*
+ Copyright © 2007-2008, John Engelhart
+ 
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+ notice, this list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright
+ notice, this list of conditions and the following disclaimer in the
+ documentation and/or other materials provided with the distribution.
+ 
+ * Neither the name of the Zang Industries nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  
+#ifndef _REGEXKIT_RKCAPTUREEXTRACTOR_H_
+#define _REGEXKIT_RKCAPTUREEXTRACTOR_H_ 1
+
+/*!
+ @header RKCaptureExtractor
+*/
+
+/*!
+@class      RKCaptureExtractor
+@toc        RKCaptureExtractor
+@abstract   Precompiled Capture Extraction References
+*/
+
+/*!
+ @toc   RKCaptureExtractor
+ @group Creating Capture Extractors
+ @group Capture Extractor Information
+ @group Extracting Captures
+*/
+
+@class RKRegex, RKCache;
+
+#import <Foundation/Foundation.h>
+#import <RegexKit/RegexKitDefines.h>
+#import <RegexKit/RegexKitTypes.h>
+
+@interface RKCaptureExtractor : NSObject {
+                RKRegex    *regex;                  // The regex the references were parsed against.
+                NSArray    *references;             // The original capture reference strings.
+  RK_STRONG_REF NSString  **referenceStrings;       // The objects of references, as a C array.
+  RK_STRONG_REF char       *referenceCharacters;    // Private UTF8 copy of the references.  The parsed references point in to this buffer.
+  RK_STRONG_REF void       *parsedReferences;       // The parsed capture references.
+                RKUInteger  referencesCount;        // The number of references.
+                RKUInteger  captureExtractOptions;
+                RKUInteger  captureExtractorHash;
+}
+
+/*!
+ @method     captureExtractorCache
+ @tocgroup   RKCaptureExtractor Creating Capture Extractors
+ @abstract   Returns the @link RKCache RKCache @/link used to cache parsed capture extraction references.
+ @discussion <p>In addition to the capture extractors created with @link captureExtractorWithRegex:references: captureExtractorWithRegex:references: @/link, the capture references passed to @link getCapturesWithRegexAndReferences: getCapturesWithRegexAndReferences: @/link and the related methods are cached here so that they are only parsed the first time they are used with a regular expression.</p>
+*/
++ (RKCache *)captureExtractorCache;
+/*!
+ @method     captureExtractorWithRegex:references:
+ @tocgroup   RKCaptureExtractor Creating Capture Extractors
+ @abstract   Returns a @link RKCaptureExtractor RKCaptureExtractor @/link for the capture references in <span class="argument">referencesArray</span> and <span class="argument">aRegex</span>.
+ @discussion <p>The returned extractor is cached, so subsequent requests for the same <span class="argument">aRegex</span> and <span class="argument">referencesArray</span> return the already parsed extractor.</p>
+   <p>The capture references use the same syntax as @link getCapturesWithRegexAndReferences: getCapturesWithRegexAndReferences:@/link, including type conversions.</p>
+ @param      aRegex A regular expression string or @link RKRegex RKRegex @/link object.
+ @param      referencesArray An @link NSArray NSArray @/link of capture reference strings.
+   <div class="box important"><div class="table"><div class="row"><div class="label cell">Important:</div><div class="message cell">Raises @link RKRegexCaptureReferenceException RKRegexCaptureReferenceException @/link if <span class="argument">referencesArray</span> contains an invalid capture reference.</div></div></div></div>
+*/
++ (RKCaptureExtractor *)captureExtractorWithRegex:(id)aRegex references:(NSArray * const)referencesArray;
++ (RKCaptureExtractor *)captureExtractorWithRegex:(id)aRegex references:(NSArray * const)referencesArray error:(NSError **)error;
+/*!
+ @method     initWithRegex:references:error:
+ @tocgroup   RKCaptureExtractor Creating Capture Extractors
+ @abstract   Initializes a @link RKCaptureExtractor RKCaptureExtractor @/link for the capture references in <span class="argument">referencesArray</span> and <span class="argument">aRegex</span>.
+ @discussion <p>Every capture reference is parsed once, resolving named captures to their capture index and selecting the type conversion, so extracting captures with the receiver does no parsing at all.</p>
+ @param      aRegex A regular expression string or @link RKRegex RKRegex @/link object.
+ @param      referencesArray An @link NSArray NSArray @/link of capture reference strings.
+ @param      error An optional parameter that if set and an error occurs, will contain a @link NSError NSError @/link object that describes the problem.  This may be set to <span class="code">NULL</span> if information about any errors is not required.
+ @result     Returns an initialized @link RKCaptureExtractor RKCaptureExtractor @/link, or <span class="code">nil</span> if a capture reference could not be parsed.
+*/
+- (id)initWithRegex:(id)aRegex references:(NSArray * const)referencesArray error:(NSError **)error;
+
+/*!
+ @method     regex
+ @tocgroup   RKCaptureExtractor Capture Extractor Information
+ @abstract   Returns the @link RKRegex RKRegex @/link the receivers capture references were parsed against.
+*/
+- (RKRegex *)regex;
+/*!
+ @method     references
+ @tocgroup   RKCaptureExtractor Capture Extractor Information
+ @abstract   Returns the capture reference strings the receiver was created with.
+*/
+- (NSArray *)references;
+
+/*!
+ @method     getCapturesFromString:pointers:
+ @tocgroup   RKCaptureExtractor Extracting Captures
+ @abstract   Matches the receivers regular expression against <span class="argument">subjectString</span> and stores the converted captures in the pointers that follow.
+ @discussion <p>This method is functionally equivalent to @link getCapturesWithRegexAndReferences: getCapturesWithRegexAndReferences:@/link, except that one pointer is supplied for each of the receivers references, in the same order, instead of alternating references and pointers.</p>
+ @param      subjectString The string to match.
+ @param      firstPointer The pointer for the receivers first capture reference, followed by one pointer for each of the remaining capture references.
+ @result     Returns <span class="code">YES</span> if the receivers regular expression matched <span class="argument">subjectString</span>, <span class="code">NO</span> otherwise.
+*/
+- (BOOL)getCapturesFromString:(NSString * const)subjectString pointers:(void *)firstPointer, ...;
+/*!
+ @method     getCapturesFromString:inRange:pointers:error:
+ @tocgroup   RKCaptureExtractor Extracting Captures
+ @abstract   Matches the receivers regular expression against <span class="argument">subjectString</span> within <span class="argument">range</span> and stores the converted captures in <span class="argument">pointers</span>.
+ @param      subjectString The string to match.
+ @param      range The range of <span class="argument">subjectString</span> to match.
+ @param      pointers A C array with one pointer for each of the receivers capture references, in the same order as @link references references@/link.
+ @param      error An optional parameter that if set and an error occurs, will contain a @link NSError NSError @/link object that describes the problem.  This may be set to <span class="code">NULL</span> if information about any errors is not required.
+ @result     Returns <span class="code">YES</span> if the receivers regular expression matched <span class="argument">subjectString</span> and the captures were stored, <span class="code">NO</span> otherwise.
+*/
+- (BOOL)getCapturesFromString:(NSString * const)subjectString inRange:(const NSRange)range pointers:(void ** const)pointers error:(NSError **)error;
+
+@end
+
+#endif // _REGEXKIT_RKCAPTUREEXTRACTOR_H_
+    
+#ifdef __cplusplus
+  }  /* extern "C" */
+#endif
@@ -63,7 +63,7 @@ extern "C" {
  @group Creating Temporary Strings from the Current Enumerated Match
 */
 
-@class RKRegex;
+@class RKRegex, RKSubstring;
 
 #import <Foundation/Foundation.h>
 #import <RegexKit/RKRegex.h>
@@ -78,6 +78,8 @@ extern "C" {
   NSRange searchUTF16Range;
   RK_STRONG_REF NSRange *resultUTF8Ranges;
   RK_STRONG_REF NSRange *resultUTF16Ranges;
+  RKUInteger conversionUTF8Location;
+  RKUInteger conversionUTF16Location;
   RKUInteger hasPerformedMatch:1;
 }
 
@@ -194,6 +196,16 @@ extern "C" {
  @seealso    @link nextRangeForCaptureName: - nextRangeForCaptureName: @/link
 */
 - (NSRange)currentRangeForCaptureName:(NSString * const)captureNameString;
+/*!
+ @method     currentSubstringForCapture:
+ @tocgroup   RKEnumerator Current Match Information
+ @abstract   Returns an autoreleased @link RKSubstring RKSubstring @/link of the current match for capture subpattern <span class="argument">capture</span>.
+ @discussion The returned substring refers to the characters of the receivers string instead of copying them, which avoids creating a new string for every field of every match.
+ @param      capture The capture subpattern of the receivers regular expression to return the substring of.
+ @result     Returns <span class="code">nil</span> if receiver has enumerated all the matches or <span class="argument">capture</span> did not match.
+ @seealso    @link currentRangeForCapture: - currentRangeForCapture: @/link
+*/
+- (RKSubstring *)currentSubstringForCapture:(const RKUInteger)capture;
 /*!
  @method     currentRanges
  @tocgroup   RKEnumerator Current Match Information
@@ -52,6 +52,49 @@ extern "C" {
 
 #define RKLOCK_MAX_SPURIOUS_ERROR_ATTEMPTS 2
 
+// Distributed reader slots.  The number of slots is the number of CPUs rounded up to a power of two, clamped to this range.
+#define RKLOCK_MIN_READER_SLOTS            4
+#define RKLOCK_MAX_READER_SLOTS            64
+#define RK_CACHE_LINE_SIZE                 64
+
+// Contention profiling.  Histogram bucket n counts the waits or holds that took at least 2^n nanoseconds, but less than 2^(n+1),
+// except for the last bucket which also counts everything longer.
+#define RKLOCK_PROFILE_HISTOGRAM_BUCKETS   32
+#define RKLOCK_PROFILE_CALL_SITES          8
+#define RKLOCK_PROFILE_NAME_LENGTH         64
+
+#pragma mark -
+#pragma mark Contention Profiling
+
+typedef struct {
+  void * volatile    callSite;
+  volatile RKInteger contendedCount;
+  volatile RKInteger waitMicroseconds;
+} RKLockCallSiteProfile;
+
+// Profiles are never freed.  When a lock is deallocated its profile is marked as no longer in use and is recycled by the next lock
+// that is created, which allows RKDumpLockProfiles() to walk the list of profiles from a signal handler without taking any locks.
+typedef struct lockProfile {
+  struct lockProfile * volatile nextProfile;
+  volatile RKInteger            inUse;
+  const void                   *lock;
+  const char                   *lockClassName;
+  char                          name[RKLOCK_PROFILE_NAME_LENGTH];
+  volatile RKInteger            acquiredCount;
+  volatile RKInteger            contendedCount;
+  volatile RKInteger            droppedCallSitesCount;
+  volatile uint64_t             lockedAtNanoseconds;
+  volatile RKInteger            waitHistogram[RKLOCK_PROFILE_HISTOGRAM_BUCKETS];
+  volatile RKInteger            holdHistogram[RKLOCK_PROFILE_HISTOGRAM_BUCKETS];
+  RKLockCallSiteProfile         callSites[RKLOCK_PROFILE_CALL_SITES];
+} RKLockProfile;
+
+RKLockProfile *RKLockProfileCreate(    const void * const lock, const char * const lockClassName) RK_ATTRIBUTES(nonnull(1,2), used, visibility("hidden"));
+void           RKLockProfileRelease(   RKLockProfile * const lockProfile)                         RK_ATTRIBUTES(used, visibility("hidden"));
+void           RKLockProfileSetName(   RKLockProfile * const lockProfile, NSString * const name)  RK_ATTRIBUTES(used, visibility("hidden"));
+void           RKLockProfileClear(     RKLockProfile * const lockProfile)                         RK_ATTRIBUTES(used, visibility("hidden"));
+NSDictionary  *RKLockProfileDictionary(RKLockProfile * const lockProfile)                         RK_ATTRIBUTES(used, visibility("hidden"));
+
 #pragma mark -
 #pragma mark Mutex
 
@@ -72,6 +115,7 @@ void RKFastMutexUnlock(id const self, SEL _cmd, pthread_mutex_t *pthreadMutex) R
 
 @interface RKLock : NSObject <NSLocking> {
   pthread_mutex_t lock;
+  RKLockProfile  *lockProfile;
 }
 
 + (void)setMultithreaded:(const BOOL)enable;
@@ -79,6 +123,10 @@ void RKFastMutexUnlock(id const self, SEL _cmd, pthread_mutex_t *pthreadMutex) R
 - (BOOL)lock;
 - (void)unlock;
 
+- (void)setProfileName:(NSString * const)name;
+- (NSDictionary *)profile;
+- (void)clearProfile;
+
 BOOL RKFastLock(  RKLock * const self) RK_ATTRIBUTES(nonnull(1), used, visibility("hidden"));
 void RKFastUnlock(RKLock * const self) RK_ATTRIBUTES(nonnull(1), used, visibility("hidden"));
 
@@ -98,8 +146,22 @@ enum {
 
 typedef RKInteger RKReadWriteLockStrategy;
 
+// A reader slot of a RKReadWriteLock with distributed readers.  Padded out to a cache line so that readers using different
+// slots never write to the same cache line.
+typedef struct {
+  volatile RKInteger readers;
+  char               padding[RK_CACHE_LINE_SIZE - sizeof(RKInteger)];
+} RKReaderSlot;
+
 @interface RKReadWriteLock : NSObject <NSLocking> {
   pthread_rwlock_t readWriteLock;
+  RKReaderSlot    *readerSlots;
+  RKUInteger       readerSlotsMask;
+  volatile RKInteger writerActive;
+  pthread_t        writerThread;
+  pthread_mutex_t  drainMutex;
+  pthread_cond_t   drainCondition;
+  RKLockProfile   *lockProfile;
   RKUInteger       readBusyCount;
   RKUInteger       readSpinCount;
   RKUInteger       readDowngradedFromWriteCount;
@@ -112,9 +174,13 @@ typedef RKInteger RKReadWriteLockStrategy;
 
 + (void)setMultithreaded:(const BOOL)enable;
 
+- (id)initWithDistributedReaders:(const BOOL)distributeReaders;
+- (BOOL)hasDistributedReaders;
+
 - (BOOL)lock;
 - (BOOL)readLock;
 - (BOOL)writeLock;
+- (BOOL)lockWithStrategy:(const RKReadWriteLockStrategy)lockStrategy lockLevelAcquired:(RKReadWriteLockStrategy *)lockLevelAcquired;
 - (void)unlock;
 
 - (void)setDebug:(const BOOL)enable;
@@ -125,6 +191,10 @@ typedef RKInteger RKReadWriteLockStrategy;
 - (RKUInteger)writeSpinCount;
 - (void)clearCounters;
 
+- (void)setProfileName:(NSString * const)name;
+- (NSDictionary *)profile;
+- (void)clearProfile;
+
 BOOL RKFastReadWriteLockWithStrategy(RKReadWriteLock * const self, const RKReadWriteLockStrategy lockStrategy, RKReadWriteLockStrategy *lockLevelAcquired) RK_ATTRIBUTES(nonnull(1), used, visibility("hidden"));
 BOOL RKFastReadWriteLock(  RKReadWriteLock * const self, const BOOL forWriting) RK_ATTRIBUTES(nonnull(1), used, visibility("hidden"));
 void RKFastReadWriteUnlock(RKReadWriteLock * const self)                        RK_ATTRIBUTES(nonnull(1), used, visibility("hidden"));
@@ -162,6 +232,7 @@ typedef RKUInteger RKConditionUnlockStrategy;
   pthread_t       lockOwner;
   NSThread       *lockOwnerThread;
   RKInteger       currentLockCondition;
+  RKLockProfile  *lockProfile;
 }
 
 + (void)setMultithreaded:(const BOOL)enable;
@@ -187,6 +258,10 @@ typedef RKUInteger RKConditionUnlockStrategy;
 - (void)unlock;
 - (void)unlockWithCondition:(RKInteger)condition;
 
+- (void)setProfileName:(NSString * const)name;
+- (NSDictionary *)profile;
+- (void)clearProfile;
+
 BOOL RKFastConditionLock(  RKConditionLock * const self, SEL _cmd, RKInteger lockOnCondition,     RKConditionLockStrategy   conditionLockStrategy, NSTimeInterval relativeTime) RK_ATTRIBUTES(nonnull(1), used, visibility("hidden"));
 void RKFastConditionUnlock(RKConditionLock * const self, SEL _cmd, RKInteger unlockWithCondition, RKConditionUnlockStrategy conditionUnlockStrategy) RK_ATTRIBUTES(nonnull(1), used, visibility("hidden"));
 
@@ -0,0 +1,215 @@
+//
+//  RKMatchContext.h
+//  RegexKit
+//  http://regexkit.sourceforge.net/
+//
+
+/*
+ Copyright © 2007-2008, John Engelhart
+ 
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+ notice, this list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright
+ notice, this list of conditions and the following disclaimer in the
+ documentation and/or other materials provided with the distribution.
+ 
+ * Neither the name of the Zang Industries nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  
+#ifndef _REGEXKIT_RKMATCHCONTEXT_H_
+#define _REGEXKIT_RKMATCHCONTEXT_H_ 1
+
+/*!
+ @header RKMatchContext
+*/
+
+/*!
+@class      RKMatchContext
+@toc        RKMatchContext
+@abstract   Reusable Regular Expression Match Results Storage
+*/
+
+/*!
+ @toc   RKMatchContext
+ @group Creating Match Contexts
+ @group Match Results
+ @group Callouts
+ @group Match Limits
+*/
+
+@class RKRegex, RKMatchContext;
+
+#import <Foundation/Foundation.h>
+#import <RegexKit/RegexKitDefines.h>
+#import <RegexKit/RegexKitTypes.h>
+#import <RegexKit/pcre.h>
+
+/*!
+ @typedef    RKMatchCalloutFunction
+ @tocgroup   RKMatchContext Callouts
+ @abstract   A function that is invoked when a callout point in a regular expression is reached during a match performed with a @link RKMatchContext RKMatchContext@/link.
+ @discussion <p>The return value follows the <a href="pcre/pcrecallout.html" class="section-link">PCRE Callouts</a> conventions: <span class="code">0</span> continues the match normally, a value &gt; <span class="code">0</span> causes the match to fail at the current point, and a value &lt; <span class="code">0</span> aborts the match and is returned as the @link RKMatchErrorCode RKMatchErrorCode @/link of the match.</p>
+*/
+typedef int (*RKMatchCalloutFunction)(RKMatchContext *matchContext, pcre_callout_block *calloutBlock, void *calloutContext);
+
+@interface RKMatchContext : NSObject {
+                RKRegex                *regex;           // The regex that the buffers are currently sized for.
+                RKUInteger              captureCount;    // The captureCount of regex.
+  RK_STRONG_REF int                    *vectors;         // pcre_exec() 'ovector', three ints per capture.
+                RKUInteger              vectorsCount;    // The number of ints in vectors.
+  RK_STRONG_REF NSRange                *ranges;          // The results of the last match converted to NSRange format.
+                RKUInteger              rangesCount;     // The number of NSRanges in ranges.
+                RKMatchErrorCode        matchErrorCode;  // The result of the last match.
+                RKMatchCalloutFunction  calloutFunction; // Invoked for callout points in a regular expression.
+                void                   *calloutContext;  // Passed to calloutFunction.
+                RKUInteger              matchLimit;      // Overrides the backtracking limit of the regex when not 0.
+                RKUInteger              recursionLimit;  // Overrides the recursion limit of the regex when not 0.
+                uint64_t                matchTimeLimit;  // Overrides the time limit of the regex, in nanoseconds, when not 0.
+}
+
+/*!
+ @method     matchContext
+ @tocgroup   RKMatchContext Creating Match Contexts
+ @abstract   Returns a new, autoreleased @link RKMatchContext RKMatchContext@/link.
+*/
++ (RKMatchContext *)matchContext;
+/*!
+ @method     currentThreadMatchContext
+ @tocgroup   RKMatchContext Creating Match Contexts
+ @abstract   Returns the @link RKMatchContext RKMatchContext @/link that belongs to the current thread.
+ @discussion <p>The match context is created on demand the first time it is requested by a thread and is released when the thread exits.  It is used by @link getRangesInMatchContext:withCharacters:length:inRange:options:error: getRangesInMatchContext:withCharacters:length:inRange:options:error: @/link when a <span class="argument">matchContext</span> of <span class="code">NULL</span> is passed.</p>
+ <div class="box important"><div class="table"><div class="row"><div class="label cell">Important:</div><div class="message cell">The returned match context must only be used by the current thread.</div></div></div></div>
+*/
++ (RKMatchContext *)currentThreadMatchContext;
+
+/*!
+ @method     regex
+ @tocgroup   RKMatchContext Match Results
+ @abstract   Returns the @link RKRegex RKRegex @/link of the last match performed with the receiver, or <span class="code">nil</span> if no match has been performed.
+*/
+- (RKRegex *)regex;
+/*!
+ @method     captureCount
+ @tocgroup   RKMatchContext Match Results
+ @abstract   Returns the number of @link NSRange NSRange @/link structures available from @link ranges ranges@/link.
+*/
+- (RKUInteger)captureCount;
+/*!
+ @method     matchErrorCode
+ @tocgroup   RKMatchContext Match Results
+ @abstract   Returns the result of the last match performed with the receiver.
+ @result     The number of captures matched (&gt;0) on success, otherwise a @link RKMatchErrorCode RKMatchErrorCode @/link (&lt;0) on failure.
+*/
+- (RKMatchErrorCode)matchErrorCode;
+/*!
+ @method     ranges
+ @tocgroup   RKMatchContext Match Results
+ @abstract   Returns a pointer to the @link captureCount captureCount @/link @link NSRange NSRange @/link structures of the last successful match.
+ @discussion <p>The returned pointer is owned by the receiver and is only valid until the next match is performed with the receiver.  The ranges are in the same units as the <span class="argument">charactersBuffer</span> that was matched.</p>
+*/
+- (const NSRange *)ranges;
+/*!
+ @method     rangeForCaptureIndex:
+ @tocgroup   RKMatchContext Match Results
+ @abstract   Returns the range of <span class="argument">captureIndex</span> for the last successful match.
+ <div class="box important"><div class="table"><div class="row"><div class="label cell">Important:</div><div class="message cell">Raises a @link NSInvalidArgumentException NSInvalidArgumentException @/link if <span class="argument">captureIndex</span> is not less than @link captureCount captureCount@/link.</div></div></div></div>
+*/
+- (NSRange)rangeForCaptureIndex:(const RKUInteger)captureIndex;
+
+/*!
+ @method     setCalloutFunction:context:
+ @tocgroup   RKMatchContext Callouts
+ @abstract   Sets the function that is invoked when a callout point, <span class="regex">(?C)</span>, in a regular expression is reached during a match performed with the receiver.
+ @param      function The @link RKMatchCalloutFunction RKMatchCalloutFunction @/link to invoke, or <span class="code">NULL</span> to disable callouts.
+ @param      context A caller supplied pointer that is passed to <span class="argument">function</span>.
+*/
+- (void)setCalloutFunction:(RKMatchCalloutFunction)function context:(void *)context;
+/*!
+ @method     calloutFunction
+ @tocgroup   RKMatchContext Callouts
+ @abstract   Returns the receivers @link RKMatchCalloutFunction RKMatchCalloutFunction@/link.
+*/
+- (RKMatchCalloutFunction)calloutFunction;
+/*!
+ @method     calloutContext
+ @tocgroup   RKMatchContext Callouts
+ @abstract   Returns the receivers callout context pointer.
+*/
+- (void *)calloutContext;
+
+/*!
+ @method     setMatchLimit:
+ @tocgroup   RKMatchContext Match Limits
+ @abstract   Sets the backtracking limit for the matches performed with the receiver.
+ @discussion <p>Overrides the @link matchLimit matchLimit @/link of the regular expression being matched.  A limit of <span class="code">0</span> uses the limit of the regular expression.  See @link setMatchLimit: -[RKRegex setMatchLimit:]@/link.</p>
+*/
+- (void)setMatchLimit:(const RKUInteger)limit;
+
+/*!
+ @method     matchLimit
+ @tocgroup   RKMatchContext Match Limits
+ @abstract   Returns the receivers backtracking limit, or <span class="code">0</span> if the limit of the regular expression is used.
+*/
+- (RKUInteger)matchLimit;
+
+/*!
+ @method     setRecursionLimit:
+ @tocgroup   RKMatchContext Match Limits
+ @abstract   Sets the recursion limit for the matches performed with the receiver.
+ @discussion <p>Overrides the @link recursionLimit recursionLimit @/link of the regular expression being matched.  A limit of <span class="code">0</span> uses the limit of the regular expression.  See @link setRecursionLimit: -[RKRegex setRecursionLimit:]@/link.</p>
+*/
+- (void)setRecursionLimit:(const RKUInteger)limit;
+
+/*!
+ @method     recursionLimit
+ @tocgroup   RKMatchContext Match Limits
+ @abstract   Returns the receivers recursion limit, or <span class="code">0</span> if the limit of the regular expression is used.
+*/
+- (RKUInteger)recursionLimit;
+
+/*!
+ @method     setMatchTimeLimit:
+ @tocgroup   RKMatchContext Match Limits
+ @abstract   Sets the time limit, in seconds, for each match performed with the receiver.
+ @discussion <p>Overrides the @link matchTimeLimit matchTimeLimit @/link of the regular expression being matched.  A time limit of <span class="code">0.0</span> uses the time limit of the regular expression.  The time is only checked at callout points, see @link setMatchTimeLimit: -[RKRegex setMatchTimeLimit:]@/link.  The time is checked before the receivers @link RKMatchCalloutFunction RKMatchCalloutFunction@/link, if any, is invoked.</p>
+*/
+- (void)setMatchTimeLimit:(const NSTimeInterval)seconds;
+
+/*!
+ @method     matchTimeLimit
+ @tocgroup   RKMatchContext Match Limits
+ @abstract   Returns the receivers time limit in seconds, or <span class="code">0.0</span> if the time limit of the regular expression is used.
+*/
+- (NSTimeInterval)matchTimeLimit;
+
+@end
+
+#endif // _REGEXKIT_RKMATCHCONTEXT_H_
+    
+#ifdef __cplusplus
+  }  /* extern "C" */
+#endif
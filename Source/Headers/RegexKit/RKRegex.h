@@ -74,6 +74,16 @@ extern "C" {
    
                 RKInteger        referenceCountMinusOne; // Keep track of the reference count ourselves.
                 RKUInteger       hash;                   // Hash value for this object.
+                RKUInteger       metricsIndex;           // Index of this regexes match metrics, 0 until it matches while metrics are enabled.
+                RKUInteger       matchLimit;             // Backtracking limit for each match, or 0 for the PCRE library default.
+                RKUInteger       recursionLimit;         // Recursion limit for each match, or 0 for the PCRE library default.
+                uint64_t         matchTimeLimit;         // Time limit for each match in nanoseconds, or 0 for no time limit.
+                RKMatchEngine    matchEngine;            // The algorithm used for matches that only need the range of the entire match.
+                RKInteger        matchEngineSamples;     // The number of matches timed so far by RKMatchEngineAutomatic.
+                uint64_t         backtrackNanoseconds;   // Total time of the backtracking matches timed by RKMatchEngineAutomatic.
+                uint64_t         dfaNanoseconds;         // Total time of the DFA matches timed by RKMatchEngineAutomatic.
+                BOOL             automaticEngineIsDFA;   // RKMatchEngineAutomatic found the DFA algorithm to be faster.
+                BOOL             dfaUnsupported;         // The regex contains items that pcre_dfa_exec() does not support.
 
   RK_STRONG_REF char            *compiledRegexUTF8String;
   RK_STRONG_REF char            *compiledOptionUTF8String;
@@ -88,6 +98,9 @@ extern "C" {
  @group Instantiated Regular Expression Information
  @group Named Capture Information
  @group Matching Regular Expressions
+ @group Match Limits
+ @group Match Engine
+ @group Backtracking Hazard Analysis
 */
 
 
@@ -389,6 +402,204 @@ if(captureRanges != NULL) {
 */
 - (RKMatchErrorCode)getRanges:(NSRange * const RK_C99(restrict))ranges withCharacters:(const void * const RK_C99(restrict))charactersBuffer length:(const RKUInteger)length inRange:(const NSRange)searchRange options:(const RKMatchOption)options;
 - (RKMatchErrorCode)getRanges:(NSRange * const RK_C99(restrict))ranges withCharacters:(const void * const RK_C99(restrict))charactersBuffer length:(const RKUInteger)length inRange:(const NSRange)searchRange options:(const RKMatchOption)options error:(NSError **)error;
+/*!
+ @method    getRangesInMatchContext:withCharacters:length:inRange:options:
+ @tocgroup   RKRegex Matching Regular Expressions
+ @abstract   Low level regular expression matching method that stores its results in a reusable @link RKMatchContext RKMatchContext @/link.
+ @discussion <p>This method is functionally equivalent to @link getRanges:withCharacters:length:inRange:options: getRanges:withCharacters:length:inRange:options: @/link except that the match results are stored in <span class="argument">matchContext</span>.  The buffers of a @link RKMatchContext RKMatchContext @/link are sized the first time it is used with a regular expression and are reused by subsequent matches, which avoids the per match set up costs when the same regular expression is matched many times in a row.</p>
+   <p>If the @link RKMatchContext RKMatchContext @/link has a callout function set, the function is invoked for each callout point (ie, <span class="regex">(?C)</span>) that is reached during matching.</p>
+ @param matchContext The @link RKMatchContext RKMatchContext @/link to store the results in.  If <span class="code">NULL</span>, the @link RKMatchContext RKMatchContext @/link returned by @link currentThreadMatchContext currentThreadMatchContext @/link is used.
+ @param charactersBuffer Pointer to the start of characters to search.
+   <div class="box important"><div class="table"><div class="row"><div class="label cell">Important:</div><div class="message cell">Raises a @link NSInvalidArgumentException NSInvalidArgumentException @/link if <span class="argument">charactersBuffer</span> is <span class="code">NULL</span>.</div></div></div></div>
+ @param length Length of <span class="argument">charactersBuffer</span>.
+ @param searchRange The range within <span class="argument">charactersBuffer</span> to match.
+   <div class="box important"><div class="table"><div class="row"><div class="label cell">Important:</div><div class="message cell">Raises a @link NSRangeException NSRangeException @/link if <span class="argument">length</span> or <span class="argument">searchRange</span> is invalid or represents an invalid combination.</div></div></div></div>
+ @param options A mask of options specified by combining @link RKMatchOption RKMatchOption @/link flags with the C bitwise OR operator.
+ @result Returns the number of captures matched (&gt;0) on success, otherwise a @link RKMatchErrorCode RKMatchErrorCode @/link (&lt;0) on failure.  The result is also available from the @link RKMatchContext RKMatchContext @/link via @link matchErrorCode matchErrorCode @/link.
+*/
+- (RKMatchErrorCode)getRangesInMatchContext:(RKMatchContext * const RK_C99(restrict))matchContext withCharacters:(const void * const RK_C99(restrict))charactersBuffer length:(const RKUInteger)length inRange:(const NSRange)searchRange options:(const RKMatchOption)options;
+- (RKMatchErrorCode)getRangesInMatchContext:(RKMatchContext * const RK_C99(restrict))matchContext withCharacters:(const void * const RK_C99(restrict))charactersBuffer length:(const RKUInteger)length inRange:(const NSRange)searchRange options:(const RKMatchOption)options error:(NSError **)error;
+
+/*!
+ @method     matchesSubjects:count:results:
+ @tocgroup   RKRegex Matching Regular Expressions
+ @abstract   Matches the receiver against each of the <span class="argument">count</span> @link NSString NSString @/link objects in <span class="argument">subjects</span> and records which subjects matched in the caller supplied bitmap <span class="argument">resultsBitmap</span>.
+ @discussion <p>Invokes @link matchesSubjects:count:results:ranges:options:concurrent:error: matchesSubjects:count:results:ranges:options:concurrent:error: @/link with <span class="argument">resultRanges</span> set to <span class="code">NULL</span>, <span class="argument">options</span> set to @link RKMatchNoOptions RKMatchNoOptions@/link, and <span class="argument">concurrent</span> set to <span class="code">NO</span>.</p>
+ @param      subjects A C array of <span class="argument">count</span> @link NSString NSString @/link objects.
+ @param      count The number of objects in <span class="argument">subjects</span>.
+ @param      resultsBitmap Caller supplied pointer to a bitmap at least @link RKMatchResultsBitmapSize RKMatchResultsBitmapSize(count) @/link bytes long.
+ @result     The number of objects in <span class="argument">subjects</span> matched by the receiver.
+*/
+- (RKUInteger)matchesSubjects:(id const * const RK_C99(restrict))subjects count:(const RKUInteger)count results:(unsigned char * const RK_C99(restrict))resultsBitmap;
+/*!
+ @method     matchesSubjects:count:results:ranges:options:concurrent:error:
+ @tocgroup   RKRegex Matching Regular Expressions
+ @abstract   Matches the receiver against each of the <span class="argument">count</span> @link NSString NSString @/link objects in <span class="argument">subjects</span> in a single call.
+ @discussion <p>This method is intended for matching a large number of subjects against a single regular expression.  The per-match setup that the @link NSString NSString @/link additions perform for every subject, such as converting the regular expression argument in to a @link RKRegex RKRegex @/link object, is done once for the entire batch.  Only the location of the entire match is requested from the <a href="pcre/index.html"><i>PCRE</i></a> library, so the number of captures in the receivers regular expression does not affect the cost of a match.</p>
+ <p>If a subject is not a @link NSString NSString @/link, the result of its @link description description @/link method is matched instead.  A <span class="code">NULL</span> entry in <span class="argument">subjects</span> is not matched.</p>
+ <p>If <span class="argument">concurrent</span> is <span class="code">YES</span> and there are a sufficient number of <span class="argument">subjects</span>, the work is divided in to blocks and distributed across the threads of the RegexKit thread pool.  Results are written in the same order as <span class="argument">subjects</span> regardless of which thread performed the match.</p>
+ @param      subjects A C array of <span class="argument">count</span> @link NSString NSString @/link objects.
+ @param      count The number of objects in <span class="argument">subjects</span>.
+ @param      resultsBitmap Caller supplied pointer to a bitmap at least @link RKMatchResultsBitmapSize RKMatchResultsBitmapSize(count) @/link bytes long, or <span class="code">NULL</span>.  The bit for a subject is set if the receiver matched the subject, otherwise it is cleared.  Use @link RKMatchResultsBitmapIsSet RKMatchResultsBitmapIsSet @/link to test the result for a subject.
+ @param      resultRanges Caller supplied pointer to an array of at least <span class="argument">count</span> @link NSRange NSRange @/link structures, or <span class="code">NULL</span>.  Each element receives the range, in the subjects UTF-16 character indexes, of the entire match for the corresponding subject or <span class="code">{</span>@link NSNotFound NSNotFound@/link<span class="code">, 0}</span> if the receiver did not match the subject.
+ @param      options A mask of options specified by combining @link RKMatchOption RKMatchOption @/link flags with the C bitwise OR operator.
+ @param      concurrent If <span class="code">YES</span>, allows the subjects to be matched in parallel.
+ @param      error An optional parameter that if set and an error occurs, will contain a @link NSError NSError @/link object of the first error that occurred while matching.
+ @result     The number of objects in <span class="argument">subjects</span> matched by the receiver.
+*/
+- (RKUInteger)matchesSubjects:(id const * const RK_C99(restrict))subjects count:(const RKUInteger)count results:(unsigned char * const RK_C99(restrict))resultsBitmap ranges:(NSRange * const RK_C99(restrict))resultRanges options:(const RKMatchOption)options concurrent:(const BOOL)concurrent error:(NSError **)error;
+/*!
+ @method     matchesSubjectsInArray:results:
+ @tocgroup   RKRegex Matching Regular Expressions
+ @abstract   Matches the receiver against each of the @link NSString NSString @/link objects in <span class="argument">subjectsArray</span> and records which subjects matched in the caller supplied bitmap <span class="argument">resultsBitmap</span>.
+ @discussion <p>Invokes @link matchesSubjects:count:results:ranges:options:concurrent:error: matchesSubjects:count:results:ranges:options:concurrent:error: @/link with the objects of <span class="argument">subjectsArray</span>.</p>
+ @param      subjectsArray An @link NSArray NSArray @/link of @link NSString NSString @/link objects.
+ @param      resultsBitmap Caller supplied pointer to a bitmap at least @link RKMatchResultsBitmapSize RKMatchResultsBitmapSize([subjectsArray count]) @/link bytes long.
+ @result     The number of objects in <span class="argument">subjectsArray</span> matched by the receiver.
+*/
+- (RKUInteger)matchesSubjectsInArray:(NSArray * const RK_C99(restrict))subjectsArray results:(unsigned char * const RK_C99(restrict))resultsBitmap;
+/*!
+ @method     matchesSubjectsInArray:results:ranges:options:concurrent:error:
+ @tocgroup   RKRegex Matching Regular Expressions
+ @abstract   Matches the receiver against each of the @link NSString NSString @/link objects in <span class="argument">subjectsArray</span> in a single call.
+ @discussion <p>See @link matchesSubjects:count:results:ranges:options:concurrent:error: matchesSubjects:count:results:ranges:options:concurrent:error: @/link for a description of the arguments.</p>
+ @result     The number of objects in <span class="argument">subjectsArray</span> matched by the receiver.
+*/
+- (RKUInteger)matchesSubjectsInArray:(NSArray * const RK_C99(restrict))subjectsArray results:(unsigned char * const RK_C99(restrict))resultsBitmap ranges:(NSRange * const RK_C99(restrict))resultRanges options:(const RKMatchOption)options concurrent:(const BOOL)concurrent error:(NSError **)error;
+/*!
+ @method     getCapturesFromSubjects:count:columns:columnCount:options:concurrent:error:
+ @tocgroup   RKRegex Matching Regular Expressions
+ @abstract   Matches the receiver against each of the <span class="argument">count</span> @link NSString NSString @/link objects in <span class="argument">subjects</span> and stores the converted captures of every subject in the caller supplied <span class="argument">columns</span>.
+ @discussion <p>Each @link RKCaptureColumn RKCaptureColumn @/link in <span class="argument">columns</span> names a capture subpattern and the @link RKCaptureColumnType RKCaptureColumnType @/link to convert it to.  The value for the subject at index <i>n</i> is stored in element <i>n</i> of the columns <span class="code">values</span> array, so a table of results is built with one array per capture rather than one object per subject.  The capture names are resolved to capture indexes once for the entire batch, and no intermediate string objects are created for the captures.</p>
+ <p>If a subject is not matched, the capture did not participate in the match, or the capture could not be converted, the value is set to <span class="code">0</span>, or <span class="code">{</span>@link NSNotFound NSNotFound@/link<span class="code">, 0}</span> for @link RKCaptureColumnRange RKCaptureColumnRange@/link, and the subjects bit in the columns <span class="code">nullBitmap</span> is set.</p>
+ <p>Subjects are handled the same as @link matchesSubjects:count:results:ranges:options:concurrent:error: matchesSubjects:count:results:ranges:options:concurrent:error: @/link, including dividing the work across the threads of the RegexKit thread pool when <span class="argument">concurrent</span> is <span class="code">YES</span>.</p>
+ <div class="box important"><div class="table"><div class="row"><div class="label cell">Important:</div><div class="message cell">Raises a @link NSInvalidArgumentException NSInvalidArgumentException @/link if <span class="argument">subjects</span> or <span class="argument">columns</span> is <span class="code">NULL</span>, or a column has a <span class="code">NULL</span> <span class="code">captureName</span> or <span class="code">values</span>, or an invalid <span class="code">type</span>.  Raises a @link RKRegexCaptureReferenceException RKRegexCaptureReferenceException @/link if a <span class="code">captureName</span> does not exist in the receivers regular expression.</div></div></div></div>
+ @param      subjects A C array of <span class="argument">count</span> @link NSString NSString @/link objects.
+ @param      count The number of objects in <span class="argument">subjects</span>.
+ @param      columns A C array of <span class="argument">columnCount</span> @link RKCaptureColumn RKCaptureColumn @/link structures describing the captures to extract.
+ @param      columnCount The number of structures in <span class="argument">columns</span>.
+ @param      options A mask of options specified by combining @link RKMatchOption RKMatchOption @/link flags with the C bitwise OR operator.
+ @param      concurrent If <span class="code">YES</span>, allows the subjects to be matched in parallel.
+ @param      error An optional parameter that if set and an error occurs, will contain a @link NSError NSError @/link object of the first error that occurred while matching.
+ @result     The number of objects in <span class="argument">subjects</span> matched by the receiver.
+*/
+- (RKUInteger)getCapturesFromSubjects:(id const * const RK_C99(restrict))subjects count:(const RKUInteger)count columns:(RKCaptureColumn * const RK_C99(restrict))columns columnCount:(const RKUInteger)columnCount options:(const RKMatchOption)options concurrent:(const BOOL)concurrent error:(NSError **)error;
+/*!
+ @method     getCapturesFromSubjectsInArray:columns:columnCount:options:concurrent:error:
+ @tocgroup   RKRegex Matching Regular Expressions
+ @abstract   Matches the receiver against each of the @link NSString NSString @/link objects in <span class="argument">subjectsArray</span> and stores the converted captures of every subject in the caller supplied <span class="argument">columns</span>.
+ @discussion <p>See @link getCapturesFromSubjects:count:columns:columnCount:options:concurrent:error: getCapturesFromSubjects:count:columns:columnCount:options:concurrent:error: @/link for a description of the arguments.</p>
+ @result     The number of objects in <span class="argument">subjectsArray</span> matched by the receiver.
+*/
+- (RKUInteger)getCapturesFromSubjectsInArray:(NSArray * const RK_C99(restrict))subjectsArray columns:(RKCaptureColumn * const RK_C99(restrict))columns columnCount:(const RKUInteger)columnCount options:(const RKMatchOption)options concurrent:(const BOOL)concurrent error:(NSError **)error;
+
+/*!
+ @method     setMatchLimit:
+ @tocgroup   RKRegex Match Limits
+ @abstract   Sets the maximum amount of backtracking that a single match of the receiver may perform.
+ @discussion <p>Each match that reaches the limit is abandoned and returns @link RKMatchErrorMatchLimit RKMatchErrorMatchLimit@/link.  The limit is the number of times the <a href="pcre/index.html" class="section-link">PCRE</a> library's internal <span class="code">match()</span> function may be called, see @link PCRE_EXTRA_MATCH_LIMIT PCRE_EXTRA_MATCH_LIMIT @/link.  A limit of <span class="code">0</span> uses the <a href="pcre/index.html" class="section-link">PCRE</a> library default, which is typically 10,000,000.</p>
+ <p>The limit applies to every match performed with the receiver, but a @link RKMatchContext RKMatchContext @/link can override it for the matches performed with that match context.</p>
+ <div class="box important"><div class="table"><div class="row"><div class="label cell">Important:</div><div class="message cell">Regular expressions are shared through the @link regexCache regexCache@/link, so the limit also applies to the other users of the same regular expression and compile options.</div></div></div></div>
+ @seealso    @link RKAbortedMatchCount RKAbortedMatchCount @/link
+*/
+- (void)setMatchLimit:(const RKUInteger)limit;
+
+/*!
+ @method     matchLimit
+ @tocgroup   RKRegex Match Limits
+ @abstract   Returns the receivers backtracking limit, or <span class="code">0</span> if the <a href="pcre/index.html" class="section-link">PCRE</a> library default is used.
+*/
+- (RKUInteger)matchLimit;
+
+/*!
+ @method     setRecursionLimit:
+ @tocgroup   RKRegex Match Limits
+ @abstract   Sets the maximum depth of recursion that a single match of the receiver may reach.
+ @discussion <p>Each match that reaches the limit is abandoned and returns @link RKMatchErrorRecursionLimit RKMatchErrorRecursionLimit@/link.  See @link PCRE_EXTRA_MATCH_LIMIT_RECURSION PCRE_EXTRA_MATCH_LIMIT_RECURSION @/link.  A limit of <span class="code">0</span> uses the <a href="pcre/index.html" class="section-link">PCRE</a> library default.  The same sharing caveats as @link setMatchLimit: setMatchLimit: @/link apply.</p>
+*/
+- (void)setRecursionLimit:(const RKUInteger)limit;
+
+/*!
+ @method     recursionLimit
+ @tocgroup   RKRegex Match Limits
+ @abstract   Returns the receivers recursion limit, or <span class="code">0</span> if the <a href="pcre/index.html" class="section-link">PCRE</a> library default is used.
+*/
+- (RKUInteger)recursionLimit;
+
+/*!
+ @method     setMatchTimeLimit:
+ @tocgroup   RKRegex Match Limits
+ @abstract   Sets the maximum time, in seconds, that a single match of the receiver may take.
+ @discussion <p>Each match that is still in progress when the time limit expires is abandoned and returns @link RKMatchErrorTimeLimit RKMatchErrorTimeLimit@/link.  A time limit of <span class="code">0.0</span> disables the time limit.</p>
+ <p>The time is checked at the callout points of the regular expression, so a time limit has no effect unless the regular expression was compiled with @link RKCompileAutoCallout RKCompileAutoCallout@/link, which checks the time before every item in the pattern, or contains explicit <span class="regex">(?C)</span> callout points.  While a time limit is set, callout points in a regular expression are no longer an error when a match is performed without a @link RKMatchContext RKMatchContext @/link callout function.  Use @link setMatchLimit: setMatchLimit: @/link to bound the matches of regular expressions without callout points.  The same sharing caveats as @link setMatchLimit: setMatchLimit: @/link apply.</p>
+*/
+- (void)setMatchTimeLimit:(const NSTimeInterval)seconds;
+
+/*!
+ @method     matchTimeLimit
+ @tocgroup   RKRegex Match Limits
+ @abstract   Returns the receivers time limit in seconds, or <span class="code">0.0</span> if there is no time limit.
+*/
+- (NSTimeInterval)matchTimeLimit;
+
+/*!
+ @method     setMatchEngine:
+ @tocgroup   RKRegex Match Engine
+ @abstract   Sets the matching algorithm that the receiver uses for the matches that only need the range of the entire match.
+ @discussion <p>The <a href="pcre/index.html" class="section-link">PCRE</a> library's DFA algorithm never backtracks, so a failing match takes time proportional to the length of the subject times the size of the regular expression, even when the backtracking algorithm would take exponential time.  It does not report captures, and it finds the longest match rather than the first one the backtracking algorithm finds, see @link RKMatchDFA RKMatchDFA@/link.</p>
+ <p>With @link RKMatchEngineAutomatic RKMatchEngineAutomatic@/link, the first matches that only need a yes or no answer alternate between the two algorithms, and once enough of them have been timed the faster algorithm is used from then on.  Matches that need the range of the match, or a search range that does not extend to the end of the subject, are always performed with the backtracking algorithm so that the answer never changes.  Regular expressions that contain atomic groups or possessive quantifiers always use the backtracking algorithm, see @link RKMatchDFA RKMatchDFA@/link.</p>
+ <p>Matches that need captures always use the backtracking algorithm unless @link RKMatchDFA RKMatchDFA @/link is passed in the match options.  The workspace that the DFA algorithm needs is allocated once per thread and reused.  The same sharing caveats as @link setMatchLimit: setMatchLimit: @/link apply.</p>
+ @param      matchEngine The @link RKMatchEngine RKMatchEngine @/link to use.
+*/
+- (void)setMatchEngine:(const RKMatchEngine)matchEngine;
+
+/*!
+ @method     matchEngine
+ @tocgroup   RKRegex Match Engine
+ @abstract   Returns the receivers @link RKMatchEngine RKMatchEngine@/link.
+*/
+- (RKMatchEngine)matchEngine;
+
+@end
+
+@interface RKRegex (HazardAnalysis)
+
+/*!
+ @method     hazardsForRegexString:options:
+ @tocgroup   RKRegex Backtracking Hazard Analysis
+ @abstract   Returns the constructs in <span class="argument">regexString</span> that can cause a failing match to backtrack exponentially or polynomially in the length of the subject.
+ @discussion <p>The regular expression is examined without being compiled.  Each hazard is described by a dictionary with the keys @link RKRegexHazardTypeKey RKRegexHazardTypeKey@/link, @link RKRegexHazardRangeKey RKRegexHazardRangeKey@/link, @link RKRegexHazardExponentialKey RKRegexHazardExponentialKey@/link, @link RKRegexHazardHardenableKey RKRegexHazardHardenableKey@/link, and @link RKRegexHazardDescriptionKey RKRegexHazardDescriptionKey@/link.  See @link RKRegexHazard RKRegexHazard @/link for the constructs that are recognized.</p>
+ <p>The analysis is conservative in the constructs it does not understand: atomic groups and possessive quantifiers can not be backtracked in to and are never reported as hazards, and back references, recursion, conditional subpatterns, and lookaround assertions are assumed to be able to match anything, which prevents the hazards next to them from being hardened.  A regular expression without any hazards may still match slowly.</p>
+ @param regexString The regular expression to analyze.
+ @param options A mask of options specified by combining @link RKCompileOption RKCompileOption @/link flags with the C bitwise OR operator.  Only @link RKCompileCaseless RKCompileCaseless@/link, @link RKCompileExtended RKCompileExtended@/link, @link RKCompileDotAll RKCompileDotAll@/link, and @link RKCompileUngreedy RKCompileUngreedy @/link affect the analysis.
+ @result     Returns an @link NSArray NSArray @/link of hazard dictionaries ordered by their location in <span class="argument">regexString</span>, which is empty if no hazards were found.
+*/
++ (NSArray *)hazardsForRegexString:(NSString * const)regexString options:(const RKCompileOption)options;
+
+/*!
+ @method     hardenedRegexString:options:hazards:
+ @tocgroup   RKRegex Backtracking Hazard Analysis
+ @abstract   Returns a copy of <span class="argument">regexString</span> with the hazards that can be removed safely rewritten with possessive quantifiers.
+ @discussion <p>A hazard is rewritten only when the repeated group can match exactly the runs of a single set of characters, such as <span class="regex">(a+)+</span> or <span class="regex">(?:&#92;w|&#92;d)*</span>, and nothing that can follow the group can begin with one of those characters.  Under those conditions giving characters back to the group can never lead to a match, so making its quantifier possessive, as in <span class="regex">(a+)++</span>, does not change what the regular expression matches or captures.</p>
+ @param regexString The regular expression to harden.
+ @param options A mask of options specified by combining @link RKCompileOption RKCompileOption @/link flags with the C bitwise OR operator.
+ @param hazards An optional pointer to an @link NSArray NSArray @/link that is set to the hazards that remain in the hardened regular expression, in the same format as @link hazardsForRegexString:options: hazardsForRegexString:options:@/link.
+ @result     Returns the hardened regular expression, which is <span class="argument">regexString</span> if nothing was rewritten.
+*/
++ (NSString *)hardenedRegexString:(NSString * const)regexString options:(const RKCompileOption)options hazards:(NSArray **)hazards;
+
+/*!
+ @method     regexWithRegexString:options:analysis:error:
+ @tocgroup   RKRegex Backtracking Hazard Analysis
+ @abstract   Convenience method for an autoreleased @link RKRegex RKRegex @/link object that is analyzed for backtracking hazards before it is compiled.
+ @discussion <p>If <span class="argument">analysisOptions</span> includes @link RKRegexAnalysisHarden RKRegexAnalysisHarden@/link, <span class="argument">regexString</span> is first rewritten with @link hardenedRegexString:options:hazards: hardenedRegexString:options:hazards:@/link, and the returned regular expression is compiled from the hardened string.  If any of the remaining hazards is of a kind rejected by <span class="argument">analysisOptions</span>, <span class="code">nil</span> is returned and <span class="argument">error</span> is set to an @link NSError NSError @/link in the @link RKRegexErrorDomain RKRegexErrorDomain @/link whose <span class="argument">userInfo</span> dictionary contains the hazards under @link RKRegexHazardsErrorKey RKRegexHazardsErrorKey@/link.</p>
+ @param regexString The regular expression to analyze and compile.
+ @param options A mask of options specified by combining @link RKCompileOption RKCompileOption @/link flags with the C bitwise OR operator.
+ @param analysisOptions A mask of options specified by combining @link RKRegexAnalysisOption RKRegexAnalysisOption @/link flags with the C bitwise OR operator.
+ @param error An optional pointer to an @link NSError NSError @/link that is set if the regular expression is rejected or can not be compiled.
+ @result Returns an autoreleased @link RKRegex RKRegex @/link object if successful, <span class="code">nil</span> otherwise.
+*/
++ (id)regexWithRegexString:(NSString * const)regexString options:(const RKCompileOption)options analysis:(const RKRegexAnalysisOption)analysisOptions error:(NSError **)error;
 
 @end
 
@@ -0,0 +1,163 @@
+//
+//  RKReplacementTemplate.h
+//  RegexKit
+//  http://regexkit.sourceforge.net/
+//
+
+/*
+ Copyright © 2007-2008, John Engelhart
+ 
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+ notice, this list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright
+ notice, this list of conditions and the following disclaimer in the
+ documentation and/or other materials provided with the distribution.
+ 
+ * Neither the name of the Zang Industries nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  
+#ifndef _REGEXKIT_RKREPLACEMENTTEMPLATE_H_
+#define _REGEXKIT_RKREPLACEMENTTEMPLATE_H_ 1
+
+/*!
+ @header RKReplacementTemplate
+*/
+
+/*!
+@class      RKReplacementTemplate
+@toc        RKReplacementTemplate
+@abstract   Precompiled Search and Replace Reference String
+*/
+
+/*!
+ @toc   RKReplacementTemplate
+ @group Creating Replacement Templates
+ @group Replacement Template Information
+ @group Search and Replace
+*/
+
+@class RKRegex, RKCache;
+
+#import <Foundation/Foundation.h>
+#import <RegexKit/RegexKitDefines.h>
+#import <RegexKit/RegexKitTypes.h>
+
+@interface RKReplacementTemplate : NSObject {
+                RKRegex    *regex;                 // The regex the reference string was compiled against.
+                NSString   *referenceString;       // The original reference string.
+  RK_STRONG_REF char       *referenceCharacters;   // Private UTF8 copy of referenceString.  The instructions point in to this buffer.
+  RK_STRONG_REF void       *instructions;          // The compiled reference instructions.
+                RKUInteger  instructionsCount;     // The number of instructions.
+                RKUInteger  replacementTemplateHash;
+}
+
+/*!
+ @method     replacementTemplateCache
+ @tocgroup   RKReplacementTemplate Creating Replacement Templates
+ @abstract   Returns the @link RKCache RKCache @/link used by @link replacementTemplateWithRegex:referenceString: replacementTemplateWithRegex:referenceString: @/link to cache compiled replacement templates.
+*/
++ (RKCache *)replacementTemplateCache;
+/*!
+ @method     replacementTemplateWithRegex:referenceString:
+ @tocgroup   RKReplacementTemplate Creating Replacement Templates
+ @abstract   Returns a compiled @link RKReplacementTemplate RKReplacementTemplate @/link for <span class="argument">referenceString</span> and <span class="argument">aRegex</span>.
+ @discussion <p>The returned template is cached, so subsequent requests for the same <span class="argument">aRegex</span> and <span class="argument">referenceString</span> return the already compiled template.</p>
+   <p><span class="argument">referenceString</span> uses the same syntax as @link stringByMatching:replace:withReferenceString: stringByMatching:replace:withReferenceString:@/link.</p>
+ @param      aRegex A regular expression string or @link RKRegex RKRegex @/link object.
+ @param      referenceString The string to compile.
+   <div class="box important"><div class="table"><div class="row"><div class="label cell">Important:</div><div class="message cell">Raises @link RKRegexCaptureReferenceException RKRegexCaptureReferenceException @/link if <span class="argument">referenceString</span> contains an invalid capture reference.</div></div></div></div>
+*/
++ (RKReplacementTemplate *)replacementTemplateWithRegex:(id)aRegex referenceString:(NSString * const)referenceString;
++ (RKReplacementTemplate *)replacementTemplateWithRegex:(id)aRegex referenceString:(NSString * const)referenceString error:(NSError **)error;
+/*!
+ @method     initWithRegex:referenceString:error:
+ @tocgroup   RKReplacementTemplate Creating Replacement Templates
+ @abstract   Initializes a compiled @link RKReplacementTemplate RKReplacementTemplate @/link for <span class="argument">referenceString</span> and <span class="argument">aRegex</span>.
+ @discussion <p>Capture references are resolved at compile time.  Named capture references are resolved to their capture index unless the regular expression allows duplicate capture names, in which case they are resolved for each match.</p>
+ @param      aRegex A regular expression string or @link RKRegex RKRegex @/link object.
+ @param      referenceString The string to compile.
+ @param      error An optional parameter that if set and an error occurs, will contain a @link NSError NSError @/link object that describes the problem.  This may be set to <span class="code">NULL</span> if information about any errors is not required.
+ @result     Returns an initialized @link RKReplacementTemplate RKReplacementTemplate @/link, or <span class="code">nil</span> if <span class="argument">referenceString</span> could not be compiled.
+*/
+- (id)initWithRegex:(id)aRegex referenceString:(NSString * const)referenceString error:(NSError **)error;
+
+/*!
+ @method     regex
+ @tocgroup   RKReplacementTemplate Replacement Template Information
+ @abstract   Returns the @link RKRegex RKRegex @/link the receiver was compiled against.
+*/
+- (RKRegex *)regex;
+/*!
+ @method     referenceString
+ @tocgroup   RKReplacementTemplate Replacement Template Information
+ @abstract   Returns the reference string the receiver was compiled from.
+*/
+- (NSString *)referenceString;
+
+/*!
+ @method     stringByMatching:replace:
+ @tocgroup   RKReplacementTemplate Search and Replace
+ @abstract   Returns a new @link NSString NSString @/link containing the results of repeatedly searching <span class="argument">subjectString</span> with the receivers regular expression and replacing up to <span class="argument">count</span> matches with the receivers expanded reference string.
+ @discussion <p>This method is functionally equivalent to @link stringByMatching:replace:withReferenceString: stringByMatching:replace:withReferenceString: @/link, except that the reference string is not parsed again for every call.</p>
+ @param      subjectString The string to search.
+ @param      count The maximum number of replacements to perform, or @link RKReplaceAll RKReplaceAll @/link to replace all matches.
+ @result     Returns a new @link NSString NSString @/link, or <span class="argument">subjectString</span> if there were no replacements.
+*/
+- (NSString *)stringByMatching:(NSString * const)subjectString replace:(const RKUInteger)count;
+/*!
+ @method     stringByMatching:inRange:replace:error:
+ @tocgroup   RKReplacementTemplate Search and Replace
+ @abstract   Returns a new @link NSString NSString @/link containing the results of repeatedly searching <span class="argument">subjectString</span> within <span class="argument">range</span> with the receivers regular expression and replacing up to <span class="argument">count</span> matches with the receivers expanded reference string.
+ @param      subjectString The string to search.
+ @param      range The range of <span class="argument">subjectString</span> to search.
+ @param      count The maximum number of replacements to perform, or @link RKReplaceAll RKReplaceAll @/link to replace all matches.
+ @param      error An optional parameter that if set and an error occurs, will contain a @link NSError NSError @/link object that describes the problem.  This may be set to <span class="code">NULL</span> if information about any errors is not required.
+ @result     Returns a new @link NSString NSString @/link, <span class="argument">subjectString</span> if there were no replacements, or <span class="code">NULL</span> if an error occurred.
+*/
+- (NSString *)stringByMatching:(NSString * const)subjectString inRange:(const NSRange)range replace:(const RKUInteger)count error:(NSError **)error;
+/*!
+ @method     appendStringByMatching:inRange:replace:toMutableData:error:
+ @tocgroup   RKReplacementTemplate Search and Replace
+ @abstract   Appends the <span class="code">UTF8</span> encoded results of repeatedly searching <span class="argument">subjectString</span> within <span class="argument">range</span> and replacing up to <span class="argument">count</span> matches with the receivers expanded reference string to <span class="argument">destination</span>.
+ @discussion <p>The replaced text is written directly to <span class="argument">destination</span> as each match is processed, so no intermediate @link NSString NSString @/link is created.  This allows the results of many replacements to be accumulated in a single buffer.</p>
+   <p>All of <span class="argument">subjectString</span> is appended, including the text that lies outside of <span class="argument">range</span>, even if there were no replacements.</p>
+ @param      subjectString The string to search.
+ @param      range The range of <span class="argument">subjectString</span> to search.
+ @param      count The maximum number of replacements to perform, or @link RKReplaceAll RKReplaceAll @/link to replace all matches.
+ @param      destination The @link NSMutableData NSMutableData @/link to append the results to.
+ @param      error An optional parameter that if set and an error occurs, will contain a @link NSError NSError @/link object that describes the problem.  This may be set to <span class="code">NULL</span> if information about any errors is not required.
+ @result     Returns the number of replacements performed, or <span class="code">NSNotFound</span> if an error occurred.  If an error occurs, <span class="argument">destination</span> may contain a partial result.
+*/
+- (RKUInteger)appendStringByMatching:(NSString * const)subjectString inRange:(const NSRange)range replace:(const RKUInteger)count toMutableData:(NSMutableData * const)destination error:(NSError **)error;
+
+@end
+
+#endif // _REGEXKIT_RKREPLACEMENTTEMPLATE_H_
+    
+#ifdef __cplusplus
+  }  /* extern "C" */
+#endif
@@ -54,10 +54,25 @@ extern "C" {
 #import <pthread.h>
 
 #define RK_SORTED_REGEX_COLLECTION_CACHE_BUCKETS 251
+#define RK_SORTED_REGEX_COLLECTION_CACHE_LINE    64
+// The minimum time between two resorts of the same collection, in nanoseconds.
+#define RK_SORTED_REGEX_COLLECTION_RESORT_INTERVAL (50ULL * 1000000ULL)
+
+// Each element's live hit counter is on its own cache line, so that counting the hits of one regex does not slow down the
+// counting for its neighbors.  The hitCount in the element is a snapshot of the counter that is only updated when resorting.
+struct collectionHitCounter {
+  RKUInteger hitCount;
+  char       padding[RK_SORTED_REGEX_COLLECTION_CACHE_LINE - sizeof(RKUInteger)];
+};
+
+typedef struct collectionHitCounter RK_STRONG_REF RKCollectionHitCounter;
 
 struct collectionElement {
   RKRegex    *regex;
   RKUInteger  hitCount;
+  RKUInteger  unionCaptureIndex; // The capture in unionRegex that is set when this element matches, or 0 if it is matched on its own.
+  uint32_t    startBytes[8];     // The bytes a match can start with, if hasStartBytes is YES.
+  BOOL        hasStartBytes;
 };
 
 typedef struct collectionElement RK_STRONG_REF RKCollectionElement;
@@ -79,6 +94,9 @@ struct _sortedRegexCollectionThreadMatchState {
   RKSortedRegexCollection *self;
     
   BOOL                     findLowestIndex;
+  BOOL                     skipUnionElements;
+  BOOL                     hasSubjectBytes;
+  uint32_t                 subjectBytes[8];
   RKUInteger               atSortedIndex;
   RKUInteger               highestMatchingArrayIndex;
   RKUInteger               finished;
@@ -102,9 +120,17 @@ typedef struct _sortedRegexCollectionThreadMatchState RK_STRONG_REF RKSortedRege
   RKUInteger                          collectionHash;
   RKUInteger                          collectionCount;
   RKUInteger                          resortRequired;
+  RKUInteger                          resortInProgress;
+  uint64_t                            lastResortNanoseconds;
   RKCollectionElement RK_STRONG_REF  *elements;
   RKCollectionElement RK_STRONG_REF **sortedElements;
   RKUInteger                          elementsCount;
+  RKCollectionHitCounter             *hitCounters;
+  void                               *hitCountersAllocation;
+  RKRegex                            *unionRegex;
+  RKUInteger                          unionElementsCount;
+  BOOL                                unionMatching;
+  RKUInteger                          startBytesElementsCount;
 
   RKUInteger RK_STRONG_REF           *missedObjectHashCache;
   
@@ -123,6 +149,11 @@ typedef struct _sortedRegexCollectionThreadMatchState RK_STRONG_REF RKSortedRege
 
 - (id)collection;
 
+- (void)setUnionMatching:(const BOOL)enableUnionMatching;
+- (BOOL)unionMatching;
+
+- (void)resortInBackground:(id)unused;
+
 - (RKRegex *)regexMatching:(id const RK_C99(restrict))matchObject lowestIndexInCollection:(const BOOL)lowestIndex;
 
 - (BOOL)isMatchedByAnyRegex:(id const RK_C99(restrict))matchObject;
@@ -0,0 +1,112 @@
+//
+//  RKSubstring.h
+//  RegexKit
+//  http://regexkit.sourceforge.net/
+//
+
+/*
+ Copyright © 2007-2008, John Engelhart
+ 
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+ notice, this list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright
+ notice, this list of conditions and the following disclaimer in the
+ documentation and/or other materials provided with the distribution.
+ 
+ * Neither the name of the Zang Industries nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  
+#ifndef _REGEXKIT_RKSUBSTRING_H_
+#define _REGEXKIT_RKSUBSTRING_H_ 1
+
+/*!
+ @header RKSubstring
+*/
+
+/*!
+@class      RKSubstring
+@toc        RKSubstring
+@abstract   Lightweight Immutable View of Part of a String
+@discussion <p>A @link RKSubstring RKSubstring @/link is an immutable @link NSString NSString @/link that refers directly to the characters of the string it was created from, rather than a private copy of them.  When the subject string is immutable, creating a @link RKSubstring RKSubstring @/link does not copy or convert any characters, it only retains the subject string so that its characters remain valid.  When the subject string is mutable, only the characters of the substring are copied.</p>
+<p>Without Core Foundation, such as with GNUstep, there is no way to get at the characters of the subject string directly, only at an autoreleased copy of them, so the characters of the substring are always copied.</p>
+<p>Substrings that contain only ASCII characters answer @link NSString NSString @/link primitive methods directly from the subject strings characters.  The first time a substring that contains non-ASCII characters needs its UTF16 characters, a private @link NSString NSString @/link copy is created and used from then on.</p>
+<p>Since @link copy copy @/link returns the receiver, a copied @link RKSubstring RKSubstring @/link keeps the subject string alive.  Use @link stringByCopyingCharacters stringByCopyingCharacters @/link to create an independent @link NSString NSString@/link, for example when a small substring of a very large subject string is kept for a long time.</p>
+*/
+
+/*!
+ @toc   RKSubstring
+ @group Creating Substrings
+ @group Creating Strings from a Substring
+*/
+
+#import <Foundation/Foundation.h>
+#import <RegexKit/RegexKitDefines.h>
+#import <RegexKit/RegexKitTypes.h>
+
+@interface RKSubstring : NSString {
+                NSString   *subjectString;      // The immutable string that characters points in to, or NULL if the characters were copied to ownedCharacters.
+  RK_STRONG_REF const char *characters;         // The first character of the substring.  Not NULL terminated unless it is ownedCharacters.
+  RK_STRONG_REF char       *ownedCharacters;    // Private NULL terminated copy of the characters when the subject string is not immutable.
+                NSString   *characterString;    // Lazily created NSString copy, used for non-ASCII characters.
+                RKUInteger  charactersLength;   // The length of characters in bytes.
+                RKUInteger  charactersEncoding; // The encoding of characters, the same as the RKStringBuffer it was created from.
+                RKUInteger  isASCII:1;
+}
+
+/*!
+ @method     substringWithString:range:
+ @tocgroup   RKSubstring Creating Substrings
+ @abstract   Returns an autoreleased @link RKSubstring RKSubstring @/link of the characters of <span class="argument">string</span> within <span class="argument">range</span>.
+ @param      string The subject string.
+ @param      range The range of the characters of <span class="argument">string</span>.
+ @discussion Raises @link NSRangeException NSRangeException @/link if <span class="argument">range</span> is not within <span class="argument">string</span>.
+*/
++ (id)substringWithString:(NSString * const)string range:(const NSRange)range;
+
+/*!
+ @method     stringByCopyingCharacters
+ @tocgroup   RKSubstring Creating Strings from a Substring
+ @abstract   Returns an autoreleased @link NSString NSString @/link with a private copy of the receivers characters.
+ @discussion The returned string does not refer to the receiver or its subject string.
+*/
+- (NSString *)stringByCopyingCharacters;
+/*!
+ @method     noCopyString
+ @tocgroup   RKSubstring Creating Strings from a Substring
+ @abstract   Returns an autoreleased @link NSString NSString @/link created with @link CFStringCreateWithBytesNoCopy CFStringCreateWithBytesNoCopy @/link that uses the receivers characters without copying them.
+ @discussion <p>This is intended for passing the substring to functions that work best with a native @link NSString NSString@/link, such as the Core Foundation @link CFString CFString @/link functions.  Depending on the encoding of the characters, the string may still need to convert them.</p>
+   <div class="box important"><div class="table"><div class="row"><div class="label cell">Important:</div><div class="message cell">The returned string does not retain the receiver.  The receiver must remain valid for as long as the returned string is used.</div></div></div></div>
+*/
+- (NSString *)noCopyString;
+
+@end
+
+#endif // _REGEXKIT_RKSUBSTRING_H_
+  
+#ifdef __cplusplus
+  }  /* extern "C" */
+#endif
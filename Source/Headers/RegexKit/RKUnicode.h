@@ -86,6 +86,8 @@ RKREGEX_STATIC_INLINE char *RKGetUTF8String(NSString *string, char *temporaryBuf
 unsigned char RKLengthOfUTF8Character(const unsigned char *p)  RK_ATTRIBUTES(nonnull, pure, used, visibility("hidden"));
 NSRange       RKConvertUTF8ToUTF16RangeForStringBuffer(RKStringBuffer *stringBuffer, NSRange utf8Range);
 NSRange       RKConvertUTF16ToUTF8RangeForStringBuffer(RKStringBuffer *stringBuffer, NSRange utf16Range);
+RKUInteger    RKSimpleCaseMapUTF8(const char *fromBuffer, RKUInteger fromLength, char *toBuffer, BOOL toUppercase) RK_ATTRIBUTES(used, visibility("hidden"));
+void          RKConvertUTF8ToUTF16RangesForStringBuffer(RKStringBuffer *stringBuffer, NSRange *ranges, RKUInteger count, RKUInteger *utf8Anchor, RKUInteger *utf16Anchor);
 NSRange       RKRangeForUTF8CharacterAtLocation(RKStringBuffer *stringBuffer, RKUInteger utf8Location);
 
 extern const unsigned char utf8ExtraBytes[];
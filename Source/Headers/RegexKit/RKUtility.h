@@ -55,6 +55,9 @@ extern "C" {
  @toc Functions
  @group Utility Functions
  @group Unicode Character Index Conversions
+ @group Replacement Callbacks
+ @group Lock Profiling
+ @group Regex Metrics
 */  
 
 /*!
@@ -127,6 +130,173 @@ REGEXKIT_EXTERN NSString *RKStringFromCompileErrorCode(const RKCompileErrorCode
  @result     Returns a string representation of a @link RKMatchErrorCode RKMatchErrorCode@/link.
 */
 REGEXKIT_EXTERN NSString *RKStringFromMatchErrorCode(const RKMatchErrorCode decodeErrorCode) RK_ATTRIBUTES(used);
+
+/*!
+ @function   RKSetLockProfilingEnabled
+ @tocgroup   Functions Lock Profiling
+ @abstract   Enables or disables contention profiling of the locks that RegexKit uses internally, such as the locks that protect the caches and sorted regex collections.
+ @discussion <p>Profiling is disabled by default.  While it is disabled the only cost is a single test of a global flag when a lock is acquired or released.</p>
+ <p>While it is enabled, every lock records how many times it was acquired and how many times it was contended, a histogram of the time spent waiting for the lock when it was contended, a histogram of the time that the lock was held, and up to eight call sites that the lock was contended at.  Hold times are only recorded for exclusive locks, which excludes read locks.  Locks are not profiled while the application is single threaded.</p>
+ @param      enableProfiling <span class="code">YES</span> to enable profiling, <span class="code">NO</span> to disable it.
+ @seealso    @link RKLockProfiles RKLockProfiles @/link
+ @seealso    @link RKDumpLockProfiles RKDumpLockProfiles @/link
+*/
+REGEXKIT_EXTERN void RKSetLockProfilingEnabled(const BOOL enableProfiling) RK_ATTRIBUTES(used);
+
+/*!
+ @function   RKLockProfilingEnabled
+ @tocgroup   Functions Lock Profiling
+ @abstract   Returns whether or not lock contention profiling is enabled.
+ @result     Returns <span class="code">YES</span> if lock contention profiling is enabled, <span class="code">NO</span> otherwise.
+*/
+REGEXKIT_EXTERN BOOL RKLockProfilingEnabled(void) RK_ATTRIBUTES(used);
+
+/*!
+ @function   RKLockProfiles
+ @tocgroup   Functions Lock Profiling
+ @abstract   Returns the contention profiles of all the locks that currently exist.
+ @discussion <p>Each profile is a dictionary with the following keys:</p>
+ <ul>
+ <li><span class="code">name</span> The name of the lock, for example the description of the cache that it protects, or an empty string.</li>
+ <li><span class="code">lockClass</span> and <span class="code">lock</span> The class and address of the lock.</li>
+ <li><span class="code">acquiredCount</span> and <span class="code">contendedCount</span> The number of times the lock was acquired, and the number of times that a thread had to wait for it.</li>
+ <li><span class="code">waitHistogram</span> and <span class="code">holdHistogram</span> Arrays of 32 counts, where index <i>n</i> counts the waits or holds that took at least 2<sup><i>n</i></sup> nanoseconds.  The last index also counts everything longer.</li>
+ <li><span class="code">callSites</span> An array of the call sites that the lock was contended at, most contended first.  Each call site is a dictionary with the keys <span class="code">callSite</span>, <span class="code">contendedCount</span>, and <span class="code">waitMicroseconds</span>.</li>
+ <li><span class="code">droppedCallSitesCount</span> The number of times the lock was contended at a call site that could not be recorded.</li>
+ </ul>
+ <p>The counters are updated without locking, so a profile is a close approximation rather than an exact snapshot.</p>
+ @result     Returns an array of dictionaries, one for each lock.
+*/
+REGEXKIT_EXTERN NSArray *RKLockProfiles(void) RK_ATTRIBUTES(used);
+
+/*!
+ @function   RKClearLockProfiles
+ @tocgroup   Functions Lock Profiling
+ @abstract   Resets the contention profiles of all the locks that currently exist.
+*/
+REGEXKIT_EXTERN void RKClearLockProfiles(void) RK_ATTRIBUTES(used);
+
+/*!
+ @function   RKDumpLockProfiles
+ @tocgroup   Functions Lock Profiling
+ @abstract   Writes the contention profiles of all the locks that have been acquired to <span class="argument">fileDescriptor</span>.
+ @discussion <p>Only async-signal-safe functions are used, so this may be called from a signal handler.  For the same reason call sites are written as addresses, which can be symbolized with <span class="code">atos</span> or <span class="code">addr2line</span>.</p>
+ @param      fileDescriptor The file descriptor to write to, for example <span class="code">STDERR_FILENO</span>.
+ @seealso    @link RKDumpLockProfilesOnSignal RKDumpLockProfilesOnSignal @/link
+*/
+REGEXKIT_EXTERN void RKDumpLockProfiles(int fileDescriptor) RK_ATTRIBUTES(used);
+
+/*!
+ @function   RKDumpLockProfilesOnSignal
+ @tocgroup   Functions Lock Profiling
+ @abstract   Installs a handler for <span class="argument">signalNumber</span> that writes the lock contention profiles to standard error.
+ @discussion <p>This allows the profiles of a running process to be inspected with, for example, <span class="code">kill -USR2 <i>pid</i></span>.  Any existing handler for <span class="argument">signalNumber</span> is replaced.</p>
+ @param      signalNumber The signal to install the handler for, for example <span class="code">SIGUSR2</span>.
+ @result     Returns <span class="code">YES</span> if the handler was installed, <span class="code">NO</span> otherwise.
+*/
+REGEXKIT_EXTERN BOOL RKDumpLockProfilesOnSignal(int signalNumber) RK_ATTRIBUTES(used);
+
+/*!
+ @function   RKSetRegexMetricsEnabled
+ @tocgroup   Functions Regex Metrics
+ @abstract   Enables or disables the collection of match metrics for every @link RKRegex RKRegex @/link.
+ @discussion <p>Metrics are disabled by default.  While they are disabled the only cost is a single test of a global flag for each match.</p>
+ <p>While they are enabled, every match records the number of match calls, the number of bytes that were scanned, the number of successful matches, the number of errors, and the time taken in a latency histogram.  Regular expressions with the same pattern and compile options share their metrics.  The counters are kept per thread and are only added together when they are read, so recording a match does not lock or use any atomic operations.</p>
+ <p>Disabling metrics does not clear the metrics that have already been collected.</p>
+ @param      enableMetrics <span class="code">YES</span> to enable metrics, <span class="code">NO</span> to disable them.
+ @seealso    @link RKRegexMetricsSnapshot RKRegexMetricsSnapshot @/link
+*/
+REGEXKIT_EXTERN void RKSetRegexMetricsEnabled(const BOOL enableMetrics) RK_ATTRIBUTES(used);
+
+/*!
+ @function   RKRegexMetricsEnabled
+ @tocgroup   Functions Regex Metrics
+ @abstract   Returns whether or not match metrics are being collected.
+ @result     Returns <span class="code">YES</span> if match metrics are enabled, <span class="code">NO</span> otherwise.
+*/
+REGEXKIT_EXTERN BOOL RKRegexMetricsEnabled(void) RK_ATTRIBUTES(used);
+
+/*!
+ @function   RKRegexMetricsSnapshot
+ @tocgroup   Functions Regex Metrics
+ @abstract   Returns the match metrics of every regular expression that has matched since the metrics were last cleared.
+ @discussion <p>The dictionary contains the totals for all regular expressions, along with a <span class="code">regexes</span> key whose value is an array with a dictionary for each regular expression.  Both contain the following keys:</p>
+ <ul>
+ <li><span class="code">matchCount</span> The number of times the regular expression was matched against a subject.</li>
+ <li><span class="code">successfulMatchCount</span> and <span class="code">errorCount</span> The number of those matches that found a match, and that failed with an error other than @link RKMatchErrorNoMatch RKMatchErrorNoMatch @/link.</li>
+ <li><span class="code">abortedCount</span> The number of errors that were caused by a match, recursion, or time limit.  See @link RKAbortedMatchCount RKAbortedMatchCount @/link.</li>
+ <li><span class="code">bytesScanned</span> The number of bytes from the start of each match to the end of its subject.</li>
+ <li><span class="code">matchNanoseconds</span> The total time taken by the matches.</li>
+ <li><span class="code">latencyHistogram</span> An array of dictionaries, one for each histogram bucket that is not empty, with the keys <span class="code">nanoseconds</span>, the lower bound of the bucket, and <span class="code">count</span>.  Each power of two from 64 nanoseconds up is split in to four buckets.</li>
+ </ul>
+ <p>The dictionaries in the <span class="code">regexes</span> array also contain <span class="code">regex</span>, the regular expression pattern, and <span class="code">compileOptions</span>, the result of @link RKArrayFromCompileOption RKArrayFromCompileOption @/link.</p>
+ <p>The counters of a thread may change while they are being added together, so a snapshot is a close approximation rather than an exact point in time.</p>
+ @result     Returns a dictionary containing only property list types.
+ @seealso    @link RKRegexMetricsJSONString RKRegexMetricsJSONString @/link
+*/
+REGEXKIT_EXTERN NSDictionary *RKRegexMetricsSnapshot(void) RK_ATTRIBUTES(used);
+
+/*!
+ @function   RKRegexMetricsTopRegexesByMatchTime
+ @tocgroup   Functions Regex Metrics
+ @abstract   Returns the match metrics of the <span class="argument">count</span> regular expressions that have spent the most time matching.
+ @discussion <p>Matching does not block, so the time spent matching is a close approximation of the CPU time used by a regular expression.</p>
+ @param      count The maximum number of regular expressions to return.
+ @result     Returns an array of dictionaries in the format of the <span class="code">regexes</span> array of @link RKRegexMetricsSnapshot RKRegexMetricsSnapshot @/link, sorted by <span class="code">matchNanoseconds</span> with the largest first.
+*/
+REGEXKIT_EXTERN NSArray *RKRegexMetricsTopRegexesByMatchTime(const RKUInteger count) RK_ATTRIBUTES(used);
+
+/*!
+ @function   RKRegexMetricsJSONString
+ @tocgroup   Functions Regex Metrics
+ @abstract   Returns the result of @link RKRegexMetricsSnapshot RKRegexMetricsSnapshot @/link as a JSON object.
+ @discussion The keys of each JSON object are written in sorted order.
+*/
+REGEXKIT_EXTERN NSString *RKRegexMetricsJSONString(void) RK_ATTRIBUTES(used);
+
+/*!
+ @function   RKWriteRegexMetricsJSON
+ @tocgroup   Functions Regex Metrics
+ @abstract   Writes the result of @link RKRegexMetricsJSONString RKRegexMetricsJSONString @/link to <span class="argument">fileDescriptor</span> as UTF-8.
+ @param      fileDescriptor The file descriptor to write to.
+ @result     Returns <span class="code">YES</span> if all of the JSON was written, <span class="code">NO</span> otherwise.
+*/
+REGEXKIT_EXTERN BOOL RKWriteRegexMetricsJSON(int fileDescriptor) RK_ATTRIBUTES(used);
+
+/*!
+ @function   RKClearRegexMetrics
+ @tocgroup   Functions Regex Metrics
+ @abstract   Resets the match metrics of every regular expression.
+ @discussion Matches that are in progress on other threads while the metrics are cleared may still be counted.
+*/
+REGEXKIT_EXTERN void RKClearRegexMetrics(void) RK_ATTRIBUTES(used);
+
+/*!
+ @function   RKAbortedMatchCount
+ @tocgroup   Functions Regex Metrics
+ @abstract   Returns the number of matches that have been abandoned because they reached a limit.
+ @discussion <p>Counts every match that returned @link RKMatchErrorMatchLimit RKMatchErrorMatchLimit@/link, @link RKMatchErrorRecursionLimit RKMatchErrorRecursionLimit@/link, or @link RKMatchErrorTimeLimit RKMatchErrorTimeLimit @/link since the process started.  Unlike the regex metrics, this count is always kept and is never cleared.</p>
+ @seealso    @link setMatchLimit: -[RKRegex setMatchLimit:] @/link
+*/
+REGEXKIT_EXTERN RKUInteger RKAbortedMatchCount(void) RK_ATTRIBUTES(used);
+
+/*!
+ @function   RKSetCollectionUnionMatchingEnabled
+ @tocgroup   Functions Collection Matching
+ @abstract   Enables or disables union matching for the methods that match an object against every regular expression in a @link NSArray NSArray @/link or @link NSSet NSSet@/link, such as @link NSObject(RegexKitAdditions)/isMatchedByAnyRegexInArray: isMatchedByAnyRegexInArray: @/link.
+ @discussion <p>Union matching is disabled by default.  While it is enabled, the regular expressions of a collection that can be safely combined are matched with a single alternation of all of them, so the subject is scanned once instead of once for each regular expression.  Regular expressions that contain back references, recursion, named captures, or conditions are still matched one at a time.  The results are the same either way.</p>
+ <p>Union matching is not used for collections compiled with @link RKCompileFirstLine RKCompileFirstLine @/link or @link RKCompileNoAutoCapture RKCompileNoAutoCapture@/link, or with a library other than @link RKRegexPCRELibrary RKRegexPCRELibrary@/link.  Collections that are already cached pick up the change the next time they are used.</p>
+ @param      enableUnionMatching <span class="code">YES</span> to enable union matching, <span class="code">NO</span> to disable it.
+*/
+REGEXKIT_EXTERN void RKSetCollectionUnionMatchingEnabled(const BOOL enableUnionMatching) RK_ATTRIBUTES(used);
+
+/*!
+ @function   RKCollectionUnionMatchingEnabled
+ @tocgroup   Functions Collection Matching
+ @abstract   Returns whether or not union matching is used for collections of regular expressions.
+ @result     Returns <span class="code">YES</span> if union matching is enabled, <span class="code">NO</span> otherwise.
+*/
+REGEXKIT_EXTERN BOOL RKCollectionUnionMatchingEnabled(void) RK_ATTRIBUTES(used);
   
 #endif // _REGEXKIT_RKUTILITY_H_
     
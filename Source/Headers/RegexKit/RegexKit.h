@@ -55,7 +55,7 @@ extern "C" {
 #endif //__MACOSX_RUNTIME__ defined in RegexKitDefines
 
 // RKLock and RKReadWriteLock are private classes
-@class RKRegex, RKCache, RKEnumerator, RKLock, RKReadWriteLock;
+@class RKRegex, RKCache, RKEnumerator, RKMatchContext, RKReplacementTemplate, RKCaptureExtractor, RKSubstring, RKLock, RKReadWriteLock;
 
 #ifdef USE_AUTORELEASED_MALLOC
 @class RKAutoreleasedMemory;
@@ -70,6 +70,10 @@ extern "C" {
 #import <RegexKit/RKCache.h>
 #import <RegexKit/RKRegex.h>
 #import <RegexKit/RKEnumerator.h>
+#import <RegexKit/RKMatchContext.h>
+#import <RegexKit/RKReplacementTemplate.h>
+#import <RegexKit/RKCaptureExtractor.h>
+#import <RegexKit/RKSubstring.h>
 #import <RegexKit/RKUtility.h>
 #import <RegexKit/NSArray.h>
 #import <RegexKit/NSData.h>
@@ -204,6 +204,21 @@ extern "C" {
 */
 #define RKReplaceAll RKIntegerMax
 
+/*!
+@defined RKMatchResultsBitmapSize
+ @tocgroup Constants Preprocessor Macros
+ @abstract The number of bytes required for a results bitmap of <span class="argument">count</span> subjects.
+ @discussion <p>For use with @link matchesSubjects:count:results: matchesSubjects:count:results: @/link and related batch matching methods.</p>
+*/
+#define RKMatchResultsBitmapSize(count) ((((RKUInteger)(count)) + 7) >> 3)
+
+/*!
+@defined RKMatchResultsBitmapIsSet
+ @tocgroup Constants Preprocessor Macros
+ @abstract Evaluates to non-zero if the bit for the subject at <span class="argument">index</span> is set in the results bitmap <span class="argument">bitmap</span>.
+*/
+#define RKMatchResultsBitmapIsSet(bitmap, index) (((bitmap)[((RKUInteger)(index)) >> 3]) & (1 << (((RKUInteger)(index)) & 7)))
+
 // Used to size/check buffers when calling private RKRegex getRanges:count:withCharacters:length:inRange:options:
 #define RK_PRESIZE_CAPTURE_COUNT(x) (256 + x + (x >> 1))
 #define RK_MINIMUM_CAPTURE_COUNT(x) (x + ((x / 3) + ((3 - (x % 3)) % 3)))
@@ -265,6 +280,18 @@ extern "C" {
 #define ENABLE_DTRACE_INSTRUMENTATION
 #endif
 
+/*!
+ @defined ENABLE_USDT_INSTRUMENTATION
+ @tocgroup Constants Preprocessor Macros
+ @abstract Preprocessor definition to enable RegexKit specific probe points as Linux USDT probes.
+ @discussion <p>When defined on a system other than Mac OS X, the RegexKit specific DTrace probe points are compiled as <span class="file">sys/sdt.h</span> USDT probes with the same provider, names, and arguments, which can be used with bpftrace, SystemTap, and <span class="code">perf</span>.  Defining it also defines @link ENABLE_DTRACE_INSTRUMENTATION ENABLE_DTRACE_INSTRUMENTATION@/link.</p>
+ <p>The GNUstep makefile defines it automatically when <span class="file">sys/sdt.h</span> is installed.</p>
+*/
+
+#if defined(ENABLE_USDT_INSTRUMENTATION) && !defined(__MACOSX_RUNTIME__) && !defined(ENABLE_DTRACE_INSTRUMENTATION)
+#define ENABLE_DTRACE_INSTRUMENTATION
+#endif
+
 // AFAIK, only the GCC 3.3+ Mac OSX objc runtime has -fobjc-exception support
 #if (!defined(__MACOSX_RUNTIME__)) || (!defined(__GNUC__)) || ((__GNUC__ == 3) && (__GNUC_MINOR__ < 3)) || (!defined(MAC_OS_X_VERSION_10_3))
 // Otherwise, use NS_DURING / NS_HANDLER and friends
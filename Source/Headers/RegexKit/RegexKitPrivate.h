@@ -113,6 +113,21 @@ extern "C" {
 #define RKPrettyObjectDescription(prettyObject) ([NSString stringWithFormat:@"[%@ @ %p]: '%.40s'%@", [prettyObject className], prettyObject, ([[prettyObject description] UTF8String] == NULL) ? "" : [[prettyObject description] UTF8String], ([[prettyObject description] length] > 40) ? @"...":@""])
 
 
+// Passed to pcre_exec as the callout data when a match has a time limit, or is performed with a RKMatchContext that has a
+// callout function.  RKRegexPCRECallout in RKPrivate.m checks the deadline before passing the callout on to the match context.
+typedef struct {
+  RKMatchContext *matchContext;         // The match context to pass callouts on to, or NULL.
+  uint64_t        deadlineNanoseconds;  // The RKRegexMetricsNanoseconds() time that the match is aborted at, or 0.
+} RKMatchCalloutState;
+
+// The per call limits of a RKMatchContext.  A limit of 0 uses the limit of the RKRegex instead.
+typedef struct {
+  RKMatchContext *calloutMatchContext;  // The match context to pass callouts on to, or NULL.
+  RKUInteger      matchLimit;
+  RKUInteger      recursionLimit;
+  uint64_t        timeLimitNanoseconds;
+} RKMatchLimits;
+
 // In RKRegex.m
 RKRegex     * RKRegexFromStringOrRegexWithError(id self, const SEL _cmd, id aRegex, NSString * const RK_C99(restrict)libraryString, const RKCompileOption compileOptions, NSError **error, const BOOL shouldAutorelease) RK_ATTRIBUTES(nonnull(3, 4), used, visibility("hidden"));
 RKRegex     * RKRegexFromStringOrRegex(id self, SEL _cmd, id aRegex, RKCompileOption compileOptions, BOOL shouldAutorelease) RK_ATTRIBUTES(nonnull(3), used, visibility("hidden"));
@@ -120,13 +135,35 @@ NSException * RKExceptionFromInitFailureForOlderAPI(id self, const SEL _cmd, NSE
 NSError     * RKErrorForCompileInitFailure(id self, const SEL _cmd, RKStringBuffer *regexStringBuffer, RKUInteger errorOffset, RKCompileErrorCode compileErrorCode, RKCompileOption compileOption, RKUInteger abreviatedPadding) RK_ATTRIBUTES(nonnull(3), used, visibility("hidden"));
 const char  * regexUTF8String(RKRegex *self) RK_ATTRIBUTES(used, visibility("hidden"), nonnull(1));
 RKUInteger    RKCaptureIndexForCaptureNameCharacters(RKRegex * const aRegex, const SEL _cmd, const char * const RK_C99(restrict) captureNameCharacters, const RKUInteger length, const NSRange * const RK_C99(restrict) matchedRanges, const BOOL raiseExceptionOnDoesNotExist) RK_ATTRIBUTES(used, visibility("hidden"));
+int           RKRegexExec(RKRegex * const self, const char * const RK_C99(restrict) charactersBuffer, const int length, const int startOffset, const int options, int * const RK_C99(restrict) vectors, const int vectorsCount, const RKMatchLimits * const matchLimits) RK_ATTRIBUTES(nonnull(1, 2), used, visibility("hidden"));
 RKUInteger    RKCaptureIndexForCaptureNameCharactersWithError(RKRegex * const aRegex, const SEL _cmd, const char * const RK_C99(restrict) captureNameCharacters, const RKUInteger length, const NSRange * const RK_C99(restrict) matchedRanges, NSError **error);
+BOOL          RKRegexCaptureNamesMayBeDuplicated(RKRegex * const aRegex) RK_ATTRIBUTES(used, visibility("hidden"), nonnull(1));
+BOOL          RKRegexGetStartBytes(RKRegex * const aRegex, uint32_t * const RK_C99(restrict) startBytes) RK_ATTRIBUTES(used, visibility("hidden"), nonnull(1, 2));
 
 @interface RKRegex (Private)
 - (RKMatchErrorCode)getRanges:(NSRange * const RK_C99(restrict))ranges count:(const RKUInteger)rangeCount withCharacters:(const void * const RK_C99(restrict))charactersBuffer length:(const RKUInteger)length inRange:(const NSRange)searchRange options:(const RKMatchOption)options error:(NSError **)error;
 @end
 
 
+// In RKMatchContext.m
+RKMatchErrorCode RKMatchContextGetRanges(RKMatchContext * const self, RKRegex * const matchRegex, const SEL _cmd, const void * const RK_C99(restrict) charactersBuffer, const RKUInteger length, const NSRange searchRange, const RKMatchOption options, NSError **error) RK_ATTRIBUTES(nonnull(1, 2), used, visibility("hidden"));
+int              RKMatchContextCallout(RKMatchContext * const self, pcre_callout_block * const calloutBlock) RK_ATTRIBUTES(nonnull, used, visibility("hidden"));
+
+
+// In RKRegexMetrics.m
+extern int32_t RKRegexMetricsCollect; // Set by RKSetRegexMetricsEnabled(), checked before every match.
+
+struct __RKRegexMetricsThread;
+uint64_t   RKRegexMetricsNanoseconds(void)                                                                                                       RK_ATTRIBUTES(used, visibility("hidden"));
+RKUInteger RKRegexMetricsRegister(NSString * const regexString, const RKCompileOption compileOption, const RKUInteger regexHash)                 RK_ATTRIBUTES(used, visibility("hidden"));
+void       RKRegexMetricsRecord(const RKUInteger metricsIndex, const RKUInteger bytesScanned, const uint64_t matchNanoseconds, const int errorCode) RK_ATTRIBUTES(used, visibility("hidden"));
+void       RKRegexMetricsThreadIsExiting(struct __RKRegexMetricsThread * const threadMetrics)                                                    RK_ATTRIBUTES(used, visibility("hidden"));
+
+
+// In RKRegexAnalysis.m
+BOOL RKAnalysisHasAtomicItems(NSString * const regexString, const RKCompileOption options) RK_ATTRIBUTES(used, visibility("hidden"), nonnull(1));
+
+
 // In RKCache.m
 id           RKFastCacheLookup(RKCache * const self, const SEL _cmd RK_ATTRIBUTES(unused), const RKUInteger objectHash, NSString * const objectDescription, const BOOL shouldAutorelease) RK_ATTRIBUTES(used, visibility("hidden"), nonnull(1));
 const char * cacheUTF8String(RKCache *self) RK_ATTRIBUTES(used, visibility("hidden"), nonnull(1));
@@ -73,6 +73,7 @@ extern "C" {
 #define RKAtomicDecrementInteger(ptr)                          OSAtomicDecrement64(       (int64_t *)ptr)
 #define RKAtomicIncrementIntegerBarrier(ptr)                   OSAtomicIncrement64Barrier((int64_t *)ptr)
 #define RKAtomicDecrementIntegerBarrier(ptr)                   OSAtomicDecrement64Barrier((int64_t *)ptr)
+#define RKAtomicAddInteger(amount, ptr)                        OSAtomicAdd64((int64_t)(amount), (int64_t *)ptr)
 #else // __LP64__ not defined
 #define RKAtomicCompareAndSwapPtr(oldp, newp, ptr)             OSAtomicCompareAndSwap32Barrier((int32_t)oldp,     (int32_t)newp,     (int32_t *)ptr)
 #define RKAtomicCompareAndSwapInteger(oldValue, newValue, ptr) OSAtomicCompareAndSwap32Barrier((int32_t)oldValue, (int32_t)newValue, (int32_t *)ptr)
@@ -81,6 +82,7 @@ extern "C" {
 #define RKAtomicDecrementInteger(ptr)                          OSAtomicDecrement32(       (int32_t *)ptr)
 #define RKAtomicIncrementIntegerBarrier(ptr)                   OSAtomicIncrement32Barrier((int32_t *)ptr)
 #define RKAtomicDecrementIntegerBarrier(ptr)                   OSAtomicDecrement32Barrier((int32_t *)ptr)
+#define RKAtomicAddInteger(amount, ptr)                        OSAtomicAdd32((int32_t)(amount), (int32_t *)ptr)
 #endif // __LP64__
 
 #endif //__MACOSX_RUNTIME__
@@ -109,12 +111,14 @@ RKREGEX_STATIC_INLINE int64_t RKAtomicDecrementInteger(       int64_t *ptr)
 RKREGEX_STATIC_INLINE int64_t RKAtomicIncrementIntegerBarrier(int64_t *ptr)                                            { atomic_add_rel_long(ptr, 1);      return(atomic_load_acq_64(ptr)); }
 RKREGEX_STATIC_INLINE int64_t RKAtomicDecrementIntegerBarrier(int64_t *ptr)                                            { atomic_subtract_rel_long(ptr, 1); return(atomic_load_acq_64(ptr)); }
 RKREGEX_STATIC_INLINE BOOL    RKAtomicCompareAndSwapInteger(int64_t oldValue, int64_t newValue, volatile int64_t *ptr) { return(atomic_cmpset_rel_long(ptr, oldValue, newValue));           }
+RKREGEX_STATIC_INLINE int64_t RKAtomicAddInteger(             int64_t amount, int64_t *ptr)                            { atomic_add_long(ptr, amount);     return(atomic_load_acq_64(ptr)); }
 #else // __LP64__ not defined
 RKREGEX_STATIC_INLINE int32_t RKAtomicIncrementInteger(       int32_t *ptr)                                            { atomic_add_int(ptr, 1);           return(atomic_load_acq_32(ptr)); }
 RKREGEX_STATIC_INLINE int32_t RKAtomicDecrementInteger(       int32_t *ptr)                                            { atomic_subtract_int(ptr, 1);      return(atomic_load_acq_32(ptr)); }
 RKREGEX_STATIC_INLINE int32_t RKAtomicIncrementIntegerBarrier(int32_t *ptr)                                            { atomic_add_rel_int(ptr, 1);       return(atomic_load_acq_32(ptr)); }
 RKREGEX_STATIC_INLINE int32_t RKAtomicDecrementIntegerBarrier(int32_t *ptr)                                            { atomic_subtract_rel_int(ptr, 1);  return(atomic_load_acq_32(ptr)); }
 RKREGEX_STATIC_INLINE BOOL    RKAtomicCompareAndSwapInteger(int32_t oldValue, int32_t newValue, volatile int32_t *ptr) { return(atomic_cmpset_rel_int(ptr, oldValue, newValue));            }
+RKREGEX_STATIC_INLINE int32_t RKAtomicAddInteger(             int32_t amount, int32_t *ptr)                            { atomic_add_int(ptr, amount);      return(atomic_load_acq_32(ptr)); }
 #endif // __LP64__
 
 #endif //__FreeBSD__
@@ -141,12 +145,14 @@ RKREGEX_STATIC_INLINE int64_t RKAtomicDecrementInteger(       int64_t *ptr)
 RKREGEX_STATIC_INLINE int64_t RKAtomicIncrementIntegerBarrier(int64_t *ptr)                                              { return(atomic_inc_ulong_nv((uint64_t *)ptr)); }
 RKREGEX_STATIC_INLINE int64_t RKAtomicDecrementIntegerBarrier(int64_t *ptr)                                              { return(atomic_dec_ulong_nv((uint64_t *)ptr)); }
 RKREGEX_STATIC_INLINE BOOL    RKAtomicCompareAndSwapInteger(  int64_t oldValue, int64_t newValue, volatile int64_t *ptr) { return(atomic_cas_ulong(ptr, (uint64_t)oldValue, (uint64_t)newValue) == oldValue ? YES : NO); }
+RKREGEX_STATIC_INLINE int64_t RKAtomicAddInteger(             int64_t amount, int64_t *ptr)                              { return(atomic_add_long_nv((ulong_t *)ptr, amount)); }
 #else // __LP64__ not defined
 RKREGEX_STATIC_INLINE int32_t RKAtomicIncrementInteger(       int32_t *ptr)                                              { return(atomic_inc_uint_nv((uint_t *)ptr)); }
 RKREGEX_STATIC_INLINE int32_t RKAtomicDecrementInteger(       int32_t *ptr)                                              { return(atomic_dec_uint_nv((uint_t *)ptr)); }
 RKREGEX_STATIC_INLINE int32_t RKAtomicIncrementIntegerBarrier(int32_t *ptr)                                              { return(atomic_inc_uint_nv((uint_t *)ptr)); }
 RKREGEX_STATIC_INLINE int32_t RKAtomicDecrementIntegerBarrier(int32_t *ptr)                                              { return(atomic_dec_uint_nv((uint_t *)ptr)); }
 RKREGEX_STATIC_INLINE BOOL    RKAtomicCompareAndSwapInteger(  int32_t oldValue, int32_t newValue, volatile int32_t *ptr) { return(atomic_cas_uint(ptr, (uint_t)oldValue, (uint_t)newValue) == oldValue ? YES : NO); }
+RKREGEX_STATIC_INLINE int32_t RKAtomicAddInteger(             int32_t amount, int32_t *ptr)                              { return(atomic_add_int_nv((uint_t *)ptr, amount)); }
 #endif // __LP64__
 
 #endif // Solaris __sun__ __svr4__
@@ -164,12 +170,13 @@ RKREGEX_STATIC_INLINE BOOL    RKAtomicCompareAndSwapInteger(  int32_t oldValue,
 #define RKAtomicIncrementIntBarrier(ptr)                       __sync_add_and_fetch(ptr, 1)
 #define RKAtomicDecrementIntBarrier(ptr)                       __sync_sub_and_fetch(ptr, 1)
 #define RKAtomicCompareAndSwapInt(oldValue, newValue, ptr)     __sync_bool_compare_and_swap(ptr, oldValue, newValue)
-#define RKAtomicCompareAndSwapPtr(oldp, newp, ptr)             __sync_bool_compare_and_swap(ptr, oldValue, newValue)
+#define RKAtomicCompareAndSwapPtr(oldp, newp, ptr)             __sync_bool_compare_and_swap(ptr, oldp, newp)
 
 #define RKAtomicIncrementInteger(ptr)                          __sync_add_and_fetch(ptr, 1)
 #define RKAtomicDecrementInteger(ptr)                          __sync_sub_and_fetch(ptr, 1)
 #define RKAtomicIncrementIntegerBarrier(ptr)                   __sync_add_and_fetch(ptr, 1)
 #define RKAtomicDecrementIntegerBarrier(ptr)                   __sync_sub_and_fetch(ptr, 1)
+#define RKAtomicAddInteger(amount, ptr)                        __sync_add_and_fetch(ptr, amount)
 #define RKAtomicCompareAndSwapInteger(oldValue, newValue, ptr) __sync_bool_compare_and_swap(ptr, oldValue, newValue)
 
 #endif // HAVE_RKREGEX_ATOMIC_OPS && gcc >= 4.1 
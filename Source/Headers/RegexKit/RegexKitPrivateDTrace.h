@@ -45,7 +45,7 @@ extern "C" {
 #ifndef _REGEXKIT_REGEXKITPRIVATEDTRACE_H_
 #define _REGEXKIT_REGEXKITPRIVATEDTRACE_H_ 1
 
-#if defined(ENABLE_DTRACE_INSTRUMENTATION) && defined(__MACOSX_RUNTIME__)
+#if defined(ENABLE_DTRACE_INSTRUMENTATION) && (defined(__MACOSX_RUNTIME__) || defined(ENABLE_USDT_INSTRUMENTATION))
 
 // Used by Begin/End Match probes to squeeze additional information in to the probe firing.
 typedef struct {
@@ -54,17 +54,89 @@ typedef struct {
   int options;
 } regexProbeObject;
 
+#ifdef __MACOSX_RUNTIME__
+
 #import "RegexKitProbes.h"
 
+#else  // ENABLE_USDT_INSTRUMENTATION
+
+// Linux USDT probes.  These have the same provider, names, and arguments as the probes in RegexKitProbes.d, and follow the same
+// REGEXKIT_<NAME>() / REGEXKIT_<NAME>_ENABLED() convention as the header that dtrace -h generates from it, so the RK_PROBE macros below
+// work unchanged.  Each probe has a semaphore that bpftrace, SystemTap, or perf increments while it is attached to the probe, which
+// is what the _ENABLED() tests check, so the probe arguments are only evaluated when something is listening.  The semaphores are
+// defined in RKPrivate.m.
+
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+#define RK_USDT_PROBES(probe) probe(PerformanceNote) probe(BeginRegexCompile) probe(EndRegexCompile) probe(MatchException) probe(BeginMatch) probe(EndMatch) \
+  probe(CacheCleared) probe(BeginCacheLookup) probe(EndCacheLookup) probe(BeginCacheAdd) probe(EndCacheAdd) probe(BeginCacheRemove) probe(EndCacheRemove)           \
+  probe(BeginLock) probe(EndLock) probe(Unlock) probe(BeginSortedRegexSort) probe(EndSortedRegexSort) probe(BeginSortedRegexMatch) probe(EndSortedRegexMatch)      \
+  probe(SortedRegexCompare) probe(SortedRegexCache)
+
+#define RK_USDT_SEMAPHORE(probeName)         RegexKit_ ## probeName ## _semaphore
+#define RK_USDT_DECLARE_SEMAPHORE(probeName) extern volatile unsigned short RK_USDT_SEMAPHORE(probeName) RK_ATTRIBUTES(visibility("hidden"));
+#define RK_USDT_DEFINE_SEMAPHORE(probeName)  volatile unsigned short RK_USDT_SEMAPHORE(probeName) RK_ATTRIBUTES(section(".probes"), used, visibility("hidden")) = 0;
+#define RK_USDT_ENABLED(probeName)           (RK_USDT_SEMAPHORE(probeName) != 0)
+
+RK_USDT_PROBES(RK_USDT_DECLARE_SEMAPHORE)
+
+#define REGEXKIT_PERFORMANCENOTE(...)              STAP_PROBE7( RegexKit, PerformanceNote,       __VA_ARGS__)
+#define REGEXKIT_PERFORMANCENOTE_ENABLED()         RK_USDT_ENABLED(PerformanceNote)
+#define REGEXKIT_BEGINREGEXCOMPILE(...)            STAP_PROBE4( RegexKit, BeginRegexCompile,     __VA_ARGS__)
+#define REGEXKIT_BEGINREGEXCOMPILE_ENABLED()       RK_USDT_ENABLED(BeginRegexCompile)
+#define REGEXKIT_ENDREGEXCOMPILE(...)              STAP_PROBE8( RegexKit, EndRegexCompile,       __VA_ARGS__)
+#define REGEXKIT_ENDREGEXCOMPILE_ENABLED()         RK_USDT_ENABLED(EndRegexCompile)
+#define REGEXKIT_MATCHEXCEPTION(...)               STAP_PROBE10(RegexKit, MatchException,        __VA_ARGS__)
+#define REGEXKIT_MATCHEXCEPTION_ENABLED()          RK_USDT_ENABLED(MatchException)
+#define REGEXKIT_BEGINMATCH(...)                   STAP_PROBE8( RegexKit, BeginMatch,            __VA_ARGS__)
+#define REGEXKIT_BEGINMATCH_ENABLED()              RK_USDT_ENABLED(BeginMatch)
+#define REGEXKIT_ENDMATCH(...)                     STAP_PROBE10(RegexKit, EndMatch,              __VA_ARGS__)
+#define REGEXKIT_ENDMATCH_ENABLED()                RK_USDT_ENABLED(EndMatch)
+#define REGEXKIT_CACHECLEARED(...)                 STAP_PROBE6( RegexKit, CacheCleared,          __VA_ARGS__)
+#define REGEXKIT_CACHECLEARED_ENABLED()            RK_USDT_ENABLED(CacheCleared)
+#define REGEXKIT_BEGINCACHELOOKUP(...)             STAP_PROBE8( RegexKit, BeginCacheLookup,      __VA_ARGS__)
+#define REGEXKIT_BEGINCACHELOOKUP_ENABLED()        RK_USDT_ENABLED(BeginCacheLookup)
+#define REGEXKIT_ENDCACHELOOKUP(...)               STAP_PROBE10(RegexKit, EndCacheLookup,        __VA_ARGS__)
+#define REGEXKIT_ENDCACHELOOKUP_ENABLED()          RK_USDT_ENABLED(EndCacheLookup)
+#define REGEXKIT_BEGINCACHEADD(...)                STAP_PROBE6( RegexKit, BeginCacheAdd,         __VA_ARGS__)
+#define REGEXKIT_BEGINCACHEADD_ENABLED()           RK_USDT_ENABLED(BeginCacheAdd)
+#define REGEXKIT_ENDCACHEADD(...)                  STAP_PROBE8( RegexKit, EndCacheAdd,           __VA_ARGS__)
+#define REGEXKIT_ENDCACHEADD_ENABLED()             RK_USDT_ENABLED(EndCacheAdd)
+#define REGEXKIT_BEGINCACHEREMOVE(...)             STAP_PROBE4( RegexKit, BeginCacheRemove,      __VA_ARGS__)
+#define REGEXKIT_BEGINCACHEREMOVE_ENABLED()        RK_USDT_ENABLED(BeginCacheRemove)
+#define REGEXKIT_ENDCACHEREMOVE(...)               STAP_PROBE7( RegexKit, EndCacheRemove,        __VA_ARGS__)
+#define REGEXKIT_ENDCACHEREMOVE_ENABLED()          RK_USDT_ENABLED(EndCacheRemove)
+#define REGEXKIT_BEGINLOCK(...)                    STAP_PROBE3( RegexKit, BeginLock,             __VA_ARGS__)
+#define REGEXKIT_BEGINLOCK_ENABLED()               RK_USDT_ENABLED(BeginLock)
+#define REGEXKIT_ENDLOCK(...)                      STAP_PROBE5( RegexKit, EndLock,               __VA_ARGS__)
+#define REGEXKIT_ENDLOCK_ENABLED()                 RK_USDT_ENABLED(EndLock)
+#define REGEXKIT_UNLOCK(...)                       STAP_PROBE3( RegexKit, Unlock,                __VA_ARGS__)
+#define REGEXKIT_UNLOCK_ENABLED()                  RK_USDT_ENABLED(Unlock)
+#define REGEXKIT_BEGINSORTEDREGEXSORT(...)         STAP_PROBE3( RegexKit, BeginSortedRegexSort,  __VA_ARGS__)
+#define REGEXKIT_BEGINSORTEDREGEXSORT_ENABLED()    RK_USDT_ENABLED(BeginSortedRegexSort)
+#define REGEXKIT_ENDSORTEDREGEXSORT(...)           STAP_PROBE4( RegexKit, EndSortedRegexSort,    __VA_ARGS__)
+#define REGEXKIT_ENDSORTEDREGEXSORT_ENABLED()      RK_USDT_ENABLED(EndSortedRegexSort)
+#define REGEXKIT_BEGINSORTEDREGEXMATCH(...)        STAP_PROBE4( RegexKit, BeginSortedRegexMatch, __VA_ARGS__)
+#define REGEXKIT_BEGINSORTEDREGEXMATCH_ENABLED()   RK_USDT_ENABLED(BeginSortedRegexMatch)
+#define REGEXKIT_ENDSORTEDREGEXMATCH(...)          STAP_PROBE10(RegexKit, EndSortedRegexMatch,   __VA_ARGS__)
+#define REGEXKIT_ENDSORTEDREGEXMATCH_ENABLED()     RK_USDT_ENABLED(EndSortedRegexMatch)
+#define REGEXKIT_SORTEDREGEXCOMPARE(...)           STAP_PROBE10(RegexKit, SortedRegexCompare,    __VA_ARGS__)
+#define REGEXKIT_SORTEDREGEXCOMPARE_ENABLED()      RK_USDT_ENABLED(SortedRegexCompare)
+#define REGEXKIT_SORTEDREGEXCACHE(...)             STAP_PROBE7( RegexKit, SortedRegexCache,      __VA_ARGS__)
+#define REGEXKIT_SORTEDREGEXCACHE_ENABLED()        RK_USDT_ENABLED(SortedRegexCache)
+
+#endif // __MACOSX_RUNTIME__
+
 #define RK_PROBE_FIRE(probeName, ...) REGEXKIT_ ## probeName(__VA_ARGS__)
 #define RK_PROBE_ENABLED(probeName)   RK_EXPECTED(REGEXKIT_ ## probeName ## _ENABLED(), 0)
 #define RK_PROBE(probeName, ...)                        if(RK_PROBE_ENABLED(probeName)) { RK_PROBE_FIRE(probeName, __VA_ARGS__); }
 #define RK_PROBE_CONDITIONAL(probeName, condition, ...) if(RK_EXPECTED(condition, 0))   { RK_PROBE_FIRE(probeName, __VA_ARGS__); }
 
-#else // ENABLE_DTRACE_INSTRUMENTATION && __MACOSX_RUNTIME__ are not defined
+#else // ENABLE_DTRACE_INSTRUMENTATION && (__MACOSX_RUNTIME__ || ENABLE_USDT_INSTRUMENTATION) are not defined
 
 #ifdef ENABLE_DTRACE_INSTRUMENTATION
-#warning DTrace is currently only supported under Mac OS X 10.5 and later.
+#warning DTrace is currently only supported under Mac OS X 10.5 and later, and as USDT probes with ENABLE_USDT_INSTRUMENTATION.
 #endif
 
 #define RK_PROBE_FIRE(probeName, ...)
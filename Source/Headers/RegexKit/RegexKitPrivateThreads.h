@@ -109,10 +109,12 @@ RKREGEX_STATIC_INLINE BOOL RKIsMainThread(void) { return((BOOL)pthread_main_np()
 
 /*
  The following block contains the compile unit private definitions for implementing
- thread local data structures.  It is currently only used to create on demand a single
+ thread local data structures.  It is currently used to create on demand a single
  NSNumberFormatter that is reused for all requested NSNumber conversions.  Apple
  documentation indicates that this object is not multithreading safe, so each thread
- gets its own NSNumberFormatter on demand.  Additionally, when the thread is exiting,
+ gets its own NSNumberFormatter on demand.  It also holds the RKMatchContext returned by
+ +[RKMatchContext currentThreadMatchContext], which is likewise not multithreading safe, and a small cache of recently converted
+ fixed format timestamps used by the capture extraction NSDate conversion, and the threads regex metrics counters.  Additionally, when the thread is exiting,
  __RKThreadIsExiting (static in RKRegex.m) gets called so we can do any clean up of allocations.
  
  RKRegex.m +load registers our pthread key, __RKRegexThreadLocalDataKey and sets the thread exit clean up handler.
@@ -123,11 +125,32 @@ extern pthread_key_t __RKRegexThreadLocalDataKey;
 // Any additions here must add a deallocation section to RKRegex.m/__RKThreadIsExiting.
 // Rough convention is to create a function that retrieves a specific item from the thread local data, demand populating the structure as required.
 
+#define RK_DATE_CACHE_ENTRIES     (4)
+#define RK_DATE_CACHE_PREFIX_SIZE (20)
+
+// Keyed by the timestamp text up to and including the minute, along with any explicit offset from GMT.
+// minuteInterval is the absolute time of that minute, so a hit only needs to add the seconds.
+struct __RKDateCacheEntry {
+  RK_STRONG_REF NSTimeZone             *timeZone;
+                NSTimeInterval          minuteInterval;
+                int32_t                 secondsFromGMT;
+                uint32_t                prefixLength;
+                char                    prefix[RK_DATE_CACHE_PREFIX_SIZE];
+};
+
+struct __RKRegexMetricsThread; // Private to RKRegexMetrics.m
+
 struct __RKThreadLocalData {
   RK_STRONG_REF NSNumberFormatter      *_numberFormatter;
+  RK_STRONG_REF RKMatchContext         *_matchContext;
 #ifdef HAVE_NSNUMBERFORMATTER_CONVERSIONS
   RK_STRONG_REF NSNumberFormatterStyle  _currentFormatterStyle;
 #endif
+  struct __RKDateCacheEntry             _dateCache[RK_DATE_CACHE_ENTRIES];
+                RKUInteger              _dateCacheNextEntry;
+  struct __RKRegexMetricsThread        *_regexMetrics;
+                int                    *_dfaWorkspace;
+                RKUInteger              _dfaWorkspaceCount;
 };
 
 struct __RKThreadLocalData *__RKGetThreadLocalData(void) RK_ATTRIBUTES(pure, used);
@@ -137,6 +160,14 @@ RKREGEX_STATIC_PURE_INLINE struct __RKThreadLocalData *RKGetThreadLocalData(void
   return(RK_EXPECTED((tld != NULL), 1) ? tld : __RKGetThreadLocalData());
 }
 
+RKMatchContext *__RKGetThreadLocalMatchContext(void) RK_ATTRIBUTES(pure, used);
+
+RKREGEX_STATIC_PURE_INLINE RKMatchContext *RKGetThreadLocalMatchContext(void) {
+  RK_STRONG_REF struct __RKThreadLocalData * RK_C99(restrict) tld = NULL;
+  if(RK_EXPECTED((tld = RKGetThreadLocalData()) == NULL, 0)) { return(NULL); }
+  return(RK_EXPECTED((tld->_matchContext != NULL), 1) ? tld->_matchContext : __RKGetThreadLocalMatchContext());
+}
+
 #ifdef HAVE_NSNUMBERFORMATTER_CONVERSIONS
 
 NSNumberFormatter *__RKGetThreadLocalNumberFormatter(void) RK_ATTRIBUTES(pure, used);
@@ -56,6 +56,7 @@ extern "C" {
  @group Error Domains
  @group Error Keys in User Info Dictionaries
  @group Exceptions
+ @group Hazard Dictionary Keys
  @group Preprocessor Macros
  @group Regular Expression Libraries
 */
@@ -265,6 +266,43 @@ extern NSString * const RKRegexReferenceRangeErrorKey;
  @abstract   The corresponding value is 
 */
 extern NSString * const RKRegexCaptureIndexErrorKey;
+/*!
+@const RKRegexHazardsErrorKey
+ @tocgroup   Constants Error Keys in User Info Dictionaries
+ @abstract   The corresponding value is an @link NSArray NSArray @/link of the backtracking hazard dictionaries that caused a regular expression to be rejected.  See @link hazardsForRegexString:options: hazardsForRegexString:options: @/link.
+*/
+extern NSString * const RKRegexHazardsErrorKey;
+
+/*!
+@const RKRegexHazardTypeKey
+ @tocgroup   Constants Hazard Dictionary Keys
+ @abstract   The corresponding value is an @link NSNumber NSNumber @/link of the @link RKRegexHazard RKRegexHazard @/link type of the hazard.
+*/
+extern NSString * const RKRegexHazardTypeKey;
+/*!
+@const RKRegexHazardRangeKey
+ @tocgroup   Constants Hazard Dictionary Keys
+ @abstract   The corresponding value is a @link NSValue NSValue @/link with the @link NSRange NSRange @/link of the regular expression string that contains the hazard.
+*/
+extern NSString * const RKRegexHazardRangeKey;
+/*!
+@const RKRegexHazardExponentialKey
+ @tocgroup   Constants Hazard Dictionary Keys
+ @abstract   The corresponding value is an @link NSNumber NSNumber @/link that is <span class="code">YES</span> if the hazard can backtrack exponentially in the length of the subject, or <span class="code">NO</span> if it is polynomial.
+*/
+extern NSString * const RKRegexHazardExponentialKey;
+/*!
+@const RKRegexHazardHardenableKey
+ @tocgroup   Constants Hazard Dictionary Keys
+ @abstract   The corresponding value is an @link NSNumber NSNumber @/link that is <span class="code">YES</span> if @link hardenedRegexString:options:hazards: hardenedRegexString:options:hazards: @/link can remove the hazard without changing what the regular expression matches.
+*/
+extern NSString * const RKRegexHazardHardenableKey;
+/*!
+@const RKRegexHazardDescriptionKey
+ @tocgroup   Constants Hazard Dictionary Keys
+ @abstract   The corresponding value is a localized @link NSString NSString @/link that describes the hazard.
+*/
+extern NSString * const RKRegexHazardDescriptionKey;
   
 /*!
  @toc DataTypes
@@ -282,7 +320,7 @@ extern NSString * const RKRegexCaptureIndexErrorKey;
  @constant RKMatchErrorUnknownOpcode While running the pattern match, an unknown item was encountered in the compiled pattern. This error could be caused by a bug in <a href="pcre/index.html" class="section-link">PCRE</a> or by overwriting of the compiled pattern.
  @constant RKMatchErrorNoMemory If a pattern contains back references and the internal matching buffers used by @link getRanges:withCharacters:length:inRange:options: getRanges:withCharacters:length:inRange:options: @/link are not big enough to hold the referenced substrings, then the <a href="pcre/index.html" class="section-link">PCRE</a> library will allocate a block of memory at the start of matching to use for this purpose.  If the <a href="pcre/index.html" class="section-link">PCRE</a> library is unable to allocate the additional memory, this error is returned.
  @constant RKMatchErrorNoSubstring This error is never returned by @link getRanges:withCharacters:length:inRange:options: getRanges:withCharacters:length:inRange:options:@/link.
- @constant RKMatchErrorMatchLimit The internal backtracking limit was reached.
+ @constant RKMatchErrorMatchLimit The backtracking limit was reached.  See @link setMatchLimit: setMatchLimit:@/link.
  @constant RKMatchErrorCallout <p>This error is never generated by @link getRanges:withCharacters:length:inRange:options: getRanges:withCharacters:length:inRange:options: @/link itself. It is provided for use by callout functions that want to yield a distinctive error code. See the <a href="pcre/pcrecallout.html" class="section-link">PCRE Callouts</a> documentation for details.</p>
  <div class="box important marginTopSpacer marginBottomSpacer"><div class="table"><div class="row"><div class="label cell">Important:</div><div class="message cell">Use of callouts are unsupported and will raise a @link RKRegexUnsupportedException RKRegexUnsupportedException @/link if used.</div></div></div></div>
  @constant RKMatchErrorBadUTF8 A string that contains an invalid UTF-8 byte sequence was passed as a subject.
@@ -291,9 +329,11 @@ extern NSString * const RKRegexCaptureIndexErrorKey;
  @constant RKMatchErrorBadPartial The @link RKMatchPartial RKMatchPartial @/link option was used with a compiled pattern containing items that are not supported for partial matching. See the <a href="pcre/pcrepartial.html" class="section-link">Partial Matching in PCRE</a> documentation for details.
  @constant RKMatchErrorInternal An unexpected internal error has occurred. This error could be caused by a bug in <a href="pcre/index.html" class="section-link">PCRE</a> or by overwriting of the compiled pattern.
  @constant RKMatchErrorBadCount This error is never returned by @link getRanges:withCharacters:length:inRange:options: getRanges:withCharacters:length:inRange:options:@/link.
- @constant RKMatchErrorRecursionLimit The internal recursion limit was reached.
+ @constant RKMatchErrorRecursionLimit The recursion limit was reached.  See @link setRecursionLimit: setRecursionLimit:@/link.
  @constant RKMatchErrorNullWorkSpaceLimit When a group that can match an empty substring is repeated with an unbounded upper limit, the subject position at the start of the group must be remembered, so that a test for an empty string can be made when the end of the group is reached. Some workspace is required for this; if it runs out, this error is given.
  @constant RKMatchErrorBadNewline An invalid combination of @link RKMatchNewlineMask RKMatchNewlineMask @/link options was given.
+ @constant RKMatchErrorDFAWorkspaceSize A @link RKMatchDFA RKMatchDFA @/link match needed more than the largest workspace RegexKit will allocate for the DFA algorithm.
+ @constant RKMatchErrorTimeLimit The match was still in progress when its time limit expired.  See @link setMatchTimeLimit: setMatchTimeLimit:@/link.  This error is generated by RegexKit, not the <a href="pcre/index.html" class="section-link">PCRE</a> library.
 */
 
 typedef enum {
@@ -313,9 +353,11 @@ typedef enum {
   RKMatchErrorBadPartial                = -13,
   RKMatchErrorInternal                  = -14,
   RKMatchErrorBadCount                  = -15,
+  RKMatchErrorDFAWorkspaceSize          = -19,
   RKMatchErrorRecursionLimit            = -21,
   RKMatchErrorNullWorkSpaceLimit        = -22,
-  RKMatchErrorBadNewline                = -23
+  RKMatchErrorBadNewline                = -23,
+  RKMatchErrorTimeLimit                 = -100
 } RKMatchErrorCode;
 
 /*!
@@ -476,6 +518,9 @@ typedef enum {
  @constant RKMatchNewlineMask A bitmask to extract only the newline setting.
  @constant RKMatchBackslashRAnyCRLR The escape sequence <span class="regex">\R</span> in the compiled regular expression will match only <b>CR</b>, <b>LF</b>, or <b>CRLF</b>, temporarily over-riding the setting used when the regular expression was compiled.  This option is mutually exclusive of @link RKMatchBackslashRUnicode RKMatchBackslashRUnicode@/link.
  @constant RKMatchBackslashRUnicode The escape sequence <span class="regex">\R</span> in the compiled regular expression will match any Unicode line ending sequence, temporarily over-riding the setting used when the regular expression was compiled.  This option is mutually exclusive of @link RKMatchBackslashRAnyCRLR RKMatchBackslashRAnyCRLR@/link.
+ @constant RKMatchDFA <p>The match is performed with the <a href="pcre/index.html" class="section-link">PCRE</a> library's alternative DFA matching algorithm, <span class="code">pcre_dfa_exec()</span>, instead of the usual backtracking algorithm.  The DFA algorithm scans the subject once, advancing every possible match in parallel, so a failing match never backtracks and takes time proportional to the length of the subject times the size of the regular expression, even for regular expressions that backtrack exponentially.</p>
+ <p>The DFA algorithm does not report captures, every capture other than the entire match is reported as not participating in the match.  The entire match is the <i>longest</i> match at the first position where the regular expression matches, which may be longer than the match found by the backtracking algorithm.  Regular expressions that contain back references, recursion, or conditional subpatterns that the DFA algorithm does not support are matched with the backtracking algorithm instead.  So are regular expressions that contain atomic groups or possessive quantifiers, since the DFA algorithm treats them as ordinary groups and quantifiers and could find a match that the backtracking algorithm does not, such as <span class="regex">(?&gt;a|ab)c</span> matching <span class="code">abc</span>.  This option is a RegexKit option and is never passed to the <a href="pcre/index.html" class="section-link">PCRE</a> library.  See also @link setMatchEngine: setMatchEngine:@/link.</p>
+ @constant RKMatchDFAShortest Implies @link RKMatchDFA RKMatchDFA@/link, and stops the DFA algorithm as soon as it finds a match, so the entire match is the <i>shortest</i> match at the first position where the regular expression matches.  This is the fastest way to determine whether or not a regular expression matches.
 */
 
 
@@ -495,9 +540,25 @@ typedef enum {
   RKMatchNewlineAnyCRLF      = 0x00500000,
   RKMatchNewlineMask         = 0x00700000,
   RKMatchBackslashRAnyCRLR   = 1 << 23,
-  RKMatchBackslashRUnicode   = 1 << 24
+  RKMatchBackslashRUnicode   = 1 << 24,
+  RKMatchDFA                 = 1 << 30,
+  RKMatchDFAShortest         = (RKMatchDFA | (1 << 16))
 } RKMatchOption;
 
+/*!
+@typedef RKMatchEngine
+ @abstract The matching algorithm that a @link RKRegex RKRegex @/link uses for the matches that only need the range of the entire match.  See @link setMatchEngine: setMatchEngine:@/link.
+ @constant RKMatchEngineBacktracking Matches use the <a href="pcre/index.html" class="section-link">PCRE</a> library's backtracking algorithm unless @link RKMatchDFA RKMatchDFA @/link is passed in the match options.  This is the default.
+ @constant RKMatchEngineDFA Matches that only need the range of the entire match, such as @link matchesCharacters:length:inRange:options: matchesCharacters:length:inRange:options: @/link and @link rangeForCharacters:length:inRange:captureIndex:options: rangeForCharacters:length:inRange:captureIndex:options: @/link with a <span class="argument">captureIndex</span> of <span class="code">0</span>, use the DFA algorithm as if @link RKMatchDFA RKMatchDFA @/link had been passed.
+ @constant RKMatchEngineAutomatic Matches that only need a yes or no answer, such as @link matchesCharacters:length:inRange:options: matchesCharacters:length:inRange:options: @/link and @link matchesSubjectsInArray:results: matchesSubjectsInArray:results:@/link, time both algorithms for a number of matches, and then use whichever one was faster.  The answer is always the same as the backtracking algorithm's.
+*/
+
+typedef enum {
+  RKMatchEngineBacktracking = 0,
+  RKMatchEngineDFA          = 1,
+  RKMatchEngineAutomatic    = 2
+} RKMatchEngine;
+
 
 /*!
 @typedef RKCompileOption
@@ -602,6 +663,84 @@ typedef enum {
   RKBuildConfigBackslashRUnicode = 1 << 24
 } RKBuildConfig;
 
+/*!
+@typedef RKCaptureColumnType
+ @abstract The type of the values that @link getCapturesFromSubjects:count:columns:columnCount:options:concurrent:error: getCapturesFromSubjects:count:columns:columnCount:options:concurrent:error: @/link stores in the <span class="code">values</span> array of a @link RKCaptureColumn RKCaptureColumn @/link.
+ @constant RKCaptureColumnInt64 The capture is converted with the <span class="code">sscanf()</span> conversion <span class="code">%lld</span> and stored as a <span class="code">int64_t</span>.
+ @constant RKCaptureColumnDouble The capture is converted with the <span class="code">sscanf()</span> conversion <span class="code">%lf</span> and stored as a <span class="code">double</span>.
+ @constant RKCaptureColumnTimestamp The capture is converted from one of the fixed format timestamps recognized by the <span class="code">&#64;d</span> capture reference conversion and stored as a @link NSTimeInterval NSTimeInterval @/link relative to the reference date, 1 January 2001, GMT.  A capture that is not in one of the fixed formats is treated as if it did not match.
+ @constant RKCaptureColumnRange The range of the capture, in the subjects UTF-16 character indexes, is stored as a @link NSRange NSRange @/link.  No string object is created for the capture.
+*/
+
+typedef enum {
+  RKCaptureColumnInt64     = 0,
+  RKCaptureColumnDouble    = 1,
+  RKCaptureColumnTimestamp = 2,
+  RKCaptureColumnRange     = 3
+} RKCaptureColumnType;
+
+/*!
+@typedef RKCaptureColumn
+ @abstract Describes a single column of values extracted from a named capture by @link getCapturesFromSubjects:count:columns:columnCount:options:concurrent:error: getCapturesFromSubjects:count:columns:columnCount:options:concurrent:error: @/link.
+ @field captureName The name of the capture subpattern to extract.  A string of decimal digits may be used to select a capture by its index.
+ @field type The @link RKCaptureColumnType RKCaptureColumnType @/link of the values.
+ @field values Caller supplied pointer to an array of at least <span class="argument">count</span> elements of the C type specified by <span class="code">type</span>.
+ @field nullBitmap Caller supplied pointer to a bitmap at least @link RKMatchResultsBitmapSize RKMatchResultsBitmapSize(count) @/link bytes long, or <span class="code">NULL</span>.  The bit for a subject is set if the subject did not match, the capture did not participate in the match, or the capture could not be converted, otherwise it is cleared.
+*/
+
+typedef struct {
+  NSString            *captureName;
+  RKCaptureColumnType  type;
+  void                *values;
+  unsigned char       *nullBitmap;
+} RKCaptureColumn;
+
+/*!
+@typedef RKSplitOption
+ @abstract Options that control how @link componentsSeparatedByRegex:inRange:limit:options:concurrent:error: componentsSeparatedByRegex:inRange:limit:options:concurrent:error: @/link divides a string in to components.
+ @constant RKSplitNoOptions No options specified.  Empty components are omitted and the components are @link NSString NSString @/link objects.
+ @constant RKSplitKeepEmptyComponents Empty components, such as those created by adjacent separators or a separator at the beginning or end of the range, are included in the result.
+ @constant RKSplitSubstringComponents The components are @link RKSubstring RKSubstring @/link objects that refer to the characters of the receiver instead of copying them.  Ignored by @link rangesOfComponentsSeparatedByRegex:inRange:limit:options:count:concurrent:error: rangesOfComponentsSeparatedByRegex:inRange:limit:options:count:concurrent:error: @/link.
+*/
+
+typedef enum {
+  RKSplitNoOptions           = 0,
+  RKSplitKeepEmptyComponents = 1 << 0,
+  RKSplitSubstringComponents = 1 << 1
+} RKSplitOption;
+
+/*!
+@typedef RKRegexHazard
+ @abstract The kinds of backtracking hazards that @link hazardsForRegexString:options: hazardsForRegexString:options: @/link can find in a regular expression.
+ @constant RKRegexHazardNestedQuantifier A repeated group contains a repeated item that can match the characters that begin the next repetition of the group, as in <span class="regex">(a+)+</span> or <span class="regex">(&#92;w+&#92;s?)*</span>.  A failing match tries every way of dividing the characters between the two quantifiers, which is exponential in the number of characters.
+ @constant RKRegexHazardOverlappingAlternation A repeated group contains alternatives that can begin with the same character, as in <span class="regex">(&#92;w|&#92;d)+</span> or <span class="regex">(a|ab)*</span>.  The hazard is exponential when two single character alternatives can match the same character, and polynomial otherwise.
+ @constant RKRegexHazardAdjacentQuantifiers Two repeated items that can match the same characters are separated only by items that can match the empty string, as in <span class="regex">&#92;d+&#92;d*</span> or <span class="regex">.*&#92;s*.*</span>.  A failing match tries every way of dividing the characters between them, which is polynomial in the number of characters.
+*/
+
+typedef enum {
+  RKRegexHazardNestedQuantifier       = 1,
+  RKRegexHazardOverlappingAlternation = 2,
+  RKRegexHazardAdjacentQuantifiers    = 3
+} RKRegexHazard;
+
+/*!
+@typedef RKRegexAnalysisOption
+ @abstract Options that control how @link regexWithRegexString:options:analysis:error: regexWithRegexString:options:analysis:error: @/link treats the backtracking hazards found in a regular expression before it is compiled.
+ @constant RKRegexAnalysisNoOptions No options specified.  The regular expression is compiled without being analyzed.
+ @constant RKRegexAnalysisHarden The hazards that can be removed without changing what the regular expression matches are rewritten with possessive quantifiers before the regular expression is compiled.
+ @constant RKRegexAnalysisRejectExponential The regular expression is rejected if it contains an exponential hazard.
+ @constant RKRegexAnalysisRejectPolynomial The regular expression is rejected if it contains a polynomial hazard.
+ @constant RKRegexAnalysisReject The regular expression is rejected if it contains any hazard.
+*/
+
+typedef enum {
+  RKRegexAnalysisNoOptions         = 0,
+  RKRegexAnalysisHarden            = 1 << 0,
+  RKRegexAnalysisRejectExponential = 1 << 1,
+  RKRegexAnalysisRejectPolynomial  = 1 << 2,
+  RKRegexAnalysisReject            = (RKRegexAnalysisRejectExponential | RKRegexAnalysisRejectPolynomial)
+} RKRegexAnalysisOption;
+
 #endif // _REGEXKIT_REGEXKITTYPES_H_
 
 #ifdef __cplusplus
@@ -46,24 +46,23 @@
 
 static BOOL RKMatchAndExtractCaptureReferences(id self, const SEL _cmd, NSString * const extractString, RK_STRONG_REF const RKUInteger * const fromIndex, RK_STRONG_REF const RKUInteger * const toIndex, RK_STRONG_REF const NSRange * const range, id aRegex, const RKCompileOption compileOptions, const RKMatchOption matchOptions, const RKCaptureExtractOptions captureExtractOptions, NSString * const firstKey, va_list useVarArgsList);
 static BOOL RKMatchAndExtractCaptureReferencesX(id self, const SEL _cmd, NSString * const extractString, RK_STRONG_REF const RKUInteger * const fromIndex, RK_STRONG_REF const RKUInteger * const toIndex, RK_STRONG_REF const NSRange * const range, id aRegex, const RKCompileOption compileOptions, const RKMatchOption matchOptions, const RKCaptureExtractOptions captureExtractOptions, NSString * const firstKey, va_list useVarArgsList, NSError **error);
-static BOOL RKExtractCapturesFromMatchesWithKeysAndPointers(id self, const SEL _cmd, RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) stringBuffer,
-                                                            RKRegex * const RK_C99(restrict) regex, RK_STRONG_REF const NSRange * const RK_C99(restrict) matchRanges,
-                                                            NSString ** const RK_C99(restrict) keyStrings, RK_STRONG_REF void *** const RK_C99(restrict) keyConversionPointers,
-                                                            const RKUInteger count, const RKCaptureExtractOptions captureExtractOptions, NSError **error);
 
 static NSString *RKStringByMatchingAndExpanding(id self, const SEL _cmd, NSString * const searchString, RK_STRONG_REF const RKUInteger * const fromIndex, RK_STRONG_REF const RKUInteger * const toIndex, RK_STRONG_REF const NSRange * const searchStringRange, const RKUInteger count, id aRegex, NSString * const referenceString, RK_STRONG_REF va_list * const argListPtr, const BOOL expandOrReplace, RK_STRONG_REF RKUInteger * const matchedCountPtr);
 static NSString *RKStringByMatchingAndExpandingX(id self, const SEL _cmd, NSString * const searchString, RK_STRONG_REF const RKUInteger * const fromIndex, RK_STRONG_REF const RKUInteger * const toIndex, RK_STRONG_REF const NSRange * const searchStringRange, const RKUInteger count, id aRegex, NSString * const referenceString, RK_STRONG_REF va_list * const argListPtr, const BOOL expandOrReplace, RK_STRONG_REF RKUInteger * const matchedCountPtr, NSError **error);
-static void RKEvaluateCopyInstructions(RK_STRONG_REF const RKCopyInstructionsBuffer * const instructionsBuffer, RK_STRONG_REF void * const toBuffer, const size_t bufferLength);
-static NSString *RKStringFromCopyInstructions(id self, const SEL _cmd, RK_STRONG_REF const RKCopyInstructionsBuffer * const instructionsBuffer, const RKStringBufferEncoding stringEncoding) RK_ATTRIBUTES(malloc);
-static NSString *RKStringFromCopyInstructionsX(id self, const SEL _cmd, RK_STRONG_REF const RKCopyInstructionsBuffer * const instructionsBuffer, const RKStringBufferEncoding stringEncoding, NSError **error) RK_ATTRIBUTES(malloc);
+static NSString *RKStringByMatchingAndReplacingWithFunctionX(id self, const SEL _cmd, RK_STRONG_REF const NSRange * const searchStringRange, const RKUInteger count, id aRegex, RKReplaceFunction function, void *info, NSError **error);
+#ifdef __BLOCKS__
+static BOOL RKReplaceBlockFunction(RKReplaceContext *replaceContext, void *info);
+#endif // __BLOCKS__
+static BOOL RKPrepareMatchAndExpandX(id self, const SEL _cmd, NSString * const searchString, RK_STRONG_REF const RKUInteger * const fromIndex, RK_STRONG_REF const RKUInteger * const toIndex, RK_STRONG_REF const NSRange * const searchStringRange, id aRegex, NSString * const referenceString, RK_STRONG_REF va_list * const argListPtr, RKRegex ** const regexPtr, RK_STRONG_REF RKStringBuffer * const searchStringBufferPtr, RK_STRONG_REF NSRange * const searchRangePtr, RK_STRONG_REF RKReferenceInstructionsBuffer * const referenceInstructionsBuffer, NSError **error);
+static NSString *RKStringFromOutputBuffer(id self, const SEL _cmd, RK_STRONG_REF RKOutputBuffer * const outputBuffer, const RKStringBufferEncoding stringEncoding) RK_ATTRIBUTES(malloc);
+static NSString *RKStringFromOutputBufferX(id self, const SEL _cmd, RK_STRONG_REF RKOutputBuffer * const outputBuffer, const RKStringBufferEncoding stringEncoding, NSError **error) RK_ATTRIBUTES(malloc);
 static BOOL RKApplyReferenceInstructions(id self, const SEL _cmd, RKRegex * const regex, RK_STRONG_REF const NSRange * const matchRanges, RK_STRONG_REF const RKStringBuffer * const stringBuffer,
-                                         RK_STRONG_REF const RKReferenceInstructionsBuffer * const referenceInstructionsBuffer, RK_STRONG_REF RKCopyInstructionsBuffer * const appliedInstructionsBuffer);
+                                         RK_STRONG_REF const RKReferenceInstructionsBuffer * const referenceInstructionsBuffer, RK_STRONG_REF RKOutputBuffer * const outputBuffer);
 static BOOL RKCompileReferenceString(id self, const SEL _cmd, RK_STRONG_REF const RKStringBuffer * const referenceStringBuffer, RKRegex * const regex,\
                                      RK_STRONG_REF RKReferenceInstructionsBuffer * const instructionBuffer);
-static BOOL RKCompileReferenceStringX(id self, const SEL _cmd, RK_STRONG_REF const RKStringBuffer * const referenceStringBuffer, RKRegex * const regex,\
-                                     RK_STRONG_REF RKReferenceInstructionsBuffer * const instructionBuffer, NSError **error);
 static BOOL RKAppendInstruction(RK_STRONG_REF RKReferenceInstructionsBuffer * const instructionsBuffer, const int op, RK_STRONG_REF const void * const ptr, const NSRange range);
-static BOOL RKAppendCopyInstruction(RK_STRONG_REF RKCopyInstructionsBuffer * const copyInstructionsBuffer, RK_STRONG_REF const void * const ptr, const NSRange range);
+static BOOL RKAppendToOutputBuffer(RK_STRONG_REF RKOutputBuffer * const outputBuffer, RK_STRONG_REF const void * const ptr, const NSRange range);
+static BOOL RKAppendCaseConvertedToOutputBuffer(RK_STRONG_REF RKOutputBuffer * const outputBuffer, RK_STRONG_REF const char * const fromPtr, const RKUInteger fromLength, const BOOL toUppercase);
 static RKUInteger RKMutableStringMatch(id self, const SEL _cmd, id aRegex,
                                        RK_STRONG_REF const RKUInteger * RK_C99(restrict) fromIndex, RK_STRONG_REF const RKUInteger * RK_C99(restrict) toIndex,
                                        RK_STRONG_REF const NSRange * RK_C99(restrict) range, const RKUInteger count,
@@ -72,10 +71,53 @@ static RKUInteger RKMutableStringMatchX(id self, const SEL _cmd, id aRegex,
                                        RK_STRONG_REF const RKUInteger * RK_C99(restrict) fromIndex, RK_STRONG_REF const RKUInteger * RK_C99(restrict) toIndex,
                                        RK_STRONG_REF const NSRange * RK_C99(restrict) range, const RKUInteger count,
                                        NSString * const RK_C99(restrict) formatString, RK_STRONG_REF va_list * const RK_C99(restrict) argListPtr, NSError **error);
+static BOOL RKMutableStringReplaceInPlaceX(id self, const SEL _cmd, RK_STRONG_REF const RKStringBuffer * const searchStringBuffer, const NSRange searchRange, const RKUInteger count, RKRegex * const regex,
+                                           RK_STRONG_REF const RKReferenceInstructionsBuffer * const referenceInstructionsBuffer, RK_STRONG_REF RKUInteger * const replacedCountPtr, NSError **error);
+
+static BOOL RKParseFixedFormatDate(RK_STRONG_REF const char * const characters, const RKUInteger length, RK_STRONG_REF RKFixedFormatDate * const date);
+static NSDate *RKDateFromFixedFormatCharacters(RK_STRONG_REF const char * const characters, const RKUInteger length);
+
+/*************** Splitting ***************/
+
+// Concurrent splits divide the subject in to chunks of at least this many bytes, and a subject must be at least two chunks long.
+#define RK_SPLIT_CONCURRENT_CHUNK_SIZE (128 * 1024)
+#define RK_SPLIT_MAXIMUM_CHUNKS        64
+
+struct _RKSplitSeparator {
+  RKUInteger scanLocation;   // The location the search that found the separator started from.
+  NSRange    separatorRange;
+};
+
+typedef struct _RKSplitSeparator RK_STRONG_REF RKSplitSeparator;
+
+struct _RKSplitChunk {
+                NSRange           chunkRange;          // The separators that start within chunkRange belong to this chunk.
+  RK_STRONG_REF RKSplitSeparator *separators;
+                RKUInteger        separatorsCount;
+                RKUInteger        separatorsCapacity;
+};
+
+typedef struct _RKSplitChunk RK_STRONG_REF RKSplitChunk;
+
+struct _RKSplitState {
+                RKRegex          *regex;
+  RK_STRONG_REF RKStringBuffer   *stringBuffer;
+                RKUInteger        endLocation;
+  RK_STRONG_REF RKSplitChunk     *chunks;
+                RKUInteger        chunksCount;
+                RKUInteger        atChunk;
+};
+
+typedef struct _RKSplitState RK_STRONG_REF RKSplitState;
+
+static NSRange *RKSplitComponentRangesX(id self, const SEL _cmd, RKRegex * const regex, RK_STRONG_REF RKStringBuffer * const stringBuffer, const NSRange searchRange, const RKUInteger limit, const RKSplitOption options, const BOOL concurrent, RK_STRONG_REF RKUInteger * const componentsCountPtr, NSError **error);
+static RKMatchErrorCode RKSplitNextSeparator(RKRegex * const regex, RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) stringBuffer, const RKUInteger length, const RKUInteger endLocation, const RKUInteger componentLocation, RK_STRONG_REF RKUInteger * const RK_C99(restrict) scanLocation, RK_STRONG_REF NSRange * const RK_C99(restrict) separatorRange);
+static BOOL RKSplitAppendSeparator(RK_STRONG_REF RKSplitChunk * const RK_C99(restrict) chunk, const RKUInteger scanLocation, const NSRange separatorRange);
+static int RKSplitChunkFunction(void *splitState) RK_ATTRIBUTES(used, nonnull);
 
 #ifdef REGEXKIT_DEBUG
 static void dumpReferenceInstructions(RK_STRONG_REF const RKReferenceInstructionsBuffer *ins);
-static void dumpCopyInstructions(RK_STRONG_REF const RKCopyInstructionsBuffer *ins);
+static void dumpOutputBuffer(RK_STRONG_REF const RKOutputBuffer *outputBuffer);
 #endif // REGEXKIT_DEBUG
 
 /*************** End match and replace operations ***************/
@@ -109,8 +151,12 @@ static BOOL RKParseReference(RK_STRONG_REF const RKStringBuffer * const RK_C99(r
                              RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) subjectBuffer, RK_STRONG_REF const NSRange * const RK_C99(restrict) subjectMatchResultRanges,
                              RKRegex * const RK_C99(restrict) regex, RK_STRONG_REF RKUInteger * const RK_C99(restrict) parsedReferenceUInteger,
                              RK_STRONG_REF void * const RK_C99(restrict) conversionPtr, const RKParseReferenceFlags parseReferenceOptions, RK_STRONG_REF NSRange * const RK_C99(restrict) parsedRange,
-                             RK_STRONG_REF NSRange * const RK_C99(restrict) parsedReferenceRange, NSString ** const RK_C99(restrict) errorString,
+                             RK_STRONG_REF NSRange * const RK_C99(restrict) parsedReferenceRange, RK_STRONG_REF RKParsedCaptureReference * const RK_C99(restrict) parsedCaptureReference, NSString ** const RK_C99(restrict) errorString,
                              RK_STRONG_REF void *** const RK_C99(restrict) autoreleasePool, RK_STRONG_REF RKUInteger * const RK_C99(restrict) autoreleasePoolIndex, NSError **error);
+static BOOL RKMakeParsedCaptureReference(const RKUInteger captureIndex, RK_STRONG_REF const char * const RK_C99(restrict) startOfConversion, RK_STRONG_REF const char * const RK_C99(restrict) endOfConversion, RK_STRONG_REF RKParsedCaptureReference * const RK_C99(restrict) parsedCaptureReference, RK_STRONG_REF RKParseErrorMessage * const RK_C99(restrict) parseErrorMessage);
+static BOOL RKConvertParsedCaptureReference(RK_STRONG_REF const RKParsedCaptureReference * const RK_C99(restrict) parsedCaptureReference, RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) subjectBuffer,
+                                            RK_STRONG_REF const NSRange * const RK_C99(restrict) subjectMatchResultRanges, RKRegex * const RK_C99(restrict) regex, RK_STRONG_REF void * const RK_C99(restrict) conversionPtr,
+                                            RK_STRONG_REF void *** const RK_C99(restrict) autoreleasePool, RK_STRONG_REF RKUInteger * const RK_C99(restrict) autoreleasePoolIndex, RK_STRONG_REF RKParseErrorMessage * const RK_C99(restrict) parseErrorMessage);
 
 /* Although the docs claim NSDate is multithreading safe, testing indicates otherwise.  NSDate will mis-parse strings occasionally under heavy threaded access. */
 static RKLock RK_STRONG_REF *NSStringRKExtensionsNSDateLock  = NULL;
@@ -200,7 +246,7 @@ static void NSStringRKExtensionsInitializeFunction(void) {
   RKStringBuffer         stringBuffer = RKStringBufferWithString(self);
   RKRegex               *regex        = RKRegexFromStringOrRegex(self, _cmd, aRegex, (RKCompileUTF8 | RKCompileNoUTF8Check), YES);
   NSRange RK_STRONG_REF *matchRanges  = [regex rangesForCharacters:stringBuffer.characters length:stringBuffer.length inRange:NSMakeRange(0, stringBuffer.length) options:RKMatchNoUTF8Check];
-  if(matchRanges != NULL) { RKUInteger captures = [regex captureCount]; for(RKUInteger x = 0; x < captures; x++) { matchRanges[x] = RKutf8to16(self, matchRanges[x]); } }
+  if(matchRanges != NULL) { RKConvertUTF8ToUTF16RangesForStringBuffer(&stringBuffer, matchRanges, [regex captureCount], NULL, NULL); }
   return(matchRanges);
 }
 
@@ -209,7 +255,7 @@ static void NSStringRKExtensionsInitializeFunction(void) {
   RKStringBuffer         stringBuffer = RKStringBufferWithString(self);
   RKRegex               *regex        = RKRegexFromStringOrRegex(self, _cmd, aRegex, (RKCompileUTF8 | RKCompileNoUTF8Check), YES);
   NSRange RK_STRONG_REF *matchRanges  = [regex rangesForCharacters:stringBuffer.characters length:stringBuffer.length inRange:RKutf16to8(self, range) options:RKMatchNoUTF8Check];
-  if(matchRanges != NULL) { RKUInteger captures = [regex captureCount]; for(RKUInteger x = 0; x < captures; x++) { matchRanges[x] = RKutf8to16(self, matchRanges[x]); } }
+  if(matchRanges != NULL) { RKConvertUTF8ToUTF16RangesForStringBuffer(&stringBuffer, matchRanges, [regex captureCount], NULL, NULL); }
   return(matchRanges);
 }
 
@@ -218,7 +264,7 @@ static void NSStringRKExtensionsInitializeFunction(void) {
   RKStringBuffer         stringBuffer = RKStringBufferWithString(self);
   RKRegex               *regex        = RKRegexFromStringOrRegex(self, _cmd, aRegex, (RKCompileUTF8 | RKCompileNoUTF8Check), YES);
   NSRange RK_STRONG_REF *matchRanges  = [regex rangesForCharacters:stringBuffer.characters length:stringBuffer.length inRange:NSMakeRange(0, stringBuffer.length) options:RKMatchNoUTF8Check error:error];
-  if(matchRanges != NULL) { RKUInteger captures = [regex captureCount]; for(RKUInteger x = 0; x < captures; x++) { matchRanges[x] = RKutf8to16(self, matchRanges[x]); } }
+  if(matchRanges != NULL) { RKConvertUTF8ToUTF16RangesForStringBuffer(&stringBuffer, matchRanges, [regex captureCount], NULL, NULL); }
   return(matchRanges);
 }
 
@@ -227,7 +273,7 @@ static void NSStringRKExtensionsInitializeFunction(void) {
   RKStringBuffer         stringBuffer = RKStringBufferWithString(self);
   RKRegex               *regex        = RKRegexFromStringOrRegex(self, _cmd, aRegex, (RKCompileUTF8 | RKCompileNoUTF8Check), YES);
   NSRange RK_STRONG_REF *matchRanges  = [regex rangesForCharacters:stringBuffer.characters length:stringBuffer.length inRange:RKutf16to8(self, range) options:RKMatchNoUTF8Check error:error];
-  if(matchRanges != NULL) { RKUInteger captures = [regex captureCount]; for(RKUInteger x = 0; x < captures; x++) { matchRanges[x] = RKutf8to16(self, matchRanges[x]); } }
+  if(matchRanges != NULL) { RKConvertUTF8ToUTF16RangesForStringBuffer(&stringBuffer, matchRanges, [regex captureCount], NULL, NULL); }
   return(matchRanges);
 }
 
@@ -288,6 +334,242 @@ static void NSStringRKExtensionsInitializeFunction(void) {
   return([RKRegexFromStringOrRegex(self, _cmd, aRegex, (RKCompileUTF8 | RKCompileNoUTF8Check), YES) matchesCharacters:stringBuffer.characters length:stringBuffer.length inRange:RKutf16to8(self, range) options:RKMatchNoUTF8Check error:error]);
 }
 
+//
+// componentsSeparatedByRegex: methods
+//
+
+- (NSArray *)componentsSeparatedByRegex:(id)aRegex
+{
+  return([self componentsSeparatedByRegex:aRegex inRange:NSMakeRange(0, [self length]) limit:0 options:RKSplitNoOptions concurrent:NO error:NULL]);
+}
+
+- (NSArray *)componentsSeparatedByRegex:(id)aRegex limit:(const RKUInteger)limit options:(const RKSplitOption)options
+{
+  return([self componentsSeparatedByRegex:aRegex inRange:NSMakeRange(0, [self length]) limit:limit options:options concurrent:NO error:NULL]);
+}
+
+// XXX WARNING: This code uses alloca().  If you do not -=COMPLETELY=- understand what alloca() does, you MUST NOT alter this code.
+- (NSArray *)componentsSeparatedByRegex:(id)aRegex inRange:(const NSRange)range limit:(const RKUInteger)limit options:(const RKSplitOption)options concurrent:(const BOOL)concurrent error:(NSError **)error
+{
+  RKStringBuffer          stringBuffer      = RKStringBufferWithString(self);
+  RKRegex                *regex             = RKRegexFromStringOrRegex(self, _cmd, aRegex, (RKCompileUTF8 | RKCompileNoUTF8Check), YES);
+  RKUInteger              componentsCount   = 0, x = 0;
+  NSRange RK_STRONG_REF  *componentRanges   = NULL;
+  id      RK_STRONG_REF  *componentObjects  = NULL;
+  NSArray                *componentsArray   = NULL;
+  
+  if((componentRanges = RKSplitComponentRangesX(self, _cmd, regex, &stringBuffer, RKutf16to8(self, range), limit, options, concurrent, &componentsCount, error)) == NULL) { return(NULL); }
+  if(componentsCount == 0) { return([NSArray array]); }
+  
+  if(RK_EXPECTED((componentObjects = RKMallocScanned(sizeof(id) * componentsCount)) == NULL, 0)) { [[NSException rkException:NSMallocException for:self selector:_cmd localizeReason:@"Unable to allocate memory for the components."] raise]; }
+  
+  for(x = 0; x < componentsCount; x++) {
+    if((options & RKSplitSubstringComponents) != 0) { componentObjects[x] = RKSubstringCreateWithStringBuffer(&stringBuffer, componentRanges[x]); continue; }
+#ifdef USE_CORE_FOUNDATION
+    componentObjects[x] = RKMakeCollectable(CFStringCreateWithBytes(NULL, (const UInt8 *)(stringBuffer.characters + componentRanges[x].location), (CFIndex)componentRanges[x].length, kCFStringEncodingUTF8, NO));
+#else  // USE_CORE_FOUNDATION is not defined
+    componentObjects[x] = [[NSString alloc] initWithBytes:(stringBuffer.characters + componentRanges[x].location) length:componentRanges[x].length encoding:NSUTF8StringEncoding];
+#endif // USE_CORE_FOUNDATION
+  }
+  
+#ifdef USE_CORE_FOUNDATION
+  if(RKRegexGarbageCollect == 0) { componentsArray = RKMakeCollectableOrAutorelease(CFArrayCreate(NULL, (const void **)&componentObjects[0], (CFIndex)componentsCount, &noRetainArrayCallBacks)); }
+  else                           { componentsArray = CFMakeCollectable             (CFArrayCreate(NULL, (const void **)&componentObjects[0], (CFIndex)componentsCount, &kCFTypeArrayCallBacks));  }
+#else  // USE_CORE_FOUNDATION is not defined
+  componentsArray = [NSArray arrayWithObjects:&componentObjects[0] count:componentsCount];
+  for(x = 0; x < componentsCount; x++) { RKRelease(componentObjects[x]); }
+#endif // USE_CORE_FOUNDATION
+  
+  RKFreeAndNULL(componentObjects);
+  return(componentsArray);
+}
+
+- (NSRange *)rangesOfComponentsSeparatedByRegex:(id)aRegex inRange:(const NSRange)range limit:(const RKUInteger)limit options:(const RKSplitOption)options count:(RKUInteger *)count concurrent:(const BOOL)concurrent error:(NSError **)error
+{
+  RKStringBuffer          stringBuffer    = RKStringBufferWithString(self);
+  RKRegex                *regex           = RKRegexFromStringOrRegex(self, _cmd, aRegex, (RKCompileUTF8 | RKCompileNoUTF8Check), YES);
+  RKUInteger              componentsCount = 0, utf8Anchor = 0, utf16Anchor = 0, x = 0;
+  NSRange RK_STRONG_REF  *componentRanges = NULL;
+  
+  if(RK_EXPECTED(count == NULL, 0)) { [[NSException rkException:NSInvalidArgumentException for:self selector:_cmd localizeReason:@"The count argument is NULL."] raise]; }
+  *count = 0;
+  
+  if((componentRanges = RKSplitComponentRangesX(self, _cmd, regex, &stringBuffer, RKutf16to8(self, range), limit, options, concurrent, &componentsCount, error)) == NULL) { return(NULL); }
+  
+  // The components are in ascending order, so each conversion picks up from where the previous one left off.
+  for(x = 0; x < componentsCount; x++) { RKConvertUTF8ToUTF16RangesForStringBuffer(&stringBuffer, &componentRanges[x], 1, &utf8Anchor, &utf16Anchor); }
+  
+  *count = componentsCount;
+  return(componentRanges);
+}
+
+//
+// Returns an autoreleased buffer of the UTF8 ranges of the components of stringBuffer within searchRange, separated by regex.
+//
+// Each search for a separator starts where the previous separator ended.  An empty separator at the start of a component would
+// only create an empty component and then find itself again, so the search moves forward one character and tries again, the
+// same as perl.  This means an empty separator splits the subject in to its individual characters.
+//
+// A concurrent split divides searchRange in to chunks, and each thread pool worker finds the separators that start within a
+// chunk, starting its search at the beginning of the chunk.  The chunks are then stitched together in order: a separator found
+// by a worker is used as is when the worker's search for it started at or before where a single sequential search would have
+// started, since no separator can start between the two.  Otherwise, which is usually only the first separator or so of each
+// chunk, the search is repeated sequentially from the correct location until it finds the same separator as the worker did.
+// The result is identical to a sequential split as long as a separator match does not depend on text more than one chunk past
+// where it starts, ie long lookahead assertions, which the workers can not see past.
+//
+
+// XXX WARNING: This code uses alloca().  If you do not -=COMPLETELY=- understand what alloca() does, you MUST NOT alter this code.
+static NSRange *RKSplitComponentRangesX(id self, const SEL _cmd, RKRegex * const regex, RK_STRONG_REF RKStringBuffer * const stringBuffer, const NSRange searchRange, const RKUInteger limit, const RKSplitOption options, const BOOL concurrent, RK_STRONG_REF RKUInteger * const componentsCountPtr, NSError **error) {
+  RKSplitChunk RK_STRONG_REF *chunks            = NULL;
+  RKSplitChunk                separators;
+  RKSplitState                splitState;
+  RKUInteger                  chunksCount       = 0, atChunk = 0, atSeparator = 0, componentsCount = 0, x = 0;
+  RKUInteger                  endLocation       = NSMaxRange(searchRange), scanLocation = searchRange.location, componentLocation = searchRange.location;
+  NSRange RK_STRONG_REF      *componentRanges   = NULL;
+  NSRange                     separatorRange;
+  RKMatchErrorCode            errorCode         = RKMatchErrorNoError;
+  NSError                    *splitError        = NULL;
+  const BOOL                  keepEmpty         = ((options & RKSplitKeepEmptyComponents) != 0) ? YES : NO;
+  
+  if(error != NULL) { *error = NULL; }
+  *componentsCountPtr = 0;
+  memset(&separators, 0, sizeof(RKSplitChunk));
+  
+  if(RK_EXPECTED(stringBuffer->characters == NULL, 0)) { splitError = [NSError rkErrorWithDomain:NSCocoaErrorDomain code:0 localizeDescription:@"Unable to convert the string to UTF8."]; goto errorExit; }
+  if(RK_EXPECTED(stringBuffer->length > INT_MAX, 0)) { [[NSException rkException:NSRangeException for:self selector:_cmd localizeReason:@"The length of the string, %lu, is greater than the maximum of a 32 bit signed int.", (unsigned long)stringBuffer->length] raise]; }
+  
+  // \G depends on where a search starts, so the workers could find separators that a sequential split would not.
+  if((concurrent == YES) && (searchRange.length >= (RK_SPLIT_CONCURRENT_CHUNK_SIZE * 2)) && ((limit == 0) || (limit > 2)) && ([[regex regexString] rangeOfString:@"\\G"].location == NSNotFound)) {
+    chunksCount = min((searchRange.length / RK_SPLIT_CONCURRENT_CHUNK_SIZE), RK_SPLIT_MAXIMUM_CHUNKS);
+    if(RK_EXPECTED((chunks = alloca(sizeof(RKSplitChunk) * chunksCount)) == NULL, 0)) { [[NSException rkException:NSMallocException for:self selector:_cmd localizeReason:@"Unable to allocate temporary stack space."] raise]; }
+    memset(chunks, 0, sizeof(RKSplitChunk) * chunksCount);
+    
+    for(x = 0; x < chunksCount; x++) {
+      RKUInteger chunkStart = (x == 0)                 ? searchRange.location : NSMaxRange(chunks[x - 1].chunkRange);
+      RKUInteger chunkEnd   = (x == (chunksCount - 1)) ? endLocation          : (searchRange.location + (((x + 1) * searchRange.length) / chunksCount));
+      while((chunkEnd < endLocation) && ((((const unsigned char *)stringBuffer->characters)[chunkEnd] & 0xC0) == 0x80)) { chunkEnd++; } // Chunks must begin on a UTF8 character.
+      chunks[x].chunkRange = NSMakeRange(chunkStart, (chunkEnd - chunkStart));
+    }
+    
+    splitState = (RKSplitState){regex, stringBuffer, endLocation, chunks, chunksCount, 0};
+    if([[RKThreadPool defaultThreadPool] threadFunction:RKSplitChunkFunction argument:&splitState] == NO) { RKSplitChunkFunction(&splitState); }
+  }
+  
+  // Gather the separators, using the ones found by the chunk workers whenever possible.  Stops once limit - 1 components have been found.
+  while((limit == 0) || ((componentsCount + 1) < limit)) {
+    BOOL foundSeparator = NO;
+    
+    while(atChunk < chunksCount) {
+      if(atSeparator >= chunks[atChunk].separatorsCount) { atChunk++; atSeparator = 0; continue; }
+      RKSplitSeparator RK_STRONG_REF *chunkSeparator = &chunks[atChunk].separators[atSeparator];
+      if(chunkSeparator->separatorRange.location < scanLocation) { atSeparator++; continue; } // Inside of, or before, the last separator.
+      if((chunkSeparator->scanLocation <= scanLocation) && ((chunkSeparator->separatorRange.length > 0) || (chunkSeparator->separatorRange.location != componentLocation))) {
+        separatorRange = chunkSeparator->separatorRange; foundSeparator = YES; atSeparator++;
+      }
+      break;
+    }
+    
+    if(foundSeparator == NO) {
+      if((errorCode = RKSplitNextSeparator(regex, stringBuffer, stringBuffer->length, endLocation, componentLocation, &scanLocation, &separatorRange)) == RKMatchErrorNoMatch) { errorCode = RKMatchErrorNoError; break; }
+      if(RK_EXPECTED(errorCode < RKMatchErrorNoError, 0)) { splitError = [NSError rkErrorWithDomain:RKRegexPCRELibraryErrorDomain code:errorCode localizeDescription:RKLocalizedStringForPCRECompileErrorCode(errorCode)]; goto errorExit; }
+    }
+    
+    if(RK_EXPECTED(RKSplitAppendSeparator(&separators, scanLocation, separatorRange) == NO, 0)) { goto allocationError; }
+    if((separatorRange.location > componentLocation) || (keepEmpty == YES)) { componentsCount++; }
+    scanLocation = componentLocation = NSMaxRange(separatorRange);
+  }
+  
+  if(RK_EXPECTED((componentRanges = RKAutoreleasedMallocNotScanned(sizeof(NSRange) * (separators.separatorsCount + 1))) == NULL, 0)) { goto allocationError; }
+  
+  componentsCount   = 0;
+  componentLocation = searchRange.location;
+  for(x = 0; x < separators.separatorsCount; x++) {
+    separatorRange = separators.separators[x].separatorRange;
+    if((separatorRange.location > componentLocation) || (keepEmpty == YES)) { componentRanges[componentsCount++] = NSMakeRange(componentLocation, (separatorRange.location - componentLocation)); }
+    componentLocation = NSMaxRange(separatorRange);
+  }
+  if((endLocation > componentLocation) || (keepEmpty == YES)) { componentRanges[componentsCount++] = NSMakeRange(componentLocation, (endLocation - componentLocation)); }
+  
+  *componentsCountPtr = componentsCount;
+  goto exitNow;
+  
+allocationError:
+  splitError = [NSError rkErrorWithDomain:NSPOSIXErrorDomain code:0 localizeDescription:@"Unable to allocate memory for the separators."];
+errorExit:
+  componentRanges = NULL;
+  if(error != NULL) { *error = splitError; }
+exitNow:
+  for(x = 0; x < chunksCount; x++) { if(chunks[x].separators != NULL) { RKFreeAndNULLNoGC(chunks[x].separators); } }
+  if(separators.separators != NULL) { RKFreeAndNULLNoGC(separators.separators); }
+  return(componentRanges);
+}
+
+//
+// Finds the next separator at or after *scanLocation that ends at or before endLocation.  If the search had to move past an empty
+// separator at componentLocation, *scanLocation is updated to where the search that found the separator started.
+//
+
+static RKMatchErrorCode RKSplitNextSeparator(RKRegex * const regex, RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) stringBuffer, const RKUInteger length, const RKUInteger endLocation, const RKUInteger componentLocation, RK_STRONG_REF RKUInteger * const RK_C99(restrict) scanLocation, RK_STRONG_REF NSRange * const RK_C99(restrict) separatorRange) {
+  RKMatchErrorCode errorCode  = RKMatchErrorNoMatch;
+  int              vectors[3] = {-1, -1, -1};
+  
+  while(*scanLocation <= endLocation) {
+    if((errorCode = (RKMatchErrorCode)RKRegexExec(regex, stringBuffer->characters, (int)length, (int)*scanLocation, RKMatchNoUTF8Check, vectors, 3, NULL)) < 0) { return(errorCode); }
+    if((RKUInteger)vectors[1] > endLocation) { return(RKMatchErrorNoMatch); }
+    
+    *separatorRange = NSMakeRange((RKUInteger)vectors[0], (RKUInteger)(vectors[1] - vectors[0]));
+    if(separatorRange->length > 0) { return(RKMatchErrorNoError); }
+    if(separatorRange->location == endLocation) { return(RKMatchErrorNoMatch); } // An empty separator at the end never creates a component.
+    if(separatorRange->location != componentLocation) { return(RKMatchErrorNoError); }
+    
+    *scanLocation = separatorRange->location + 1;
+    while((*scanLocation < endLocation) && ((((const unsigned char *)stringBuffer->characters)[*scanLocation] & 0xC0) == 0x80)) { *scanLocation = *scanLocation + 1; }
+  }
+  
+  return(RKMatchErrorNoMatch);
+}
+
+static BOOL RKSplitAppendSeparator(RK_STRONG_REF RKSplitChunk * const RK_C99(restrict) chunk, const RKUInteger scanLocation, const NSRange separatorRange) {
+  if(RK_EXPECTED(chunk->separatorsCount == chunk->separatorsCapacity, 0)) {
+    RKUInteger                      newCapacity   = (chunk->separatorsCapacity == 0) ? 256 : (chunk->separatorsCapacity * 2);
+    RKSplitSeparator RK_STRONG_REF *newSeparators = NULL;
+    if(RK_EXPECTED((newSeparators = realloc(chunk->separators, sizeof(RKSplitSeparator) * newCapacity)) == NULL, 0)) { return(NO); }
+    chunk->separators         = newSeparators;
+    chunk->separatorsCapacity = newCapacity;
+  }
+  
+  chunk->separators[chunk->separatorsCount++] = (RKSplitSeparator){scanLocation, separatorRange};
+  return(YES);
+}
+
+//
+// The concurrent split worker.  May be executed by several threads at once, each of which claims chunks until there are none
+// left.  A worker only searches a window of two chunks so that a chunk with no separators does not search the rest of the subject.
+// A separator that ends at the edge of the window may have been cut short, so the worker stops there and leaves the rest of the
+// chunk to the sequential stitching pass.
+//
+
+static int RKSplitChunkFunction(void *splitState) {
+  RKSplitState RK_STRONG_REF *state = (RKSplitState RK_STRONG_REF *)splitState;
+  
+  for(RKUInteger atChunk = (RKAtomicIncrementIntegerBarrier(&state->atChunk) - 1); atChunk < state->chunksCount; atChunk = (RKAtomicIncrementIntegerBarrier(&state->atChunk) - 1)) {
+    RKSplitChunk RK_STRONG_REF *chunk        = &state->chunks[atChunk];
+    RKUInteger                  chunkEnd     = NSMaxRange(chunk->chunkRange), windowEnd = min((chunkEnd + chunk->chunkRange.length), state->endLocation);
+    RKUInteger                  scanLocation = chunk->chunkRange.location, componentLocation = chunk->chunkRange.location;
+    NSRange                     separatorRange;
+    
+    while(RKSplitNextSeparator(state->regex, state->stringBuffer, windowEnd, windowEnd, componentLocation, &scanLocation, &separatorRange) == RKMatchErrorNoError) {
+      if(separatorRange.location >= chunkEnd) { break; }
+      if((NSMaxRange(separatorRange) == windowEnd) && (windowEnd < state->endLocation)) { break; }
+      if(RK_EXPECTED(RKSplitAppendSeparator(chunk, scanLocation, separatorRange) == NO, 0)) { break; }
+      scanLocation = componentLocation = NSMaxRange(separatorRange);
+    }
+  }
+  
+  return(1);
+}
+
 //
 // matchEnumeratorWithRegex: methods
 //
@@ -416,6 +698,24 @@ static void NSStringRKExtensionsInitializeFunction(void) {
 - (NSString *)stringByMatching:(id)aRegex inRange:(const NSRange)range replace:(const RKUInteger)count error:(NSError **)error withReferenceFormat:(NSString * const)referenceFormatString arguments:(va_list)argList
 { return(RKStringByMatchingAndExpandingX(self, _cmd, self, NULL, NULL, &range, count, aRegex, referenceFormatString, (va_list *)&argList, YES, NULL, error)); }
 
+//
+// stringByMatching:replace:usingFunction: methods
+//
+
+- (NSString *)stringByMatching:(id)aRegex replace:(const RKUInteger)count usingFunction:(RKReplaceFunction)function info:(void *)info
+{ return(RKStringByMatchingAndReplacingWithFunctionX(self, _cmd, NULL,   count, aRegex, function, info, NULL)); }
+
+- (NSString *)stringByMatching:(id)aRegex inRange:(const NSRange)range replace:(const RKUInteger)count usingFunction:(RKReplaceFunction)function info:(void *)info error:(NSError **)error
+{ return(RKStringByMatchingAndReplacingWithFunctionX(self, _cmd, &range, count, aRegex, function, info, error)); }
+
+#ifdef __BLOCKS__
+- (NSString *)stringByMatching:(id)aRegex replace:(const RKUInteger)count usingBlock:(RKReplaceBlock)block
+{ return(RKStringByMatchingAndReplacingWithFunctionX(self, _cmd, NULL,   count, aRegex, (block == NULL) ? NULL : RKReplaceBlockFunction, (void *)block, NULL)); }
+
+- (NSString *)stringByMatching:(id)aRegex inRange:(const NSRange)range replace:(const RKUInteger)count usingBlock:(RKReplaceBlock)block error:(NSError **)error
+{ return(RKStringByMatchingAndReplacingWithFunctionX(self, _cmd, &range, count, aRegex, (block == NULL) ? NULL : RKReplaceBlockFunction, (void *)block, error)); }
+#endif // __BLOCKS__
+
 @end
 
 /* NSMutableString additions */
@@ -477,14 +777,15 @@ static RKUInteger RKMutableStringMatch(id self, const SEL _cmd, id aRegex,
                                        RK_STRONG_REF const RKUInteger * RK_C99(restrict) fromIndex, RK_STRONG_REF const RKUInteger * RK_C99(restrict) toIndex,
                                        RK_STRONG_REF const NSRange * RK_C99(restrict) range, const RKUInteger count,
                                        NSString * const RK_C99(restrict) formatString, RK_STRONG_REF va_list * const RK_C99(restrict) argListPtr) {
-  RKUInteger                  replaceCount   = 0;
-  NSString * RK_C99(restrict) replacedString = RKStringByMatchingAndExpanding(self, _cmd, self, fromIndex, toIndex, range, count, aRegex, formatString, argListPtr, YES, &replaceCount);
-  if(replacedString == self) { return(0); }
-#ifdef USE_CORE_FOUNDATION
-  CFStringReplaceAll((CFMutableStringRef)self, (CFStringRef)replacedString);
-#else  // USE_CORE_FOUNDATION is not defined
-  [self setString:replacedString];
-#endif // USE_CORE_FOUNDATION
+  RKUInteger  replaceCount = 0;
+  NSError    *replaceError = NULL;
+  
+  replaceCount = RKMutableStringMatchX(self, _cmd, aRegex, fromIndex, toIndex, range, count, formatString, argListPtr, &replaceError);
+  if(replaceError != NULL) {
+    if(([[replaceError domain] isEqualToString:RKRegexErrorDomain] == YES) && ([replaceError userInfo] != NULL)) { [RKExceptionFromInitFailureForOlderAPI(self, _cmd, replaceError) raise]; }
+    [[NSException exceptionWithName:NSGenericException reason:[replaceError localizedDescription]  userInfo:NULL] raise];
+  }
+  
   return(replaceCount);
 }
 
@@ -492,17 +793,115 @@ static RKUInteger RKMutableStringMatchX(id self, const SEL _cmd, id aRegex,
                                        RK_STRONG_REF const RKUInteger * RK_C99(restrict) fromIndex, RK_STRONG_REF const RKUInteger * RK_C99(restrict) toIndex,
                                        RK_STRONG_REF const NSRange * RK_C99(restrict) range, const RKUInteger count,
                                        NSString * const RK_C99(restrict) formatString, RK_STRONG_REF va_list * const RK_C99(restrict) argListPtr, NSError **error) {
-  RKUInteger                  replaceCount   = 0;
-  NSString * RK_C99(restrict) replacedString = RKStringByMatchingAndExpandingX(self, _cmd, self, fromIndex, toIndex, range, count, aRegex, formatString, argListPtr, YES, &replaceCount, error);
-  if(replacedString == self) { return(0); }
+  RKRegex * RK_C99(restrict)    regex          = NULL;
+  NSString * RK_C99(restrict)   replacedString = NULL;
+  NSError                      *replaceError   = NULL;
+  RKUInteger                    replaceCount   = 0;
+  RKStringBuffer                searchStringBuffer;
+  NSRange                       searchRange;
+  RKReferenceInstruction        stackReferenceInstructions[RK_DEFAULT_STACK_INSTRUCTIONS];
+  RKReferenceInstructionsBuffer referenceInstructionsBuffer = RKMakeReferenceInstructionsBuffer(0, RK_DEFAULT_STACK_INSTRUCTIONS, &stackReferenceInstructions[0], NULL);
+  
+  if(RKPrepareMatchAndExpandX(self, _cmd, self, fromIndex, toIndex, range, aRegex, formatString, argListPtr, &regex, &searchStringBuffer, &searchRange, &referenceInstructionsBuffer, &replaceError) == NO) { goto errorExit; }
+  
+  // Edit the receiver directly when there are only a few replacements, otherwise build the new string in one pass and replace the receivers contents with it.
+  if(RKMutableStringReplaceInPlaceX(self, _cmd, &searchStringBuffer, searchRange, count, regex, &referenceInstructionsBuffer, &replaceCount, &replaceError) == YES) { return(replaceCount); }
+  if(replaceError != NULL) { goto errorExit; }
+  
+  replacedString = RKStringByApplyingReferenceInstructionsX(self, _cmd, self, &searchStringBuffer, searchRange, count, regex, &referenceInstructionsBuffer, YES, &replaceCount, &replaceError);
+  if(replacedString == NULL) { goto errorExit;  }
+  if(replaceCount   == 0)    { return(0);       }
 #ifdef USE_CORE_FOUNDATION
   CFStringReplaceAll((CFMutableStringRef)self, (CFStringRef)replacedString);
 #else  // USE_CORE_FOUNDATION is not defined
   [self setString:replacedString];
 #endif // USE_CORE_FOUNDATION
   return(replaceCount);
+
+errorExit:
+  if(error != NULL) { *error = replaceError; }
+  return(0);
 }
 
+//
+// Records up to RK_MAX_IN_PLACE_EDITS replacements and then applies them to the receiver with CFStringReplace(), last to first, so that an edit
+// never moves the text of an edit that is still to be made.  For a large string with a handful of replacements this avoids building an
+// entirely new string and then copying it back over the receiver.  An edit that changes the length moves everything after it, which for k
+// edits is O(k * n), so at most RK_MAX_IN_PLACE_RESIZES of them are made in place and more than that are left to the single pass rebuild.
+//
+// Returns NO without modifying the receiver if there are more than RK_MAX_IN_PLACE_EDITS replacements, or more than RK_MAX_IN_PLACE_RESIZES
+// that change the length, in which case error is not set and the caller should fall back to rebuilding the string.  The search string buffer
+// may point directly to the receivers storage, so every match is found and every replacement string is created before the receiver is
+// modified.
+//
+
+// XXX WARNING: This code uses alloca().  If you do not -=COMPLETELY=- understand what alloca() does, you MUST NOT alter this code.
+static BOOL RKMutableStringReplaceInPlaceX(id self, const SEL _cmd, RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) searchStringBuffer, const NSRange searchRange, const RKUInteger count,
+                                           RKRegex * const RK_C99(restrict) regex, RK_STRONG_REF const RKReferenceInstructionsBuffer * const RK_C99(restrict) referenceInstructionsBuffer,
+                                           RK_STRONG_REF RKUInteger * const RK_C99(restrict) replacedCountPtr, NSError **error) {
+  NSError                                 *stringError   = NULL;
+  RKUInteger                               searchIndex   = searchRange.location, editsCount = 0, editIndex = 0, createdCount = 0, captureCount = [regex captureCount], utf8Anchor = 0, utf16Anchor = 0;
+  NSRange RK_STRONG_REF * RK_C99(restrict) matchRanges   = NULL;
+  RKMatchErrorCode                         matched;
+  RKStringEdit                             edits[RK_MAX_IN_PLACE_EDITS];
+  id                                       replacementStrings[RK_MAX_IN_PLACE_EDITS];
+  char                                     stackOutputBytes[RK_DEFAULT_STACK_OUTPUT_SIZE];
+  RKOutputBuffer                           expansionsBuffer = RKMakeOutputBuffer(&stackOutputBytes[0], RK_DEFAULT_STACK_OUTPUT_SIZE, NULL);
+  RKUInteger                               resizesCount     = 0, movingCount = 0;
+  BOOL                                     didReplace       = NO;
+  
+  if((matchRanges = alloca(sizeof(NSRange) * RK_PRESIZE_CAPTURE_COUNT(captureCount))) == NULL) { goto exitNow; }
+  
+  while((searchIndex < (searchRange.location + searchRange.length)) && ((editsCount < count) || (count == RKReplaceAll)) && (stringError == NULL)) {
+    if((matched = [regex getRanges:&matchRanges[0] count:RK_PRESIZE_CAPTURE_COUNT(captureCount) withCharacters:searchStringBuffer->characters length:searchStringBuffer->length inRange:NSMakeRange(searchIndex, (searchRange.location + searchRange.length) - searchIndex) options:RKMatchNoUTF8Check error:&stringError]) < 0) {
+      if(matched != RKMatchErrorNoMatch) { goto exitNow; }
+      break;
+    }
+    
+    if(editsCount == RK_MAX_IN_PLACE_EDITS) { RK_PROBE(PERFORMANCENOTE, NULL, 0, NULL, 0, -1, 0, "The number of replacements exceeded the in place limit, the mutable string will be rebuilt."); goto exitNow; }
+    
+    edits[editsCount].expansionLocation = expansionsBuffer.length;
+    if(RKApplyReferenceInstructions(self, _cmd, regex, matchRanges, searchStringBuffer, referenceInstructionsBuffer, &expansionsBuffer) == NO) { goto exitNow; }
+    edits[editsCount].expansionLength   = expansionsBuffer.length - edits[editsCount].expansionLocation;
+    if((edits[editsCount].expansionLength != matchRanges[0].length) && (++resizesCount > RK_MAX_IN_PLACE_RESIZES)) { RK_PROBE(PERFORMANCENOTE, NULL, 0, NULL, 0, -1, 0, "The number of replacements that change the length exceeded the in place limit, the mutable string will be rebuilt."); goto exitNow; }
+    edits[editsCount].range             = matchRanges[0];
+    RKConvertUTF8ToUTF16RangesForStringBuffer((RKStringBuffer *)searchStringBuffer, &edits[editsCount].range, 1, &utf8Anchor, &utf16Anchor);
+    
+    searchIndex = matchRanges[0].location + matchRanges[0].length;
+    editsCount++;
+  }
+  
+  for(createdCount = 0; createdCount < editsCount; createdCount++) {
+    if((replacementStrings[createdCount] = [[NSString alloc] initWithBytes:(expansionsBuffer.bytes + edits[createdCount].expansionLocation) length:edits[createdCount].expansionLength encoding:NSUTF8StringEncoding]) == NULL) {
+      stringError = [NSError rkErrorWithDomain:NSCocoaErrorDomain code:0 localizeDescription:@"Unable to create the replacement string."];
+      break;
+    }
+    // Only an edit with a different UTF16 length moves any characters.  The UTF8 length checked above usually, but not always, agrees.
+    if(([replacementStrings[createdCount] length] != edits[createdCount].range.length) && (++movingCount > RK_MAX_IN_PLACE_RESIZES)) { createdCount++; break; }
+  }
+  
+  if((createdCount == editsCount) && (movingCount <= RK_MAX_IN_PLACE_RESIZES)) {
+    // Applied last to first, so an edit that changes the length never moves the text of an edit that is still to be made.
+    for(editIndex = editsCount; editIndex > 0; editIndex--) {
+#ifdef USE_CORE_FOUNDATION
+      CFStringReplace((CFMutableStringRef)self, CFRangeMake((CFIndex)edits[editIndex - 1].range.location, (CFIndex)edits[editIndex - 1].range.length), (CFStringRef)replacementStrings[editIndex - 1]);
+#else  // USE_CORE_FOUNDATION is not defined
+      [self replaceCharactersInRange:edits[editIndex - 1].range withString:replacementStrings[editIndex - 1]];
+#endif // USE_CORE_FOUNDATION
+    }
+    
+    if(replacedCountPtr != NULL) { *replacedCountPtr = editsCount; }
+    didReplace = YES;
+  }
+  
+  for(editIndex = 0; editIndex < createdCount; editIndex++) { RKRelease(replacementStrings[editIndex]); }
+  
+exitNow:
+  RKReleaseOutputBuffer(&expansionsBuffer);
+  if((didReplace == NO) && (stringError == NULL) && (expansionsBuffer.isValid == NO)) { stringError = [NSError rkErrorWithDomain:NSPOSIXErrorDomain code:0 localizeDescription:@"Unable to allocate memory for final copied string."]; }
+  if(error != NULL) { *error = stringError; }
+  return(didReplace);
+}
 
 
 /* Functions for performing various regex string tasks, most private. */
@@ -598,6 +997,8 @@ BOOL RKExtractCapturesFromMatchesWithKeyArgumentsX(id self, const SEL _cmd, RK_S
   void RK_STRONG_REF ***keyConversionPointers = NULL;
   NSString            **keyStrings            = NULL;
   NSError               *extractError         = NULL;
+  RKCaptureExtractor    *captureExtractor     = NULL;
+  RK_STRONG_REF const RKParsedCaptureReference *parsedCaptureReferences = NULL;
   BOOL                   returnBool           = NO;
   va_list                varArgsList;
 
@@ -622,18 +1023,51 @@ finishedCountingArgs:
   }
   va_end(varArgsList);
   
-  returnBool = RKExtractCapturesFromMatchesWithKeysAndPointers(self, _cmd, stringBuffer, regex, matchRanges, keyStrings, keyConversionPointers, count, captureExtractOptions, &extractError);
+  // The keys are almost always the same literal strings every time, so the parsed references are cached along with the regex.
+  if((captureExtractor = RKCaptureExtractorForKeys(regex, keyStrings, count, captureExtractOptions)) != NULL) { parsedCaptureReferences = RKCaptureExtractorParsedReferences(captureExtractor); }
+  
+  returnBool = RKExtractCapturesFromMatchesWithKeysAndPointers(self, _cmd, stringBuffer, regex, matchRanges, keyStrings, parsedCaptureReferences, keyConversionPointers, count, captureExtractOptions, &extractError);
+  
+  if(captureExtractor != NULL) { RKRelease(captureExtractor); captureExtractor = NULL; }
   
 errorExit:
   if(error != NULL) { *error = extractError; }
   return(returnBool);
 }
 
-// Takes a set of match results and loops over all keys, parses them, and fills in the result.  parseReference does the heavy work and conversion
-static BOOL RKExtractCapturesFromMatchesWithKeysAndPointers(id self RK_ATTRIBUTES(unused), const SEL _cmd RK_ATTRIBUTES(unused), RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) stringBuffer, 
-                                                            RKRegex * const RK_C99(restrict) regex, RK_STRONG_REF const NSRange * const RK_C99(restrict) matchRanges,
-                                                            NSString ** const RK_C99(restrict) keyStrings, RK_STRONG_REF void *** const RK_C99(restrict) keyConversionPointers,
-                                                            const RKUInteger count, const RKCaptureExtractOptions captureExtractOptions, NSError **error) {
+static RKParseReferenceFlags RKParseReferenceFlagsForCaptureExtractOptions(const RKCaptureExtractOptions captureExtractOptions) {
+  return(((((captureExtractOptions & RKCaptureExtractAllowConversions)  != 0) ? RKParseReferenceConversionAllowed : 0) |
+          (((captureExtractOptions & RKCaptureExtractStrictReference)   != 0) ? RKParseReferenceStrictReference   : 0) |
+          (((captureExtractOptions & RKCaptureExtractIgnoreConversions) != 0) ? RKParseReferenceIgnoreConversion  : 0) |
+          RKParseReferenceCheckCaptureName));
+}
+
+// Parses a single capture reference key without performing a conversion.  Used by RKCaptureExtractor to parse its keys once.
+BOOL RKParseCaptureReferenceX(id self RK_ATTRIBUTES(unused), const SEL _cmd RK_ATTRIBUTES(unused), RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) referenceBuffer, RKRegex * const RK_C99(restrict) regex,
+                              const RKCaptureExtractOptions captureExtractOptions, RK_STRONG_REF RKParsedCaptureReference * const RK_C99(restrict) parsedCaptureReference, NSError **error) {
+  NSString *parseErrorString = NULL;
+  NSError  *parseError       = NULL;
+  BOOL      didParse         = NO;
+  
+  NSCParameterAssert(RK_EXPECTED(referenceBuffer != NULL, 1) && RK_EXPECTED(regex != NULL, 1) && RK_EXPECTED(parsedCaptureReference != NULL, 1));
+  
+  parsedCaptureReference->captureIndex = NSNotFound;
+  didParse = RKParseReference(referenceBuffer, NSMakeRange(0, referenceBuffer->length), NULL, NULL, regex, NULL, NULL, RKParseReferenceFlagsForCaptureExtractOptions(captureExtractOptions),
+                              NULL, NULL, parsedCaptureReference, &parseErrorString, NULL, NULL, &parseError);
+  
+  // A capture name that is not defined is only an error when it is checked, so make sure we really ended up with a capture index.
+  if(RK_EXPECTED(didParse == YES, 1) && RK_EXPECTED(parsedCaptureReference->captureIndex == NSNotFound, 0)) { didParse = NO; }
+  if(error != NULL) { *error = parseError; }
+  return(didParse);
+}
+
+// Takes a set of match results and loops over all keys, parses them, and fills in the result.  parseReference does the heavy work and conversion.
+// If parsedCaptureReferences is not NULL, it holds the already parsed keys, and a key is only parsed again if its conversion fails so that the
+// error is reported exactly as it would have been without the parsed keys.
+BOOL RKExtractCapturesFromMatchesWithKeysAndPointers(id self RK_ATTRIBUTES(unused), const SEL _cmd RK_ATTRIBUTES(unused), RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) stringBuffer, 
+                                                     RKRegex * const RK_C99(restrict) regex, RK_STRONG_REF const NSRange * const RK_C99(restrict) matchRanges,
+                                                     NSString ** const RK_C99(restrict) keyStrings, RK_STRONG_REF const RKParsedCaptureReference * const RK_C99(restrict) parsedCaptureReferences,
+                                                     RK_STRONG_REF void *** const RK_C99(restrict) keyConversionPointers, const RKUInteger count, const RKCaptureExtractOptions captureExtractOptions, NSError **error) {
   RKUInteger                      autoreleaseObjectsIndex = 0, x = 0;
   NSException * RK_C99(restrict)  caughtException         = NULL;
   NSError                        *extractError            = NULL;
@@ -642,14 +1076,13 @@ static BOOL RKExtractCapturesFromMatchesWithKeysAndPointers(id self RK_ATTRIBUTE
   BOOL                            returnResult            = NO;
   RKStringBuffer                  keyBuffer;
 
-  const int parseReferenceOptions = ((((captureExtractOptions & RKCaptureExtractAllowConversions)  != 0) ? RKParseReferenceConversionAllowed : 0) |
-                                     (((captureExtractOptions & RKCaptureExtractStrictReference)   != 0) ? RKParseReferenceStrictReference   : 0) |
-                                     (((captureExtractOptions & RKCaptureExtractIgnoreConversions) != 0) ? RKParseReferenceIgnoreConversion  : 0) |
-                                     RKParseReferencePerformConversion | RKParseReferenceCheckCaptureName);
+  const RKParseReferenceFlags parseReferenceOptions = (RKParseReferenceFlagsForCaptureExtractOptions(captureExtractOptions) | RKParseReferencePerformConversion);
+  RKParseErrorMessage         parseErrorMessage     = RKParseErrorNotValid;
   
   NSCParameterAssert(RK_EXPECTED(self != NULL, 1) && RK_EXPECTED(_cmd != NULL, 1) && RK_EXPECTED(keyConversionPointers != NULL, 1) && RK_EXPECTED(keyStrings != NULL, 1) && RK_EXPECTED(stringBuffer != NULL, 1) && RK_EXPECTED(matchRanges != NULL, 1) && RK_EXPECTED(regex != NULL, 1));
   
-  if(RK_EXPECTED((autoreleaseObjects = alloca(count * sizeof(void *))) == NULL, 0)) { goto exitNow; }
+  // A key whose parsed conversion fails is parsed and converted again to report the error, which may create a second object for it.
+  if(RK_EXPECTED((autoreleaseObjects = alloca((count * 2) * sizeof(void *))) == NULL, 0)) { goto exitNow; }
 
 #ifdef USE_MACRO_EXCEPTIONS
 NS_DURING
@@ -657,9 +1090,13 @@ NS_DURING
 @try {
 #endif // USE_MACRO_EXCEPTIONS
   for(x = 0; x < count && RK_EXPECTED(extractError == NULL, 1); x++) {
+    if(parsedCaptureReferences != NULL) {
+      if(matchRanges[parsedCaptureReferences[x].captureIndex].location == NSNotFound) { continue; }
+      if(RK_EXPECTED(RKConvertParsedCaptureReference(&parsedCaptureReferences[x], stringBuffer, matchRanges, regex, keyConversionPointers[x], (void ***)autoreleaseObjects, &autoreleaseObjectsIndex, &parseErrorMessage) == YES, 1)) { continue; }
+    }
     keyBuffer = RKStringBufferWithString(keyStrings[x]);
     if(RK_EXPECTED(RKParseReference((const RKStringBuffer *)&keyBuffer, NSMakeRange(0, keyBuffer.length), stringBuffer,
-                                    matchRanges, regex, NULL, keyConversionPointers[x], parseReferenceOptions, NULL, NULL, &parseErrorString,
+                                    matchRanges, regex, NULL, keyConversionPointers[x], parseReferenceOptions, NULL, NULL, NULL, &parseErrorString,
                                     (void ***)autoreleaseObjects, &autoreleaseObjectsIndex, &extractError) == NO, 0)) {
       // We hold off on raising the exception until we make sure we've autoreleased any objects we created, if necessary.
       //extractError = [NSError errorWithDomain:RKRegexErrorDomain code:0 userInfo:[NSDictionary dictionaryWithObject:parseErrorString forKey:NSLocalizedDescriptionKey]];
@@ -706,9 +1143,9 @@ exitNow:
  @param      replaceCount Pointer to an int if the number of replacements performed is needed, NULL otherwise.
  @result     Returns a new @link NSString NSString @/link with all the search and replaces applied.
  @discussion     <p>This function forms the bulk of the search and replace machinery.<p>
- <p>The high level overview of what happens is this function calls compileReferenceString which parses replaceWithString and assembles a list of instructions / operations to perform for each match.  For each match, a instructions to build a replacement string are built up instruction by instruction.  The first instruction copies the text inbetween the last match to the start of the current match. Replacement instructions are fairly simple, from copying verbatim a range of characters to appending the characters of a match. The instructions to build the replacement string are 'fully resolved' and consist only of verbatim copy operations. This continues until there are no more matches left.  The result is a list of instructions to process to create the finished, fully substituted string.</p>
+ <p>The high level overview of what happens is this function calls compileReferenceString which parses replaceWithString and assembles a list of instructions / operations to perform for each match.  For each match, the text inbetween the end of the last match and the start of the current match is written to the output buffer, followed by the result of evaluating the instructions against the current match. Replacement instructions are fairly simple, from copying verbatim a range of characters to appending the characters of a match. This continues until there are no more matches left, at which point the remaining text is written and the output buffer becomes the finished, fully substituted string.</p>
  
- <p>The space to record the instructions to build the finished string are initially allocated off the stack.  If the number of instructions to complete the finished string is greater than the space allocated on the stack, the instructions are copied in to a NSMutableData buffer and that is grown as required.  The number of instructions allocated off the stack is determined by INITIAL_EDIT_INS.  This means that for the majority of cases the only time a call to malloc is required is at the very end, when its ready to process all of the instructions to create the replaced string.  Additionally, because only the ranges to be copied are recorded, no temporary buffers are create to keep intermediate results.</p>
+ <p>The output buffer is initially allocated off the stack, and its size is determined by RK_DEFAULT_STACK_OUTPUT_SIZE.  If the finished string is larger than the space allocated on the stack, the contents are moved to the heap and the buffer is doubled in size each time it fills up.  When the buffer was moved to the heap, its allocation becomes the backing store of the finished string, otherwise a single malloc of the exact size is made at the very end.  Because the replaced string is written in a single pass, no temporary buffers are created to keep intermediate results.</p>
 */
 static NSString *RKStringByMatchingAndExpanding(id self, const SEL _cmd, NSString * const RK_C99(restrict) searchString, RK_STRONG_REF const RKUInteger * const RK_C99(restrict) fromIndex,
                                                 RK_STRONG_REF const RKUInteger * const RK_C99(restrict) toIndex, RK_STRONG_REF const NSRange * const RK_C99(restrict) searchStringRange,
@@ -734,19 +1171,34 @@ static NSString *RKStringByMatchingAndExpandingX(id self, const SEL _cmd, NSStri
                                                 RK_STRONG_REF va_list * const RK_C99(restrict) argListPtr, const BOOL expandOrReplace,
                                                 RK_STRONG_REF RKUInteger * const RK_C99(restrict) matchedCountPtr, NSError **error) {
   RKRegex * RK_C99(restrict)               regex       = NULL;
+  RKStringBuffer                           searchStringBuffer;
+  NSRange                                  searchRange;
+  RKReferenceInstruction                   stackReferenceInstructions[RK_DEFAULT_STACK_INSTRUCTIONS];
+  RKReferenceInstructionsBuffer            referenceInstructionsBuffer = RKMakeReferenceInstructionsBuffer(0, RK_DEFAULT_STACK_INSTRUCTIONS, &stackReferenceInstructions[0], NULL);
+  
+  if(RKPrepareMatchAndExpandX(self, _cmd, searchString, fromIndex, toIndex, searchStringRange, aRegex, referenceString, argListPtr, &regex, &searchStringBuffer, &searchRange, &referenceInstructionsBuffer, error) == NO) { return(NULL); }
+  
+  return(RKStringByApplyingReferenceInstructionsX(self, _cmd, searchString, &searchStringBuffer, searchRange, count, regex, &referenceInstructionsBuffer, expandOrReplace, matchedCountPtr, error));
+}
+
+//
+// Resolves the regex, the search range in bytes, and compiles the reference string in to referenceInstructionsBuffer, which the caller supplies.
+//
+
+static BOOL RKPrepareMatchAndExpandX(id self, const SEL _cmd, NSString * const RK_C99(restrict) searchString, RK_STRONG_REF const RKUInteger * const RK_C99(restrict) fromIndex,
+                                     RK_STRONG_REF const RKUInteger * const RK_C99(restrict) toIndex, RK_STRONG_REF const NSRange * const RK_C99(restrict) searchStringRange,
+                                     id aRegex, NSString * const RK_C99(restrict) referenceString, RK_STRONG_REF va_list * const RK_C99(restrict) argListPtr,
+                                     RKRegex ** const RK_C99(restrict) regexPtr, RK_STRONG_REF RKStringBuffer * const RK_C99(restrict) searchStringBufferPtr, RK_STRONG_REF NSRange * const RK_C99(restrict) searchRangePtr,
+                                     RK_STRONG_REF RKReferenceInstructionsBuffer * const RK_C99(restrict) referenceInstructionsBuffer, NSError **error) {
+  RKRegex * RK_C99(restrict)               regex       = NULL;
   NSError                                 *stringError = NULL;
   RKStringBuffer                           searchStringBuffer, referenceStringBuffer;
-  RKUInteger                               searchIndex = 0,    matchedCount = 0, captureCount = 0, fromIndexByte = 0;
-  NSRange RK_STRONG_REF * RK_C99(restrict) matchRanges = NULL; NSRange searchRange;
-  RKMatchErrorCode                         matched;
-  RKReferenceInstruction                   stackReferenceInstructions[RK_DEFAULT_STACK_INSTRUCTIONS];
-  RKCopyInstruction                        stackCopyInstructions[RK_DEFAULT_STACK_INSTRUCTIONS];
+  RKUInteger                               fromIndexByte = 0;
+  NSRange                                  searchRange;
   
   searchRange = NSMakeRange(NSNotFound, 0);
   if((regex = RKRegexFromStringOrRegexWithError(self, _cmd, aRegex, RKRegexPCRELibrary, (RKCompileUTF8 | RKCompileNoUTF8Check), &stringError, YES)) == NULL) { NSCParameterAssert(stringError != NULL); goto errorExit; }
   
-  captureCount          = [regex captureCount];
-  if((matchRanges = alloca(sizeof(NSRange) * RK_PRESIZE_CAPTURE_COUNT(captureCount))) == NULL) { goto errorExit; }
   searchStringBuffer    = RKStringBufferWithString(searchString);
   referenceStringBuffer = RKStringBufferWithString((argListPtr == NULL) ? referenceString : (NSString *)RKAutorelease([[NSString alloc] initWithFormat:referenceString arguments:*argListPtr]));
   
@@ -760,86 +1212,264 @@ static NSString *RKStringByMatchingAndExpandingX(id self, const SEL _cmd, NSStri
   else if(fromIndex         != NULL)                                          { searchRange = NSMakeRange(fromIndexByte, (searchStringBuffer.length - fromIndexByte)); }
   else if(toIndex           != NULL)                                          { searchRange = RKutf16to8(self, NSMakeRange(0, *toIndex));                              }
   
-  RKReferenceInstructionsBuffer referenceInstructionsBuffer = RKMakeReferenceInstructionsBuffer(0, RK_DEFAULT_STACK_INSTRUCTIONS,    &stackReferenceInstructions[0], NULL);
-  RKCopyInstructionsBuffer      copyInstructionsBuffer      = RKMakeCopyInstructionsBuffer(     0, RK_DEFAULT_STACK_INSTRUCTIONS, 0, &stackCopyInstructions[0],      NULL);
-  
-  if(RKCompileReferenceString(self, _cmd, &referenceStringBuffer, regex, &referenceInstructionsBuffer) == NO) { goto errorExit; }
-  
-  searchIndex = searchRange.location;
-  
-  if((expandOrReplace == YES) && (searchIndex != 0)) { if(RKAppendCopyInstruction(&copyInstructionsBuffer, searchStringBuffer.characters, NSMakeRange(0, searchIndex)) == NO) { goto errorExit; } }
+  if(RKCompileReferenceString(self, _cmd, &referenceStringBuffer, regex, referenceInstructionsBuffer) == NO) { goto errorExit; }
   
+  *regexPtr              = regex;
+  *searchStringBufferPtr = searchStringBuffer;
+  *searchRangePtr        = searchRange;
+  return(YES);
+
+errorExit:
+  if(error != NULL) { *error = stringError; }
+  return(NO);
+}
+
+//
+// The match loop of RKStringByMatchingAndExpandingX.  Split out so that a RKReplacementTemplate can supply reference instructions
+// that were compiled ahead of time.
+//
+
+// XXX WARNING: This code uses alloca().  If you do not -=COMPLETELY=- understand what alloca() does, you MUST NOT alter this code.
+NSString *RKStringByApplyingReferenceInstructionsX(id self, const SEL _cmd, NSString * const RK_C99(restrict) searchString, RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) searchStringBuffer,
+                                                   const NSRange searchRange, const RKUInteger count, RKRegex * const RK_C99(restrict) regex,
+                                                   RK_STRONG_REF const RKReferenceInstructionsBuffer * const RK_C99(restrict) referenceInstructionsBuffer, const BOOL expandOrReplace,
+                                                   RK_STRONG_REF RKUInteger * const RK_C99(restrict) matchedCountPtr, NSError **error) {
+  NSError        *stringError  = NULL;
+  RKUInteger      matchedCount = 0;
+  char            stackOutputBytes[RK_DEFAULT_STACK_OUTPUT_SIZE];
+  RKOutputBuffer  outputBuffer = RKMakeOutputBuffer(&stackOutputBytes[0], RK_DEFAULT_STACK_OUTPUT_SIZE, NULL);
+
+  if(RKMatchAndApplyReferenceInstructionsX(self, _cmd, searchStringBuffer, searchRange, count, regex, referenceInstructionsBuffer, expandOrReplace, &outputBuffer, &matchedCount, &stringError) == NO) { goto errorExit; }
+
+  if(matchedCountPtr != NULL) { *matchedCountPtr = matchedCount; }
+  if((expandOrReplace == YES) && (matchedCount == 0)) { RKReleaseOutputBuffer(&outputBuffer); return(RKAutorelease([searchString copy])); } // There were no changes.  -copy of an immutable string is just a retain, a mutable search string must not be returned as the result.
+    
+  return(RKStringFromOutputBufferX(self, _cmd, &outputBuffer, RKUTF8StringEncoding, error));
+
+errorExit:
+  RKReleaseOutputBuffer(&outputBuffer);
+  if(error != NULL) { *error = stringError; }
+  return(NULL);
+}
+
+//
+// Performs the matches and writes the result directly in to outputBuffer in a single pass.  The text between matches is copied lazily,
+// only when the next match (or the end of the search) is reached, so nothing is appended for a replace that does not match unless
+// outputBuffer has a caller supplied mutableData destination, in which case the unmodified text is always appended.
+//
+
+// XXX WARNING: This code uses alloca().  If you do not -=COMPLETELY=- understand what alloca() does, you MUST NOT alter this code.
+BOOL RKMatchAndApplyReferenceInstructionsX(id self, const SEL _cmd, RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) searchStringBuffer, const NSRange searchRange,
+                                           const RKUInteger count, RKRegex * const RK_C99(restrict) regex,
+                                           RK_STRONG_REF const RKReferenceInstructionsBuffer * const RK_C99(restrict) referenceInstructionsBuffer, const BOOL expandOrReplace,
+                                           RK_STRONG_REF RKOutputBuffer * const RK_C99(restrict) outputBuffer, RK_STRONG_REF RKUInteger * const RK_C99(restrict) matchedCountPtr, NSError **error) {
+  NSCParameterAssert(outputBuffer != NULL); NSCParameterAssert(outputBuffer->isValid == YES);
+  NSError                                 *stringError  = NULL;
+  RKUInteger                               searchIndex  = searchRange.location, copiedIndex = 0, matchedCount = 0, captureCount = [regex captureCount];
+  NSRange RK_STRONG_REF * RK_C99(restrict) matchRanges  = NULL;
+  RKMatchErrorCode                         matched;
+
+  if((matchRanges = alloca(sizeof(NSRange) * RK_PRESIZE_CAPTURE_COUNT(captureCount))) == NULL) { goto errorExit; }
+
   while((searchIndex < (searchRange.location + searchRange.length)) && ((matchedCount < count) || (count == RKReplaceAll)) && (stringError == NULL)) {
-    if((matched = [regex getRanges:&matchRanges[0] count:RK_PRESIZE_CAPTURE_COUNT(captureCount) withCharacters:searchStringBuffer.characters length:searchStringBuffer.length inRange:NSMakeRange(searchIndex, (searchRange.location + searchRange.length) - searchIndex) options:RKMatchNoUTF8Check error:&stringError]) < 0) {
+    if((matched = [regex getRanges:&matchRanges[0] count:RK_PRESIZE_CAPTURE_COUNT(captureCount) withCharacters:searchStringBuffer->characters length:searchStringBuffer->length inRange:NSMakeRange(searchIndex, (searchRange.location + searchRange.length) - searchIndex) options:RKMatchNoUTF8Check error:&stringError]) < 0) {
       if(matched != RKMatchErrorNoMatch) { goto errorExit; }
       break;
     }
     
-    if(expandOrReplace == YES) { if(RKAppendCopyInstruction(&copyInstructionsBuffer, searchStringBuffer.characters, NSMakeRange(searchIndex, (matchRanges[0].location - searchIndex))) == NO) { goto errorExit; } }
-    searchIndex = matchRanges[0].location + matchRanges[0].length;
-    if(RKApplyReferenceInstructions(self, _cmd, regex, matchRanges, &searchStringBuffer, &referenceInstructionsBuffer, &copyInstructionsBuffer) == NO) { goto errorExit; }
+    if(expandOrReplace == YES) { if(RKAppendToOutputBuffer(outputBuffer, searchStringBuffer->characters, NSMakeRange(copiedIndex, (matchRanges[0].location - copiedIndex))) == NO) { goto errorExit; } }
+    searchIndex = copiedIndex = matchRanges[0].location + matchRanges[0].length;
+    if(RKApplyReferenceInstructions(self, _cmd, regex, matchRanges, searchStringBuffer, referenceInstructionsBuffer, outputBuffer) == NO) { goto errorExit; }
     matchedCount++;
   }
 
   if(matchedCountPtr != NULL) { *matchedCountPtr = matchedCount; }
   
-  if(expandOrReplace == YES) {
-    NSRange copySearchStringRange = NSMakeRange(searchIndex, (searchStringBuffer.length - searchIndex));
-    if((copyInstructionsBuffer.length == 0) && (NSEqualRanges(NSMakeRange(0, copyInstructionsBuffer.length), copySearchStringRange) == YES)) { return(searchString); } // There were no changes, so the replaced string == search string.
-    if(RKAppendCopyInstruction(&copyInstructionsBuffer, searchStringBuffer.characters, copySearchStringRange) == NO) { goto errorExit; }
+  if((expandOrReplace == YES) && ((matchedCount > 0) || (outputBuffer->mutableData != NULL))) {
+    if(RKAppendToOutputBuffer(outputBuffer, searchStringBuffer->characters, NSMakeRange(copiedIndex, (searchStringBuffer->length - copiedIndex))) == NO) { goto errorExit; }
   }
-    
-  return(RKStringFromCopyInstructions(self, _cmd, &copyInstructionsBuffer, RKUTF8StringEncoding));
+  
+  return(YES);
+
+errorExit:
+  if((stringError == NULL) && (outputBuffer->isValid == NO)) { stringError = [NSError rkErrorWithDomain:NSPOSIXErrorDomain code:0 localizeDescription:@"Unable to allocate memory for final copied string."]; }
+  if(error != NULL) { *error = stringError; }
+  return(NO);
+}
+
+//
+// The same single pass match loop as RKMatchAndApplyReferenceInstructionsX, except that the replacement text for each match is
+// appended by a caller supplied function.  Nothing is done for a match beyond calling the function: the capture ranges are handed
+// over as UTF8 byte ranges and only converted, or turned in to objects, when the function asks for them.
+//
 
+// XXX WARNING: This code uses alloca().  If you do not -=COMPLETELY=- understand what alloca() does, you MUST NOT alter this code.
+static NSString *RKStringByMatchingAndReplacingWithFunctionX(id self, const SEL _cmd, RK_STRONG_REF const NSRange * const RK_C99(restrict) searchStringRange, const RKUInteger count, id aRegex, RKReplaceFunction function, void *info, NSError **error) {
+  RKRegex * RK_C99(restrict)               regex        = NULL;
+  NSError                                 *stringError  = NULL;
+  RKStringBuffer                           searchStringBuffer;
+  RKUInteger                               searchIndex  = 0, copiedIndex = 0, matchedCount = 0, captureCount = 0;
+  NSRange RK_STRONG_REF * RK_C99(restrict) matchRanges  = NULL;
+  NSRange                                  searchRange;
+  char                                     stackOutputBytes[RK_DEFAULT_STACK_OUTPUT_SIZE];
+  RKOutputBuffer                           outputBuffer = RKMakeOutputBuffer(&stackOutputBytes[0], RK_DEFAULT_STACK_OUTPUT_SIZE, NULL);
+  RKReplaceContext                         replaceContext;
+  RKMatchErrorCode                         matched;
+  
+  if(RK_EXPECTED(function == NULL, 0)) { [[NSException rkException:NSInvalidArgumentException for:self selector:_cmd localizeReason:@"The replacement function is NULL."] raise]; }
+  if((regex = RKRegexFromStringOrRegexWithError(self, _cmd, aRegex, RKRegexPCRELibrary, (RKCompileUTF8 | RKCompileNoUTF8Check), &stringError, YES)) == NULL) { NSCParameterAssert(stringError != NULL); goto errorExit; }
+  
+  searchStringBuffer = RKStringBufferWithString(self);
+  if(RK_EXPECTED(searchStringBuffer.characters == NULL, 0)) { stringError = [NSError rkErrorWithDomain:NSCocoaErrorDomain code:0 localizeDescription:@"Unable to convert the string to UTF8."]; goto errorExit; }
+  
+  searchRange  = (searchStringRange == NULL) ? NSMakeRange(0, searchStringBuffer.length) : RKutf16to8(self, *searchStringRange);
+  searchIndex  = searchRange.location;
+  captureCount = [regex captureCount];
+  
+  if((matchRanges = alloca(sizeof(NSRange) * RK_PRESIZE_CAPTURE_COUNT(captureCount))) == NULL) { goto errorExit; }
+  replaceContext = (RKReplaceContext){regex, &searchStringBuffer, matchRanges, captureCount, 0, 0, &outputBuffer, NULL};
+  
+  while((searchIndex < (searchRange.location + searchRange.length)) && ((matchedCount < count) || (count == RKReplaceAll))) {
+    if((matched = [regex getRanges:&matchRanges[0] count:RK_PRESIZE_CAPTURE_COUNT(captureCount) withCharacters:searchStringBuffer.characters length:searchStringBuffer.length inRange:NSMakeRange(searchIndex, (searchRange.location + searchRange.length) - searchIndex) options:RKMatchNoUTF8Check error:&stringError]) < 0) {
+      if(matched != RKMatchErrorNoMatch) { goto errorExit; }
+      break;
+    }
+    
+    if(RKAppendToOutputBuffer(&outputBuffer, searchStringBuffer.characters, NSMakeRange(copiedIndex, (matchRanges[0].location - copiedIndex))) == NO) { goto errorExit; }
+    searchIndex = copiedIndex = matchRanges[0].location + matchRanges[0].length;
+    matchedCount++;
+    
+    BOOL continueReplacing = function(&replaceContext, info);
+    if(RK_EXPECTED(outputBuffer.isValid == NO, 0)) { stringError = replaceContext.error; goto errorExit; }
+    if(continueReplacing == NO) { break; }
+    
+    // An empty match would otherwise be found again at the same location.
+    if(matchRanges[0].length == 0) { do { searchIndex++; } while((searchIndex < searchStringBuffer.length) && ((((const unsigned char *)searchStringBuffer.characters)[searchIndex] & 0xC0) == 0x80)); }
+  }
+  
+  if(matchedCount == 0) { RKReleaseOutputBuffer(&outputBuffer); return(RKAutorelease([self copy])); } // There were no changes, return an immutable copy in case the receiver is mutable.
+  if(RKAppendToOutputBuffer(&outputBuffer, searchStringBuffer.characters, NSMakeRange(copiedIndex, (searchStringBuffer.length - copiedIndex))) == NO) { goto errorExit; }
+  
+  return(RKStringFromOutputBufferX(self, _cmd, &outputBuffer, RKUTF8StringEncoding, error));
+  
 errorExit:
+  if((stringError == NULL) && (outputBuffer.isValid == NO)) { stringError = [NSError rkErrorWithDomain:NSPOSIXErrorDomain code:0 localizeDescription:@"Unable to allocate memory for final copied string."]; }
+  RKReleaseOutputBuffer(&outputBuffer);
   if(error != NULL) { *error = stringError; }
   return(NULL);
 }
 
+#ifdef __BLOCKS__
+static BOOL RKReplaceBlockFunction(RKReplaceContext *replaceContext, void *info) { return(((RKReplaceBlock)info)(replaceContext)); }
+#endif // __BLOCKS__
+
+//
+// RKReplaceContext functions, called by a RKReplaceFunction for the current match.
+//
+
+RKUInteger RKReplaceContextCaptureCount(RKReplaceContext *replaceContext) {
+  if(RK_EXPECTED(replaceContext == NULL, 0)) { [[NSException rkException:NSInvalidArgumentException localizeReason:@"The replaceContext parameter is NULL."] raise]; }
+  return(replaceContext->captureCount);
+}
+
+NSRange RKReplaceContextRangeOfCapture(RKReplaceContext *replaceContext, const RKUInteger capture) {
+  if(RK_EXPECTED(replaceContext == NULL, 0)) { [[NSException rkException:NSInvalidArgumentException localizeReason:@"The replaceContext parameter is NULL."] raise]; }
+  if(RK_EXPECTED(capture >= replaceContext->captureCount, 0)) { [[NSException rkException:NSRangeException localizeReason:@"The capture %lu is greater than the number of captures, %lu.", (unsigned long)capture, (unsigned long)replaceContext->captureCount] raise]; }
+  
+  NSRange captureRange = replaceContext->matchRanges[capture];
+  if(captureRange.location == NSNotFound) { return(NSMakeRange(NSNotFound, 0)); }
+  RKConvertUTF8ToUTF16RangesForStringBuffer(replaceContext->stringBuffer, &captureRange, 1, &replaceContext->utf8Anchor, &replaceContext->utf16Anchor);
+  return(captureRange);
+}
+
+RKSubstring *RKReplaceContextSubstringOfCapture(RKReplaceContext *replaceContext, const RKUInteger capture) {
+  if(RK_EXPECTED(replaceContext == NULL, 0)) { [[NSException rkException:NSInvalidArgumentException localizeReason:@"The replaceContext parameter is NULL."] raise]; }
+  if(RK_EXPECTED(capture >= replaceContext->captureCount, 0)) { [[NSException rkException:NSRangeException localizeReason:@"The capture %lu is greater than the number of captures, %lu.", (unsigned long)capture, (unsigned long)replaceContext->captureCount] raise]; }
+  
+  if(replaceContext->matchRanges[capture].location == NSNotFound) { return(NULL); }
+  return(RKAutorelease(RKSubstringCreateWithStringBuffer(replaceContext->stringBuffer, replaceContext->matchRanges[capture])));
+}
+
+BOOL RKReplaceContextAppendString(RKReplaceContext *replaceContext, NSString *string) {
+  if(RK_EXPECTED(replaceContext == NULL, 0)) { [[NSException rkException:NSInvalidArgumentException localizeReason:@"The replaceContext parameter is NULL."] raise]; }
+  if(replaceContext->outputBuffer->isValid == NO) { return(NO); }
+  if(string == NULL) { return(YES); }
+  
+  RKStringBuffer stringBuffer = RKStringBufferWithString(string);
+  if(RK_EXPECTED(stringBuffer.characters == NULL, 0)) {
+    // The match would silently lose its replacement, so fail the whole replace instead.
+    replaceContext->error                 = [NSError rkErrorWithDomain:NSCocoaErrorDomain code:0 localizeDescription:@"Unable to convert the replacement string to UTF8."];
+    replaceContext->outputBuffer->isValid = NO;
+    return(NO);
+  }
+  return(RKAppendToOutputBuffer(replaceContext->outputBuffer, stringBuffer.characters, NSMakeRange(0, stringBuffer.length)));
+}
+
+BOOL RKReplaceContextAppendCapture(RKReplaceContext *replaceContext, const RKUInteger capture) {
+  if(RK_EXPECTED(replaceContext == NULL, 0)) { [[NSException rkException:NSInvalidArgumentException localizeReason:@"The replaceContext parameter is NULL."] raise]; }
+  if(RK_EXPECTED(capture >= replaceContext->captureCount, 0)) { [[NSException rkException:NSRangeException localizeReason:@"The capture %lu is greater than the number of captures, %lu.", (unsigned long)capture, (unsigned long)replaceContext->captureCount] raise]; }
+  
+  if(replaceContext->outputBuffer->isValid == NO) { return(NO); }
+  if(replaceContext->matchRanges[capture].location == NSNotFound) { return(YES); }
+  return(RKAppendToOutputBuffer(replaceContext->outputBuffer, replaceContext->stringBuffer->characters, replaceContext->matchRanges[capture]));
+}
+
+BOOL RKReplaceContextAppendUTF8Characters(RKReplaceContext *replaceContext, const char *characters, const RKUInteger length) {
+  if(RK_EXPECTED(replaceContext == NULL, 0)) { [[NSException rkException:NSInvalidArgumentException localizeReason:@"The replaceContext parameter is NULL."] raise]; }
+  if(RK_EXPECTED((characters == NULL) && (length > 0), 0)) { [[NSException rkException:NSInvalidArgumentException localizeReason:@"The characters parameter is NULL."] raise]; }
+  if(replaceContext->outputBuffer->isValid == NO) { return(NO); }
+  
+  return(RKAppendToOutputBuffer(replaceContext->outputBuffer, characters, NSMakeRange(0, length)));
+}
+
 NSString *RKStringFromReferenceString(id self, const SEL _cmd, RKRegex * const RK_C99(restrict) regex, RK_STRONG_REF const NSRange * const RK_C99(restrict) matchRanges, RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) matchStringBuffer, RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) referenceStringBuffer) {
   RKReferenceInstruction        stackReferenceInstructions[RK_DEFAULT_STACK_INSTRUCTIONS];
-  RKCopyInstruction             stackCopyInstructions[RK_DEFAULT_STACK_INSTRUCTIONS];
+  char                          stackOutputBytes[RK_DEFAULT_STACK_OUTPUT_SIZE];
 
-  RKReferenceInstructionsBuffer referenceInstructionsBuffer = RKMakeReferenceInstructionsBuffer(0, RK_DEFAULT_STACK_INSTRUCTIONS,    &stackReferenceInstructions[0], NULL);
-  RKCopyInstructionsBuffer      copyInstructionsBuffer      = RKMakeCopyInstructionsBuffer(     0, RK_DEFAULT_STACK_INSTRUCTIONS, 0, &stackCopyInstructions[0],      NULL);
+  RKReferenceInstructionsBuffer referenceInstructionsBuffer = RKMakeReferenceInstructionsBuffer(0, RK_DEFAULT_STACK_INSTRUCTIONS, &stackReferenceInstructions[0], NULL);
+  RKOutputBuffer                outputBuffer                = RKMakeOutputBuffer(&stackOutputBytes[0], RK_DEFAULT_STACK_OUTPUT_SIZE, NULL);
   
-  if(RKCompileReferenceString(    self, _cmd, referenceStringBuffer, regex, &referenceInstructionsBuffer)                                   == NO) { goto errorExit; }
-  if(RKApplyReferenceInstructions(self, _cmd, regex, matchRanges, matchStringBuffer, &referenceInstructionsBuffer, &copyInstructionsBuffer) == NO) { goto errorExit; }
+  if(RKCompileReferenceString(    self, _cmd, referenceStringBuffer, regex, &referenceInstructionsBuffer)                         == NO) { goto errorExit; }
+  if(RKApplyReferenceInstructions(self, _cmd, regex, matchRanges, matchStringBuffer, &referenceInstructionsBuffer, &outputBuffer) == NO) { goto errorExit; }
 
-  return(RKStringFromCopyInstructions(self, _cmd, &copyInstructionsBuffer, RKUTF8StringEncoding));
+  return(RKStringFromOutputBuffer(self, _cmd, &outputBuffer, RKUTF8StringEncoding));
 
 errorExit:
+  RKReleaseOutputBuffer(&outputBuffer);
   return(NULL);
 }
 
 NSString *RKStringFromReferenceStringX(id self, const SEL _cmd, RKRegex * const RK_C99(restrict) regex, RK_STRONG_REF const NSRange * const RK_C99(restrict) matchRanges, RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) matchStringBuffer, RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) referenceStringBuffer, NSError **error) {
   RKReferenceInstruction        stackReferenceInstructions[RK_DEFAULT_STACK_INSTRUCTIONS];
-  RKCopyInstruction             stackCopyInstructions[RK_DEFAULT_STACK_INSTRUCTIONS];
+  char                          stackOutputBytes[RK_DEFAULT_STACK_OUTPUT_SIZE];
   
-  RKReferenceInstructionsBuffer referenceInstructionsBuffer = RKMakeReferenceInstructionsBuffer(0, RK_DEFAULT_STACK_INSTRUCTIONS,    &stackReferenceInstructions[0], NULL);
-  RKCopyInstructionsBuffer      copyInstructionsBuffer      = RKMakeCopyInstructionsBuffer(     0, RK_DEFAULT_STACK_INSTRUCTIONS, 0, &stackCopyInstructions[0],      NULL);
+  RKReferenceInstructionsBuffer referenceInstructionsBuffer = RKMakeReferenceInstructionsBuffer(0, RK_DEFAULT_STACK_INSTRUCTIONS, &stackReferenceInstructions[0], NULL);
+  RKOutputBuffer                outputBuffer                = RKMakeOutputBuffer(&stackOutputBytes[0], RK_DEFAULT_STACK_OUTPUT_SIZE, NULL);
   
-  if(RKCompileReferenceStringX(   self, _cmd, referenceStringBuffer, regex, &referenceInstructionsBuffer, error)                            == NO) { goto errorExit; }
-  if(RKApplyReferenceInstructions(self, _cmd, regex, matchRanges, matchStringBuffer, &referenceInstructionsBuffer, &copyInstructionsBuffer) == NO) { goto errorExit; }
+  if(RKCompileReferenceStringX(   self, _cmd, referenceStringBuffer, regex, &referenceInstructionsBuffer, error)                  == NO) { goto errorExit; }
+  if(RKApplyReferenceInstructions(self, _cmd, regex, matchRanges, matchStringBuffer, &referenceInstructionsBuffer, &outputBuffer) == NO) { goto errorExit; }
   
-  return(RKStringFromCopyInstructionsX(self, _cmd, &copyInstructionsBuffer, RKUTF8StringEncoding, error));
+  return(RKStringFromOutputBufferX(self, _cmd, &outputBuffer, RKUTF8StringEncoding, error));
   
 errorExit:
+  RKReleaseOutputBuffer(&outputBuffer);
   return(NULL);
 }
 
 
-static NSString *RKStringFromCopyInstructions(id self, const SEL _cmd, RK_STRONG_REF const RKCopyInstructionsBuffer * const RK_C99(restrict) instructionsBuffer, const RKStringBufferEncoding stringEncoding) {
+static NSString *RKStringFromOutputBuffer(id self, const SEL _cmd, RK_STRONG_REF RKOutputBuffer * const RK_C99(restrict) outputBuffer, const RKStringBufferEncoding stringEncoding) {
   NSString *copyString = NULL;
   NSError  *copyError  = NULL;
   
-  copyString = RKStringFromCopyInstructionsX(self, _cmd, instructionsBuffer, stringEncoding, &copyError);
+  copyString = RKStringFromOutputBufferX(self, _cmd, outputBuffer, stringEncoding, &copyError);
   if(copyError != NULL) { [[NSException exceptionWithName:NSGenericException reason:[copyError localizedDescription] userInfo:NULL] raise]; }
 
   return(copyString);
 }
-NSAllocateCollectable
-static NSString *RKStringFromCopyInstructionsX(id self RK_ATTRIBUTES(unused), const SEL _cmd RK_ATTRIBUTES(unused), RK_STRONG_REF const RKCopyInstructionsBuffer * const RK_C99(restrict) instructionsBuffer, const RKStringBufferEncoding stringEncoding, NSError **error) {
+
+// Takes ownership of outputBuffers bytes.  If they were moved to the heap, the allocation is handed directly to the string, otherwise they are copied.
+static NSString *RKStringFromOutputBufferX(id self RK_ATTRIBUTES(unused), const SEL _cmd RK_ATTRIBUTES(unused), RK_STRONG_REF RKOutputBuffer * const RK_C99(restrict) outputBuffer, const RKStringBufferEncoding stringEncoding, NSError **error) {
+  NSCParameterAssert(outputBuffer != NULL); NSCParameterAssert(outputBuffer->mutableData == NULL);
   char RK_STRONG_REF * RK_C99(restrict) copyBuffer = NULL;
   NSString           * RK_C99(restrict) copyString = NULL;
   NSError            * RK_C99(restrict) copyError  = NULL;
@@ -853,47 +1483,48 @@ static NSString *RKStringFromCopyInstructionsX(id self RK_ATTRIBUTES(unused), co
   // that pointer to CFString causes the GC system to 'loose track of' the liveness of the string buffer because CoreFoundation does not issue the proper 'GC Notification'
   // function calls regarding the GC backed pointer we hand it.
   
-  //if((copyBuffer = RKMallocNotScanned(instructionsBuffer->copiedLength + 1)) == NULL) { copyError = [NSError rkErrorWithDomain:NSPOSIXErrorDomain code:0 localizeDescription:@"Unable to allocate memory for final copied string."]; goto errorExit; }
-  if((copyBuffer = RKMallocNoGC(instructionsBuffer->copiedLength + 1)) == NULL) { copyError = [NSError rkErrorWithDomain:NSPOSIXErrorDomain code:0 localizeDescription:@"Unable to allocate memory for final copied string."]; goto errorExit; }
-
-  RKEvaluateCopyInstructions(instructionsBuffer, copyBuffer, (instructionsBuffer->copiedLength + 1));
+  if(outputBuffer->isValid == NO) { copyError = [NSError rkErrorWithDomain:NSPOSIXErrorDomain code:0 localizeDescription:@"Unable to allocate memory for final copied string."]; goto errorExit; }
+
+  if(outputBuffer->isHeapAllocated == YES) {
+    // The heap buffer always has room for the terminating NUL.  Trim any excess from the geometric growth before handing it off.
+    char *trimmedBuffer = NULL;
+    outputBuffer->bytes[outputBuffer->length] = 0;
+    if((trimmedBuffer = realloc(outputBuffer->bytes, outputBuffer->length + 1)) != NULL) { outputBuffer->bytes = trimmedBuffer; }
+    copyBuffer                    = outputBuffer->bytes;
+    outputBuffer->bytes           = NULL;
+    outputBuffer->isHeapAllocated = NO;
+  } else {
+    if((copyBuffer = RKMallocNoGC(outputBuffer->length + 1)) == NULL) { copyError = [NSError rkErrorWithDomain:NSPOSIXErrorDomain code:0 localizeDescription:@"Unable to allocate memory for final copied string."]; goto errorExit; }
+    memcpy(copyBuffer, outputBuffer->bytes, outputBuffer->length);
+    copyBuffer[outputBuffer->length] = 0;
+  }
 
 #ifdef USE_CORE_FOUNDATION
   //copyString = RKMakeCollectableOrAutorelease(CFStringCreateWithCStringNoCopy(kCFAllocatorDefault, copyBuffer, stringEncoding, RK_EXPECTED(RKRegexGarbageCollect == 1, 0) ? kCFAllocatorNull : kCFAllocatorMalloc));
   copyString = RKMakeCollectableOrAutorelease(CFStringCreateWithCStringNoCopy(kCFAllocatorDefault, copyBuffer, stringEncoding, kCFAllocatorMalloc));
 #else  // USE_CORE_FOUNDATION is not defined
-  //copyString = RKAutorelease([[NSString alloc] initWithBytesNoCopy:copyBuffer length:instructionsBuffer->copiedLength encoding:stringEncoding freeWhenDone:(RKRegexGarbageCollect == 1, 0) ? NO : YES]);
-  copyString = RKAutorelease([[NSString alloc] initWithBytesNoCopy:copyBuffer length:instructionsBuffer->copiedLength encoding:stringEncoding freeWhenDone:YES]);
+  //copyString = RKAutorelease([[NSString alloc] initWithBytesNoCopy:copyBuffer length:outputBuffer->length encoding:stringEncoding freeWhenDone:(RKRegexGarbageCollect == 1, 0) ? NO : YES]);
+  copyString = RKAutorelease([[NSString alloc] initWithBytesNoCopy:copyBuffer length:outputBuffer->length encoding:stringEncoding freeWhenDone:YES]);
 #endif // USE_CORE_FOUNDATION
 
 errorExit:
+  RKReleaseOutputBuffer(outputBuffer);
   if(error != NULL) { *error = copyError; }
   return(copyString);
 }
 
-static void RKEvaluateCopyInstructions(RK_STRONG_REF const RKCopyInstructionsBuffer * const RK_C99(restrict) instructionsBuffer, RK_STRONG_REF void * const RK_C99(restrict) toBuffer, const size_t bufferLength) {
-  NSCParameterAssert(instructionsBuffer != NULL); NSCParameterAssert(toBuffer != NULL); NSCParameterAssert(instructionsBuffer->isValid == YES); NSCParameterAssert(instructionsBuffer->instructions != NULL);
-  RKUInteger instructionIndex = 0, copyBufferIndex = 0;
-  
-  while((instructionIndex < instructionsBuffer->length) && (copyBufferIndex <= bufferLength)) {
-    RKCopyInstruction * RK_C99(restrict) atInstruction = &instructionsBuffer->instructions[instructionIndex];
-    NSCParameterAssert(atInstruction != NULL); NSCParameterAssert((copyBufferIndex + atInstruction->length) <= instructionsBuffer->copiedLength); NSCParameterAssert((copyBufferIndex + atInstruction->length) <= bufferLength);
-    
-    memcpy(toBuffer + copyBufferIndex, atInstruction->ptr, atInstruction->length);
-    copyBufferIndex += atInstruction->length;
-    instructionIndex++;
-  }
-  NSCParameterAssert(copyBufferIndex <= bufferLength);
-  ((char *)toBuffer)[copyBufferIndex] = 0;
+void RKReleaseOutputBuffer(RK_STRONG_REF RKOutputBuffer * const RK_C99(restrict) outputBuffer) {
+  NSCParameterAssert(outputBuffer != NULL);
+  if((outputBuffer->isHeapAllocated == YES) && (outputBuffer->bytes != NULL)) { RKFreeAndNULLNoGC(outputBuffer->bytes); }
+  outputBuffer->isHeapAllocated = NO;
 }
 
 static BOOL RKApplyReferenceInstructions(id self, const SEL _cmd, RKRegex * const RK_C99(restrict) regex, RK_STRONG_REF const NSRange * const RK_C99(restrict) matchRanges,
                                          RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) stringBuffer,
                                          RK_STRONG_REF const RKReferenceInstructionsBuffer * const RK_C99(restrict) referenceInstructionsBuffer,
-                                         RK_STRONG_REF RKCopyInstructionsBuffer * const RK_C99(restrict) appliedInstructionsBuffer) {
+                                         RK_STRONG_REF RKOutputBuffer * const RK_C99(restrict) outputBuffer) {
   int              currentOp        = 0, lastOp           = referenceInstructionsBuffer->instructions[0].op;
   RKUInteger       captureIndex     = 0, instructionIndex = 0;
-  NSMutableString *conversionString = NULL;
   
   while((lastOp != OP_STOP) && (instructionIndex < referenceInstructionsBuffer->length)) {
     RKReferenceInstruction RK_STRONG_REF * RK_C99(restrict) atInstruction = &referenceInstructionsBuffer->instructions[instructionIndex];
@@ -925,51 +1556,34 @@ static BOOL RKApplyReferenceInstructions(id self, const SEL _cmd, RKRegex * cons
     
     if((currentOp == 0) && (thisOp == OP_CHANGE_CASE_END)) { continue; }
 
-    if((thisOp == OP_CHANGE_CASE_END) && ((currentOp == OP_UPPERCASE_NEXT_CHAR) || (currentOp == OP_LOWERCASE_NEXT_CHAR) || (currentOp == OP_UPPERCASE_BEGIN) || (currentOp == OP_LOWERCASE_BEGIN)) && ([conversionString length] == 0)) {
+    if((thisOp == OP_CHANGE_CASE_END) && ((currentOp == OP_UPPERCASE_NEXT_CHAR) || (currentOp == OP_LOWERCASE_NEXT_CHAR) || (currentOp == OP_UPPERCASE_BEGIN) || (currentOp == OP_LOWERCASE_BEGIN))) {
       currentOp = 0;
       continue;
     }
     
     if((currentOp == 0) && (thisOp == 0) && ((fromPtr != NULL) && (fromRange.length > 0))) {
-      if(RKAppendCopyInstruction(appliedInstructionsBuffer, fromPtr, fromRange) == NO) { goto errorExit; }
+      if(RKAppendToOutputBuffer(outputBuffer, fromPtr, fromRange) == NO) { goto errorExit; }
       continue;
     }
 
+    // Each span is case converted and written to the output buffer as it is encountered.
     if(((currentOp == OP_UPPERCASE_BEGIN) || (currentOp == OP_LOWERCASE_BEGIN)) && (thisOp == 0) && ((fromPtr != NULL) && (fromRange.length > 0))) {
-      if(conversionString == NULL) { RK_PROBE(PERFORMANCENOTE, NULL, 0, NULL, 0, -1, 0, "Temporary NSMutableString for case conversion created."); if((conversionString = [[NSMutableString alloc] initWithCapacity:1024]) == NULL) { goto errorExit; } }
-      NSString *fromString = [[NSString alloc] initWithBytes:(fromPtr + fromRange.location) length:fromRange.length encoding:NSUTF8StringEncoding];
-      [conversionString appendString:fromString];
-      RKRelease(fromString);
+      if(RKAppendCaseConvertedToOutputBuffer(outputBuffer, (fromPtr + fromRange.location), fromRange.length, (currentOp == OP_UPPERCASE_BEGIN) ? YES : NO) == NO) { goto errorExit; }
       continue;
     }
     
     if(((currentOp == OP_UPPERCASE_BEGIN) || (currentOp == OP_LOWERCASE_BEGIN)) && (thisOp != currentOp) && ((thisOp != 0) || (lastOp == OP_STOP))) {
-      const char RK_STRONG_REF *convertedPtr    = NULL;
-      size_t                    convertedLength = 0;
-      
-      if([conversionString length] > 0) {
-        if(currentOp == OP_UPPERCASE_BEGIN) { convertedPtr = [[conversionString uppercaseString] UTF8String]; } else { convertedPtr = [[conversionString lowercaseString] UTF8String]; } 
-        if(convertedPtr != NULL) { convertedLength = strlen(convertedPtr); }
-      
-        if(RKAppendCopyInstruction(appliedInstructionsBuffer, convertedPtr, NSMakeRange(0, convertedLength)) == NO) { goto errorExit; }
-        [conversionString setString:@""];
-      }
       currentOp = 0;
       if(thisOp == OP_CHANGE_CASE_END) { continue; }
     }
 
     if(((currentOp == OP_UPPERCASE_NEXT_CHAR) || (currentOp == OP_LOWERCASE_NEXT_CHAR)) && (thisOp == 0) && ((fromPtr != NULL) && (fromRange.length > 0))) {
-      const char RK_STRONG_REF *convertedPtr = NULL, RK_STRONG_REF *fromBasePtr = (fromPtr + fromRange.location);
-      const unsigned char       convertChar  = *((const unsigned char *)fromBasePtr);
-      int                       fromLength   = (convertChar < 128) ? 1 : utf8ExtraBytes[(convertChar & 0x3f)] + 1;
-      NSString                 *sourceString = [[NSString alloc] initWithBytes:fromBasePtr length:fromLength encoding:NSUTF8StringEncoding];
-
-      if(currentOp == OP_UPPERCASE_NEXT_CHAR) { convertedPtr = [[sourceString uppercaseString] UTF8String]; } else { convertedPtr = [[sourceString lowercaseString] UTF8String]; }
-      
-      if(sourceString != NULL) { RKRelease(sourceString); sourceString = NULL; }
+      const char RK_STRONG_REF *fromBasePtr = (fromPtr + fromRange.location);
+      const unsigned char       convertChar = *((const unsigned char *)fromBasePtr);
+      int                       fromLength  = (convertChar < 128) ? 1 : utf8ExtraBytes[(convertChar & 0x3f)] + 1;
 
-      if(RKAppendCopyInstruction(appliedInstructionsBuffer, convertedPtr,               NSMakeRange(0, (convertedPtr == NULL) ? 0 : strlen(convertedPtr))) == NO) { goto errorExit; }
-      if(RKAppendCopyInstruction(appliedInstructionsBuffer, (fromBasePtr + fromLength), NSMakeRange(0, fromRange.length - fromLength))                     == NO) { goto errorExit; }
+      if(RKAppendCaseConvertedToOutputBuffer(outputBuffer, fromBasePtr, fromLength, (currentOp == OP_UPPERCASE_NEXT_CHAR) ? YES : NO)  == NO) { goto errorExit; }
+      if(RKAppendToOutputBuffer(outputBuffer, (fromBasePtr + fromLength), NSMakeRange(0, fromRange.length - fromLength)) == NO) { goto errorExit; }
       
       currentOp = 0;
       continue;
@@ -979,13 +1593,9 @@ static BOOL RKApplyReferenceInstructions(id self, const SEL _cmd, RKRegex * cons
     currentOp = thisOp;
   }
 
-  NSCParameterAssert([conversionString length] == 0);
-  
-  if(conversionString != NULL) { RKRelease(conversionString); conversionString = NULL; }
   return(YES);
   
 errorExit:
-  if(conversionString != NULL) { RKRelease(conversionString); conversionString = NULL; }
   return(NO);
 }
 
@@ -1001,7 +1611,7 @@ static BOOL RKCompileReferenceString(id self, const SEL _cmd, RK_STRONG_REF cons
   return(didCompile);
 }
 
-static BOOL RKCompileReferenceStringX(id self RK_ATTRIBUTES(unused), const SEL _cmd RK_ATTRIBUTES(unused), RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) referenceStringBuffer, RKRegex * const RK_C99(restrict) regex,
+BOOL RKCompileReferenceStringX(id self RK_ATTRIBUTES(unused), const SEL _cmd RK_ATTRIBUTES(unused), RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) referenceStringBuffer, RKRegex * const RK_C99(restrict) regex,
                                      RK_STRONG_REF RKReferenceInstructionsBuffer * const RK_C99(restrict) instructionBuffer, NSError **error) {
   NSCParameterAssert((referenceStringBuffer != NULL) && (regex != NULL) && (instructionBuffer != NULL));
   NSRange     currentRange     = NSMakeRange(0, 0), validVarRange  = NSMakeRange(NSNotFound, 0), parsedVarRange = NSMakeRange(NSNotFound, 0);
@@ -1017,7 +1627,7 @@ static BOOL RKCompileReferenceStringX(id self RK_ATTRIBUTES(unused), const SEL _
       currentRange    = NSMakeRange(referenceIndex, 0);
       continue;
     } else if(referenceStringBuffer->characters[referenceIndex] == '$') {
-      if(RKParseReference(referenceStringBuffer, NSMakeRange(referenceIndex, (referenceStringBuffer->length - referenceIndex)), NULL, NULL, regex, &parsedUInteger, NULL, RKParseReferenceIgnoreConversion | RKParseReferenceCheckCaptureName, &parsedVarRange, &validVarRange, &parseErrorString, NULL, NULL, &compileError)) {
+      if(RKParseReference(referenceStringBuffer, NSMakeRange(referenceIndex, (referenceStringBuffer->length - referenceIndex)), NULL, NULL, regex, &parsedUInteger, NULL, RKParseReferenceIgnoreConversion | RKParseReferenceCheckCaptureName, &parsedVarRange, &validVarRange, NULL, &parseErrorString, NULL, NULL, &compileError)) {
         if(currentRange.length > 0)      {
           if(RKAppendInstruction(instructionBuffer, OP_COPY_RANGE,        referenceStringBuffer->characters,                  currentRange)  == NO) { goto errorExit; }
         } if(parsedUInteger == NSNotFound) {
@@ -1113,61 +1723,669 @@ errorExit:
   return(NO);
 }
 
-static BOOL RKAppendCopyInstruction(RK_STRONG_REF RKCopyInstructionsBuffer * const RK_C99(restrict) instructionsBuffer, RK_STRONG_REF const void * const RK_C99(restrict) ptr, const NSRange range) {
-  NSCParameterAssert(instructionsBuffer != NULL); NSCParameterAssert(instructionsBuffer->length <= instructionsBuffer->capacity); NSCParameterAssert(instructionsBuffer->isValid == YES);
+static BOOL RKAppendToOutputBuffer(RK_STRONG_REF RKOutputBuffer * const RK_C99(restrict) outputBuffer, RK_STRONG_REF const void * const RK_C99(restrict) ptr, const NSRange range) {
+  NSCParameterAssert(outputBuffer != NULL); NSCParameterAssert(outputBuffer->length <= outputBuffer->capacity); NSCParameterAssert(outputBuffer->isValid == YES);
   
   if(range.length == 0) { return(YES); }
 
-  // If the current append request starts where the last copy ends, just append the current requests length
-  if(instructionsBuffer->length > 0) {
-    RKCopyInstruction RK_STRONG_REF *lastInstruction = &instructionsBuffer->instructions[(instructionsBuffer->length) - 1];
-    if((lastInstruction->ptr + lastInstruction->length) == (ptr + range.location)) {
-      lastInstruction->length          += range.length;
-      instructionsBuffer->copiedLength += range.length;
-      return(YES);
-    }
+  if(outputBuffer->mutableData != NULL) {
+    [outputBuffer->mutableData appendBytes:(ptr + range.location) length:range.length];
+    outputBuffer->length += range.length;
+    return(YES);
   }
 
-  if(instructionsBuffer->length >= instructionsBuffer->capacity) {
-    if(instructionsBuffer->mutableData == NULL) {
-      RK_PROBE(PERFORMANCENOTE, NULL, 0, NULL, 0, -1, 0, "The number of RKCopyInstructions exceeded stack buffer requiring a buffer to be allocated from the heap.");
-      if((instructionsBuffer->mutableData = [NSMutableData dataWithLength:(sizeof(RKCopyInstruction) * (instructionsBuffer->capacity + RK_DEFAULT_STACK_INSTRUCTIONS))]) == NULL) { goto errorExit; }
-      if((instructionsBuffer->instructions != NULL) && (instructionsBuffer->capacity > 0)) {
-        [instructionsBuffer->mutableData appendBytes:instructionsBuffer->instructions length:(sizeof(RKCopyInstruction) * instructionsBuffer->capacity)];
-      }
-      instructionsBuffer->capacity += RK_DEFAULT_STACK_INSTRUCTIONS;
+  // Always keep at least one byte free so the final string can be NUL terminated in place.
+  if((outputBuffer->length + range.length) >= outputBuffer->capacity) {
+    RKUInteger newCapacity = (outputBuffer->capacity < RK_DEFAULT_STACK_OUTPUT_SIZE) ? RK_DEFAULT_STACK_OUTPUT_SIZE : outputBuffer->capacity;
+    char      *newBytes    = NULL;
+    
+    while((outputBuffer->length + range.length) >= newCapacity) { newCapacity *= 2; }
+    
+    if(outputBuffer->isHeapAllocated == NO) {
+      RK_PROBE(PERFORMANCENOTE, NULL, 0, NULL, 0, -1, 0, "The replaced string exceeded the stack output buffer requiring a buffer to be allocated from the heap.");
+      if((newBytes = RKMallocNoGC(newCapacity)) == NULL) { goto errorExit; }
+      if(outputBuffer->length > 0) { memcpy(newBytes, outputBuffer->bytes, outputBuffer->length); }
+      outputBuffer->isHeapAllocated = YES;
     }
     else {
-      RK_PROBE(PERFORMANCENOTE, NULL, 0, NULL, 0, -1, 0, "The number of RKCopyInstructions exceeded current heap buffer size requiring additional heap storage be allocated.");
-      [instructionsBuffer->mutableData increaseLengthBy:(sizeof(RKCopyInstruction) * RK_DEFAULT_STACK_INSTRUCTIONS)];
-      instructionsBuffer->capacity += RK_DEFAULT_STACK_INSTRUCTIONS;
+      RK_PROBE(PERFORMANCENOTE, NULL, 0, NULL, 0, -1, 0, "The replaced string exceeded the current heap output buffer requiring it to be grown.");
+      if((newBytes = realloc(outputBuffer->bytes, newCapacity)) == NULL) { goto errorExit; }
     }
-    if((instructionsBuffer->instructions = [instructionsBuffer->mutableData mutableBytes]) == NULL) { goto errorExit; }
+    outputBuffer->bytes    = newBytes;
+    outputBuffer->capacity = newCapacity;
   }
   
-  instructionsBuffer->instructions[instructionsBuffer->length].ptr    = (ptr + range.location);
-  instructionsBuffer->instructions[instructionsBuffer->length].length = range.length;
-  instructionsBuffer->copiedLength += instructionsBuffer->instructions[instructionsBuffer->length].length;
-  instructionsBuffer->length++;
+  memcpy(outputBuffer->bytes + outputBuffer->length, ptr + range.location, range.length);
+  outputBuffer->length += range.length;
 
   return(YES);
   
 errorExit:
-    instructionsBuffer->isValid = NO;
+    outputBuffer->isValid = NO;
     return(NO);
 }
 
+//
+// Case converts the fromLength bytes at fromPtr directly in to the output buffer.  Characters that are not covered by RKSimpleCaseMapUTF8()
+// cause the whole span to be converted by Foundation instead, so that context sensitive and length changing mappings are handled correctly.
+//
+
+static BOOL RKAppendCaseConvertedToOutputBuffer(RK_STRONG_REF RKOutputBuffer * const RK_C99(restrict) outputBuffer, RK_STRONG_REF const char * const RK_C99(restrict) fromPtr, const RKUInteger fromLength, const BOOL toUppercase) {
+  NSCParameterAssert(outputBuffer != NULL); NSCParameterAssert(fromPtr != NULL); NSCParameterAssert(outputBuffer->isValid == YES);
+  char       convertedBuffer[RK_CASE_CONVERSION_BUFFER_SIZE];
+  RKUInteger startLength = outputBuffer->length, convertedIndex = 0, convertedLength = 0;
+  
+  while(convertedIndex < fromLength) {
+    RKUInteger chunkEnd = min((convertedIndex + RK_CASE_CONVERSION_BUFFER_SIZE), fromLength);
+    while((chunkEnd < fromLength) && (chunkEnd > convertedIndex) && ((((const unsigned char *)fromPtr)[chunkEnd] & 0xc0) == 0x80)) { chunkEnd--; } // Don't split a character.
+    
+    if((convertedLength = RKSimpleCaseMapUTF8(fromPtr + convertedIndex, (chunkEnd - convertedIndex), convertedBuffer, toUppercase)) == NSNotFound) { goto foundationConversion; }
+    if(RKAppendToOutputBuffer(outputBuffer, convertedBuffer, NSMakeRange(0, convertedLength)) == NO) { return(NO); }
+    convertedIndex = chunkEnd;
+  }
+  
+  return(YES);
+  
+foundationConversion:
+  RK_PROBE(PERFORMANCENOTE, NULL, 0, NULL, 0, -1, 0, "Temporary NSString for case conversion created.");
+  
+  // Discard anything that was already converted for this span.
+  if(outputBuffer->mutableData != NULL) { [outputBuffer->mutableData setLength:([outputBuffer->mutableData length] - (outputBuffer->length - startLength))]; }
+  outputBuffer->length = startLength;
+  
+  NSString                 *fromString   = [[NSString alloc] initWithBytes:fromPtr length:fromLength encoding:NSUTF8StringEncoding];
+  const char RK_STRONG_REF *convertedPtr = (toUppercase == YES) ? [[fromString uppercaseString] UTF8String] : [[fromString lowercaseString] UTF8String];
+  
+  if(fromString != NULL) { RKRelease(fromString); fromString = NULL; }
+  
+  return(RKAppendToOutputBuffer(outputBuffer, convertedPtr, NSMakeRange(0, (convertedPtr == NULL) ? 0 : strlen(convertedPtr))));
+}
+
+
+//
+// Fast numeric conversions for the common scanf style % conversions.  These work directly on the capture bytes and return NO for
+// anything they can't convert with exactly the same result as the original conversion, in which case the caller falls back to sscanf().
+//
+// The plain 32 bit %d, %i, %o, %u, %x, and %X conversions keep the semantics of the original inline conversion: the base is taken from
+// the prefix of the capture ('0x' is hex, a leading '0' is octal), and out of range values are clamped.  The h, hh, l, ll, and q length
+// modifiers and the %f / %lf family follow the sscanf() rules instead, which is what they have always been converted with.
+//
+
+#if defined(__LITTLE_ENDIAN__) || (defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__))
+#define RK_SWAR_DIGITS
+#endif
+
+#define RK_CONVERSION_CHARACTER(ptr, length, index) (((index) < (length)) ? (ptr)[(index)] : 0)
+
+#ifdef    RK_SWAR_DIGITS
+// Eight ASCII digits at a time, as in fast_float.  The first digit is in the lowest byte, so this requires a little endian load.
+RKREGEX_STATIC_INLINE BOOL     RKIsEightDigits(const uint64_t eightCharacters)    { return(((eightCharacters & 0xF0F0F0F0F0F0F0F0ULL) | (((eightCharacters + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL); }
+RKREGEX_STATIC_INLINE uint32_t RKEightDigitsValue(uint64_t eightCharacters) {
+  eightCharacters -= 0x3030303030303030ULL;
+  eightCharacters  = (eightCharacters * 10) + (eightCharacters >> 8);
+  return((uint32_t)((((eightCharacters & 0x000000FF000000FFULL) * 0x000F424000000064ULL) + (((eightCharacters >> 16) & 0x000000FF000000FFULL) * 0x0000271000000001ULL)) >> 32));
+}
+#endif // RK_SWAR_DIGITS
+
+// Accumulates the decimal digits starting at *atIndex, stopping before value could overflow 19 digits.  Returns the number of digits consumed.
+static RKUInteger RKAccumulateDecimalDigits(RK_STRONG_REF const char * const RK_C99(restrict) characters, const RKUInteger length, RK_STRONG_REF RKUInteger * const RK_C99(restrict) atIndex, RK_STRONG_REF uint64_t * const RK_C99(restrict) value, const RKUInteger maxDigits) {
+  RKUInteger digits = 0, index = *atIndex;
+  uint64_t   accumulator = *value;
+  
+#ifdef    RK_SWAR_DIGITS
+  while(((index + 8) <= length) && ((digits + 8) <= maxDigits)) {
+    uint64_t eightCharacters;
+    memcpy(&eightCharacters, &characters[index], sizeof(uint64_t));
+    if(RKIsEightDigits(eightCharacters) == NO) { break; }
+    accumulator = (accumulator * 100000000ULL) + RKEightDigitsValue(eightCharacters);
+    index += 8; digits += 8;
+  }
+#endif // RK_SWAR_DIGITS
+  while((index < length) && (digits < maxDigits) && (characters[index] >= '0') && (characters[index] <= '9')) { accumulator = (accumulator * 10) + (uint64_t)(characters[index] - '0'); index++; digits++; }
+  
+  *atIndex = index;
+  *value   = accumulator;
+  return(digits);
+}
+
+static BOOL RKConvertLegacyInt(RK_STRONG_REF const char * const RK_C99(restrict) characters, const RKUInteger length, const BOOL unsignedConversion, RK_STRONG_REF int * const RK_C99(restrict) conversionPtr) {
+  // Modified from the libc conversion routine.
+  int neg = 0, any = 0, cutlim = 0, base = 0;
+  RKUInteger atIndex = 0;
+  unsigned int acc = 0, cutoff = 0;
+  char c = 0;
+  
+  do { c = RK_CONVERSION_CHARACTER(characters, length, atIndex); atIndex++; } while (isspace((unsigned char)c) && (atIndex <= length));
+  if(c == '-') { neg = 1; c = RK_CONVERSION_CHARACTER(characters, length, atIndex); atIndex++; } else if (c == '+') { c = RK_CONVERSION_CHARACTER(characters, length, atIndex); atIndex++; }
+  if((c == '0') && ((RK_CONVERSION_CHARACTER(characters, length, atIndex) | 0x20) == 'x')) { c = RK_CONVERSION_CHARACTER(characters, length, atIndex + 1); atIndex += 2; base = 16; } else { base = c == '0' ? 8 : 10; }
+  
+  if(unsignedConversion == YES) { cutoff = UINT_MAX / base; cutlim = UINT_MAX % base; } 
+  else { cutoff = (neg ? (unsigned int)-(INT_MIN + INT_MAX) + INT_MAX : INT_MAX) / base; cutlim = cutoff % base; }
+  
+  do {
+    if(c >= '0' && c <= '9') { c -= '0'; } else if(c >= 'A' && c <= 'F') { c -= 'A' - 10; } else if(c >= 'a' && c <= 'f') { c -= 'a' - 10; } else { break; }
+    if(c >= base) {  break; }
+    if(any < 0 || acc > cutoff || (acc == cutoff && c > cutlim)) { any = -1; }
+    else { any = 1; acc *= base; acc += c; }
+  } while(((c = RK_CONVERSION_CHARACTER(characters, length, atIndex)) != 0) && (atIndex++ < length));
+  
+  if(any < 0) { if(unsignedConversion == YES) { acc = UINT_MAX; } else { acc = neg ? INT_MIN : INT_MAX; } } else if(neg) { acc = -acc; }
+  
+  *conversionPtr = acc;
+  return(YES);
+}
+
+static BOOL RKConvertScanfInteger(RK_STRONG_REF const char * const RK_C99(restrict) characters, const RKUInteger length, const char lengthModifier, const char conversion, RK_STRONG_REF void * const RK_C99(restrict) conversionPtr) {
+  RKUInteger atIndex = 0, digits = 0;
+  uint64_t   value   = 0;
+  BOOL       negative = NO;
+  int        base     = (conversion == 'o') ? 8 : (((conversion == 'x') || (conversion == 'X')) ? 16 : (conversion == 'i') ? 0 : 10);
+  
+  while((atIndex < length) && isspace((unsigned char)characters[atIndex])) { atIndex++; }
+  if((atIndex < length) && ((characters[atIndex] == '-') || (characters[atIndex] == '+'))) { negative = (characters[atIndex] == '-') ? YES : NO; atIndex++; }
+  
+  if(((base == 16) || (base == 0)) && (RK_CONVERSION_CHARACTER(characters, length, atIndex) == '0') && ((RK_CONVERSION_CHARACTER(characters, length, atIndex + 1) | 0x20) == 'x')) {
+    if(isxdigit((unsigned char)RK_CONVERSION_CHARACTER(characters, length, atIndex + 2)) == 0) { return(NO); } // '0x' without any hex digits, let sscanf() decide.
+    atIndex += 2; base = 16;
+  }
+  if(base == 0) { base = (RK_CONVERSION_CHARACTER(characters, length, atIndex) == '0') ? 8 : 10; }
+  
+  if(base == 10) {
+    if((digits = RKAccumulateDecimalDigits(characters, length, &atIndex, &value, 19)) == 0) { return(NO); }
+    if((atIndex < length) && (characters[atIndex] >= '0') && (characters[atIndex] <= '9')) { return(NO); } // More than 19 digits, may overflow.
+  } else {
+    for(; atIndex < length; atIndex++, digits++) {
+      unsigned int digit = (unsigned int)characters[atIndex];
+      if((digit >= '0') && (digit <= '9')) { digit -= '0'; } else if(((digit | 0x20) >= 'a') && ((digit | 0x20) <= 'f')) { digit = (digit | 0x20) - 'a' + 10; } else { break; }
+      if(digit >= (unsigned int)base) { break; }
+      if(value > ((UINT64_MAX - digit) / (uint64_t)base)) { return(NO); }
+      value = (value * (uint64_t)base) + digit;
+    }
+    if(digits == 0) { return(NO); }
+  }
+  
+  if((conversion == 'd') || (conversion == 'i')) {
+    if(value > ((negative == YES) ? ((uint64_t)INT64_MAX + 1) : (uint64_t)INT64_MAX)) { return(NO); } // sscanf() clamps, let it.
+  }
+  if(negative == YES) { value = (uint64_t)0 - value; }
+  
+  // Narrower conversions are truncated, just as sscanf() does after converting with strtoimax() / strtoumax().
+  switch(lengthModifier) {
+    case 'H': *((char      *)conversionPtr) = (char)value;      break;
+    case 'h': *((short     *)conversionPtr) = (short)value;     break;
+    case 'l':
+      if((sizeof(long) < sizeof(int64_t)) && ((((conversion == 'd') || (conversion == 'i')) ? (((int64_t)value < LONG_MIN) || ((int64_t)value > LONG_MAX)) : ((negative == NO) && (value > ULONG_MAX))))) { return(NO); }
+      *((long      *)conversionPtr) = (long)value;
+      break;
+    case 'q': *((long long *)conversionPtr) = (long long)value; break;
+    default:  return(NO);                                        break;
+  }
+  return(YES);
+}
+
+static BOOL RKConvertScanfFloat(RK_STRONG_REF const char * const RK_C99(restrict) characters, const RKUInteger length, const BOOL doublePrecision, RK_STRONG_REF void * const RK_C99(restrict) conversionPtr) {
+  static const double powersOf10[23] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+  static const float  powersOf10f[11] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+  RKUInteger atIndex = 0, significantDigits = 0, fractionDigits = 0, digitsStart = 0;
+  uint64_t   mantissa = 0;
+  int        exponent = 0;
+  BOOL       negative = NO;
+  
+  while((atIndex < length) && isspace((unsigned char)characters[atIndex])) { atIndex++; }
+  if((atIndex < length) && ((characters[atIndex] == '-') || (characters[atIndex] == '+'))) { negative = (characters[atIndex] == '-') ? YES : NO; atIndex++; }
+  
+  // Hex floats, inf, and nan are left to sscanf().
+  if((RK_CONVERSION_CHARACTER(characters, length, atIndex) == '0') && ((RK_CONVERSION_CHARACTER(characters, length, atIndex + 1) | 0x20) == 'x')) { return(NO); }
+  
+  digitsStart = atIndex;
+  while((atIndex < length) && (characters[atIndex] == '0')) { atIndex++; }
+  significantDigits = RKAccumulateDecimalDigits(characters, length, &atIndex, &mantissa, 19);
+  if((atIndex < length) && (characters[atIndex] >= '0') && (characters[atIndex] <= '9')) { return(NO); }
+  if((atIndex < length) && (characters[atIndex] == '.')) {
+    RKUInteger fractionStart = ++atIndex;
+    if(mantissa == 0) { while((atIndex < length) && (characters[atIndex] == '0')) { atIndex++; } }
+    RKUInteger leadingZeros = atIndex - fractionStart;
+    significantDigits += RKAccumulateDecimalDigits(characters, length, &atIndex, &mantissa, 19 - significantDigits);
+    if((atIndex < length) && (characters[atIndex] >= '0') && (characters[atIndex] <= '9')) { return(NO); }
+    fractionDigits = leadingZeros + (atIndex - fractionStart - leadingZeros);
+    if((atIndex - digitsStart) == 1) { return(NO); } // Just a '.', not a number.
+  } else if(atIndex == digitsStart) { return(NO); }
+  
+  if((atIndex < length) && ((characters[atIndex] | 0x20) == 'e')) {
+    RKUInteger exponentIndex = atIndex + 1;
+    BOOL       negativeExponent = NO;
+    if((exponentIndex < length) && ((characters[exponentIndex] == '-') || (characters[exponentIndex] == '+'))) { negativeExponent = (characters[exponentIndex] == '-') ? YES : NO; exponentIndex++; }
+    if((exponentIndex < length) && (characters[exponentIndex] >= '0') && (characters[exponentIndex] <= '9')) {
+      while((exponentIndex < length) && (characters[exponentIndex] >= '0') && (characters[exponentIndex] <= '9')) { if(exponent > 9999) { return(NO); } exponent = (exponent * 10) + (characters[exponentIndex] - '0'); exponentIndex++; }
+      if(negativeExponent == YES) { exponent = -exponent; }
+    } // Otherwise the 'e' isn't part of the number.
+  }
+  exponent -= (int)fractionDigits;
+  
+  // Clinger's fast path: when both the mantissa and the power of ten are exactly representable, a single multiply or divide is correctly rounded.
+  if(doublePrecision == YES) {
+    double doubleValue = (double)mantissa;
+    if(mantissa != 0) {
+      if((mantissa > (1ULL << 53)) || (exponent < -22) || (exponent > 22)) { return(NO); }
+      doubleValue = (exponent < 0) ? (doubleValue / powersOf10[-exponent]) : (doubleValue * powersOf10[exponent]);
+    }
+    *((double *)conversionPtr) = (negative == YES) ? -doubleValue : doubleValue;
+  } else {
+    float floatValue = (float)mantissa;
+    if(mantissa != 0) {
+      if((mantissa > (1ULL << 24)) || (exponent < -10) || (exponent > 10)) { return(NO); }
+      floatValue = (exponent < 0) ? (floatValue / powersOf10f[-exponent]) : (floatValue * powersOf10f[exponent]);
+    }
+    *((float *)conversionPtr) = (negative == YES) ? -floatValue : floatValue;
+  }
+  return(YES);
+}
+
+BOOL RKConvertNumericCharacters(RK_STRONG_REF const char * const RK_C99(restrict) characters, const RKUInteger length, RK_STRONG_REF const char * const RK_C99(restrict) format, const RKUInteger formatLength, RK_STRONG_REF void * const RK_C99(restrict) conversionPtr) {
+  NSCParameterAssert(characters != NULL); NSCParameterAssert(format != NULL); NSCParameterAssert(format[0] == '%'); NSCParameterAssert(conversionPtr != NULL);
+  const char conversion = format[formatLength - 1];
+  char       lengthModifier = 0;
+  
+  switch(formatLength) {
+    case 2:                                                                           break;
+    case 3: if((format[1] == 'h') || (format[1] == 'l') || (format[1] == 'q')) { lengthModifier = format[1]; } else { return(NO); } break;
+    case 4: if((format[1] == 'h') && (format[2] == 'h')) { lengthModifier = 'H'; } else if((format[1] == 'l') && (format[2] == 'l')) { lengthModifier = 'q'; } else { return(NO); } break;
+    default: return(NO); break;
+  }
+  
+  switch(conversion) {
+    case 'd': case 'i': case 'o': case 'u': case 'x': case 'X':
+      if(lengthModifier == 0) { return(RKConvertLegacyInt(characters, length, ((conversion == 'd') || (conversion == 'i') || (conversion == 'o')) ? NO : YES, (int *)conversionPtr)); }
+      return(RKConvertScanfInteger(characters, length, lengthModifier, conversion, conversionPtr));
+      break;
+    case 'f': case 'e': case 'g': case 'E': case 'G':
+      if(lengthModifier == 0)   { return(RKConvertScanfFloat(characters, length, NO,  conversionPtr)); }
+      if(lengthModifier == 'l') { return(RKConvertScanfFloat(characters, length, YES, conversionPtr)); }
+      break;
+    default: break;
+  }
+  
+  return(NO);
+}
+
+//
+// Fixed format timestamp conversion for @d capture conversions.  The common log file timestamp formats are parsed directly from
+// the UTF8 bytes so that they do not need to serialize through NSStringRKExtensionsNSDateLock.  Anything that isn't an exact match
+// for one of the formats returns NULL and falls back to +[NSDate dateWithNaturalLanguageString:].
+//
+
+static int RKFixedFormatDateDigits(RK_STRONG_REF const char * const RK_C99(restrict) characters, const RKUInteger count) {
+  RKUInteger digitIndex = 0;
+  int        value      = 0;
+  
+  for(digitIndex = 0; digitIndex < count; digitIndex++) {
+    const unsigned int digit = (unsigned int)(characters[digitIndex] - '0');
+    if(RK_EXPECTED(digit > 9, 0)) { return(-1); }
+    value = (value * 10) + (int)digit;
+  }
+  return(value);
+}
+
+static int RKFixedFormatDateMonth(RK_STRONG_REF const char * const RK_C99(restrict) characters) {
+  switch(((characters[0] | 0x20) << 16) | ((characters[1] | 0x20) << 8) | (characters[2] | 0x20)) {
+    case ('j' << 16) | ('a' << 8) | 'n': return(1);
+    case ('f' << 16) | ('e' << 8) | 'b': return(2);
+    case ('m' << 16) | ('a' << 8) | 'r': return(3);
+    case ('a' << 16) | ('p' << 8) | 'r': return(4);
+    case ('m' << 16) | ('a' << 8) | 'y': return(5);
+    case ('j' << 16) | ('u' << 8) | 'n': return(6);
+    case ('j' << 16) | ('u' << 8) | 'l': return(7);
+    case ('a' << 16) | ('u' << 8) | 'g': return(8);
+    case ('s' << 16) | ('e' << 8) | 'p': return(9);
+    case ('o' << 16) | ('c' << 8) | 't': return(10);
+    case ('n' << 16) | ('o' << 8) | 'v': return(11);
+    case ('d' << 16) | ('e' << 8) | 'c': return(12);
+    default: return(0);
+  }
+}
+
+// Days since 1970-01-01 in the proleptic Gregorian calendar.
+static int64_t RKFixedFormatDateDaysFromCivil(int year, const int month, const int day) {
+  year -= (month <= 2) ? 1 : 0;
+  const int64_t era        = ((year >= 0) ? year : (year - 399)) / 400;
+  const int64_t yearOfEra  = (int64_t)year - (era * 400);
+  const int64_t dayOfYear  = (((153 * (month + ((month > 2) ? -3 : 9))) + 2) / 5) + (day - 1);
+  const int64_t dayOfEra   = (yearOfEra * 365) + (yearOfEra / 4) - (yearOfEra / 100) + dayOfYear;
+  return((era * 146097) + dayOfEra - 719468);
+}
+
+static BOOL RKFixedFormatDateIsValid(RK_STRONG_REF const RKFixedFormatDate * const RK_C99(restrict) date) {
+  static const int daysInMonth[12] = {31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+  
+  if(RK_EXPECTED((date->month < 1) || (date->month > 12), 0))                        { return(NO); }
+  if(RK_EXPECTED((date->day   < 1) || (date->day   > daysInMonth[date->month - 1]), 0)) { return(NO); }
+  if(RK_EXPECTED((date->hour  < 0) || (date->hour  > 23) || (date->minute < 0) || (date->minute > 59) || (date->second < 0) || (date->second > 59), 0)) { return(NO); }
+  if((date->year != 0) && (date->month == 2) && (date->day == 29) && (((date->year % 4) != 0) || (((date->year % 100) == 0) && ((date->year % 400) != 0)))) { return(NO); }
+  return(YES);
+}
+
+static BOOL RKParseFixedFormatDate(RK_STRONG_REF const char * const RK_C99(restrict) characters, const RKUInteger length, RK_STRONG_REF RKFixedFormatDate * const RK_C99(restrict) date) {
+  NSCParameterAssert(characters != NULL); NSCParameterAssert(date != NULL);
+  RKUInteger atIndex = 0;
+  
+  memset(date, 0, sizeof(RKFixedFormatDate));
+  date->secondsFromGMT = RK_DATE_LOCAL_TIME_ZONE;
+  
+  // ISO-8601 / RFC-3339: 2008-01-31T12:34[:56[.789]][Z|+hh[[:]mm]]
+  if((length >= 16) && (characters[4] == '-') && (characters[7] == '-') && ((characters[10] == 'T') || (characters[10] == 't') || (characters[10] == ' ')) && (characters[13] == ':')) {
+    date->year   = RKFixedFormatDateDigits(&characters[0],  4);
+    date->month  = RKFixedFormatDateDigits(&characters[5],  2);
+    date->day    = RKFixedFormatDateDigits(&characters[8],  2);
+    date->hour   = RKFixedFormatDateDigits(&characters[11], 2);
+    date->minute = RKFixedFormatDateDigits(&characters[14], 2);
+    date->prefixLength = atIndex = 16;
+    
+    if((atIndex < length) && (characters[atIndex] == ':')) {
+      if(RK_EXPECTED((atIndex + 3) > length, 0)) { return(NO); }
+      date->second = RKFixedFormatDateDigits(&characters[atIndex + 1], 2);
+      atIndex += 3;
+      if((atIndex < length) && ((characters[atIndex] == '.') || (characters[atIndex] == ','))) {
+        NSTimeInterval scale = 0.1;
+        RKUInteger     fractionStart = ++atIndex;
+        while((atIndex < length) && (characters[atIndex] >= '0') && (characters[atIndex] <= '9')) { date->fraction += (characters[atIndex] - '0') * scale; scale /= 10.0; atIndex++; }
+        if(RK_EXPECTED(atIndex == fractionStart, 0)) { return(NO); }
+      }
+    }
+    
+    if(atIndex < length) {
+      if((characters[atIndex] == 'Z') || (characters[atIndex] == 'z')) { date->secondsFromGMT = 0; atIndex++; }
+      else if((characters[atIndex] == '+') || (characters[atIndex] == '-')) {
+        const int sign = (characters[atIndex] == '-') ? -1 : 1;
+        int offsetHours = 0, offsetMinutes = 0;
+        
+        if(RK_EXPECTED((atIndex + 3) > length, 0)) { return(NO); }
+        offsetHours = RKFixedFormatDateDigits(&characters[atIndex + 1], 2);
+        atIndex += 3;
+        if((atIndex < length) && (characters[atIndex] == ':')) { atIndex++; }
+        if((atIndex + 2) <= length) { offsetMinutes = RKFixedFormatDateDigits(&characters[atIndex], 2); atIndex += 2; }
+        if(RK_EXPECTED((offsetHours < 0) || (offsetHours > 23) || (offsetMinutes < 0) || (offsetMinutes > 59), 0)) { return(NO); }
+        date->secondsFromGMT = sign * ((offsetHours * 3600) + (offsetMinutes * 60));
+      }
+    }
+    
+    return((atIndex == length) && (date->year > 0) && RKFixedFormatDateIsValid(date));
+  }
+  
+  // syslog: Jan 31 12:34:56, the day may be space padded.  The year is the current year.
+  if((length == 15) && (characters[3] == ' ') && (characters[6] == ' ') && (characters[9] == ':') && (characters[12] == ':')) {
+    date->month  = RKFixedFormatDateMonth(&characters[0]);
+    date->day    = (characters[4] == ' ') ? RKFixedFormatDateDigits(&characters[5], 1) : RKFixedFormatDateDigits(&characters[4], 2);
+    date->hour   = RKFixedFormatDateDigits(&characters[7],  2);
+    date->minute = RKFixedFormatDateDigits(&characters[10], 2);
+    date->second = RKFixedFormatDateDigits(&characters[13], 2);
+    date->prefixLength = 12;
+    
+    return(RKFixedFormatDateIsValid(date));
+  }
+  
+  // Apache common log format: 31/Jan/2008:12:34:56 -0800
+  if((length == 26) && (characters[2] == '/') && (characters[6] == '/') && (characters[11] == ':') && (characters[14] == ':') && (characters[17] == ':') && (characters[20] == ' ') && ((characters[21] == '+') || (characters[21] == '-'))) {
+    const int offsetHours = RKFixedFormatDateDigits(&characters[22], 2), offsetMinutes = RKFixedFormatDateDigits(&characters[24], 2);
+    
+    date->day    = RKFixedFormatDateDigits(&characters[0],  2);
+    date->month  = RKFixedFormatDateMonth(&characters[3]);
+    date->year   = RKFixedFormatDateDigits(&characters[7],  4);
+    date->hour   = RKFixedFormatDateDigits(&characters[12], 2);
+    date->minute = RKFixedFormatDateDigits(&characters[15], 2);
+    date->second = RKFixedFormatDateDigits(&characters[18], 2);
+    date->prefixLength = 17;
+    
+    if(RK_EXPECTED((date->year <= 0) || (offsetHours < 0) || (offsetHours > 23) || (offsetMinutes < 0) || (offsetMinutes > 59), 0)) { return(NO); }
+    date->secondsFromGMT = ((characters[21] == '-') ? -1 : 1) * ((offsetHours * 3600) + (offsetMinutes * 60));
+    
+    return(RKFixedFormatDateIsValid(date));
+  }
+  
+  return(NO);
+}
+
+// Works out the absolute time of the minute in date, and the time zone the returned date should be in.
+static BOOL RKFixedFormatDateMinuteInterval(RK_STRONG_REF const RKFixedFormatDate * const RK_C99(restrict) date, RK_STRONG_REF NSTimeInterval * const RK_C99(restrict) minuteInterval, NSTimeZone ** const RK_C99(restrict) timeZone) {
+  int year = date->year;
+  
+  if(year == 0) {
+    time_t    now = time(NULL);
+    struct tm nowTM;
+    if(RK_EXPECTED(localtime_r(&now, &nowTM) == NULL, 0)) { return(NO); }
+    year = nowTM.tm_year + 1900;
+    if((date->month == 2) && (date->day == 29) && (((year % 4) != 0) || (((year % 100) == 0) && ((year % 400) != 0)))) { return(NO); }
+  }
+  
+  NSTimeInterval wallClockInterval = ((NSTimeInterval)RKFixedFormatDateDaysFromCivil(year, date->month, date->day) * 86400.0) + (NSTimeInterval)((date->hour * 3600) + (date->minute * 60)) - RK_DATE_REFERENCE_EPOCH;
+  
+  if(date->secondsFromGMT != RK_DATE_LOCAL_TIME_ZONE) {
+    *timeZone       = [NSTimeZone timeZoneForSecondsFromGMT:date->secondsFromGMT];
+    *minuteInterval = wallClockInterval - (NSTimeInterval)date->secondsFromGMT;
+  } else {
+    // The offset at the wall clock time is usually right, the second lookup corrects it when a daylight saving time transition is in between.
+    NSTimeZone *defaultTimeZone = [NSTimeZone defaultTimeZone];
+    RKInteger   secondsFromGMT  = [defaultTimeZone secondsFromGMTForDate:[NSDate dateWithTimeIntervalSinceReferenceDate:wallClockInterval]];
+    secondsFromGMT              = [defaultTimeZone secondsFromGMTForDate:[NSDate dateWithTimeIntervalSinceReferenceDate:(wallClockInterval - (NSTimeInterval)secondsFromGMT)]];
+    *timeZone       = defaultTimeZone;
+    *minuteInterval = wallClockInterval - (NSTimeInterval)secondsFromGMT;
+  }
+  
+  return(*timeZone != NULL);
+}
+
+BOOL RKTimeIntervalFromFixedFormatCharacters(RK_STRONG_REF const char * const RK_C99(restrict) characters, const RKUInteger length, RK_STRONG_REF NSTimeInterval * const RK_C99(restrict) timeInterval, NSTimeZone ** const RK_C99(restrict) timeZonePtr) {
+  RKFixedFormatDate date;
+  NSTimeInterval    minuteInterval = 0.0;
+  NSTimeZone       *timeZone       = NULL;
+  
+  if(RKParseFixedFormatDate(characters, length, &date) == NO) { return(NO); }
+  
+#ifdef    RK_ENABLE_THREAD_LOCAL_STORAGE
+  struct __RKThreadLocalData RK_STRONG_REF * RK_C99(restrict) tld = RKGetThreadLocalData();
+  struct __RKDateCacheEntry  RK_STRONG_REF * RK_C99(restrict) dateCacheEntry = NULL;
+  RKUInteger                                                  dateCacheIndex = 0;
+  
+  if(RK_EXPECTED(tld != NULL, 1) && RK_EXPECTED(date.prefixLength <= RK_DATE_CACHE_PREFIX_SIZE, 1)) {
+    for(dateCacheIndex = 0; dateCacheIndex < RK_DATE_CACHE_ENTRIES; dateCacheIndex++) {
+      dateCacheEntry = &tld->_dateCache[dateCacheIndex];
+      if((dateCacheEntry->timeZone != NULL) && (dateCacheEntry->prefixLength == date.prefixLength) && (dateCacheEntry->secondsFromGMT == date.secondsFromGMT) && (memcmp(dateCacheEntry->prefix, characters, date.prefixLength) == 0)) {
+        minuteInterval = dateCacheEntry->minuteInterval;
+        timeZone       = dateCacheEntry->timeZone;
+        goto finishedConversion;
+      }
+    }
+    
+    if(RKFixedFormatDateMinuteInterval(&date, &minuteInterval, &timeZone) == NO) { return(NO); }
+    
+    dateCacheEntry = &tld->_dateCache[tld->_dateCacheNextEntry];
+    tld->_dateCacheNextEntry = (tld->_dateCacheNextEntry + 1) % RK_DATE_CACHE_ENTRIES;
+    if(dateCacheEntry->timeZone != NULL) { RKEnableCollectorForPointer(dateCacheEntry->timeZone); RKRelease(dateCacheEntry->timeZone); dateCacheEntry->timeZone = NULL; }
+    memcpy(dateCacheEntry->prefix, characters, date.prefixLength);
+    dateCacheEntry->prefixLength   = (uint32_t)date.prefixLength;
+    dateCacheEntry->secondsFromGMT = date.secondsFromGMT;
+    dateCacheEntry->minuteInterval = minuteInterval;
+    dateCacheEntry->timeZone       = RKRetain(timeZone);
+    RKDisableCollectorForPointer(dateCacheEntry->timeZone);
+    goto finishedConversion;
+  }
+#endif // RK_ENABLE_THREAD_LOCAL_STORAGE
+  
+  if(RKFixedFormatDateMinuteInterval(&date, &minuteInterval, &timeZone) == NO) { return(NO); }
+  
+#ifdef    RK_ENABLE_THREAD_LOCAL_STORAGE
+finishedConversion:
+#endif // RK_ENABLE_THREAD_LOCAL_STORAGE
+  *timeInterval = minuteInterval + (NSTimeInterval)date.second + date.fraction;
+  if(timeZonePtr != NULL) { *timeZonePtr = timeZone; }
+  return(YES);
+}
+
+static NSDate *RKDateFromFixedFormatCharacters(RK_STRONG_REF const char * const RK_C99(restrict) characters, const RKUInteger length) {
+  NSTimeInterval  timeInterval = 0.0;
+  NSTimeZone     *timeZone     = NULL;
+  
+  if(RKTimeIntervalFromFixedFormatCharacters(characters, length, &timeInterval, &timeZone) == NO) { return(NULL); }
+  
+  // +dateWithNaturalLanguageString: returns a NSCalendarDate in the parsed time zone, so we do the same.
+  NSCalendarDate *calendarDate = [[NSCalendarDate alloc] initWithTimeIntervalSinceReferenceDate:timeInterval];
+  [calendarDate setTimeZone:timeZone];
+  return(RKAutorelease(calendarDate));
+}
+
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 
+//
+// RKParseReference splits a capture reference in to the capture index and the conversion to perform on it, which is
+// recorded in a RKParsedCaptureReference.  Only this part of the work depends on the capture reference string, so callers
+// that use the same capture reference repeatedly (RKCaptureExtractor) keep the parsed reference and go straight to
+// RKConvertParsedCaptureReference for each match.
+//
+
+static BOOL RKMakeParsedCaptureReference(const RKUInteger captureIndex, RK_STRONG_REF const char * const RK_C99(restrict) startOfConversion, RK_STRONG_REF const char * const RK_C99(restrict) endOfConversion, RK_STRONG_REF RKParsedCaptureReference * const RK_C99(restrict) parsedCaptureReference, RK_STRONG_REF RKParseErrorMessage * const RK_C99(restrict) parseErrorMessage) {
+  NSCParameterAssert(parsedCaptureReference != NULL); NSCParameterAssert(parseErrorMessage != NULL);
+  
+  *parsedCaptureReference = (RKParsedCaptureReference){captureIndex, RKCaptureConversionString, 0, startOfConversion, 0};
+  
+  if(startOfConversion == NULL) { return(YES); }
+  NSCParameterAssert(endOfConversion != NULL);
+  
+  parsedCaptureReference->formatLength = (endOfConversion - startOfConversion);
+  
+  if(*startOfConversion == '%') { parsedCaptureReference->conversion = RKCaptureConversionScanf; return(YES); }
+  
+  if(RK_EXPECTED((*startOfConversion == '@'), 1) && (*(endOfConversion - 1) == 'd') && ((startOfConversion + 1) == (endOfConversion - 1))) { parsedCaptureReference->conversion = RKCaptureConversionDate; return(YES); }
+  if(RK_EXPECTED((*startOfConversion == '@'), 1) && (*(endOfConversion - 1) == 's') && ((startOfConversion + 1) == (endOfConversion - 1))) { parsedCaptureReference->conversion = RKCaptureConversionSubstring; return(YES); }
+  
+#ifdef HAVE_NSNUMBERFORMATTER_CONVERSIONS
+  if(RK_EXPECTED((*startOfConversion == '@'), 1) && (*(endOfConversion - 1) == 'n') && (((startOfConversion + 1) == (endOfConversion - 1)) || ((startOfConversion + 2) == (endOfConversion - 1)))) {
+    parsedCaptureReference->conversion = RKCaptureConversionNumber;
+    if((startOfConversion + 1) != (endOfConversion - 1)) {
+      switch(*(startOfConversion + 1)) {
+        case '.': case '$': case '%': case 's': case 'w': parsedCaptureReference->numberStyle = *(startOfConversion + 1); break;
+        default: *parseErrorMessage = RKParseErrorNSNumberConversionNotValid; return(NO); break;
+      }
+    }
+    return(YES);
+  }
+#endif // HAVE_NSNUMBERFORMATTER_CONVERSIONS
+  
+  *parseErrorMessage = RKParseErrorUnknownTypeConversion;
+  return(NO);
+}
+
+static BOOL RKConvertParsedCaptureReference(RK_STRONG_REF const RKParsedCaptureReference * const RK_C99(restrict) parsedCaptureReference, RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) subjectBuffer,
+                                            RK_STRONG_REF const NSRange * const RK_C99(restrict) subjectMatchResultRanges, RKRegex * const RK_C99(restrict) regex, RK_STRONG_REF void * const RK_C99(restrict) conversionPtr,
+                                            RK_STRONG_REF void *** const RK_C99(restrict) autoreleasePool, RK_STRONG_REF RKUInteger * const RK_C99(restrict) autoreleasePoolIndex, RK_STRONG_REF RKParseErrorMessage * const RK_C99(restrict) parseErrorMessage) {
+  NSCParameterAssert(parsedCaptureReference != NULL); NSCParameterAssert(subjectBuffer != NULL); NSCParameterAssert(subjectMatchResultRanges != NULL); NSCParameterAssert(parseErrorMessage != NULL);
+  
+  const NSRange                  captureRange      = subjectMatchResultRanges[parsedCaptureReference->captureIndex];
+  RK_STRONG_REF const char      *captureCharacters = (subjectBuffer->characters + captureRange.location);
+  const RKCaptureConversionType  conversion        = parsedCaptureReference->conversion;
+  const BOOL                     createMutableConvertedString = NO;
+  id                             convertedString   = NULL;
+  
+  NSCParameterAssert(captureRange.location != NSNotFound);
+  NSCParameterAssert((captureRange.location + captureRange.length) <= subjectBuffer->length);
+  
+  if(RK_EXPECTED(conversionPtr == NULL, 0)) { *parseErrorMessage = RKParseErrorStoragePointerNull; return(NO); }
+  
+  if(conversion == RKCaptureConversionScanf) {
+    RK_STRONG_REF const char * RK_C99(restrict) startOfConversion = parsedCaptureReference->format;
+    const RKUInteger                            formatLength      = parsedCaptureReference->formatLength, convertLength = captureRange.length;
+    RK_STRONG_REF       char * RK_C99(restrict) convertBuffer     = NULL; char convertStackBuffer[1024];
+    RK_STRONG_REF       char * RK_C99(restrict) formatBuffer      = NULL; char formatStackBuffer[1024]; // If it fits in our *stackBuffer, use that, otherwise grab an autoreleasedMalloc to hold the characters.
+    
+    // Fast, inline bypass for the common integer and floating point conversions.
+    if(RK_EXPECTED(RKConvertNumericCharacters(captureCharacters, convertLength, startOfConversion, formatLength, conversionPtr) == YES, 1)) { return(YES); }
+    
+    if(RK_EXPECTED(convertLength < 1020, 1)) { memcpy(&convertStackBuffer[0], captureCharacters, convertLength); convertBuffer = &convertStackBuffer[0]; }
+    else { convertBuffer = RKAutoreleasedMalloc(convertLength + 1); memcpy(&convertBuffer[0], captureCharacters, convertLength); }
+    convertBuffer[convertLength] = 0;
+    
+    if(RK_EXPECTED(formatLength < 1020, 1)) { memcpy(&formatStackBuffer[0], startOfConversion, formatLength); formatBuffer = &formatStackBuffer[0]; } 
+    else { formatBuffer = RKAutoreleasedMalloc(formatLength + 1); memcpy(&formatBuffer[0], startOfConversion, formatLength); }
+    formatBuffer[formatLength] = 0;
+    
+    if(RK_EXPECTED((convertBuffer != NULL), 1) && RK_EXPECTED((formatBuffer != NULL), 1)) {
+      RK_PROBE(PERFORMANCENOTE, regex, [regex hash], (char *)regexUTF8String(regex), 0, -1, 0, "Slow conversion via sscanf.");
+      sscanf(convertBuffer, formatBuffer, conversionPtr); 
+    }
+    return(YES);
+  }
+  
+#ifdef HAVE_NSNUMBERFORMATTER_CONVERSIONS
+  // A plain run of digits converts to the same value without creating a string for NSNumberFormatter in its default style.
+  if((conversion == RKCaptureConversionNumber) && (parsedCaptureReference->numberStyle == 0) && (captureRange.length > 0)) {
+    RKUInteger digitsIndex = captureRange.location, digitsEnd = NSMaxRange(captureRange);
+    uint64_t   digitsValue = 0;
+    if((RKAccumulateDecimalDigits(subjectBuffer->characters, digitsEnd, &digitsIndex, &digitsValue, 15) > 0) && (digitsIndex == digitsEnd)) { *((NSNumber **)conversionPtr) = [NSNumber numberWithLongLong:(long long)digitsValue]; return(YES); }
+  }
+#endif // HAVE_NSNUMBERFORMATTER_CONVERSIONS
+  if(conversion == RKCaptureConversionDate) {
+    NSDate *fixedFormatDate = RKDateFromFixedFormatCharacters(captureCharacters, captureRange.length);
+    if(fixedFormatDate != NULL) { *((NSDate **)conversionPtr) = fixedFormatDate; return(YES); }
+    RK_PROBE(PERFORMANCENOTE, regex, [regex hash], (char *)regexUTF8String(regex), 0, -1, 0, "Slow, serialized NSDate conversion via dateWithNaturalLanguageString:.");
+  }
+  
+  // A substring refers to the subjects characters instead of copying them.
+  if(conversion == RKCaptureConversionSubstring) { convertedString = RKSubstringCreateWithStringBuffer(subjectBuffer, captureRange); }
+  else {
+#ifdef USE_CORE_FOUNDATION
+    if(RK_EXPECTED(createMutableConvertedString == NO, 1)) { convertedString = RKMakeCollectable(CFStringCreateWithBytes(NULL, (const UInt8 *)captureCharacters, (CFIndex)captureRange.length, kCFStringEncodingUTF8, NO));
+    } else { convertedString = [[NSMutableString alloc] initWithBytes:captureCharacters length:captureRange.length encoding:NSUTF8StringEncoding]; }
+#else  // USE_CORE_FOUNDATION is not defined
+    if(RK_EXPECTED(createMutableConvertedString == YES, 0)) { convertedString = [[NSMutableString alloc] initWithBytes:captureCharacters length:captureRange.length encoding:NSUTF8StringEncoding]; }
+    else { convertedString = [[NSString alloc] initWithBytes:captureCharacters length:captureRange.length encoding:NSUTF8StringEncoding]; }
+#endif // USE_CORE_FOUNDATION
+  }
+  if((autoreleasePool != NULL) && (RKRegexGarbageCollect == 0)) { autoreleasePool[*autoreleasePoolIndex] = (void *)convertedString; *autoreleasePoolIndex = *autoreleasePoolIndex + 1; }
+  if((autoreleasePool == NULL) && (RKRegexGarbageCollect == 0)) { RKAutorelease(convertedString); }
+
+  if((conversion == RKCaptureConversionString) || (conversion == RKCaptureConversionSubstring)) { *((NSString **)conversionPtr) = convertedString; return(YES); }
+  
+  if(conversion == RKCaptureConversionDate) {
+    static BOOL didPrintLockWarning = NO;
+    if(RK_EXPECTED(NSStringRKExtensionsInitialized == 0, 0)) { NSStringRKExtensionsInitializeFunction(); } 
+    if(RK_EXPECTED(RKFastLock(NSStringRKExtensionsNSDateLock) == NO, 0)) {
+      if(didPrintLockWarning == NO) { NSLog(@"Unable to acquire the NSDate access serialization lock.  Heavy concurrent date conversions may return incorrect results."); didPrintLockWarning = YES; }
+    }
+    *((NSDate **)conversionPtr) = [NSDate dateWithNaturalLanguageString:convertedString];
+    RKFastUnlock(NSStringRKExtensionsNSDateLock);
+    return(YES);
+  }
+#ifdef HAVE_NSNUMBERFORMATTER_CONVERSIONS
+  else if(conversion == RKCaptureConversionNumber) {
+    struct __RKThreadLocalData RK_STRONG_REF * RK_C99(restrict) tld = RKGetThreadLocalData();
+    if(RK_EXPECTED(tld == NULL, 0)) { *parseErrorMessage = RKParseErrorNotValid; return(NO); }
+    NSNumberFormatter * RK_C99(restrict) numberFormatter = RK_EXPECTED((tld->_numberFormatter == NULL), 0) ? RKGetThreadLocalNumberFormatter() : tld->_numberFormatter;
+    NSNumberFormatterStyle               numberStyle     = NSNumberFormatterNoStyle;
+    switch(parsedCaptureReference->numberStyle) {
+      case '.': numberStyle = NSNumberFormatterDecimalStyle;    break;
+      case '$': numberStyle = NSNumberFormatterCurrencyStyle;   break;
+      case '%': numberStyle = NSNumberFormatterPercentStyle;    break;
+      case 's': numberStyle = NSNumberFormatterScientificStyle; break;
+      case 'w': numberStyle = NSNumberFormatterSpellOutStyle;   break;
+      default:  numberStyle = NSNumberFormatterNoStyle;         break;
+    }
+    if(tld->_currentFormatterStyle != numberStyle) { tld->_currentFormatterStyle = numberStyle; [numberFormatter setNumberStyle:numberStyle]; }
+    *((NSNumber **)conversionPtr) = [numberFormatter numberFromString:convertedString];
+    return(YES);
+  }
+#endif // HAVE_NSNUMBERFORMATTER_CONVERSIONS
+  
+  *parseErrorMessage = RKParseErrorUnknownTypeConversion;
+  return(NO);
+}
+
 static BOOL RKParseReference(RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) referenceBuffer, const NSRange referenceRange,
                              RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) subjectBuffer, RK_STRONG_REF const NSRange * const RK_C99(restrict) subjectMatchResultRanges,
                              RKRegex * const RK_C99(restrict) regex, RK_STRONG_REF RKUInteger * const RK_C99(restrict) parsedReferenceUIntegerPtr,
                              RK_STRONG_REF void * const RK_C99(restrict) conversionPtr, const RKParseReferenceFlags parseReferenceOptions, RK_STRONG_REF NSRange * const RK_C99(restrict) parsedRangePtr,
-                             RK_STRONG_REF NSRange * const RK_C99(restrict) parsedReferenceRangePtr, NSString ** const RK_C99(restrict) errorString,
+                             RK_STRONG_REF NSRange * const RK_C99(restrict) parsedReferenceRangePtr, RK_STRONG_REF RKParsedCaptureReference * const RK_C99(restrict) parsedCaptureReferencePtr, NSString ** const RK_C99(restrict) errorString,
                              RK_STRONG_REF void *** const RK_C99(restrict) autoreleasePool, RK_STRONG_REF RKUInteger * const RK_C99(restrict) autoreleasePoolIndex, NSError **error) {
   NSCParameterAssert(referenceBuffer != NULL);
   NSCParameterAssert(regex           != NULL);
@@ -1181,7 +2399,7 @@ static BOOL RKParseReference(RK_STRONG_REF const RKStringBuffer * const RK_C99(r
   const BOOL strictReference   = (parseReferenceOptions & RKParseReferenceStrictReference)   != 0 ? YES : NO;
   const BOOL performConversion = (parseReferenceOptions & RKParseReferencePerformConversion) != 0 ? YES : NO;
   const BOOL checkCaptureName  = (parseReferenceOptions & RKParseReferenceCheckCaptureName)  != 0 ? YES : NO;
-        BOOL successfulParse   = NO, createMutableConvertedString = NO;
+        BOOL successfulParse   = NO;
   RKUInteger captureIndex      = 0;
   
   const char RK_STRONG_REF *startOfCaptureReference = captureReferenceBuffer.characters, RK_STRONG_REF *endOfCaptureReference = captureReferenceBuffer.characters;;
@@ -1256,128 +2474,17 @@ finishedParse:
   if(captureIndex != NSNotFound) {
     if(RK_EXPECTED(captureIndex >= [regex captureCount], 0)) { parseErrorMessage = RKParseErrorCaptureGreaterThanRegexCaptures; goto finishedParseError; }
 
-    if((performConversion == YES) && (subjectMatchResultRanges[captureIndex].location != NSNotFound)) {
-      NSCParameterAssert((subjectMatchResultRanges[captureIndex].location + subjectMatchResultRanges[captureIndex].length) <= subjectBuffer->length);
-      
-      id convertedString = NULL;
-      
-      if(startOfConversion != NULL) {
-        if(*startOfConversion == '%') {
-          RKUInteger convertLength = subjectMatchResultRanges[captureIndex].length;
-          RK_STRONG_REF       char * RK_C99(restrict) convertBuffer = NULL; char convertStackBuffer[1024];
-          RK_STRONG_REF const char * RK_C99(restrict) convertPtr    = (subjectBuffer->characters + subjectMatchResultRanges[captureIndex].location);
-          RK_STRONG_REF       char * RK_C99(restrict) formatBuffer  = NULL; char formatStackBuffer[1024]; // If it fits in our *stackBuffer, use that, otherwise grab an autoreleasedMalloc to hold the characters.
-          
-          if(RK_EXPECTED(convertLength < 1020, 1)) { memcpy(&convertStackBuffer[0], convertPtr, convertLength); convertBuffer = &convertStackBuffer[0]; }
-          else { convertBuffer = RKAutoreleasedMalloc(convertLength + 1); memcpy(&convertBuffer[0], convertPtr, convertLength); }
-          convertBuffer[convertLength] = 0;
-          
-          if(RK_EXPECTED((endOfConversion - startOfConversion) < 1020, 1)) { memcpy(&formatStackBuffer[0], startOfConversion, (endOfConversion - startOfConversion)); formatBuffer = &formatStackBuffer[0]; } 
-          else { formatBuffer = RKAutoreleasedMalloc((endOfConversion - startOfConversion) + 1); memcpy(&formatBuffer[0], startOfConversion, (endOfConversion - startOfConversion)); }
-          formatBuffer[(endOfConversion - startOfConversion)] = 0;
-          
-          if(RK_EXPECTED((convertBuffer != NULL), 1) && RK_EXPECTED((formatBuffer != NULL), 1)) {
-            if(formatBuffer[2] == 0) { // Fast, inline bypass if it's a simple (32 bit int) conversion.
-              BOOL unsignedConversion = NO;
-              
-              switch(formatBuffer[1]) {
-                case 'u': unsignedConversion = YES; // Fall-thru
-                case 'x': unsignedConversion = YES; // Fall-thru
-                case 'X': unsignedConversion = YES; // Fall-thru 
-                case 'd': // Fall-thru
-                case 'i': // Fall-thru
-                case 'o':
-                { // Modified from the libc conversion routine.
-                  int neg = 0, any = 0, cutlim = 0, base = 0;
-                  const char * RK_C99(restrict) s = &convertBuffer[0];
-                  unsigned int acc = 0, cutoff = 0;
-                  char c = 0;
-                  
-                  NSCParameterAssert(s != NULL);
-                  
-                  do { c = *s++; } while (isspace((unsigned char)c) && (s <= &convertBuffer[convertLength]));
-                  if(c == '-') { neg = 1; c = *s++; } else if (c == '+') { c = *s++; } 
-                  if((c == '0') && (*s == 'x' || *s == 'X') && (s <= &convertBuffer[convertLength])) { c = s[1]; s += 2; base = 16; } else { base = c == '0' ? 8 : 10; }
-                  
-                  if(unsignedConversion == YES) { cutoff = UINT_MAX / base; cutlim = UINT_MAX % base; } 
-                  else { cutoff = (neg ? (unsigned int)-(INT_MIN + INT_MAX) + INT_MAX : INT_MAX) / base; cutlim = cutoff % base; }
-                  
-                  do {
-                    if(c >= '0' && c <= '9') { c -= '0'; } else if(c >= 'A' && c <= 'F') { c -= 'A' - 10; } else if(c >= 'a' && c <= 'f') { c -= 'a' - 10; } else { break; }
-                    if(c >= base) {  break; }
-                    if(any < 0 || acc > cutoff || (acc == cutoff && c > cutlim)) { any = -1; }
-                    else { any = 1; acc *= base; acc += c; }
-                  } while(((c = *s++) != 0) && (s <= &convertBuffer[convertLength]));
-                  
-                  if(any < 0) { if(unsignedConversion == YES) { acc = UINT_MAX; } else { acc = neg ? INT_MIN : INT_MAX; } } else if(neg) { acc = -acc; }
-                  
-                  if(RK_EXPECTED(conversionPtr == NULL, 0)) { parseErrorMessage = RKParseErrorStoragePointerNull; goto finishedParseError; }
-                  *((int *)conversionPtr) = acc;
-                  goto finishedParseSuccess;
-                }
-                  break;
-                default: break; // Will fall thru to sscanf if we didn't fast bypass convert it here.
-              }
-            }
-            RK_PROBE(PERFORMANCENOTE, regex, [regex hash], (char *)regexUTF8String(regex), 0, -1, 0, "Slow conversion via sscanf.");
-            sscanf(convertBuffer, formatBuffer, conversionPtr); 
-          }
-          goto finishedParseSuccess;
-        }
-        
-        NSCParameterAssert(endOfConversion != NULL);
-        
-        // Before we create a string, check if it's something reasonable.
-        if( ! ( RK_EXPECTED((*startOfConversion == '@'), 1) && 
-                     ( ((*(endOfConversion - 1) == 'n') && (((startOfConversion + 1) == (endOfConversion - 1)) || ((startOfConversion + 2) == (endOfConversion - 1)))) ||
-                       ((*(endOfConversion - 1) == 'd') &&  ((startOfConversion + 1) == (endOfConversion - 1))) ))) { parseErrorMessage = RKParseErrorUnknownTypeConversion; goto finishedParseError; }
-      }
-#ifdef USE_CORE_FOUNDATION
-      if(RK_EXPECTED(createMutableConvertedString == NO, 1)) { convertedString = RKMakeCollectable(CFStringCreateWithBytes(NULL, (const UInt8 *)(&subjectBuffer->characters[subjectMatchResultRanges[captureIndex].location]), (CFIndex)subjectMatchResultRanges[captureIndex].length, kCFStringEncodingUTF8, NO));
-      } else { convertedString = [[NSMutableString alloc] initWithBytes:&subjectBuffer->characters[subjectMatchResultRanges[captureIndex].location] length:subjectMatchResultRanges[captureIndex].length encoding:NSUTF8StringEncoding]; }
-#else  // USE_CORE_FOUNDATION is not defined
-      if(RK_EXPECTED(createMutableConvertedString == YES, 0)) { convertedString = [[NSMutableString alloc] initWithBytes:&subjectBuffer->characters[subjectMatchResultRanges[captureIndex].location] length:subjectMatchResultRanges[captureIndex].length encoding:NSUTF8StringEncoding]; }
-      else { convertedString = [[NSString alloc] initWithBytes:&subjectBuffer->characters[subjectMatchResultRanges[captureIndex].location] length:subjectMatchResultRanges[captureIndex].length encoding:NSUTF8StringEncoding]; }
-#endif // USE_CORE_FOUNDATION
-      if((autoreleasePool != NULL) && (RKRegexGarbageCollect == 0)) { autoreleasePool[*autoreleasePoolIndex] = (void *)convertedString; *autoreleasePoolIndex = *autoreleasePoolIndex + 1; }
-      if((autoreleasePool == NULL) && (RKRegexGarbageCollect == 0)) { RKAutorelease(convertedString); }
-
-      if(startOfConversion == NULL) { *((NSString **)conversionPtr) = convertedString; goto finishedParseSuccess; }
+    const BOOL convertCapture = ((performConversion == YES) && (subjectMatchResultRanges[captureIndex].location != NSNotFound)) ? YES : NO;
+    
+    if((convertCapture == YES) || (parsedCaptureReferencePtr != NULL)) {
+      RKParsedCaptureReference parsedCaptureReference;
       
-      if(RK_EXPECTED((*startOfConversion == '@'), 1) && RK_EXPECTED((*(endOfConversion - 1) == 'd'), 1) && RK_EXPECTED(((startOfConversion + 1) == (endOfConversion - 1)), 1)) {
-        static BOOL didPrintLockWarning = NO;
-        if(RK_EXPECTED(NSStringRKExtensionsInitialized == 0, 0)) { NSStringRKExtensionsInitializeFunction(); } 
-        if(RK_EXPECTED(RKFastLock(NSStringRKExtensionsNSDateLock) == NO, 0)) {
-          if(didPrintLockWarning == NO) { NSLog(@"Unable to acquire the NSDate access serialization lock.  Heavy concurrent date conversions may return incorrect results."); didPrintLockWarning = YES; }
-        }
-        *((NSDate **)conversionPtr) = [NSDate dateWithNaturalLanguageString:convertedString];
-        RKFastUnlock(NSStringRKExtensionsNSDateLock);
-        goto finishedParseSuccess;
-      }
-#ifdef HAVE_NSNUMBERFORMATTER_CONVERSIONS
-      else if(RK_EXPECTED((*startOfConversion == '@'), 1) && (*(endOfConversion - 1) == 'n') && (((startOfConversion + 1) == (endOfConversion - 1)) || ((startOfConversion + 2) == (endOfConversion - 1)))) {
-        struct __RKThreadLocalData RK_STRONG_REF * RK_C99(restrict) tld = RKGetThreadLocalData();
-        if(RK_EXPECTED(tld == NULL, 0)) { parseErrorMessage = RKParseErrorNotValid; goto finishedParseError; }
-        NSNumberFormatter * RK_C99(restrict) numberFormatter = RK_EXPECTED((tld->_numberFormatter == NULL), 0) ? RKGetThreadLocalNumberFormatter() : tld->_numberFormatter;
-        if((startOfConversion + 1) != (endOfConversion - 1)) {
-          switch(*(startOfConversion + 1)) {
-            case '.': if(tld->_currentFormatterStyle != NSNumberFormatterDecimalStyle)    { tld->_currentFormatterStyle = NSNumberFormatterDecimalStyle;    [numberFormatter setNumberStyle:NSNumberFormatterDecimalStyle]; }    break;
-            case '$': if(tld->_currentFormatterStyle != NSNumberFormatterCurrencyStyle)   { tld->_currentFormatterStyle = NSNumberFormatterCurrencyStyle;   [numberFormatter setNumberStyle:NSNumberFormatterCurrencyStyle]; }   break;
-            case '%': if(tld->_currentFormatterStyle != NSNumberFormatterPercentStyle)    { tld->_currentFormatterStyle = NSNumberFormatterPercentStyle;    [numberFormatter setNumberStyle:NSNumberFormatterPercentStyle]; }    break;
-            case 's': if(tld->_currentFormatterStyle != NSNumberFormatterScientificStyle) { tld->_currentFormatterStyle = NSNumberFormatterScientificStyle; [numberFormatter setNumberStyle:NSNumberFormatterScientificStyle]; } break;
-            case 'w': if(tld->_currentFormatterStyle != NSNumberFormatterSpellOutStyle)   { tld->_currentFormatterStyle = NSNumberFormatterSpellOutStyle;   [numberFormatter setNumberStyle:NSNumberFormatterSpellOutStyle]; }   break;
-            default: parseErrorMessage = RKParseErrorNSNumberConversionNotValid; goto finishedParseError; break;
-          }
-        } else { if(tld->_currentFormatterStyle != NSNumberFormatterNoStyle) { tld->_currentFormatterStyle = NSNumberFormatterNoStyle; [numberFormatter setNumberStyle:NSNumberFormatterNoStyle]; } }
-        *((NSNumber **)conversionPtr) = [numberFormatter numberFromString:convertedString];
-        goto finishedParseSuccess;
-      }
-#endif // HAVE_NSNUMBERFORMATTER_CONVERSIONS
-      else { parseErrorMessage = RKParseErrorUnknownTypeConversion; goto finishedParseError; }
+      if(RKMakeParsedCaptureReference(captureIndex, startOfConversion, endOfConversion, &parsedCaptureReference, &parseErrorMessage) == NO) { goto finishedParseError; }
+      if(parsedCaptureReferencePtr != NULL) { *parsedCaptureReferencePtr = parsedCaptureReference; }
+      if((convertCapture == YES) && (RKConvertParsedCaptureReference(&parsedCaptureReference, subjectBuffer, subjectMatchResultRanges, regex, conversionPtr, autoreleasePool, autoreleasePoolIndex, &parseErrorMessage) == NO)) { goto finishedParseError; }
     }
   }
   
-finishedParseSuccess:
   successfulParse = YES;
   goto finishedExit;
   
@@ -1480,20 +2587,16 @@ static void dumpReferenceInstructions(RK_STRONG_REF const RKReferenceInstruction
 }
 
 
-static void dumpCopyInstructions(RK_STRONG_REF const RKCopyInstructionsBuffer *ins) {
-  if(ins == NULL) { NSLog(@"NULL copy instructions"); return; }
-  NSLog(@"Copy instructions");
-  NSLog(@"isValid      : %@",  RKYesOrNo(ins->isValid));
-  NSLog(@"Length       : %lu", (unsigned long)ins->length);
-  NSLog(@"Capacity     : %lu", (unsigned long)ins->capacity);
-  NSLog(@"Copied length: %lu", (unsigned long)ins->copiedLength);
-  NSLog(@"Instructions : %p",  ins->instructions);
-  NSLog(@"mutableData  : %p",  ins->mutableData);
-  
-  for(RKUInteger x = 0; x < ins->length; x++) {
-    RKCopyInstruction *at = &ins->instructions[x];
-    NSLog(@"[%4lu] ptr: %p - %p length %lu (0x%8.8lx) = '%*.*s'", (unsigned long)x, at->ptr, at->ptr + at->length, (unsigned long)at->length, (unsigned long)at->length, (int)min(at->length, (unsigned)16), (int)min(at->length, (unsigned)16), at->ptr); 
-  }
+static void dumpOutputBuffer(RK_STRONG_REF const RKOutputBuffer *outputBuffer) {
+  if(outputBuffer == NULL) { NSLog(@"NULL output buffer"); return; }
+  NSLog(@"Output buffer");
+  NSLog(@"isValid        : %@",  RKYesOrNo(outputBuffer->isValid));
+  NSLog(@"isHeapAllocated: %@",  RKYesOrNo(outputBuffer->isHeapAllocated));
+  NSLog(@"Length         : %lu", (unsigned long)outputBuffer->length);
+  NSLog(@"Capacity       : %lu", (unsigned long)outputBuffer->capacity);
+  NSLog(@"Bytes          : %p",  outputBuffer->bytes);
+  NSLog(@"mutableData    : %p",  outputBuffer->mutableData);
+  if((outputBuffer->bytes != NULL) && (outputBuffer->mutableData == NULL)) { NSLog(@"Contents       : '%*.*s'", (int)outputBuffer->length, (int)outputBuffer->length, outputBuffer->bytes); }
 }
 
 #endif // REGEXKIT_DEBUG
@@ -134,7 +134,7 @@ RKUInteger  intPointerFunctionsSize(const void *item RK_ATTRIBUTES(unused)) { re
   RKAutorelease(self);
     
   if(RKAtomicCompareAndSwapInt(0, 1, &cacheInitialized)) {
-    if(RK_EXPECTED((cacheRWLock = [[RKReadWriteLock alloc] init]) == NULL, 0)) { NSLog(@"Unable to initialize cache lock, caching is disabled."); goto errorExit; }
+    if(RK_EXPECTED((cacheRWLock = [[RKReadWriteLock alloc] initWithDistributedReaders:YES]) == NULL, 0)) { NSLog(@"Unable to initialize cache lock, caching is disabled."); goto errorExit; }
     else {
       if(RK_EXPECTED([self clearCache] == NO, 0)) { NSLog(@"Unable to create cache hash map."); goto errorExit; }
       cacheClearedCount = 0;
@@ -159,6 +159,7 @@ errorExit:
 {
   if(cacheDescriptionString != NULL) { RKAutorelease(cacheDescriptionString); cacheDescriptionString = NULL; }
   if(descriptionString      != NULL) { cacheDescriptionString = RKRetain(descriptionString);                 }
+  [cacheRWLock setProfileName:descriptionString];
 }
 
 const char *cacheUTF8String(RKCache *self) {
@@ -0,0 +1,333 @@
+//
+//  RKCaptureExtractor.m
+//  RegexKit
+//  http://regexkit.sourceforge.net/
+//
+
+/*
+ Copyright © 2007-2008, John Engelhart
+ 
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+ notice, this list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright
+ notice, this list of conditions and the following disclaimer in the
+ documentation and/or other materials provided with the distribution.
+ 
+ * Neither the name of the Zang Industries nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#import <RegexKit/RKCaptureExtractor.h>
+#import <RegexKit/RegexKitPrivate.h>
+
+// The options used by the NSString, RKRegex, and RKEnumerator capture extraction methods, so they all share the same cached extractors.
+#define RK_CAPTURE_EXTRACTOR_OPTIONS (RKCaptureExtractAllowConversions | RKCaptureExtractStrictReference)
+
+static RKCache *RKCaptureExtractorCache = NULL;
+
+static RKUInteger          RKCaptureExtractorHashForKeys(RKRegex * const regex, NSString ** const RK_C99(restrict) keyStrings, const RKUInteger count, const RKCaptureExtractOptions captureExtractOptions) RK_ATTRIBUTES(nonnull(1), used);
+static RKCaptureExtractor *RKCaptureExtractorLookup(const SEL _cmd, const RKUInteger captureExtractorHash, RKRegex * const regex, NSString ** const RK_C99(restrict) keyStrings, const RKUInteger count, const RKCaptureExtractOptions captureExtractOptions) RK_ATTRIBUTES(nonnull(3), used);
+static RKCaptureExtractor *RKCaptureExtractorInit(RKCaptureExtractor *self, const SEL _cmd, RKRegex * const regex, NSArray * const initReferences, NSString ** const RK_C99(restrict) keyStrings, const RKUInteger count, const RKCaptureExtractOptions initCaptureExtractOptions, NSError **error) RK_ATTRIBUTES(nonnull(1, 3), used);
+static void                releaseRKCaptureExtractorResources(RKCaptureExtractor * const self) RK_ATTRIBUTES(nonnull(1), used);
+
+@implementation RKCaptureExtractor
+
++ (void)initialize
+{
+  RKAtomicMemoryBarrier(); // Extra cautious
+  
+  if(RKCaptureExtractorCache == NULL) {
+    RKCache *tmpCache = RKAutorelease([[RKCache alloc] initWithDescription:RKLocalizedString(@"Capture Extractor Cache")]);
+    if(RKAtomicCompareAndSwapPtr(NULL, tmpCache, &RKCaptureExtractorCache)) { RKRetain(RKCaptureExtractorCache); RKDisableCollectorForPointer(RKCaptureExtractorCache); }
+  }
+}
+
++ (RKCache *)captureExtractorCache
+{
+  return(RKAutorelease(RKRetain(RKCaptureExtractorCache)));
+}
+
++ (RKCaptureExtractor *)captureExtractorWithRegex:(id)aRegex references:(NSArray * const)referencesArray
+{
+  RKCaptureExtractor *captureExtractor = NULL;
+  NSError            *initError        = NULL;
+  
+  captureExtractor = [self captureExtractorWithRegex:aRegex references:referencesArray error:&initError];
+  if(RK_EXPECTED(initError != NULL, 0)) {
+    if(([[initError domain] isEqualToString:RKRegexErrorDomain] == YES) && ([[initError userInfo] objectForKey:RKRegexStringErrorKey] != NULL)) { [RKExceptionFromInitFailureForOlderAPI(self, _cmd, initError) raise]; }
+    [[NSException exceptionWithName:RKRegexCaptureReferenceException reason:[initError localizedDescription] userInfo:NULL] raise];
+  }
+  
+  return(captureExtractor);
+}
+
++ (RKCaptureExtractor *)captureExtractorWithRegex:(id)aRegex references:(NSArray * const)referencesArray error:(NSError **)error
+{
+  return(RKAutorelease([[self alloc] initWithRegex:aRegex references:referencesArray error:error]));
+}
+
+// XXX WARNING: This code uses alloca().  If you do not -=COMPLETELY=- understand what alloca() does, you MUST NOT alter this code.
+- (id)initWithRegex:(id)aRegex references:(NSArray * const)referencesArray error:(NSError **)error
+{
+  RKCaptureExtractor  *cachedCaptureExtractor = NULL;
+  RKRegex             *initRegex              = NULL;
+  NSString           **keyStrings             = NULL;
+  RKUInteger           keyCount               = 0, initHash = 0;
+  NSError             *initError              = NULL;
+  
+  if(error != NULL) { *error = NULL; }
+  
+  if((self = [self init]) == NULL) { goto errorExit; }
+  RKAutorelease(self);
+  
+  if(RK_EXPECTED(referencesArray == NULL, 0)) { [[NSException rkException:NSInvalidArgumentException for:self selector:_cmd localizeReason:@"The referencesArray argument is NULL."] raise]; goto errorExit; }
+  
+  if((initRegex = RKRegexFromStringOrRegexWithError(self, _cmd, aRegex, RKRegexPCRELibrary, (RKCompileUTF8 | RKCompileNoUTF8Check), &initError, NO)) == NULL) { NSCParameterAssert(initError != NULL); goto errorExit; }
+  
+  keyCount = [referencesArray count];
+  if(RK_EXPECTED((keyStrings = alloca(sizeof(NSString *) * (keyCount + 1))) == NULL, 0)) { [[NSException rkException:NSMallocException for:self selector:_cmd localizeReason:@"Unable to allocate temporary stack space."] raise]; goto errorExit; }
+  [referencesArray getObjects:keyStrings];
+  
+  initHash = RKCaptureExtractorHashForKeys(initRegex, keyStrings, keyCount, RK_CAPTURE_EXTRACTOR_OPTIONS);
+  if(RK_EXPECTED((cachedCaptureExtractor = RKCaptureExtractorLookup(_cmd, initHash, initRegex, keyStrings, keyCount, RK_CAPTURE_EXTRACTOR_OPTIONS)) != NULL, 1)) { RKRelease(initRegex); return(cachedCaptureExtractor); }
+  
+  if(RKCaptureExtractorInit(self, _cmd, initRegex, referencesArray, keyStrings, keyCount, RK_CAPTURE_EXTRACTOR_OPTIONS, &initError) == NULL) { goto errorExit; }
+  
+  return(RKRetain(self));
+  
+errorExit:
+  if(initRegex != NULL) { RKRelease(initRegex); initRegex = NULL; }
+  if(RK_EXPECTED(initError != NULL, 0) && (error != NULL)) { *error = initError; }
+  return(NULL);
+}
+
+//
+// Used by RKExtractCapturesFromMatchesWithKeyArgumentsX to find the parsed references for the keys of a capture extraction,
+// creating and caching them the first time the keys are used with regex.  Returns a retained extractor, or NULL if any of the
+// keys could not be parsed, in which case the caller parses the keys itself so any errors are reported in the usual way.
+//
+
+RKCaptureExtractor *RKCaptureExtractorForKeys(RKRegex * const regex, NSString ** const RK_C99(restrict) keyStrings, const RKUInteger count, const RKCaptureExtractOptions captureExtractOptions) {
+  RKCaptureExtractor *captureExtractor     = NULL;
+  RKUInteger          captureExtractorHash = 0;
+  NSError            *initError            = NULL;
+  
+  if(RK_EXPECTED(RKCaptureExtractorCache == NULL, 0)) { [RKCaptureExtractor class]; } // Forces +initialize.
+  
+  captureExtractorHash = RKCaptureExtractorHashForKeys(regex, keyStrings, count, captureExtractOptions);
+  if(RK_EXPECTED((captureExtractor = RKCaptureExtractorLookup(NULL, captureExtractorHash, regex, keyStrings, count, captureExtractOptions)) != NULL, 1)) { return(captureExtractor); }
+  
+  if(RK_EXPECTED((captureExtractor = [RKCaptureExtractor alloc]) == NULL, 0)) { return(NULL); }
+  if((captureExtractor = [captureExtractor init]) == NULL) { return(NULL); }
+  
+  if(RKCaptureExtractorInit(captureExtractor, NULL, RKRetain(regex), [NSArray arrayWithObjects:keyStrings count:count], keyStrings, count, captureExtractOptions, &initError) == NULL) { RKRelease(regex); RKRelease(captureExtractor); return(NULL); }
+  
+  return(captureExtractor);
+}
+
+const RKParsedCaptureReference *RKCaptureExtractorParsedReferences(RKCaptureExtractor * const self) {
+  return((const RKParsedCaptureReference *)self->parsedReferences);
+}
+
+static RKUInteger RKCaptureExtractorHashForKeys(RKRegex * const regex, NSString ** const RK_C99(restrict) keyStrings, const RKUInteger count, const RKCaptureExtractOptions captureExtractOptions) {
+  RKUInteger captureExtractorHash = ([regex hash] ^ (captureExtractOptions << 3) ^ (RKUInteger)0x3c3c3c3c), x = 0;
+  for(x = 0; x < count; x++) { captureExtractorHash = ((captureExtractorHash << 5) | (captureExtractorHash >> ((sizeof(RKUInteger) * 8) - 5))) ^ [keyStrings[x] hash]; }
+  return(captureExtractorHash);
+}
+
+static RKCaptureExtractor *RKCaptureExtractorLookup(const SEL _cmd, const RKUInteger captureExtractorHash, RKRegex * const regex, NSString ** const RK_C99(restrict) keyStrings, const RKUInteger count, const RKCaptureExtractOptions captureExtractOptions) {
+  RKCaptureExtractor *cachedCaptureExtractor = NULL;
+  RKUInteger          x                      = 0;
+  
+  if((cachedCaptureExtractor = RKFastCacheLookup(RKCaptureExtractorCache, _cmd, captureExtractorHash, ((count > 0) ? keyStrings[0] : @""), NO)) == NULL) { return(NULL); }
+  
+  if((cachedCaptureExtractor->referencesCount != count) || (cachedCaptureExtractor->captureExtractOptions != captureExtractOptions) || ([cachedCaptureExtractor->regex isEqual:regex] == NO)) { goto hashCollision; }
+  for(x = 0; x < count; x++) {
+    if(RK_EXPECTED(cachedCaptureExtractor->referenceStrings[x] == keyStrings[x], 1)) { continue; } // The keys are usually the very same literal strings.
+    if([cachedCaptureExtractor->referenceStrings[x] isEqualToString:keyStrings[x]] == NO) { goto hashCollision; }
+  }
+  
+  return(cachedCaptureExtractor);
+  
+hashCollision:
+  RKRelease(cachedCaptureExtractor); // Parse the keys again, they just won't be able to replace the cached extractor.
+  return(NULL);
+}
+
+// Takes ownership of the retained regex.  On failure, the caller must still release regex, everything else is released with self.
+static RKCaptureExtractor *RKCaptureExtractorInit(RKCaptureExtractor *self, const SEL _cmd, RKRegex * const initRegex, NSArray * const initReferences, NSString ** const RK_C99(restrict) keyStrings, const RKUInteger count, const RKCaptureExtractOptions initCaptureExtractOptions, NSError **error) {
+  RKUInteger     charactersLength = 0, charactersIndex = 0, x = 0;
+  NSError       *initError        = NULL;
+  RKStringBuffer keyBuffer;
+  
+  for(x = 0; x < count; x++) {
+    if(RK_EXPECTED(keyStrings[x] == NULL, 0)) { initError = [NSError rkErrorWithDomain:RKRegexErrorDomain code:0 localizeDescription:@"A capture reference is NULL."]; goto errorExit; }
+    keyBuffer = RKStringBufferWithString(keyStrings[x]);
+    if(RK_EXPECTED(keyBuffer.characters == NULL, 0)) { initError = [NSError rkErrorWithDomain:NSCocoaErrorDomain code:0 localizeDescription:@"Unable to convert the capture reference to UTF8."]; goto errorExit; }
+    charactersLength += (keyBuffer.length + 1);
+  }
+  
+  // The parsed references point directly in to the reference characters, so we keep our own copy that lives as long as we do.
+  if(RK_EXPECTED((self->referenceCharacters = RKMallocNotScanned(charactersLength + 1))                            == NULL, 0)) { goto allocationError; }
+  if(RK_EXPECTED((self->parsedReferences    = RKMallocNotScanned(sizeof(RKParsedCaptureReference) * (count + 1))) == NULL, 0)) { goto allocationError; }
+  if(RK_EXPECTED((self->referenceStrings    = RKMallocNotScanned(sizeof(NSString *) * (count + 1)))                == NULL, 0)) { goto allocationError; }
+  
+  for(x = 0; x < count; x++) {
+    keyBuffer = RKStringBufferWithString(keyStrings[x]);
+    memcpy(&self->referenceCharacters[charactersIndex], keyBuffer.characters, keyBuffer.length);
+    self->referenceCharacters[charactersIndex + keyBuffer.length] = 0;
+    keyBuffer.characters = &self->referenceCharacters[charactersIndex];
+    charactersIndex += (keyBuffer.length + 1);
+    
+    if(RKParseCaptureReferenceX(self, _cmd, &keyBuffer, initRegex, initCaptureExtractOptions, &((RKParsedCaptureReference *)self->parsedReferences)[x], &initError) == NO) {
+      if(initError == NULL) { initError = [NSError rkErrorWithDomain:RKRegexErrorDomain code:0 localizeDescription:@"The capture reference '%@' is not valid.", keyStrings[x]]; }
+      goto errorExit;
+    }
+  }
+  
+  self->regex                 = initRegex;
+  self->references            = [initReferences copy];
+  [self->references getObjects:self->referenceStrings];
+  self->referencesCount       = count;
+  self->captureExtractOptions = initCaptureExtractOptions;
+  self->captureExtractorHash  = RKCaptureExtractorHashForKeys(initRegex, self->referenceStrings, count, initCaptureExtractOptions);
+  
+  [RKCaptureExtractorCache addObjectToCache:self withHash:self->captureExtractorHash];
+  
+  return(self);
+  
+allocationError:
+  initError = [NSError rkErrorWithDomain:NSPOSIXErrorDomain code:0 localizeDescription:@"Unable to allocate memory for the parsed capture references."];
+errorExit:
+  releaseRKCaptureExtractorResources(self);
+  if(error != NULL) { *error = initError; }
+  return(NULL);
+}
+
+- (void)dealloc
+{
+  releaseRKCaptureExtractorResources(self);
+  [super dealloc];
+}
+
+#ifdef    ENABLE_MACOSX_GARBAGE_COLLECTION
+- (void)finalize
+{
+  releaseRKCaptureExtractorResources(self);
+  [super finalize];
+}
+#endif // ENABLE_MACOSX_GARBAGE_COLLECTION
+
+static void releaseRKCaptureExtractorResources(RKCaptureExtractor * const self) {
+  if(self->regex               != NULL) { RKRelease(self->regex);      self->regex      = NULL; }
+  if(self->references          != NULL) { RKRelease(self->references); self->references = NULL; }
+  if(self->referenceStrings    != NULL) { RKFreeAndNULL(self->referenceStrings);                 }
+  if(self->referenceCharacters != NULL) { RKFreeAndNULL(self->referenceCharacters);              }
+  if(self->parsedReferences    != NULL) { RKFreeAndNULL(self->parsedReferences);                 }
+  self->referencesCount = 0;
+}
+
+- (RKUInteger)hash
+{
+  return(captureExtractorHash);
+}
+
+- (BOOL)isEqual:(id)anObject
+{
+  BOOL equal = NO;
+  RKCaptureExtractor *captureExtractorObject = anObject;
+  if(self == anObject)                                                                 { equal = YES; goto exitNow; }
+  if([anObject isKindOfClass:[RKCaptureExtractor class]] == NO)                        { equal = NO;  goto exitNow; }
+  if(captureExtractorHash  != captureExtractorObject->captureExtractorHash)            { equal = NO;  goto exitNow; }
+  if(captureExtractOptions != captureExtractorObject->captureExtractOptions)           { equal = NO;  goto exitNow; }
+  if([regex isEqual:captureExtractorObject->regex] == NO)                              { equal = NO;  goto exitNow; }
+  if([references isEqualToArray:captureExtractorObject->references] == NO)             { equal = NO;  goto exitNow; }
+  equal = YES;
+  
+exitNow:
+  return(equal);
+}
+
+- (NSString *)description
+{
+  return(RKLocalizedFormat(@"<%@: %p> Regular expression = '%@', References = %@", [self className], self, [regex regexString], references));
+}
+
+- (RKRegex *)regex
+{
+  return(RKAutorelease(RKRetain(regex)));
+}
+
+- (NSArray *)references
+{
+  return(RKAutorelease(RKRetain(references)));
+}
+
+// XXX WARNING: This code uses alloca().  If you do not -=COMPLETELY=- understand what alloca() does, you MUST NOT alter this code.
+- (BOOL)getCapturesFromString:(NSString * const)subjectString pointers:(void *)firstPointer, ...
+{
+  void     **pointers     = NULL;
+  NSError   *extractError = NULL;
+  BOOL       didExtract   = NO;
+  RKUInteger x            = 0;
+  va_list    varArgsList;
+  
+  if(RK_EXPECTED(subjectString == NULL, 0)) { [[NSException rkException:NSInvalidArgumentException for:self selector:_cmd localizeReason:@"The subjectString argument is NULL."] raise]; }
+  if(RK_EXPECTED((pointers = alloca(sizeof(void *) * (referencesCount + 1))) == NULL, 0)) { [[NSException rkException:NSMallocException for:self selector:_cmd localizeReason:@"Unable to allocate temporary stack space."] raise]; }
+  
+  va_start(varArgsList, firstPointer);
+  for(x = 0; x < referencesCount; x++) { pointers[x] = (x == 0) ? firstPointer : va_arg(varArgsList, void *); }
+  va_end(varArgsList);
+  
+  didExtract = [self getCapturesFromString:subjectString inRange:NSMakeRange(0, [subjectString length]) pointers:pointers error:&extractError];
+  if(extractError != NULL) { [[NSException exceptionWithName:RKRegexCaptureReferenceException reason:[extractError localizedDescription] userInfo:NULL] raise]; }
+  
+  return(didExtract);
+}
+
+// XXX WARNING: This code uses alloca().  If you do not -=COMPLETELY=- understand what alloca() does, you MUST NOT alter this code.
+- (BOOL)getCapturesFromString:(NSString * const)subjectString inRange:(const NSRange)range pointers:(void ** const)pointers error:(NSError **)error
+{
+  NSRange RK_STRONG_REF * RK_C99(restrict) matchRanges = NULL;
+  RKUInteger                               captureCount = [regex captureCount];
+  NSError                                 *extractError = NULL;
+  BOOL                                     didExtract   = NO;
+  RKStringBuffer                           subjectStringBuffer;
+  
+  if(RK_EXPECTED(subjectString == NULL, 0))                          { [[NSException rkException:NSInvalidArgumentException for:self selector:_cmd localizeReason:@"The subjectString argument is NULL."] raise]; }
+  if(RK_EXPECTED((pointers == NULL) && (referencesCount > 0), 0))    { [[NSException rkException:NSInvalidArgumentException for:self selector:_cmd localizeReason:@"The pointers argument is NULL."]      raise]; }
+  
+  subjectStringBuffer = RKStringBufferWithString(subjectString);
+  if(RK_EXPECTED(subjectStringBuffer.characters == NULL, 0)) { goto exitNow; }
+  if(RK_EXPECTED((matchRanges = alloca(RK_PRESIZE_CAPTURE_COUNT(captureCount) * sizeof(NSRange))) == NULL, 0)) { goto exitNow; }
+  
+  if([regex getRanges:matchRanges count:RK_PRESIZE_CAPTURE_COUNT(captureCount) withCharacters:subjectStringBuffer.characters length:subjectStringBuffer.length inRange:RKutf16to8(subjectString, range) options:RKMatchNoUTF8Check error:&extractError] <= 0) { goto exitNow; }
+  
+  didExtract = RKExtractCapturesFromMatchesWithKeysAndPointers(self, _cmd, &subjectStringBuffer, regex, matchRanges, referenceStrings, (const RKParsedCaptureReference *)parsedReferences, (void ***)pointers, referencesCount, captureExtractOptions, &extractError);
+  if(extractError != NULL) { didExtract = NO; }
+  
+exitNow:
+  if(error != NULL) { *error = extractError; }
+  return(didExtract);
+}
+
+@end
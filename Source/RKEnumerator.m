@@ -110,6 +110,10 @@
   atBufferLocation  = searchByteRange.location;
   hasPerformedMatch = 0;
 
+  // A known pair of equivalent locations that the UTF8 to UTF16 conversion of each match can resume from.
+  conversionUTF8Location  = searchByteRange.location;
+  conversionUTF16Location = searchUTF16Range.location;
+
   if(RK_EXPECTED(stringBuffer.length < searchByteRange.location, 0))    { [[NSException rkException:NSRangeException for:self selector:_cmd localizeReason:@"The strings length of %lu is less than the start location of %lu for the inRange: parameter of {%lu, %lu}.", (unsigned long)[string length], (unsigned long)searchUTF16Range.location, (unsigned long)searchUTF16Range.location, (unsigned long)searchUTF16Range.length] raise]; }  
   if(RK_EXPECTED(stringBuffer.length < NSMaxRange(searchByteRange), 0)) { [[NSException rkException:NSRangeException for:self selector:_cmd localizeReason:@"The strings length of %lu is less than the end location of %lu for the inRange: parameter of {%lu, %lu}.", (unsigned long)[string length], (unsigned long)NSMaxRange(searchUTF16Range), (unsigned long)searchUTF16Range.location, (unsigned long)searchUTF16Range.length] raise]; }  
 
@@ -205,6 +209,17 @@ exitNow:
 }
 
 
+- (RKSubstring *)currentSubstringForCapture:(const RKUInteger)capture
+{
+  if(RK_EXPECTED(atBufferLocation == NSNotFound, 0)) { return(NULL); }
+  if(RK_EXPECTED(hasPerformedMatch == 0, 0)) { [[NSException rkException:NSInvalidArgumentException for:self selector:_cmd localizeReason:@"A 'next...' method must be invoked before information about the current match is available."] raise]; }
+  if(RK_EXPECTED(capture >= regexCaptureCount, 0)) { [[NSException rkException:NSInvalidArgumentException for:self selector:_cmd localizeReason:@"The capture number %lu is greater than the %lu capture%s in the regular expression.", (unsigned long)capture, (unsigned long)(regexCaptureCount + 1), (regexCaptureCount + 1) > 1 ? "s":""] raise]; }
+  if(resultUTF8Ranges[capture].location == NSNotFound) { return(NULL); }
+  
+  RKStringBuffer stringBuffer = RKStringBufferWithString(string);
+  return(RKAutorelease(RKSubstringCreateWithStringBuffer(&stringBuffer, resultUTF8Ranges[capture])));
+}
+
 - (NSRange *)currentRanges
 {
   if(RK_EXPECTED(atBufferLocation == NSNotFound, 0)) { return(NULL); }
@@ -328,7 +343,8 @@ exitNow:
   hasPerformedMatch = 1;
   if(RK_EXPECTED(matched > 0, 1)) {
     atBufferLocation = (resultUTF8Ranges[0].location + resultUTF8Ranges[0].length);
-    for(RKUInteger x = 0; x < regexCaptureCount; x++) { resultUTF16Ranges[x] = RKutf8to16(string, resultUTF8Ranges[x]); }
+    memcpy(resultUTF16Ranges, resultUTF8Ranges, sizeof(NSRange) * regexCaptureCount);
+    RKConvertUTF8ToUTF16RangesForStringBuffer(&stringBuffer, resultUTF16Ranges, regexCaptureCount, &conversionUTF8Location, &conversionUTF16Location);
     return(YES);
   }
   [self releaseAllResources]; // else no more matches
@@ -45,6 +45,13 @@
 
 #import <RegexKit/RKLock.h>
 #import <sys/time.h>
+#import <signal.h>
+#import <dlfcn.h>
+#ifdef __MACOSX_RUNTIME__
+#import <mach/mach_time.h>
+#else
+#import <time.h>
+#endif
 
 #pragma mark Exceptions
 
@@ -53,6 +60,30 @@ NSString * const RKLockingException       = @"RKLockingException";
 
 #pragma mark Global Variables
 static int globalIsMultiThreaded = 0;
+static volatile int globalLockProfilingEnabled = 0;
+static RKLockProfile * volatile globalLockProfiles = NULL;
+
+#pragma mark -
+#pragma mark Contention Profiling Macros
+
+// waitStarted is only sampled the first time that a lock attempt turns out to be contended.  The call site is the return address of
+// the public RKFast* function, which is the code that asked for the lock.  It is captured there and passed down to any helper, since
+// __builtin_return_address(0) in a helper would only ever record the RKFast* function itself.
+#define RKLockProfileContended(waitStarted)                                          do { if(RK_EXPECTED(globalLockProfilingEnabled != 0, 0) && ((waitStarted) == 0)) { (waitStarted) = RKLockProfileNanoseconds(); } } while(0)
+#define RKLockProfileDidLock(lockProfile, didLock, exclusive, waitStarted, callSite) do { if(RK_EXPECTED(globalLockProfilingEnabled != 0, 0)) { RKLockProfileAcquired((lockProfile), (didLock), (exclusive), (waitStarted), (callSite)); } } while(0)
+#define RKLockProfileDidUnlock(lockProfile)                                          do { if(RK_EXPECTED(globalLockProfilingEnabled != 0, 0)) { RKLockProfileReleased(lockProfile); } } while(0)
+
+RKREGEX_STATIC_INLINE uint64_t RKLockProfileNanoseconds(void) {
+#ifdef __MACOSX_RUNTIME__
+  static mach_timebase_info_data_t timebaseInfo;
+  if(RK_EXPECTED(timebaseInfo.denom == 0, 0)) { mach_timebase_info(&timebaseInfo); }
+  return((mach_absolute_time() * timebaseInfo.numer) / timebaseInfo.denom);
+#else
+  struct timespec monotonicTime;
+  clock_gettime(CLOCK_MONOTONIC, &monotonicTime);
+  return(((uint64_t)monotonicTime.tv_sec * 1000000000ULL) + (uint64_t)monotonicTime.tv_nsec);
+#endif
+}
 
 #pragma mark -
 #pragma mark Prototypes
@@ -60,6 +91,10 @@ static int globalIsMultiThreaded = 0;
 static void releaseRKLockResources(         RKLock          * const self, SEL _cmd) RK_ATTRIBUTES(nonnull(1), used);
 static void releaseRKReadWriteResources(    RKReadWriteLock * const self, SEL _cmd) RK_ATTRIBUTES(nonnull(1), used);
 static void releaseRKConditionLockResources(RKConditionLock * const self, SEL _cmd) RK_ATTRIBUTES(nonnull(1), used);
+static BOOL RKDistributedReadWriteLock(     RKReadWriteLock * const self, const RKReadWriteLockStrategy lockStrategy, RKReadWriteLockStrategy *lockLevelAcquired, void * const callSite) RK_ATTRIBUTES(nonnull(1), used);
+static void RKDistributedReadWriteUnlock(   RKReadWriteLock * const self) RK_ATTRIBUTES(nonnull(1), used);
+static void RKLockProfileAcquired(          RKLockProfile * const lockProfile, const BOOL didLock, const BOOL exclusive, const uint64_t waitStarted, void * const callSite) RK_ATTRIBUTES(used);
+static void RKLockProfileReleased(          RKLockProfile * const lockProfile) RK_ATTRIBUTES(used);
 
 #pragma mark -
 #pragma mark Mutex Functions
@@ -126,6 +161,7 @@ void RKFastMutexUnlock(id const self, SEL _cmd, pthread_mutex_t *pthreadMutex) {
   }
 
   if(mutexAttributeInitialized == YES) { mutexAttributeInitialized = NO; pthread_mutexattr_destroy(&threadMutexAttribute); }
+  if((lockProfile = RKLockProfileCreate(self, "RKLock")) == NULL) { NSLog(@"Unable to allocate the lock profile."); goto errorExit; }
   return(RKRetain(self));
 
 errorExit:
@@ -156,6 +192,7 @@ static void releaseRKLockResources(RKLock * const self, SEL _cmd RK_ATTRIBUTES(u
   }
 
 errorExit:
+  if(self->lockProfile != NULL) { RKLockProfileRelease(self->lockProfile); self->lockProfile = NULL; }
   return;
 }
 
@@ -179,17 +216,40 @@ errorExit:
   return(RKFastUnlock(self));
 }
 
+- (void)setProfileName:(NSString * const)name
+{
+  RKLockProfileSetName(lockProfile, name);
+}
+
+- (NSDictionary *)profile
+{
+  return(RKLockProfileDictionary(lockProfile));
+}
+
+- (void)clearProfile
+{
+  RKLockProfileClear(lockProfile);
+}
+
 BOOL RKFastLock(RKLock * const self) {
+  uint64_t waitStarted = 0;
+  BOOL     didLock     = NO;
+
   if(globalIsMultiThreaded == 0) {
     if(RK_EXPECTED([NSThread isMultiThreaded] == NO, 1)) { RK_PROBE(BEGINLOCK, self, 0, globalIsMultiThreaded); RK_PROBE(ENDLOCK, self, 0, globalIsMultiThreaded, 1, 0); return(YES); }
     RKAtomicCompareAndSwapInt(0, 1, &globalIsMultiThreaded);
   }
   
-  return(RKFastMutexLock(self, @selector(lock), &self->lock, RKMutexFullLock));
+  if(RK_EXPECTED(globalLockProfilingEnabled == 0, 1)) { return(RKFastMutexLock(self, @selector(lock), &self->lock, RKMutexFullLock)); }
+  
+  // When profiling, try for the lock first so that the time spent waiting on a contended lock can be measured.
+  if((didLock = RKFastMutexLock(self, @selector(lock), &self->lock, RKMutexTryFullLock)) == NO) { RKLockProfileContended(waitStarted); didLock = RKFastMutexLock(self, @selector(lock), &self->lock, RKMutexFullLock); }
+  RKLockProfileDidLock(self->lockProfile, didLock, YES, waitStarted, __builtin_return_address(0));
+  return(didLock);
 }
 
 void RKFastUnlock(RKLock * const self) {
-  if(globalIsMultiThreaded != 0) { RKFastMutexUnlock(self, @selector(unlock), &self->lock); } else { RK_PROBE(UNLOCK, self, 0, globalIsMultiThreaded); }
+  if(globalIsMultiThreaded != 0) { RKLockProfileDidUnlock(self->lockProfile); RKFastMutexUnlock(self, @selector(unlock), &self->lock); } else { RK_PROBE(UNLOCK, self, 0, globalIsMultiThreaded); }
 }
 
 
@@ -205,6 +265,21 @@ void RKFastUnlock(RKLock * const self) {
 }
 
 - (id)init
+{
+  return([self initWithDistributedReaders:NO]);
+}
+
+//
+// With distributed readers, a read lock only increments a counter in one of several reader slots, each on its own cache line,
+// instead of every reader updating the same pthread_rwlock_t.  A thread always uses the same slot, which is picked by hashing its
+// pthread_t, so with roughly one thread per CPU most readers never share a cache line.  A writer takes the pthread_rwlock_t for
+// writing, which serializes writers and gives waiting readers something to block on, raises writerActive, and then sleeps on
+// drainCondition until every slot has drained.  A reader that empties its slot while writerActive is raised signals drainCondition.
+// This makes read locks much cheaper when there are many readers at the expense of more expensive write locks, so it is only suitable
+// for read mostly locks.
+//
+
+- (id)initWithDistributedReaders:(const BOOL)distributeReaders
 {
   int pthreadError = 0, initTryCount = 0;
   
@@ -220,6 +295,22 @@ void RKFastUnlock(RKLock * const self) {
     if(pthreadError == ENOMEM)  { NSLog(@"pthread_rwlock_init returned ENOMEM.");  goto errorExit; }
   }
   
+  if(distributeReaders == YES) {
+    RKUInteger slotsCount = RKLOCK_MIN_READER_SLOTS;
+    long       cpuCount   = sysconf(_SC_NPROCESSORS_CONF);
+    void      *slots      = NULL;
+    
+    while((slotsCount < (RKUInteger)cpuCount) && (slotsCount < RKLOCK_MAX_READER_SLOTS)) { slotsCount *= 2; }
+    if((pthreadError = pthread_mutex_init(&drainMutex, NULL))    != 0) { NSLog(@"pthread_mutex_init returned #%d, %s.", pthreadError, strerror(pthreadError)); goto errorExit; }
+    if((pthreadError = pthread_cond_init(&drainCondition, NULL)) != 0) { NSLog(@"pthread_cond_init returned #%d, %s.",  pthreadError, strerror(pthreadError)); pthread_mutex_destroy(&drainMutex); goto errorExit; }
+    if((pthreadError = posix_memalign(&slots, RK_CACHE_LINE_SIZE, sizeof(RKReaderSlot) * slotsCount)) != 0) { NSLog(@"posix_memalign returned %d, unable to allocate the reader slots.", pthreadError); pthread_cond_destroy(&drainCondition); pthread_mutex_destroy(&drainMutex); goto errorExit; }
+    memset(slots, 0, sizeof(RKReaderSlot) * slotsCount);
+    readerSlots     = slots;
+    readerSlotsMask = slotsCount - 1;
+  }
+  
+  if((lockProfile = RKLockProfileCreate(self, "RKReadWriteLock")) == NULL) { NSLog(@"Unable to allocate the lock profile."); goto errorExit; }
+  
   return(RKRetain(self));
   
 errorExit:
@@ -250,6 +341,8 @@ static void releaseRKReadWriteResources(RKReadWriteLock * const self, SEL _cmd R
   }
   
 errorExit:
+  if(self->readerSlots != NULL) { RKFreeAndNULLNoGC(self->readerSlots); pthread_cond_destroy(&self->drainCondition); pthread_mutex_destroy(&self->drainMutex); }
+  if(self->lockProfile != NULL) { RKLockProfileRelease(self->lockProfile); self->lockProfile = NULL; }
   return;
 }
 
@@ -278,11 +371,21 @@ errorExit:
   return(RKFastReadWriteLock(self, YES));
 }
 
+- (BOOL)lockWithStrategy:(const RKReadWriteLockStrategy)lockStrategy lockLevelAcquired:(RKReadWriteLockStrategy *)lockLevelAcquired
+{
+  return(RKFastReadWriteLockWithStrategy(self, lockStrategy, lockLevelAcquired));
+}
+
 - (void)unlock
 {
   RKFastReadWriteUnlock(self);
 }
 
+- (BOOL)hasDistributedReaders
+{
+  return((readerSlots != NULL) ? YES : NO);
+}
+
 - (void)setDebug:(const BOOL)enable
 {
   debuggingEnabled = enable;
@@ -322,12 +425,28 @@ errorExit:
   writeSpinCount = 0;
 }
 
+- (void)setProfileName:(NSString * const)name
+{
+  RKLockProfileSetName(lockProfile, name);
+}
+
+- (NSDictionary *)profile
+{
+  return(RKLockProfileDictionary(lockProfile));
+}
+
+- (void)clearProfile
+{
+  RKLockProfileClear(lockProfile);
+}
+
 BOOL RKFastReadWriteLock(RKReadWriteLock * const self, const BOOL forWriting) {
   return(RKFastReadWriteLockWithStrategy(self, (forWriting == NO) ? RKLockForReading : RKLockForWriting, NULL));
 }
 
 BOOL RKFastReadWriteLockWithStrategy(RKReadWriteLock * const self, const RKReadWriteLockStrategy lockStrategy, RKReadWriteLockStrategy *lockLevelAcquired) {
   int pthreadError = 0, spuriousErrors = 0, spinCount = 0;
+  uint64_t waitStarted = 0;
   NSString * RK_C99(restrict) functionString = NULL;
   BOOL didLock = NO, forWriting = ((lockStrategy == RKLockForReading) || (lockStrategy == RKLockTryForReading)) ? NO : YES;
 
@@ -338,24 +457,28 @@ BOOL RKFastReadWriteLockWithStrategy(RKReadWriteLock * const self, const RKReadW
     RKAtomicCompareAndSwapInt(0, 1, &globalIsMultiThreaded);
   }
 
-  if(RK_EXPECTED(lockStrategy == RKLockTryForWritingThenForReading, 0)) {
+  if(self->readerSlots != NULL) { return(RKDistributedReadWriteLock(self, lockStrategy, lockLevelAcquired, __builtin_return_address(0))); }
+
+  if(RK_EXPECTED((lockStrategy == RKLockTryForWritingThenForReading) || (lockStrategy == RKLockTryForWritingThenTryForReading), 0)) {
     if(RK_EXPECTED((pthreadError = pthread_rwlock_trywrlock(&self->readWriteLock)) == 0, 1)) { // Fast exit on the common acquired lock case.
       self->writeLocked = forWriting;
+      RKLockProfileDidLock(self->lockProfile, YES, YES, 0, __builtin_return_address(0));
       RK_PROBE(ENDLOCK, self, forWriting, globalIsMultiThreaded, 1, spinCount);
       if(lockLevelAcquired) { *lockLevelAcquired = RKLockForWriting; }
       return(YES);
     }
+    if(self->debuggingEnabled == YES) { self->writeBusyCount++; self->readDowngradedFromWriteCount++; }
     forWriting = NO; // Unable to acquire a write level lock, downgrade and acquire a read level lock.
   }
   
   if(RK_EXPECTED(forWriting == YES, 0)) {
     functionString = @"pthread_rwlock_trywrlock";
-    if(RK_EXPECTED((pthreadError = pthread_rwlock_trywrlock(&self->readWriteLock)) == 0, 1)) { self->writeLocked = forWriting; RK_PROBE(ENDLOCK, self, forWriting, globalIsMultiThreaded, 1, spinCount); if(lockLevelAcquired) { *lockLevelAcquired = RKLockForWriting; } return(YES); } // Fast exit on the common acquired lock case.
+    if(RK_EXPECTED((pthreadError = pthread_rwlock_trywrlock(&self->readWriteLock)) == 0, 1)) { self->writeLocked = forWriting; RKLockProfileDidLock(self->lockProfile, YES, forWriting, 0, __builtin_return_address(0)); RK_PROBE(ENDLOCK, self, forWriting, globalIsMultiThreaded, 1, spinCount); if(lockLevelAcquired) { *lockLevelAcquired = RKLockForWriting; } return(YES); } // Fast exit on the common acquired lock case.
 
     switch(pthreadError) {
       case 0:                                                      didLock = YES; goto exitNow; break; // Lock was acquired
       case EAGAIN:                                                                                     // drop through
-      case EBUSY:   spinCount++; if(self->debuggingEnabled == YES) { self->writeBusyCount++; }  break; // Do nothing, we need to wait on the lock, which we do after the switch
+      case EBUSY:   spinCount++; if(self->debuggingEnabled == YES) { self->writeBusyCount++; } RKLockProfileContended(waitStarted); break; // Do nothing, we need to wait on the lock, which we do after the switch
       case EDEADLK: NSLog(@"%@ returned EDEADLK.", functionString);               goto exitNow; break; // XXX Hopeless?
       case ENOMEM:  NSLog(@"%@ returned ENOMEM.", functionString);                goto exitNow; break; // XXX Hopeless?
       case EINVAL:  NSLog(@"%@ returned EINVAL.", functionString);                goto exitNow; break; // XXX Hopeless?
@@ -392,13 +515,13 @@ BOOL RKFastReadWriteLockWithStrategy(RKReadWriteLock * const self, const RKReadW
     } while(pthreadError != 0);
     
   } else { // forWriting == NO
-    if(RK_EXPECTED((pthreadError = pthread_rwlock_tryrdlock(&self->readWriteLock)) == 0, 1)) { self->writeLocked = forWriting; RK_PROBE(ENDLOCK, self, forWriting, globalIsMultiThreaded, 1, spinCount); if(lockLevelAcquired) { *lockLevelAcquired = RKLockForReading; } return(YES); } // Fast exit on the common acquired lock case.
+    if(RK_EXPECTED((pthreadError = pthread_rwlock_tryrdlock(&self->readWriteLock)) == 0, 1)) { self->writeLocked = forWriting; RKLockProfileDidLock(self->lockProfile, YES, forWriting, 0, __builtin_return_address(0)); RK_PROBE(ENDLOCK, self, forWriting, globalIsMultiThreaded, 1, spinCount); if(lockLevelAcquired) { *lockLevelAcquired = RKLockForReading; } return(YES); } // Fast exit on the common acquired lock case.
     functionString = @"pthread_rwlock_tryrdlock";
     
     switch(pthreadError) {
       case 0:                                                    didLock = YES; goto exitNow; break; // Lock was acquired
       case EAGAIN:                                                                                   // drop through
-      case EBUSY:   spinCount++; if(self->debuggingEnabled == YES) { self->readBusyCount++; } break; // Do nothing, we need to wait on the lock, which we do after the switch
+      case EBUSY:   spinCount++; if(self->debuggingEnabled == YES) { self->readBusyCount++; } RKLockProfileContended(waitStarted); break; // Do nothing, we need to wait on the lock, which we do after the switch
       case EDEADLK: NSLog(@"%@ returned EDEADLK.", functionString);             goto exitNow; break; // XXX Hopeless?
       case ENOMEM:  NSLog(@"%@ returned ENOMEM.", functionString);              goto exitNow; break; // XXX Hopeless?
       case EINVAL:  NSLog(@"%@ returned EINVAL.", functionString);              goto exitNow; break; // XXX Hopeless?
@@ -411,7 +534,7 @@ BOOL RKFastReadWriteLockWithStrategy(RKReadWriteLock * const self, const RKReadW
         break;
     }
     
-    if(lockStrategy == RKLockTryForReading) { goto exitNow; }
+    if((lockStrategy == RKLockTryForReading) || (lockStrategy == RKLockTryForWritingThenTryForReading)) { goto exitNow; }
     functionString = (self->debuggingEnabled == YES) ? @"pthread_rwlock_tryrdlock":@"pthread_rwlock_rdlock";
     
     do {
@@ -438,6 +561,7 @@ BOOL RKFastReadWriteLockWithStrategy(RKReadWriteLock * const self, const RKReadW
   
 exitNow:
   if(didLock == YES) { self->writeLocked = forWriting; }
+  RKLockProfileDidLock(self->lockProfile, didLock, forWriting, waitStarted, __builtin_return_address(0));
   RK_PROBE(ENDLOCK, self, forWriting, globalIsMultiThreaded, didLock, spinCount);
   if(lockLevelAcquired) { if(didLock == YES) { *lockLevelAcquired = forWriting; } else { *lockLevelAcquired = RKLockDidNotLock; } }
   return(didLock);
@@ -449,12 +573,116 @@ void RKFastReadWriteUnlock(RKReadWriteLock * const self) {
   RK_PROBE(UNLOCK, self, self->writeLocked, globalIsMultiThreaded); 
   
   if(globalIsMultiThreaded == 0) { return; }
+  RKLockProfileDidUnlock(self->lockProfile);
+  if(self->readerSlots != NULL) { RKDistributedReadWriteUnlock(self); return; }
   if(RK_EXPECTED((pthreadError = pthread_rwlock_unlock(&self->readWriteLock)) != 0, 0)) {
     if(pthreadError == EINVAL) { NSLog(@"pthread_mutex_unlock returned EINVAL.");           return; }
     if(pthreadError == EPERM)  { NSLog(@"pthread_mutex_unlock returned EPERM, not owner?"); return; }
   }
 }
 
+// The slot used by the current thread.  pthread_t is usually the address of the threads stack or control block, so the higher
+// bits are folded in to the low bits that select the slot.
+RKREGEX_STATIC_INLINE RKReaderSlot *RKReaderSlotForCurrentThread(RKReadWriteLock * const self) {
+  uintptr_t threadHash = (uintptr_t)pthread_self();
+  threadHash ^= (threadHash >> 7) ^ (threadHash >> 13) ^ (threadHash >> 23);
+  return(&self->readerSlots[threadHash & self->readerSlotsMask]);
+}
+
+// Drops a reader from readerSlot.  The decrement is a barrier and the writer raises writerActive before it looks at the slots, so
+// either the writer sees the slot drain or the reader sees writerActive and wakes the writer.  The writer checks its slot again under
+// drainMutex, so a signal for some other slot is harmless.
+RKREGEX_STATIC_INLINE void RKReaderSlotRelease(RKReadWriteLock * const self, RKReaderSlot * const readerSlot) {
+  RKAtomicDecrementIntegerBarrier(&readerSlot->readers);
+  if(RK_EXPECTED(self->writerActive != 0, 0)) {
+    pthread_mutex_lock(&self->drainMutex);
+    pthread_cond_signal(&self->drainCondition);
+    pthread_mutex_unlock(&self->drainMutex);
+  }
+}
+
+static BOOL RKDistributedReadWriteLock(RKReadWriteLock * const self, const RKReadWriteLockStrategy lockStrategy, RKReadWriteLockStrategy *lockLevelAcquired, void * const callSite) {
+  BOOL          didLock     = NO, forWriting = ((lockStrategy == RKLockForReading) || (lockStrategy == RKLockTryForReading)) ? NO : YES;
+  BOOL          tryLock     = ((lockStrategy == RKLockForReading) || (lockStrategy == RKLockForWriting)) ? NO : YES;
+  int           spinCount   = 0;
+  uint64_t      waitStarted = 0;
+  RKUInteger    atSlot      = 0;
+  RKReaderSlot *readerSlot  = NULL;
+  
+  if(forWriting == YES) {
+    if(pthread_rwlock_trywrlock(&self->readWriteLock) != 0) {
+      spinCount++; if(self->debuggingEnabled == YES) { self->writeBusyCount++; }
+      RKLockProfileContended(waitStarted);
+      if(tryLock == YES) { goto downgradeToReading; }
+      if(pthread_rwlock_wrlock(&self->readWriteLock) != 0) { NSLog(@"pthread_rwlock_wrlock failed while acquiring a distributed readers write lock."); goto exitNow; }
+    }
+    
+    // Readers check writerActive after incrementing their slot, and the writer checks the slots after raising writerActive, so at
+    // least one of them always sees the other.
+    self->writerThread = pthread_self();
+    RKAtomicCompareAndSwapInteger(0, 1, &self->writerActive);
+    
+    for(atSlot = 0; atSlot <= self->readerSlotsMask; atSlot++) {
+      if(self->readerSlots[atSlot].readers == 0) { continue; }
+      if(tryLock == YES) {
+        RKAtomicCompareAndSwapInteger(1, 0, &self->writerActive);
+        pthread_rwlock_unlock(&self->readWriteLock);
+        if(self->debuggingEnabled == YES) { self->writeBusyCount++; }
+        goto downgradeToReading;
+      }
+      spinCount++; if(self->debuggingEnabled == YES) { self->writeSpinCount++; }
+      RKLockProfileContended(waitStarted);
+      
+      // Sleep until the readers in this slot have left, see RKReaderSlotRelease().
+      pthread_mutex_lock(&self->drainMutex);
+      while(self->readerSlots[atSlot].readers != 0) { pthread_cond_wait(&self->drainCondition, &self->drainMutex); }
+      pthread_mutex_unlock(&self->drainMutex);
+    }
+    
+    didLock = YES;
+    goto exitNow;
+    
+  downgradeToReading:
+    if(lockStrategy == RKLockTryForWriting) { goto exitNow; }
+    if(self->debuggingEnabled == YES) { self->readDowngradedFromWriteCount++; }
+    forWriting = NO;
+    tryLock    = (lockStrategy == RKLockTryForWritingThenTryForReading) ? YES : NO;
+  }
+  
+  readerSlot = RKReaderSlotForCurrentThread(self);
+  
+  for(;;) {
+    RKAtomicIncrementIntegerBarrier(&readerSlot->readers);
+    if(RK_EXPECTED(self->writerActive == 0, 1)) { didLock = YES; break; }
+    RKReaderSlotRelease(self, readerSlot);
+    
+    if(self->debuggingEnabled == YES) { if(spinCount == 0) { self->readBusyCount++; } else { self->readSpinCount++; } }
+    spinCount++;
+    RKLockProfileContended(waitStarted);
+    if(tryLock == YES) { break; }
+    
+    // Wait for the writer by queuing behind it on the pthread_rwlock_t that it holds.
+    if(pthread_rwlock_rdlock(&self->readWriteLock) == 0) { pthread_rwlock_unlock(&self->readWriteLock); } else { RKThreadYield(); }
+  }
+  
+exitNow:
+  if(didLock == YES) { self->writeLocked = forWriting; }
+  RKLockProfileDidLock(self->lockProfile, didLock, forWriting, waitStarted, callSite);
+  RK_PROBE(ENDLOCK, self, forWriting, globalIsMultiThreaded, didLock, spinCount);
+  if(lockLevelAcquired) { if(didLock == YES) { *lockLevelAcquired = forWriting; } else { *lockLevelAcquired = RKLockDidNotLock; } }
+  return(didLock);
+}
+
+static void RKDistributedReadWriteUnlock(RKReadWriteLock * const self) {
+  if((self->writerActive != 0) && (pthread_equal(self->writerThread, pthread_self()) != 0)) {
+    RKAtomicCompareAndSwapInteger(1, 0, &self->writerActive);
+    pthread_rwlock_unlock(&self->readWriteLock);
+    return;
+  }
+  
+  RKReaderSlotRelease(self, RKReaderSlotForCurrentThread(self));
+}
+
 @end
 
 #pragma mark -
@@ -499,6 +727,8 @@ void RKFastReadWriteUnlock(RKReadWriteLock * const self) {
     
   currentLockCondition = initCondition;
   
+  if((lockProfile = RKLockProfileCreate(self, "RKConditionLock")) == NULL) { NSLog(@"Unable to allocate the lock profile."); goto errorExit; }
+  
   return(RKRetain(self));
   
 errorExit:
@@ -535,6 +765,7 @@ static void releaseRKConditionLockResources(RKConditionLock * const self, SEL _c
   }
   
 errorExit:
+  if(self->lockProfile != NULL) { RKLockProfileRelease(self->lockProfile); self->lockProfile = NULL; }
   return;
 }
 
@@ -583,6 +814,24 @@ errorExit:
   return(RKAutorelease(RKRetain(lockOwnerThread)));
 }
 
+#pragma mark -
+#pragma mark RKConditionalLock Profiling
+
+- (void)setProfileName:(NSString * const)name
+{
+  RKLockProfileSetName(lockProfile, name);
+}
+
+- (NSDictionary *)profile
+{
+  return(RKLockProfileDictionary(lockProfile));
+}
+
+- (void)clearProfile
+{
+  RKLockProfileClear(lockProfile);
+}
+
 #pragma mark -
 #pragma mark RKConditionalLock Locking Methods
 
@@ -646,6 +895,7 @@ BOOL RKFastConditionLock(RKConditionLock * const self, SEL _cmd, RKInteger lockO
   double relativeTimeIntegralPart, relativeTimeFractionalPart;
   struct timespec pthreadConditionTimeSpec;
   struct timeval nowTimeVal;
+  uint64_t waitStarted = 0;
   int pthreadError = 0;
 
   switch(conditionLockStrategy) {
@@ -671,7 +921,10 @@ BOOL RKFastConditionLock(RKConditionLock * const self, SEL _cmd, RKInteger lockO
     pthreadConditionTimeSpec.tv_nsec = (long)(relativeTimeFractionalPart * 1.0E9);
   }
   
-  mutexLocked = RKFastMutexLock(self, _cmd, &self->pthreadMutex, (tryToLock == YES) ? RKMutexTryFullLock : RKMutexFullLock);
+  if((tryToLock == NO) && RK_EXPECTED(globalLockProfilingEnabled != 0, 0)) {
+    if((mutexLocked = RKFastMutexLock(self, _cmd, &self->pthreadMutex, RKMutexTryFullLock)) == NO) { RKLockProfileContended(waitStarted); }
+  }
+  if(mutexLocked == NO) { mutexLocked = RKFastMutexLock(self, _cmd, &self->pthreadMutex, (tryToLock == YES) ? RKMutexTryFullLock : RKMutexFullLock); }
 
   if((mutexLocked == NO) && (tryToLock == YES)) { goto exitNow; }
   else if((mutexLocked == NO) && (tryToLock == NO)) { [[NSException rkException:RKConditionLockException for:self selector:_cmd localizeReason:@"Mutex did not lock as expected."] raise]; }
@@ -683,6 +936,7 @@ BOOL RKFastConditionLock(RKConditionLock * const self, SEL _cmd, RKInteger lockO
   if((tryToLock == YES) && ((self->conditionIsLocked == YES) || ((self->currentLockCondition != lockOnCondition) && (lockOnAnyCondition == NO)))) { goto exitNow; }
   
   while((((self->currentLockCondition != lockOnCondition) && (lockOnAnyCondition == NO)) || (self->conditionIsLocked == YES)) && (lockTimedOut == NO) && (tryToLock == NO)) {
+    RKLockProfileContended(waitStarted);
     if(canTimeOut == YES) { pthreadError = pthread_cond_timedwait(&self->pthreadCondition, &self->pthreadMutex, &pthreadConditionTimeSpec); }
     else {                  pthreadError = pthread_cond_wait(     &self->pthreadCondition, &self->pthreadMutex); }
     
@@ -705,6 +959,7 @@ BOOL RKFastConditionLock(RKConditionLock * const self, SEL _cmd, RKInteger lockO
   }
 
 exitNow:
+  RKLockProfileDidLock(self->lockProfile, didLock, YES, waitStarted, __builtin_return_address(0));
   RK_PROBE(ENDLOCK, self, 0, globalIsMultiThreaded, didLock, 0);
   if(mutexLocked == YES) { RKFastMutexUnlock(self, _cmd, &self->pthreadMutex); mutexLocked = NO; }
   return(didLock);
@@ -714,6 +969,7 @@ void RKFastConditionUnlock(RKConditionLock * const self, SEL _cmd, RKInteger unl
   if(RKFastMutexLock(self, _cmd, &self->pthreadMutex, RKMutexFullLock) == NO) { [[NSException rkException:RKConditionLockException for:self selector:_cmd localizeReason:@"Mutex did not lock as expected."] raise]; }
   if((self->conditionIsLocked == NO) || (pthread_equal(self->lockOwner, pthread_self()) == 0)) { [[NSException rkException:RKConditionLockException for:self selector:_cmd localizeReason:@"Illegal unlock attempt. conditionIsLocked: %@, thread is lock owner: %@.", RKYesOrNo(self->conditionIsLocked), RKYesOrNo(pthread_equal(self->lockOwner, pthread_self()))] raise]; }
   
+  RKLockProfileDidUnlock(self->lockProfile);
   self->conditionIsLocked    = NO;
   self->currentLockCondition = unlockWithCondition;
 
@@ -724,3 +980,334 @@ void RKFastConditionUnlock(RKConditionLock * const self, SEL _cmd, RKInteger unl
 }
 
 @end
+
+#pragma mark -
+#pragma mark Contention Profiling
+
+RKREGEX_STATIC_INLINE RKUInteger RKLockProfileBucket(uint64_t nanoseconds) {
+  RKUInteger bucket = 0;
+  while(((nanoseconds >>= 1) != 0) && (bucket < (RKLOCK_PROFILE_HISTOGRAM_BUCKETS - 1))) { bucket++; }
+  return(bucket);
+}
+
+static void RKLockProfileCallSite(RKLockProfile * const lockProfile, void * const callSite, const uint64_t waitNanoseconds) {
+  RKUInteger atCallSite = 0;
+  
+  // Call sites claim an empty slot the first time they are seen.  Once all the slots are taken, any other call sites are only counted.
+  for(atCallSite = 0; atCallSite < RKLOCK_PROFILE_CALL_SITES; atCallSite++) {
+    RKLockCallSiteProfile *callSiteProfile = &lockProfile->callSites[atCallSite];
+    
+    if(callSiteProfile->callSite == NULL) { RKAtomicCompareAndSwapPtr(NULL, callSite, &callSiteProfile->callSite); }
+    if(callSiteProfile->callSite == callSite) {
+      RKAtomicIncrementInteger(&callSiteProfile->contendedCount);
+      RKAtomicAddInteger((RKInteger)(waitNanoseconds / 1000), &callSiteProfile->waitMicroseconds);
+      return;
+    }
+  }
+  
+  RKAtomicIncrementInteger(&lockProfile->droppedCallSitesCount);
+}
+
+static void RKLockProfileAcquired(RKLockProfile * const lockProfile, const BOOL didLock, const BOOL exclusive, const uint64_t waitStarted, void * const callSite) {
+  uint64_t nowNanoseconds = 0, waitNanoseconds = 0;
+  
+  if(RK_EXPECTED(lockProfile == NULL, 0)) { return; }
+  if(didLock == YES) { RKAtomicIncrementInteger(&lockProfile->acquiredCount); }
+  if((waitStarted == 0) && ((exclusive == NO) || (didLock == NO))) { return; }
+  
+  nowNanoseconds = RKLockProfileNanoseconds();
+  // Hold times are only measured for exclusive locks since there is only one owner to time.
+  if((didLock == YES) && (exclusive == YES)) { lockProfile->lockedAtNanoseconds = nowNanoseconds; }
+  if(waitStarted == 0) { return; }
+  
+  waitNanoseconds = nowNanoseconds - waitStarted;
+  RKAtomicIncrementInteger(&lockProfile->contendedCount);
+  RKAtomicIncrementInteger(&lockProfile->waitHistogram[RKLockProfileBucket(waitNanoseconds)]);
+  RKLockProfileCallSite(lockProfile, callSite, waitNanoseconds);
+}
+
+static void RKLockProfileReleased(RKLockProfile * const lockProfile) {
+  uint64_t lockedAtNanoseconds = 0;
+  
+  if(RK_EXPECTED(lockProfile == NULL, 0) || ((lockedAtNanoseconds = lockProfile->lockedAtNanoseconds) == 0)) { return; }
+  lockProfile->lockedAtNanoseconds = 0;
+  RKAtomicIncrementInteger(&lockProfile->holdHistogram[RKLockProfileBucket(RKLockProfileNanoseconds() - lockedAtNanoseconds)]);
+}
+
+RKLockProfile *RKLockProfileCreate(const void * const lock, const char * const lockClassName) {
+  RKLockProfile *lockProfile = NULL;
+  
+  for(lockProfile = globalLockProfiles; lockProfile != NULL; lockProfile = lockProfile->nextProfile) {
+    if((lockProfile->inUse == 0) && (RKAtomicCompareAndSwapInteger(0, 1, &lockProfile->inUse))) { break; }
+  }
+  
+  if(lockProfile != NULL) {
+    RKLockProfileClear(lockProfile);
+    lockProfile->lock          = lock;
+    lockProfile->lockClassName = lockClassName;
+    lockProfile->name[0]       = 0;
+    return(lockProfile);
+  }
+  
+  if((lockProfile = RKMallocNoGC(sizeof(RKLockProfile))) == NULL) { return(NULL); }
+  memset(lockProfile, 0, sizeof(RKLockProfile));
+  lockProfile->inUse         = 1;
+  lockProfile->lock          = lock;
+  lockProfile->lockClassName = lockClassName;
+  
+  do { lockProfile->nextProfile = globalLockProfiles; } while(RKAtomicCompareAndSwapPtr(lockProfile->nextProfile, lockProfile, &globalLockProfiles) == NO);
+  
+  return(lockProfile);
+}
+
+void RKLockProfileRelease(RKLockProfile * const lockProfile) {
+  if(lockProfile == NULL) { return; }
+  lockProfile->lock = NULL;
+  RKAtomicCompareAndSwapInteger(1, 0, &lockProfile->inUse);
+}
+
+void RKLockProfileSetName(RKLockProfile * const lockProfile, NSString * const name) {
+  const char *nameUTF8String = NULL;
+  size_t      nameLength     = 0;
+  
+  if(lockProfile == NULL) { return; }
+  lockProfile->name[0] = 0;
+  if((name == NULL) || ((nameUTF8String = [name UTF8String]) == NULL)) { return; }
+  
+  // A long name is cut at the last whole character that fits, the first byte left out must not be a UTF8 continuation byte.
+  if((nameLength = strlen(nameUTF8String)) > (RKLOCK_PROFILE_NAME_LENGTH - 1)) {
+    nameLength = RKLOCK_PROFILE_NAME_LENGTH - 1;
+    while((nameLength > 0) && ((nameUTF8String[nameLength] & 0xC0) == 0x80)) { nameLength--; }
+  }
+  memcpy(lockProfile->name, nameUTF8String, nameLength);
+  lockProfile->name[nameLength] = 0;
+}
+
+void RKLockProfileClear(RKLockProfile * const lockProfile) {
+  RKUInteger atIndex = 0;
+  
+  if(lockProfile == NULL) { return; }
+  
+  lockProfile->acquiredCount         = 0;
+  lockProfile->contendedCount        = 0;
+  lockProfile->droppedCallSitesCount = 0;
+  for(atIndex = 0; atIndex < RKLOCK_PROFILE_HISTOGRAM_BUCKETS; atIndex++) { lockProfile->waitHistogram[atIndex] = 0; lockProfile->holdHistogram[atIndex] = 0; }
+  for(atIndex = 0; atIndex < RKLOCK_PROFILE_CALL_SITES; atIndex++) {
+    lockProfile->callSites[atIndex].contendedCount   = 0;
+    lockProfile->callSites[atIndex].waitMicroseconds = 0;
+    lockProfile->callSites[atIndex].callSite         = NULL;
+  }
+}
+
+static int RKLockCallSiteProfileCompare(const void *firstCallSite, const void *secondCallSite) {
+  RKInteger firstCount = ((const RKLockCallSiteProfile *)firstCallSite)->contendedCount, secondCount = ((const RKLockCallSiteProfile *)secondCallSite)->contendedCount;
+  return((firstCount > secondCount) ? -1 : ((firstCount < secondCount) ? 1 : 0));
+}
+
+static NSString *RKLockProfileCallSiteString(const void * const callSite) {
+  Dl_info callSiteInfo;
+  
+  if((dladdr(callSite, &callSiteInfo) != 0) && (callSiteInfo.dli_sname != NULL)) {
+    return([NSString stringWithFormat:@"%s + %lu (%p)", callSiteInfo.dli_sname, (unsigned long)((const char *)callSite - (const char *)callSiteInfo.dli_saddr), callSite]);
+  }
+  return([NSString stringWithFormat:@"%p", callSite]);
+}
+
+NSDictionary *RKLockProfileDictionary(RKLockProfile * const lockProfile) {
+  RKLockCallSiteProfile sortedCallSites[RKLOCK_PROFILE_CALL_SITES];
+  NSMutableArray *waitHistogram = NULL, *holdHistogram = NULL, *callSites = NULL;
+  RKUInteger atIndex = 0, callSitesCount = 0;
+  
+  if(lockProfile == NULL) { return(NULL); }
+  
+  waitHistogram = [NSMutableArray arrayWithCapacity:RKLOCK_PROFILE_HISTOGRAM_BUCKETS];
+  holdHistogram = [NSMutableArray arrayWithCapacity:RKLOCK_PROFILE_HISTOGRAM_BUCKETS];
+  callSites     = [NSMutableArray arrayWithCapacity:RKLOCK_PROFILE_CALL_SITES];
+  
+  for(atIndex = 0; atIndex < RKLOCK_PROFILE_HISTOGRAM_BUCKETS; atIndex++) {
+    [waitHistogram addObject:[NSNumber numberWithUnsignedLong:(unsigned long)lockProfile->waitHistogram[atIndex]]];
+    [holdHistogram addObject:[NSNumber numberWithUnsignedLong:(unsigned long)lockProfile->holdHistogram[atIndex]]];
+  }
+  
+  for(atIndex = 0; atIndex < RKLOCK_PROFILE_CALL_SITES; atIndex++) {
+    if(lockProfile->callSites[atIndex].callSite == NULL) { continue; }
+    sortedCallSites[callSitesCount].callSite         = lockProfile->callSites[atIndex].callSite;
+    sortedCallSites[callSitesCount].contendedCount   = lockProfile->callSites[atIndex].contendedCount;
+    sortedCallSites[callSitesCount].waitMicroseconds = lockProfile->callSites[atIndex].waitMicroseconds;
+    callSitesCount++;
+  }
+  qsort(sortedCallSites, callSitesCount, sizeof(RKLockCallSiteProfile), RKLockCallSiteProfileCompare);
+  
+  for(atIndex = 0; atIndex < callSitesCount; atIndex++) {
+    [callSites addObject:[NSDictionary dictionaryWithObjectsAndKeys:
+                          RKLockProfileCallSiteString(sortedCallSites[atIndex].callSite),                                   @"callSite",
+                          [NSNumber numberWithUnsignedLong:(unsigned long)sortedCallSites[atIndex].contendedCount],   @"contendedCount",
+                          [NSNumber numberWithUnsignedLong:(unsigned long)sortedCallSites[atIndex].waitMicroseconds], @"waitMicroseconds",
+                          NULL]];
+  }
+  
+  return([NSDictionary dictionaryWithObjectsAndKeys:
+          [NSString stringWithUTF8String:lockProfile->name],                                           @"name",
+          [NSString stringWithUTF8String:lockProfile->lockClassName],                                  @"lockClass",
+          [NSString stringWithFormat:@"%p", lockProfile->lock],                                        @"lock",
+          [NSNumber numberWithUnsignedLong:(unsigned long)lockProfile->acquiredCount],                 @"acquiredCount",
+          [NSNumber numberWithUnsignedLong:(unsigned long)lockProfile->contendedCount],                @"contendedCount",
+          [NSNumber numberWithUnsignedLong:(unsigned long)lockProfile->droppedCallSitesCount],         @"droppedCallSitesCount",
+          waitHistogram,                                                                               @"waitHistogram",
+          holdHistogram,                                                                               @"holdHistogram",
+          callSites,                                                                                   @"callSites",
+          NULL]);
+}
+
+#pragma mark -
+#pragma mark Contention Profiling Functions
+
+void RKSetLockProfilingEnabled(const BOOL enableProfiling) {
+  RKLockProfile *lockProfile = NULL;
+  
+  // A lock acquired while profiling was disabled has no valid locked at time, so clear any stale ones before enabling.
+  if((enableProfiling == YES) && (globalLockProfilingEnabled == 0)) {
+    for(lockProfile = globalLockProfiles; lockProfile != NULL; lockProfile = lockProfile->nextProfile) { lockProfile->lockedAtNanoseconds = 0; }
+  }
+  
+  globalLockProfilingEnabled = (enableProfiling == YES) ? 1 : 0;
+  RKAtomicMemoryBarrier();
+}
+
+BOOL RKLockProfilingEnabled(void) {
+  return((globalLockProfilingEnabled != 0) ? YES : NO);
+}
+
+NSArray *RKLockProfiles(void) {
+  NSMutableArray *lockProfiles = [NSMutableArray array];
+  RKLockProfile  *lockProfile  = NULL;
+  NSDictionary   *profileDictionary = NULL;
+  
+  for(lockProfile = globalLockProfiles; lockProfile != NULL; lockProfile = lockProfile->nextProfile) {
+    if((lockProfile->inUse != 0) && ((profileDictionary = RKLockProfileDictionary(lockProfile)) != NULL)) { [lockProfiles addObject:profileDictionary]; }
+  }
+  
+  return(lockProfiles);
+}
+
+void RKClearLockProfiles(void) {
+  RKLockProfile *lockProfile = NULL;
+  for(lockProfile = globalLockProfiles; lockProfile != NULL; lockProfile = lockProfile->nextProfile) { if(lockProfile->inUse != 0) { RKLockProfileClear(lockProfile); } }
+}
+
+// RKDumpLockProfiles() can be called from a signal handler, so everything below is limited to async-signal-safe functions.  Numbers
+// are formatted by hand and call sites are written as raw addresses instead of being symbolized with dladdr().
+
+typedef struct {
+  int        fileDescriptor;
+  RKUInteger length;
+  char       buffer[1024];
+} RKLockProfileDumpBuffer;
+
+static void RKLockProfileDumpFlush(RKLockProfileDumpBuffer * const dumpBuffer) {
+  RKUInteger written = 0;
+  ssize_t    writeResult = 0;
+  
+  while(written < dumpBuffer->length) {
+    if((writeResult = write(dumpBuffer->fileDescriptor, &dumpBuffer->buffer[written], dumpBuffer->length - written)) < 0) { if(errno == EINTR) { continue; } break; }
+    written += (RKUInteger)writeResult;
+  }
+  dumpBuffer->length = 0;
+}
+
+static void RKLockProfileDumpString(RKLockProfileDumpBuffer * const dumpBuffer, const char *string) {
+  if(string == NULL) { return; }
+  while(*string != 0) {
+    if(dumpBuffer->length == sizeof(dumpBuffer->buffer)) { RKLockProfileDumpFlush(dumpBuffer); }
+    dumpBuffer->buffer[dumpBuffer->length++] = *string++;
+  }
+}
+
+static void RKLockProfileDumpNumber(RKLockProfileDumpBuffer * const dumpBuffer, uint64_t number, const unsigned int base) {
+  char digits[24];
+  int  atDigit = sizeof(digits) - 1;
+  
+  digits[atDigit] = 0;
+  do { digits[--atDigit] = "0123456789abcdef"[number % base]; number /= base; } while((number != 0) && (atDigit > 0));
+  if(base == 16) { RKLockProfileDumpString(dumpBuffer, "0x"); }
+  RKLockProfileDumpString(dumpBuffer, &digits[atDigit]);
+}
+
+static void RKLockProfileDumpHistogram(RKLockProfileDumpBuffer * const dumpBuffer, const char * const label, volatile RKInteger * const histogram) {
+  RKUInteger atBucket = 0;
+  BOOL       isEmpty  = YES;
+  
+  RKLockProfileDumpString(dumpBuffer, label);
+  for(atBucket = 0; atBucket < RKLOCK_PROFILE_HISTOGRAM_BUCKETS; atBucket++) {
+    if(histogram[atBucket] == 0) { continue; }
+    RKLockProfileDumpString(dumpBuffer, (isEmpty == YES) ? " >= 2^" : ", >= 2^");
+    RKLockProfileDumpNumber(dumpBuffer, atBucket, 10);
+    RKLockProfileDumpString(dumpBuffer, "ns: ");
+    RKLockProfileDumpNumber(dumpBuffer, (uint64_t)histogram[atBucket], 10);
+    isEmpty = NO;
+  }
+  RKLockProfileDumpString(dumpBuffer, (isEmpty == YES) ? " none\n" : "\n");
+}
+
+void RKDumpLockProfiles(int fileDescriptor) {
+  RKLockProfileDumpBuffer dumpBuffer;
+  RKLockProfile *lockProfile = NULL;
+  RKUInteger     atCallSite  = 0;
+  
+  dumpBuffer.fileDescriptor = fileDescriptor;
+  dumpBuffer.length         = 0;
+  
+  for(lockProfile = globalLockProfiles; lockProfile != NULL; lockProfile = lockProfile->nextProfile) {
+    if((lockProfile->inUse == 0) || (lockProfile->acquiredCount == 0)) { continue; }
+    
+    RKLockProfileDumpString(&dumpBuffer, "RegexKit lock profile: ");
+    RKLockProfileDumpString(&dumpBuffer, lockProfile->lockClassName);
+    RKLockProfileDumpString(&dumpBuffer, " ");
+    RKLockProfileDumpNumber(&dumpBuffer, (uint64_t)(uintptr_t)lockProfile->lock, 16);
+    if(lockProfile->name[0] != 0) { RKLockProfileDumpString(&dumpBuffer, " \""); RKLockProfileDumpString(&dumpBuffer, lockProfile->name); RKLockProfileDumpString(&dumpBuffer, "\""); }
+    RKLockProfileDumpString(&dumpBuffer, ", acquired: ");
+    RKLockProfileDumpNumber(&dumpBuffer, (uint64_t)lockProfile->acquiredCount, 10);
+    RKLockProfileDumpString(&dumpBuffer, ", contended: ");
+    RKLockProfileDumpNumber(&dumpBuffer, (uint64_t)lockProfile->contendedCount, 10);
+    RKLockProfileDumpString(&dumpBuffer, "\n");
+    
+    RKLockProfileDumpHistogram(&dumpBuffer, "  wait:", lockProfile->waitHistogram);
+    RKLockProfileDumpHistogram(&dumpBuffer, "  hold:", lockProfile->holdHistogram);
+    
+    for(atCallSite = 0; atCallSite < RKLOCK_PROFILE_CALL_SITES; atCallSite++) {
+      if(lockProfile->callSites[atCallSite].callSite == NULL) { continue; }
+      RKLockProfileDumpString(&dumpBuffer, "  call site ");
+      RKLockProfileDumpNumber(&dumpBuffer, (uint64_t)(uintptr_t)lockProfile->callSites[atCallSite].callSite, 16);
+      RKLockProfileDumpString(&dumpBuffer, ", contended: ");
+      RKLockProfileDumpNumber(&dumpBuffer, (uint64_t)lockProfile->callSites[atCallSite].contendedCount, 10);
+      RKLockProfileDumpString(&dumpBuffer, ", wait: ");
+      RKLockProfileDumpNumber(&dumpBuffer, (uint64_t)lockProfile->callSites[atCallSite].waitMicroseconds, 10);
+      RKLockProfileDumpString(&dumpBuffer, "us\n");
+    }
+    if(lockProfile->droppedCallSitesCount != 0) {
+      RKLockProfileDumpString(&dumpBuffer, "  contended at other call sites: ");
+      RKLockProfileDumpNumber(&dumpBuffer, (uint64_t)lockProfile->droppedCallSitesCount, 10);
+      RKLockProfileDumpString(&dumpBuffer, "\n");
+    }
+  }
+  
+  RKLockProfileDumpFlush(&dumpBuffer);
+}
+
+static void RKLockProfileSignalHandler(int signalNumber RK_ATTRIBUTES(unused)) {
+  int savedErrno = errno;
+  RKDumpLockProfiles(STDERR_FILENO);
+  errno = savedErrno;
+}
+
+BOOL RKDumpLockProfilesOnSignal(int signalNumber) {
+  struct sigaction signalAction;
+  
+  memset(&signalAction, 0, sizeof(struct sigaction));
+  signalAction.sa_handler = RKLockProfileSignalHandler;
+  signalAction.sa_flags   = SA_RESTART;
+  sigemptyset(&signalAction.sa_mask);
+  
+  if(sigaction(signalNumber, &signalAction, NULL) != 0) { NSLog(@"sigaction for signal %d returned #%d, %s.", signalNumber, errno, strerror(errno)); return(NO); }
+  return(YES);
+}
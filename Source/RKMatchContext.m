@@ -0,0 +1,265 @@
+//
+//  RKMatchContext.m
+//  RegexKit
+//  http://regexkit.sourceforge.net/
+//
+
+/*
+ Copyright © 2007-2008, John Engelhart
+ 
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+ notice, this list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright
+ notice, this list of conditions and the following disclaimer in the
+ documentation and/or other materials provided with the distribution.
+ 
+ * Neither the name of the Zang Industries nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#import <RegexKit/RKMatchContext.h>
+#import <RegexKit/RegexKitPrivate.h>
+
+#ifndef   RK_ENABLE_THREAD_LOCAL_STORAGE
+static NSString * const RKMatchContextThreadDictionaryKey = @"RKMatchContext";
+#endif // RK_ENABLE_THREAD_LOCAL_STORAGE
+
+static void releaseRKMatchContextResources(RKMatchContext * const self) RK_ATTRIBUTES(nonnull(1), used);
+
+@implementation RKMatchContext
+
++ (RKMatchContext *)matchContext
+{
+  return(RKAutorelease([[self alloc] init]));
+}
+
++ (RKMatchContext *)currentThreadMatchContext
+{
+#ifdef    RK_ENABLE_THREAD_LOCAL_STORAGE
+  return(RKGetThreadLocalMatchContext());
+#else  // RK_ENABLE_THREAD_LOCAL_STORAGE is not defined
+  NSMutableDictionary *threadDictionary = [[NSThread currentThread] threadDictionary];
+  RKMatchContext      *matchContext     = [threadDictionary objectForKey:RKMatchContextThreadDictionaryKey];
+
+  if(RK_EXPECTED(matchContext == NULL, 0)) {
+    if((matchContext = [[RKMatchContext alloc] init]) == NULL) { return(NULL); }
+    [threadDictionary setObject:matchContext forKey:RKMatchContextThreadDictionaryKey];
+    RKRelease(matchContext);
+  }
+
+  return(matchContext);
+#endif // RK_ENABLE_THREAD_LOCAL_STORAGE
+}
+
+- (void)dealloc
+{
+  releaseRKMatchContextResources(self);
+  [super dealloc];
+}
+
+#ifdef    ENABLE_MACOSX_GARBAGE_COLLECTION
+- (void)finalize
+{
+  releaseRKMatchContextResources(self);
+  [super finalize];
+}
+#endif // ENABLE_MACOSX_GARBAGE_COLLECTION
+
+static void releaseRKMatchContextResources(RKMatchContext * const self) {
+  if(self->regex   != NULL) { RKRelease(self->regex); self->regex = NULL; }
+  if(self->vectors != NULL) { RKFreeAndNULL(self->vectors);                }
+  if(self->ranges  != NULL) { RKFreeAndNULL(self->ranges);                 }
+  self->vectorsCount = 0;
+  self->rangesCount  = 0;
+}
+
+- (RKUInteger)hash
+{
+  return((RKUInteger)self);
+}
+
+- (BOOL)isEqual:(id)anObject
+{
+  if(self == anObject) { return(YES); } else { return(NO); }
+}
+
+- (NSString *)description
+{
+  return(RKLocalizedFormat(@"<%@: %p> Regular expression = '%@', Capture count = %lu, Last match result = %ld", [self className], self, (regex == NULL) ? @"" : [regex regexString], (unsigned long)captureCount, (long)matchErrorCode));
+}
+
+- (RKRegex *)regex
+{
+  return(RKAutorelease(RKRetain(regex)));
+}
+
+- (RKUInteger)captureCount
+{
+  return(captureCount);
+}
+
+- (RKMatchErrorCode)matchErrorCode
+{
+  return(matchErrorCode);
+}
+
+- (const NSRange *)ranges
+{
+  return(ranges);
+}
+
+- (NSRange)rangeForCaptureIndex:(const RKUInteger)captureIndex
+{
+  if(RK_EXPECTED(captureIndex >= captureCount, 0)) { [[NSException rkException:NSInvalidArgumentException for:self selector:_cmd localizeReason:@"The capture number %lu is greater than the %lu capture%s in the regular expression.", (unsigned long)captureIndex, (unsigned long)captureCount, (captureCount > 1) ? "s":""] raise]; }
+  if(RK_EXPECTED(matchErrorCode <= 0, 0)) { return(NSMakeRange(NSNotFound, 0)); }
+  return(ranges[captureIndex]);
+}
+
+- (void)setCalloutFunction:(RKMatchCalloutFunction)function context:(void *)context
+{
+  calloutFunction = function;
+  calloutContext  = context;
+}
+
+- (RKMatchCalloutFunction)calloutFunction
+{
+  return(calloutFunction);
+}
+
+- (void *)calloutContext
+{
+  return(calloutContext);
+}
+
+- (void)setMatchLimit:(const RKUInteger)limit
+{
+  matchLimit = limit;
+}
+
+- (RKUInteger)matchLimit
+{
+  return(matchLimit);
+}
+
+- (void)setRecursionLimit:(const RKUInteger)limit
+{
+  recursionLimit = limit;
+}
+
+- (RKUInteger)recursionLimit
+{
+  return(recursionLimit);
+}
+
+- (void)setMatchTimeLimit:(const NSTimeInterval)seconds
+{
+  if(RK_EXPECTED(seconds < 0.0, 0)) { [[NSException rkException:NSInvalidArgumentException for:self selector:_cmd localizeReason:@"The time limit of %f seconds is negative.", seconds] raise]; }
+  matchTimeLimit = (uint64_t)(seconds * 1000000000.0);
+}
+
+- (NSTimeInterval)matchTimeLimit
+{
+  return((NSTimeInterval)matchTimeLimit / 1000000000.0);
+}
+
+//
+// Sizes the receivers buffers for matchRegex.  The buffers are only grown, never shrunk, so a match context that is reused
+// with a number of different regular expressions settles on buffers large enough for all of them.
+//
+
+static BOOL RKMatchContextPrepareForRegex(RKMatchContext * const self, RKRegex * const matchRegex) {
+  RKUInteger matchCaptureCount = [matchRegex captureCount], requiredVectors = (matchCaptureCount * 3);
+
+  if(RK_EXPECTED(requiredVectors > self->vectorsCount, 0)) {
+    if(self->vectors != NULL) { RKFreeAndNULL(self->vectors); self->vectorsCount = 0; }
+    if(RK_EXPECTED((self->vectors = RKMallocNotScanned(sizeof(int) * requiredVectors)) == NULL, 0)) { return(NO); }
+    self->vectorsCount = requiredVectors;
+  }
+
+  if(RK_EXPECTED(matchCaptureCount > self->rangesCount, 0)) {
+    if(self->ranges != NULL) { RKFreeAndNULL(self->ranges); self->rangesCount = 0; }
+    if(RK_EXPECTED((self->ranges = RKMallocNotScanned(sizeof(NSRange) * matchCaptureCount)) == NULL, 0)) { return(NO); }
+    self->rangesCount = matchCaptureCount;
+  }
+
+  if(self->regex != NULL) { RKRelease(self->regex); self->regex = NULL; }
+  self->regex        = RKRetain(matchRegex);
+  self->captureCount = matchCaptureCount;
+
+  return(YES);
+}
+
+//
+// The match context equivalent of -[RKRegex getRanges:count:withCharacters:length:inRange:options:error:].
+// The int vectors from pcre_exec are kept separate from the converted NSRange results, so unlike the stack based
+// version there are no 32 <-> 64 bit in-place conversion ordering issues.
+//
+
+RKMatchErrorCode RKMatchContextGetRanges(RKMatchContext * const self, RKRegex * const matchRegex, const SEL _cmd, const void * const RK_C99(restrict) charactersBuffer, const RKUInteger length, const NSRange searchRange, const RKMatchOption options, NSError **error) {
+  RKMatchErrorCode errorCode      = RKMatchErrorNoError;
+  NSError         *getRangesError = NULL;
+  RKUInteger       x              = 0;
+
+  if(RK_EXPECTED(charactersBuffer == NULL, 0))                             { [[NSException rkException:NSInvalidArgumentException for:matchRegex selector:_cmd localizeReason:@"The charactersBuffer argument is NULL."] raise]; }
+  if(RK_EXPECTED(length < searchRange.location, 0))                        { [[NSException rkException:NSRangeException for:matchRegex selector:_cmd localizeReason:@"The length: parameter of %lu is less than the start location of %lu for the inRange: parameter of {%lu, %lu}.", (unsigned long)length, (unsigned long)searchRange.location, (unsigned long)searchRange.location, (unsigned long)searchRange.length] raise]; }
+  if(RK_EXPECTED(length < (searchRange.location + searchRange.length), 0)) { [[NSException rkException:NSRangeException for:matchRegex selector:_cmd localizeReason:@"The length: parameter of %lu is less than the end location of %lu for the inRange: parameter of {%lu, %lu}.", (unsigned long)length, (unsigned long)NSMaxRange(searchRange), (unsigned long)searchRange.location, (unsigned long)searchRange.length] raise]; }
+  if(RK_EXPECTED(length > INT_MAX, 0))                                     { [[NSException rkException:NSRangeException for:matchRegex selector:_cmd localizeReason:@"The length: parameter of %lu is greater than the maximum of a 32 bit signed int.", (unsigned long)length] raise]; }
+
+  if(RK_EXPECTED(self->regex != matchRegex, 0)) {
+    if(RK_EXPECTED(RKMatchContextPrepareForRegex(self, matchRegex) == NO, 0)) { getRangesError = [NSError rkErrorWithDomain:NSPOSIXErrorDomain code:0 localizeDescription:@"Unable to allocate additional memory."]; errorCode = RKMatchErrorNoMemory; goto exitNow; }
+  }
+
+  RK_PROBE(BEGINMATCH, &((regexProbeObject){matchRegex, regexUTF8String(matchRegex), [matchRegex compileOption]}), [matchRegex hash], self->ranges, self->captureCount, (void *)charactersBuffer, length, (NSRange *)&searchRange, options);
+
+  if(RK_EXPECTED(self->calloutFunction == NULL, 1) && RK_EXPECTED((self->matchLimit | self->recursionLimit | self->matchTimeLimit) == 0, 1)) {
+    errorCode = (RKMatchErrorCode)RKRegexExec(matchRegex, (const char *)charactersBuffer, (int)length, (int)searchRange.location, (int)options, self->vectors, (int)(self->captureCount * 3), NULL);
+  } else {
+    RKMatchLimits matchLimits = { (self->calloutFunction != NULL) ? self : NULL, self->matchLimit, self->recursionLimit, self->matchTimeLimit };
+    errorCode = (RKMatchErrorCode)RKRegexExec(matchRegex, (const char *)charactersBuffer, (int)length, (int)searchRange.location, (int)options, self->vectors, (int)(self->captureCount * 3), &matchLimits);
+  }
+
+  if(errorCode > 0) {
+    if((self->vectors[1] != -1) && ((RKUInteger)self->vectors[1] > NSMaxRange(searchRange))) { errorCode = RKMatchErrorNoMatch; }
+    else {
+      for(x = 0; x < (RKUInteger)errorCode; x++) {
+        if(RK_EXPECTED(self->vectors[(x * 2)] == -1, 0)) { self->ranges[x] = NSMakeRange(NSNotFound, 0); } else { self->ranges[x] = NSMakeRange(self->vectors[(x * 2)], (self->vectors[(x * 2) + 1] - self->vectors[(x * 2)])); }
+      }
+      for(x = (RKUInteger)errorCode; x < self->captureCount; x++) { self->ranges[x] = NSMakeRange(NSNotFound, 0); }
+    }
+  } else {
+    if(errorCode < RKMatchErrorNoMatch) { getRangesError = [NSError rkErrorWithDomain:RKRegexPCRELibraryErrorDomain code:errorCode localizeDescription:RKLocalizedStringForPCRECompileErrorCode(errorCode)]; }
+  }
+
+  RK_PROBE(ENDMATCH, &((regexProbeObject){matchRegex, regexUTF8String(matchRegex), [matchRegex compileOption]}), [matchRegex hash], self->ranges, self->captureCount, (void *)charactersBuffer, length, (NSRange *)&searchRange, options, errorCode, (errorCode > 0) ? "Successful Match" : (char *)RKCharactersFromMatchErrorCode(errorCode));
+
+exitNow:
+  self->matchErrorCode = errorCode;
+  if(error != NULL) { *error = getRangesError; }
+  return(errorCode);
+}
+
+int RKMatchContextCallout(RKMatchContext * const self, pcre_callout_block * const calloutBlock) {
+  if(RK_EXPECTED(self->calloutFunction == NULL, 0)) { return(0); }
+  return(self->calloutFunction(self, calloutBlock, self->calloutContext));
+}
+
+@end
@@ -130,7 +130,13 @@ NSString *RKVPrettyObjectMethodStringFunction(id self, SEL _cmd, NSString * cons
 
 #pragma mark -
 
-int RKRegexPCRECallout(pcre_callout_block * const callout_block RK_ATTRIBUTES(unused)) {
+int RKRegexPCRECallout(pcre_callout_block * const callout_block) {
+  // callout_data is only set when the match has a time limit, or is performed with a RKMatchContext that has a callout function.
+  if(RK_EXPECTED(callout_block->callout_data != NULL, 1)) {
+    RKMatchCalloutState * const calloutState = (RKMatchCalloutState *)callout_block->callout_data;
+    if((calloutState->deadlineNanoseconds != 0) && RK_EXPECTED(RKRegexMetricsNanoseconds() >= calloutState->deadlineNanoseconds, 0)) { return(RKMatchErrorTimeLimit); }
+    return((calloutState->matchContext != NULL) ? RKMatchContextCallout(calloutState->matchContext, callout_block) : 0);
+  }
   [[NSException exceptionWithName:RKRegexUnsupportedException reason:RKLocalizedString(@"Callouts are not supported.") userInfo:NULL] raise];
   return(RKMatchErrorBadOption);
 }
@@ -216,6 +222,12 @@ NSString *RKLocalizedStringForPCRECompileErrorCode(int errorCode) {
     case RKCompileErrorNumberIsTooBig:                              localizeString = @"The number is too large, valid numbers are less than 2147483647."; break;
     case RKCompileErrorSubpatternNameExpected:                      localizeString = @"A named subpattern is required."; break;
     case RKCompileErrorDigitExpectedAfterRelativeSubpattern:        localizeString = @"A number is required after a '(?+' relative subpattern reference."; break;
+
+    // Match errors that are the result of the limits set with RKRegex or RKMatchContext.
+    case RKMatchErrorMatchLimit:                                    localizeString = @"The match limit was reached before the match completed."; break;
+    case RKMatchErrorRecursionLimit:                                localizeString = @"The recursion limit was reached before the match completed."; break;
+    case RKMatchErrorTimeLimit:                                     localizeString = @"The time limit was reached before the match completed."; break;
+    case RKMatchErrorDFAWorkspaceSize:                              localizeString = @"The DFA match needed more workspace than the maximum allowed."; break;
       
     /*
      "(*VERB) with an argument is not supported\0"
@@ -231,3 +243,10 @@ NSString *RKLocalizedStringForPCRECompileErrorCode(int errorCode) {
   if(localizeString != NULL) { returnString = RKLocalizedStringFromTable(localizeString, @"pcre"); }
   return(returnString);
 }
+
+#ifdef    RK_USDT_PROBES
+#pragma mark -
+#pragma mark USDT Probe Semaphores
+
+RK_USDT_PROBES(RK_USDT_DEFINE_SEMAPHORE)
+#endif // RK_USDT_PROBES
@@ -84,6 +84,15 @@ NSString * const RKRegexCaptureRangeErrorKey               = @"RKRegexCaptureRan
 NSString * const RKRegexConversionRangeErrorKey            = @"RKRegexConversionRangeErrorKey";
 NSString * const RKRegexReferenceRangeErrorKey             = @"RKRegexReferenceRangeErrorKey";
 NSString * const RKRegexCaptureIndexErrorKey               = @"RKRegexCaptureIndexErrorKey";
+NSString * const RKRegexHazardsErrorKey                    = @"RKRegexHazardsErrorKey";
+
+#pragma mark Hazard Dictionary Keys
+
+NSString * const RKRegexHazardTypeKey                      = @"RKRegexHazardTypeKey";
+NSString * const RKRegexHazardRangeKey                     = @"RKRegexHazardRangeKey";
+NSString * const RKRegexHazardExponentialKey               = @"RKRegexHazardExponentialKey";
+NSString * const RKRegexHazardHardenableKey                = @"RKRegexHazardHardenableKey";
+NSString * const RKRegexHazardDescriptionKey               = @"RKRegexHazardDescriptionKey";
 
 #pragma mark Global Variables
 
@@ -98,6 +107,62 @@ static NSString      *RKRegexPCREVersionString = NULL;
 static int32_t        RKRegexPCREMajorVersion  = 0;
 static int32_t        RKRegexPCREMinorVersion  = 0;
 static RKBuildConfig  RKRegexPCREBuildConfig   = 0;
+static RKInteger      RKRegexAbortedMatchCount = 0;
+
+#pragma mark -
+#pragma mark Batch Matching State
+
+// The number of subjects a thread claims at a time.  Must be a multiple of 8 so that each thread owns whole bytes of the results bitmap.
+#define RK_BATCH_MATCH_BLOCK_SIZE 64
+
+struct _RKRegexBatchMatchState {
+  RKRegex                         *regex;
+  id const        RK_STRONG_REF   *subjects;
+  RKUInteger                       count;
+  unsigned char   RK_STRONG_REF   *resultsBitmap;
+  NSRange         RK_STRONG_REF   *resultRanges;
+  RKMatchOption                    options;
+  RKUInteger                       atBlock;
+  RKUInteger                       matchedCount;
+  RKMatchErrorCode                 firstErrorCode;
+};
+
+typedef struct _RKRegexBatchMatchState RK_STRONG_REF RKRegexBatchMatchState;
+
+static int RKRegexBatchMatchFunction(void *batchMatchState) RK_ATTRIBUTES(used, nonnull);
+
+// The largest capture that is copied to the stack and handed to sscanf() when a numeric capture can not be converted directly.
+#define RK_BATCH_EXTRACT_MAX_SCANF_LENGTH 127
+
+struct _RKRegexBatchExtractState {
+  RKRegex                         *regex;
+  id const        RK_STRONG_REF   *subjects;
+  RKUInteger                       count;
+  RKCaptureColumn RK_STRONG_REF   *columns;
+  RKUInteger      RK_STRONG_REF   *columnCaptureIndexes;
+  RKUInteger                       columnCount;
+  RKMatchOption                    options;
+  RKUInteger                       atBlock;
+  RKUInteger                       matchedCount;
+  RKMatchErrorCode                 firstErrorCode;
+};
+
+typedef struct _RKRegexBatchExtractState RK_STRONG_REF RKRegexBatchExtractState;
+
+static int RKRegexBatchExtractFunction(void *batchExtractState) RK_ATTRIBUTES(used, nonnull);
+
+static const pcre_extra *RKRegexLimitedExtra(RKRegex * const self, const RKMatchLimits * const matchLimits, pcre_extra * const limitedExtraPCRE, RKMatchCalloutState * const calloutState) RK_ATTRIBUTES(used, nonnull(1, 3, 4));
+
+// pcre_dfa_exec() workspace sizes, in ints.  The workspace starts small and is grown by four times each time it is too small.
+#define RK_DFA_INITIAL_WORKSPACE (1024)
+#define RK_DFA_MAXIMUM_WORKSPACE (1024 * 1024)
+// The number of timed matches RKMatchEngineAutomatic samples, half with each algorithm, before it picks one.
+#define RK_MATCH_ENGINE_SAMPLES  (32)
+
+static int RKRegexPCREDFAExec(RKRegex * const self, const pcre_extra * const extraPCRE, const char * const RK_C99(restrict) charactersBuffer, const int length, const int startOffset, const int options, int * const RK_C99(restrict) vectors, const int vectorsCount) RK_ATTRIBUTES(used, nonnull(1, 3));
+static int RKRegexWholeMatchExec(RKRegex * const self, const char * const RK_C99(restrict) charactersBuffer, const int length, const int startOffset, const int options, int * const RK_C99(restrict) vectors, const int vectorsCount, const BOOL isMatchOnly) RK_ATTRIBUTES(used, nonnull(1, 2));
+
+static RKMatchErrorCode RKRegexGetRangeForCaptureIndex(RKRegex * const self, const SEL _cmd, const void * const RK_C99(restrict) charactersBuffer, const RKUInteger length, const NSRange searchRange, const RKUInteger captureIndex, const RKMatchOption options, const BOOL isMatchOnly, NSRange * const RK_C99(restrict) matchRange, NSError **error) RK_ATTRIBUTES(used, nonnull(1, 9));
 
 #pragma mark -
 #pragma mark Core Foundation Call Backs
@@ -124,6 +189,14 @@ static void __RKThreadIsExiting(void *arg) {
   struct __RKThreadLocalData RK_STRONG_REF *tld = (struct __RKThreadLocalData *)arg;
   if(tld == NULL) { return; }
   if(tld->_numberFormatter != NULL) { RKEnableCollectorForPointer(tld->_numberFormatter); RKRelease(tld->_numberFormatter); tld->_numberFormatter = NULL; }
+  if(tld->_matchContext    != NULL) { RKEnableCollectorForPointer(tld->_matchContext);    RKRelease(tld->_matchContext);    tld->_matchContext    = NULL; }
+  if(tld->_regexMetrics    != NULL) { RKRegexMetricsThreadIsExiting(tld->_regexMetrics);                                                tld->_regexMetrics    = NULL; }
+  if(tld->_dfaWorkspace    != NULL) { RKFreeAndNULLNoGC(tld->_dfaWorkspace);                                                                tld->_dfaWorkspaceCount = 0; }
+  RKUInteger dateCacheIndex = 0;
+  for(dateCacheIndex = 0; dateCacheIndex < RK_DATE_CACHE_ENTRIES; dateCacheIndex++) {
+    struct __RKDateCacheEntry RK_STRONG_REF *dateCacheEntry = &tld->_dateCache[dateCacheIndex];
+    if(dateCacheEntry->timeZone != NULL) { RKEnableCollectorForPointer(dateCacheEntry->timeZone); RKRelease(dateCacheEntry->timeZone); dateCacheEntry->timeZone = NULL; }
+  }
   RKFreeAndNULLNoGC(tld);
   tld = NULL;
 }
@@ -141,6 +214,19 @@ struct __RKThreadLocalData *__RKGetThreadLocalData(void) {
   return(tld);
 }
 
+RKMatchContext *__RKGetThreadLocalMatchContext(void) {
+  if(RK_EXPECTED(RKRegexLoadInitialized == 0, 0)) { [RKRegex initialize]; }
+
+  struct __RKThreadLocalData RK_STRONG_REF *tld = NULL;
+  
+  if(RK_EXPECTED((tld = __RKGetThreadLocalData()) == NULL, 0)) { return(NULL);                }
+  if(RK_EXPECTED(tld->_matchContext               != NULL, 1)) { return(tld->_matchContext); }
+  
+  tld->_matchContext = [[RKMatchContext alloc] init];
+  RKDisableCollectorForPointer(tld->_matchContext);
+  return(tld->_matchContext);
+}
+
 #ifdef    HAVE_NSNUMBERFORMATTER_CONVERSIONS
 
 NSNumberFormatter *__RKGetThreadLocalNumberFormatter(void) {
@@ -167,6 +253,158 @@ NSNumberFormatter *__RKGetThreadLocalNumberFormatter(void) {
 
 @implementation RKRegex
 
+// Every pcre_exec in this file goes through here so that the match limits and, when enabled, the match metrics see every match.
+// matchLimits is only passed by matches performed with a RKMatchContext, and overrides the limits of the regex.
+
+RKREGEX_STATIC_INLINE int RKRegexPCREExec(RKRegex * const self, const RKMatchLimits * const matchLimits, const char * const RK_C99(restrict) charactersBuffer, const int length, const int startOffset, const int options, int * const RK_C99(restrict) vectors, const int vectorsCount) {
+  const pcre_extra    *extraPCRE    = self->_extraPCRE;
+  pcre_extra           limitedExtraPCRE;
+  RKMatchCalloutState  calloutState;
+  uint64_t             matchStarted = 0;
+  int                  errorCode    = 0;
+  
+  if(RK_EXPECTED(matchLimits != NULL, 0) || RK_EXPECTED((self->matchLimit | self->recursionLimit | self->matchTimeLimit) != 0, 0)) { extraPCRE = RKRegexLimitedExtra(self, matchLimits, &limitedExtraPCRE, &calloutState); }
+  
+  if(RK_EXPECTED(RKRegexMetricsCollect == 0, 1)) {
+    if(RK_EXPECTED((options & RKMatchDFA) == 0, 1)) { errorCode = pcre_exec(self->_compiledPCRE, extraPCRE, charactersBuffer, length, startOffset, options, vectors, vectorsCount); }
+    else { errorCode = RKRegexPCREDFAExec(self, extraPCRE, charactersBuffer, length, startOffset, options, vectors, vectorsCount); }
+  } else {
+    if(RK_EXPECTED(self->metricsIndex == 0, 0)) { self->metricsIndex = RKRegexMetricsRegister(self->compiledRegexString, self->compileOption, self->hash); }
+    matchStarted = RKRegexMetricsNanoseconds();
+    if(RK_EXPECTED((options & RKMatchDFA) == 0, 1)) { errorCode = pcre_exec(self->_compiledPCRE, extraPCRE, charactersBuffer, length, startOffset, options, vectors, vectorsCount); }
+    else { errorCode = RKRegexPCREDFAExec(self, extraPCRE, charactersBuffer, length, startOffset, options, vectors, vectorsCount); }
+    RKRegexMetricsRecord(self->metricsIndex, (RKUInteger)(length - startOffset), RKRegexMetricsNanoseconds() - matchStarted, errorCode);
+  }
+  
+  if(RK_EXPECTED(errorCode < RKMatchErrorNoMatch, 0) && ((errorCode == RKMatchErrorMatchLimit) || (errorCode == RKMatchErrorRecursionLimit) || (errorCode == RKMatchErrorTimeLimit))) { RKAtomicIncrementInteger(&RKRegexAbortedMatchCount); }
+  
+  return(errorCode);
+}
+
+// Fills in limitedExtraPCRE, a copy of the regexes pcre_extra with the match limits applied, and calloutState when the match
+// needs callouts for a time limit or a match context callout function.  The shared _extraPCRE is never modified.
+
+static const pcre_extra *RKRegexLimitedExtra(RKRegex * const self, const RKMatchLimits * const matchLimits, pcre_extra * const limitedExtraPCRE, RKMatchCalloutState * const calloutState) {
+  RKUInteger matchLimit     = self->matchLimit,     recursionLimit = self->recursionLimit;
+  uint64_t   matchTimeLimit = self->matchTimeLimit;
+  
+  if(self->_extraPCRE != NULL) { *limitedExtraPCRE = *self->_extraPCRE; } else { memset(limitedExtraPCRE, 0, sizeof(pcre_extra)); }
+  calloutState->matchContext        = NULL;
+  calloutState->deadlineNanoseconds = 0;
+  
+  if(matchLimits != NULL) {
+    if(matchLimits->matchLimit           != 0) { matchLimit     = matchLimits->matchLimit;           }
+    if(matchLimits->recursionLimit       != 0) { recursionLimit = matchLimits->recursionLimit;       }
+    if(matchLimits->timeLimitNanoseconds != 0) { matchTimeLimit = matchLimits->timeLimitNanoseconds; }
+    calloutState->matchContext = matchLimits->calloutMatchContext;
+  }
+  
+  if(matchLimit     != 0) { limitedExtraPCRE->flags |= PCRE_EXTRA_MATCH_LIMIT;           limitedExtraPCRE->match_limit           = (unsigned long)matchLimit;     }
+  if(recursionLimit != 0) { limitedExtraPCRE->flags |= PCRE_EXTRA_MATCH_LIMIT_RECURSION; limitedExtraPCRE->match_limit_recursion = (unsigned long)recursionLimit; }
+  if(matchTimeLimit != 0) { calloutState->deadlineNanoseconds = RKRegexMetricsNanoseconds() + matchTimeLimit; }
+  
+  if((calloutState->matchContext != NULL) || (calloutState->deadlineNanoseconds != 0)) {
+    limitedExtraPCRE->flags        |= PCRE_EXTRA_CALLOUT_DATA;
+    limitedExtraPCRE->callout_data  = calloutState;
+  }
+  
+  return(limitedExtraPCRE);
+}
+
+// Performs a RKMatchDFA match with pcre_dfa_exec().  The result is returned in the same form as pcre_exec(): the longest (or
+// with RKMatchDFAShortest, the shortest) match at the first matching position is returned in the first pair of vectors, and the
+// pairs for the captures are set to -1 since the DFA algorithm does not track them.  The workspace is kept in the thread local
+// data and grown as needed.  Regexes with items the DFA algorithm does not support are matched with pcre_exec() instead.
+
+static int RKRegexPCREDFAExec(RKRegex * const self, const pcre_extra * const extraPCRE, const char * const RK_C99(restrict) charactersBuffer, const int length, const int startOffset, const int options, int * const RK_C99(restrict) vectors, const int vectorsCount) {
+  struct __RKThreadLocalData RK_STRONG_REF *tld = NULL;
+  const pcre_extra                         *dfaExtraPCRE     = extraPCRE;
+  pcre_extra                                unlimitedExtraPCRE;
+  int                                      *workspace        = NULL, dfaVectors[2] = {-1, -1}, errorCode = RKMatchErrorNoMemory, atVector = 0;
+  RKUInteger                                workspaceCount   = RK_DFA_INITIAL_WORKSPACE;
+  
+  if(RK_EXPECTED(self->dfaUnsupported == YES, 0)) { goto backtrackingMatch; }
+  
+  // The DFA algorithm never backtracks, so the backtracking limits do not apply.  pcre_dfa_exec() returns an error if they are set.
+  if((extraPCRE != NULL) && ((extraPCRE->flags & (PCRE_EXTRA_MATCH_LIMIT | PCRE_EXTRA_MATCH_LIMIT_RECURSION)) != 0)) {
+    unlimitedExtraPCRE        = *extraPCRE;
+    unlimitedExtraPCRE.flags &= ~(PCRE_EXTRA_MATCH_LIMIT | PCRE_EXTRA_MATCH_LIMIT_RECURSION);
+    dfaExtraPCRE              = &unlimitedExtraPCRE;
+  }
+  
+  // The workspace is taken out of the thread local data for the duration of the match.  A callout may start a nested DFA match on
+  // this thread, which must not write to, or grow and free, the workspace that this match is still using.
+#ifdef    RK_ENABLE_THREAD_LOCAL_STORAGE
+  if(RK_EXPECTED((tld = RKGetThreadLocalData()) != NULL, 1) && RK_EXPECTED(tld->_dfaWorkspace != NULL, 1)) { workspace = tld->_dfaWorkspace; workspaceCount = tld->_dfaWorkspaceCount; tld->_dfaWorkspace = NULL; tld->_dfaWorkspaceCount = 0; }
+#endif // RK_ENABLE_THREAD_LOCAL_STORAGE
+  
+  for(;;) {
+    if(RK_EXPECTED(workspace == NULL, 0)) { if((workspace = RKMallocNoGC(sizeof(int) * workspaceCount)) == NULL) { errorCode = RKMatchErrorNoMemory; break; } }
+    errorCode = pcre_dfa_exec(self->_compiledPCRE, dfaExtraPCRE, charactersBuffer, length, startOffset, (options & ~RKMatchDFA), dfaVectors, 2, workspace, (int)workspaceCount);
+    if(RK_EXPECTED(errorCode != RKMatchErrorDFAWorkspaceSize, 1) || (workspaceCount >= RK_DFA_MAXIMUM_WORKSPACE)) { break; }
+    
+    RKFreeAndNULLNoGC(workspace);
+    workspaceCount *= 4;
+  }
+  
+  // Put the workspace back for the next match.  If a nested match left a workspace behind, only the larger of the two is kept.
+  if((tld != NULL) && (workspace != NULL)) {
+    if((tld->_dfaWorkspace != NULL) && (tld->_dfaWorkspaceCount >= workspaceCount)) { RKFreeAndNULLNoGC(workspace); }
+    else { if(tld->_dfaWorkspace != NULL) { RKFreeAndNULLNoGC(tld->_dfaWorkspace); } tld->_dfaWorkspace = workspace; tld->_dfaWorkspaceCount = workspaceCount; workspace = NULL; }
+  }
+  if(workspace != NULL) { RKFreeAndNULLNoGC(workspace); }
+  
+  if(RK_EXPECTED(errorCode >= 0, 1)) {
+    if(vectorsCount < 2) { return(0); }
+    vectors[0] = dfaVectors[0];
+    vectors[1] = dfaVectors[1];
+    for(atVector = 2; atVector < ((vectorsCount / 3) * 2); atVector++) { vectors[atVector] = -1; }
+    return((vectorsCount >= 3) ? 1 : 0);
+  }
+  
+  if(RK_EXPECTED((errorCode != PCRE_ERROR_DFA_UITEM) && (errorCode != PCRE_ERROR_DFA_UCOND) && (errorCode != PCRE_ERROR_DFA_RECURSE), 1)) { return(errorCode); }
+  self->dfaUnsupported = YES;
+  
+backtrackingMatch:
+  return(pcre_exec(self->_compiledPCRE, extraPCRE, charactersBuffer, length, startOffset, (options & ~RKMatchDFAShortest), vectors, vectorsCount));
+}
+
+// Used by the matches that only need the range of the entire match to pick the algorithm for the regexes RKMatchEngine.
+// isMatchOnly is YES when the caller only needs a yes or no answer and the search extends to the end of the subject, which
+// are the only matches where RKMatchEngineAutomatic may use the DFA algorithm.  Regexes with atomic groups or possessive
+// quantifiers, where the DFA algorithm could give a different answer, are marked dfaUnsupported when they are compiled.
+
+static int RKRegexWholeMatchExec(RKRegex * const self, const char * const RK_C99(restrict) charactersBuffer, const int length, const int startOffset, const int options, int * const RK_C99(restrict) vectors, const int vectorsCount, const BOOL isMatchOnly) {
+  uint64_t   matchStarted = 0;
+  RKInteger  samples      = 0;
+  BOOL       useDFA       = NO;
+  int        errorCode    = 0;
+  
+  if(RK_EXPECTED(self->matchEngine == RKMatchEngineBacktracking, 1) || ((options & RKMatchDFA) != 0)) { return(RKRegexPCREExec(self, NULL, charactersBuffer, length, startOffset, options, vectors, vectorsCount)); }
+  if(self->matchEngine == RKMatchEngineDFA) { return(RKRegexPCREExec(self, NULL, charactersBuffer, length, startOffset, (options | RKMatchDFA), vectors, vectorsCount)); }
+  
+  if((isMatchOnly == NO) || (self->dfaUnsupported == YES) || ((options & RKMatchPartial) != 0)) { return(RKRegexPCREExec(self, NULL, charactersBuffer, length, startOffset, options, vectors, vectorsCount)); }
+  
+  if(RK_EXPECTED((samples = self->matchEngineSamples) >= RK_MATCH_ENGINE_SAMPLES, 1)) {
+    RKAtomicMemoryBarrier();
+    return(RKRegexPCREExec(self, NULL, charactersBuffer, length, startOffset, (self->automaticEngineIsDFA == YES) ? (options | RKMatchDFA) : options, vectors, vectorsCount));
+  }
+  
+  // Still sampling.  Alternate between the two algorithms.  The totals are updated without locking, an occasional lost sample does not matter.
+  useDFA       = ((samples & 1) == 1) ? YES : NO;
+  matchStarted = RKRegexMetricsNanoseconds();
+  errorCode    = RKRegexPCREExec(self, NULL, charactersBuffer, length, startOffset, (useDFA == YES) ? (options | RKMatchDFA) : options, vectors, vectorsCount);
+  if(useDFA == YES) { self->dfaNanoseconds += RKRegexMetricsNanoseconds() - matchStarted; } else { self->backtrackNanoseconds += RKRegexMetricsNanoseconds() - matchStarted; }
+  
+  if(RKAtomicIncrementInteger(&self->matchEngineSamples) == (RK_MATCH_ENGINE_SAMPLES - 1)) {
+    self->automaticEngineIsDFA = ((self->dfaUnsupported == NO) && (self->dfaNanoseconds < self->backtrackNanoseconds)) ? YES : NO;
+    RKAtomicMemoryBarrier();
+    RKAtomicIncrementInteger(&self->matchEngineSamples);
+  }
+  
+  return(errorCode);
+}
+
 //
 // +initialize is called by the runtime just before the class receives its first message.
 //
@@ -602,6 +840,9 @@ NSError *RKErrorForCompileInitFailure(id self RK_ATTRIBUTES(unused), const SEL _
   if(RK_EXPECTED(pcre_fullinfo(_compiledPCRE, _extraPCRE, PCRE_INFO_CAPTURECOUNT, &captureCount) != RKMatchErrorNoError, 0)) { goto errorExit; }
   captureCount++;
   
+  // The DFA algorithm matches atomic groups and possessive quantifiers as if they were ordinary groups and quantifiers, which can change the answer.
+  if(RK_EXPECTED(RKAnalysisHasAtomicItems(compiledRegexString, compileOption) == YES, 0)) { dfaUnsupported = YES; }
+  
   if(RK_EXPECTED(pcre_fullinfo(_compiledPCRE,   _extraPCRE, PCRE_INFO_NAMECOUNT,     &captureNameTableLength) != RKMatchErrorNoError, 0)) { goto errorExit; }
   if(captureNameTableLength > 0) {
     if(RK_EXPECTED(pcre_fullinfo(_compiledPCRE, _extraPCRE, PCRE_INFO_NAMEENTRYSIZE, &captureNameLength)      != RKMatchErrorNoError, 0)) { goto errorExit; }
@@ -781,6 +1022,62 @@ exitNow:
   return(captureCount);
 }
 
+#pragma mark -
+#pragma mark Match Limits
+
+- (void)setMatchLimit:(const RKUInteger)limit
+{
+  matchLimit = limit;
+}
+
+- (RKUInteger)matchLimit
+{
+  return(matchLimit);
+}
+
+- (void)setRecursionLimit:(const RKUInteger)limit
+{
+  recursionLimit = limit;
+}
+
+- (RKUInteger)recursionLimit
+{
+  return(recursionLimit);
+}
+
+- (void)setMatchTimeLimit:(const NSTimeInterval)seconds
+{
+  if(RK_EXPECTED(seconds < 0.0, 0)) { [[NSException rkException:NSInvalidArgumentException for:self selector:_cmd localizeReason:@"The time limit of %f seconds is negative.", seconds] raise]; }
+  matchTimeLimit = (uint64_t)(seconds * 1000000000.0);
+}
+
+- (NSTimeInterval)matchTimeLimit
+{
+  return((NSTimeInterval)matchTimeLimit / 1000000000.0);
+}
+
+#pragma mark -
+#pragma mark Match Engine
+
+- (void)setMatchEngine:(const RKMatchEngine)engine
+{
+  if(RK_EXPECTED((RKUInteger)engine > (RKUInteger)RKMatchEngineAutomatic, 0)) { [[NSException rkException:NSInvalidArgumentException for:self selector:_cmd localizeReason:@"The match engine %lu is not valid.", (unsigned long)engine] raise]; }
+  if(engine == matchEngine) { return; }
+  
+  // Changing to RKMatchEngineAutomatic starts a new round of sampling.
+  automaticEngineIsDFA = NO;
+  backtrackNanoseconds = 0;
+  dfaNanoseconds       = 0;
+  matchEngineSamples   = 0;
+  RKAtomicMemoryBarrier();
+  matchEngine          = engine;
+}
+
+- (RKMatchEngine)matchEngine
+{
+  return(matchEngine);
+}
+
 #pragma mark -
 #pragma mark Capture Name Methods
 
@@ -960,17 +1257,66 @@ exitNow:
   return(captureIndex);
 }
 
+// Returns YES if a capture name may refer to more than one capture index, in which case the index can only be determined from the match results.
+BOOL RKRegexCaptureNamesMayBeDuplicated(RKRegex * const aRegex) {
+  RKRegex *self           = aRegex;
+  int      optionJChanged = 0;
+  
+  if((self->compileOption & RKCompileDupNames) != 0) { return(YES); }
+#ifdef    PCRE_INFO_JCHANGED // Only checked if defined, which is pcre >= 7.2
+  if(RK_EXPECTED(pcre_fullinfo(self->_compiledPCRE, self->_extraPCRE, PCRE_INFO_JCHANGED, &optionJChanged) != RKMatchErrorNoError, 0)) { return(YES); }
+#endif // PCRE_INFO_JCHANGED
+  return((optionJChanged == 0) ? NO : YES);
+}
+
+// Sets the bits in the 256 bit startBytes set for the bytes that a match can start with, from PCRE_INFO_FIRSTBYTE or the studied
+// PCRE_INFO_FIRSTTABLE.  Returns NO if PCRE does not know, for example when the regex can match the empty string, in which case
+// a match may start with any byte.
+BOOL RKRegexGetStartBytes(RKRegex * const aRegex, uint32_t * const RK_C99(restrict) startBytes) {
+  RKRegex             *self       = aRegex;
+  const unsigned char *firstTable = NULL;
+  int                  firstByte  = -2, atByte = 0;
+  
+  memset(startBytes, 0, sizeof(uint32_t) * 8);
+  if(RK_EXPECTED(pcre_fullinfo(self->_compiledPCRE, self->_extraPCRE, PCRE_INFO_FIRSTBYTE, &firstByte) != RKMatchErrorNoError, 0)) { return(NO); }
+  
+  if(firstByte >= 0) {
+    atByte = (firstByte & 0xff);
+    startBytes[atByte >> 5] |= (1U << (atByte & 0x1f));
+    if((firstByte & 0x100) != 0) { // Caseless.  Only ASCII letters are folded.
+      if(((atByte >= 'a') && (atByte <= 'z')) || ((atByte >= 'A') && (atByte <= 'Z'))) { atByte ^= 0x20; startBytes[atByte >> 5] |= (1U << (atByte & 0x1f)); }
+      else if(atByte > 0x7f) { return(NO); }
+    }
+    return(YES);
+  }
+  
+  if((firstByte == -1) || (self->_extraPCRE == NULL)) { return(NO); } // -1 is a match that starts at the start of a line.
+  if(RK_EXPECTED(pcre_fullinfo(self->_compiledPCRE, self->_extraPCRE, PCRE_INFO_FIRSTTABLE, &firstTable) != RKMatchErrorNoError, 0) || (firstTable == NULL)) { return(NO); }
+  for(atByte = 0; atByte < 256; atByte++) { if((firstTable[atByte >> 3] & (1 << (atByte & 0x7))) != 0) { startBytes[atByte >> 5] |= (1U << (atByte & 0x1f)); } }
+  return(YES);
+}
+
 #pragma mark -
 #pragma mark Regex Matching Methods
 
 - (BOOL)matchesCharacters:(const void * const RK_C99(restrict))matchCharacters length:(const RKUInteger)length inRange:(const NSRange)searchRange options:(const RKMatchOption)options
 {
-  return((NSEqualRanges(NSMakeRange(NSNotFound, 0), [self rangeForCharacters:matchCharacters length:length inRange:searchRange captureIndex:0 options:options]) == YES) ? NO : YES);
+  NSError *matchError = NULL;
+  BOOL     matches    = [self matchesCharacters:matchCharacters length:length inRange:searchRange options:options error:&matchError];
+
+  if((matchError != NULL) && ([[matchError domain] isEqualToString:RKRegexPCRELibraryErrorDomain] == NO)) { [[NSException exceptionWithName:[[matchError domain] isEqualToString:NSPOSIXErrorDomain] ? NSMallocException : NSInvalidArgumentException reason:RKPrettyObjectMethodString([matchError localizedDescription]) userInfo:NULL] raise]; }
+  return(matches);
 }
 
+// Only a yes or no answer is needed, so RKMatchEngineAutomatic is free to use the DFA algorithm.
 - (BOOL)matchesCharacters:(const void * const RK_C99(restrict))matchCharacters length:(const RKUInteger)length inRange:(const NSRange)searchRange options:(const RKMatchOption)options error:(NSError **)error
 {
-  return((NSEqualRanges(NSMakeRange(NSNotFound, 0), [self rangeForCharacters:matchCharacters length:length inRange:searchRange captureIndex:0 options:options error:error]) == YES) ? NO : YES);
+  NSRange  matchRange = NSMakeRange(NSNotFound, 0);
+  NSError *matchError = NULL;
+  
+  RKRegexGetRangeForCaptureIndex(self, _cmd, matchCharacters, length, searchRange, 0, options, YES, &matchRange, &matchError);
+  if(error != NULL) { *error = matchError; }
+  return((matchRange.location == NSNotFound) ? NO : YES);
 }
 
 
@@ -984,26 +1330,66 @@ exitNow:
   return(matchRange);
 }
 
-// XXX WARNING: This code uses alloca().  If you do not -=COMPLETELY=- understand what alloca() does, you MUST NOT alter this code.
 - (NSRange)rangeForCharacters:(const void * const RK_C99(restrict))matchCharacters length:(const RKUInteger)length inRange:(const NSRange)searchRange captureIndex:(const RKUInteger)captureIndex options:(const RKMatchOption)options error:(NSError **)error
 {
-  RKMatchErrorCode matchErrorCode = RKMatchErrorNoError;
-  NSRange * RK_C99(restrict) matchRanges = NULL, returnRange = NSMakeRange(NSNotFound, 0);
-  NSError *matchError = NULL;
+  NSRange  returnRange = NSMakeRange(NSNotFound, 0);
+  NSError *matchError  = NULL;
   
-  if(RK_EXPECTED((matchRanges = alloca(RK_PRESIZE_CAPTURE_COUNT(captureCount) * sizeof(NSRange))) == NULL, 0)) { matchError = [NSError rkErrorWithDomain:NSPOSIXErrorDomain code:0 localizeDescription:@"Unable to allocate temporary stack space."]; goto errorExit; }
-
   if(RK_EXPECTED(captureIndex >= captureCount, 0)) { matchError = [NSError rkErrorWithCode:0 localizeDescription:@"The capture number %lu is greater than the %lu capture%s in the regular expression.", (unsigned long)captureIndex, (unsigned long)(captureCount + 1), (captureCount + 1) > 1 ? "s":""]; goto errorExit; }
 
-  matchErrorCode = [self getRanges:matchRanges count:RK_PRESIZE_CAPTURE_COUNT(captureCount) withCharacters:matchCharacters length:length inRange:searchRange options:options error:&matchError];
-  if((matchErrorCode <= 0) || RK_EXPECTED(RKRangeInsideRange(matchRanges[0], searchRange) == NO, 0)) { goto errorExit; } // safe despite uninitialized matchRanges[0] on error
-  returnRange = matchRanges[captureIndex];
+  RKRegexGetRangeForCaptureIndex(self, _cmd, matchCharacters, length, searchRange, captureIndex, options, NO, &returnRange, &matchError);
 
 errorExit:
   if(error != NULL) { *error = matchError; }
   return(returnRange);
 }
 
+//
+// Fast path for the methods that only need a single range (or just a yes / no answer), ie rangeForCharacters: and
+// matchesCharacters:.  Rather than a full RK_PRESIZE_CAPTURE_COUNT() ovector and a conversion of every capture to a
+// NSRange, pcre_exec is only given room for the pairs up to and including captureIndex.  When the ovector is too
+// small to hold all of the captures pcre_exec returns 0, which is still a successful match, and the pairs that did fit
+// are valid.  A captureIndex of 0 asks for the whole match pair only, which is still needed to check that the match
+// does not extend past the end of searchRange.
+//
+
+// XXX WARNING: This code uses alloca().  If you do not -=COMPLETELY=- understand what alloca() does, you MUST NOT alter this code.
+static RKMatchErrorCode RKRegexGetRangeForCaptureIndex(RKRegex * const self, const SEL _cmd, const void * const RK_C99(restrict) charactersBuffer, const RKUInteger length, const NSRange searchRange, const RKUInteger captureIndex, const RKMatchOption options, const BOOL isMatchOnly, NSRange * const RK_C99(restrict) matchRange, NSError **error) {
+  RKMatchErrorCode errorCode = RKMatchErrorNoError;
+  int wholeMatchVectors[3], * RK_C99(restrict) vectors = wholeMatchVectors, vectorsCount = (int)((captureIndex + 1) * 3);
+
+  if(RK_EXPECTED(charactersBuffer == NULL, 0))                             { [[NSException rkException:NSInvalidArgumentException for:self selector:_cmd localizeReason:@"The charactersBuffer argument is NULL."] raise]; }
+  if(RK_EXPECTED(length < searchRange.location, 0))                        { [[NSException rkException:NSRangeException for:self selector:_cmd localizeReason:@"The length: parameter of %lu is less than the start location of %lu for the inRange: parameter of {%lu, %lu}.", (unsigned long)length, (unsigned long)searchRange.location, (unsigned long)searchRange.location, (unsigned long)searchRange.length] raise]; }
+  if(RK_EXPECTED(length < (searchRange.location + searchRange.length), 0)) { [[NSException rkException:NSRangeException for:self selector:_cmd localizeReason:@"The length: parameter of %lu is less than the end location of %lu for the inRange: parameter of {%lu, %lu}.", (unsigned long)length, (unsigned long)NSMaxRange(searchRange), (unsigned long)searchRange.location, (unsigned long)searchRange.length] raise]; }
+  if(RK_EXPECTED(length > INT_MAX, 0))                                     { [[NSException rkException:NSRangeException for:self selector:_cmd localizeReason:@"The length: parameter of %lu is greater than the maximum of a 32 bit signed int.", (unsigned long)length] raise]; }
+
+  *matchRange = NSMakeRange(NSNotFound, 0);
+  
+  if(RK_EXPECTED(captureIndex > 0, 0)) {
+    if(RK_EXPECTED((vectors = alloca(vectorsCount * sizeof(int))) == NULL, 0)) { if(error != NULL) { *error = [NSError rkErrorWithDomain:NSPOSIXErrorDomain code:0 localizeDescription:@"Unable to allocate temporary stack space."]; } return(RKMatchErrorNoMemory); }
+  }
+
+  RK_PROBE(BEGINMATCH, &((regexProbeObject){self, regexUTF8String(self), self->compileOption}), self->hash, matchRange, 1, (void *)charactersBuffer, length, (NSRange *)&searchRange, options);
+
+  if(RK_EXPECTED(captureIndex == 0, 1)) { errorCode = (RKMatchErrorCode)RKRegexWholeMatchExec(self, (const char *)charactersBuffer, (int)length, (int)searchRange.location, (int)options, vectors, vectorsCount, ((isMatchOnly == YES) && (NSMaxRange(searchRange) == length)) ? YES : NO); }
+  else { errorCode = (RKMatchErrorCode)RKRegexPCREExec(self, NULL, (const char *)charactersBuffer, (int)length, (int)searchRange.location, (int)options, vectors, vectorsCount); }
+
+  if(errorCode >= 0) {
+    if(RK_EXPECTED((RKUInteger)vectors[1] > NSMaxRange(searchRange), 0)) { errorCode = RKMatchErrorNoMatch; }
+    else {
+      if(errorCode == 0) { errorCode = (RKMatchErrorCode)(captureIndex + 1); }
+      else if((RKUInteger)errorCode <= captureIndex) { goto exitNow; } // captureIndex, and everything after it, did not participate in the match.
+      if(vectors[(captureIndex * 2)] != -1) { *matchRange = NSMakeRange(vectors[(captureIndex * 2)], (vectors[(captureIndex * 2) + 1] - vectors[(captureIndex * 2)])); }
+    }
+  } else if(errorCode < RKMatchErrorNoMatch) {
+    if(error != NULL) { *error = [NSError rkErrorWithDomain:RKRegexPCRELibraryErrorDomain code:errorCode localizeDescription:RKLocalizedStringForPCRECompileErrorCode(errorCode)]; }
+  }
+
+exitNow:
+  RK_PROBE(ENDMATCH, &((regexProbeObject){self, regexUTF8String(self), self->compileOption}), self->hash, matchRange, 1, (void *)charactersBuffer, length, (NSRange *)&searchRange, options, errorCode, (errorCode > 0) ? "Successful Match" : (char *)RKCharactersFromMatchErrorCode(errorCode));
+  return(errorCode);
+}
+
 
 //
 // Returns a pointer to a chunk of memory that is an array of NSRanges with captureCount elements.  Example:
@@ -1048,6 +1434,306 @@ errorExit:
   return(returnRanges);  
 }
 
+#pragma mark -
+#pragma mark Batch Matching Methods
+
+- (RKUInteger)matchesSubjects:(id const * const RK_C99(restrict))subjects count:(const RKUInteger)count results:(unsigned char * const RK_C99(restrict))resultsBitmap
+{
+  return([self matchesSubjects:subjects count:count results:resultsBitmap ranges:NULL options:RKMatchNoOptions concurrent:NO error:NULL]);
+}
+
+- (RKUInteger)matchesSubjects:(id const * const RK_C99(restrict))subjects count:(const RKUInteger)count results:(unsigned char * const RK_C99(restrict))resultsBitmap ranges:(NSRange * const RK_C99(restrict))resultRanges options:(const RKMatchOption)options concurrent:(const BOOL)concurrent error:(NSError **)error
+{
+  if(error != NULL) { *error = NULL; }
+  if(RK_EXPECTED(count == 0, 0)) { return(0); }
+  if(RK_EXPECTED(subjects == NULL, 0)) { [[NSException rkException:NSInvalidArgumentException for:self selector:_cmd localizeReason:@"The subjects argument is NULL."] raise]; }
+  if(RK_EXPECTED((resultsBitmap == NULL) && (resultRanges == NULL), 0)) { [[NSException rkException:NSInvalidArgumentException for:self selector:_cmd localizeReason:@"Both the results and ranges arguments are NULL."] raise]; }
+
+  RKRegexBatchMatchState RK_STRONG_REF batchMatchState;
+  memset(&batchMatchState, 0, sizeof(RKRegexBatchMatchState));
+
+  batchMatchState.regex          = self;
+  batchMatchState.subjects       = subjects;
+  batchMatchState.count          = count;
+  batchMatchState.resultsBitmap  = resultsBitmap;
+  batchMatchState.resultRanges   = resultRanges;
+  batchMatchState.options        = options;
+  batchMatchState.firstErrorCode = RKMatchErrorNoError;
+
+  // Only worth waking up the thread pool if there is more than one block of work for the threads to divide up.
+  if((concurrent == NO) || (count <= RK_BATCH_MATCH_BLOCK_SIZE) || ([[RKThreadPool defaultThreadPool] threadFunction:RKRegexBatchMatchFunction argument:&batchMatchState] == NO)) {
+    RKRegexBatchMatchFunction(&batchMatchState);
+  }
+
+  if(RK_EXPECTED(batchMatchState.firstErrorCode != RKMatchErrorNoError, 0) && (error != NULL)) { *error = [NSError rkErrorWithDomain:RKRegexPCRELibraryErrorDomain code:batchMatchState.firstErrorCode localizeDescription:RKLocalizedStringForPCRECompileErrorCode(batchMatchState.firstErrorCode)]; }
+
+  return(batchMatchState.matchedCount);
+}
+
+- (RKUInteger)matchesSubjectsInArray:(NSArray * const RK_C99(restrict))subjectsArray results:(unsigned char * const RK_C99(restrict))resultsBitmap
+{
+  return([self matchesSubjectsInArray:subjectsArray results:resultsBitmap ranges:NULL options:RKMatchNoOptions concurrent:NO error:NULL]);
+}
+
+// XXX WARNING: This code uses alloca().  If you do not -=COMPLETELY=- understand what alloca() does, you MUST NOT alter this code.
+- (RKUInteger)matchesSubjectsInArray:(NSArray * const RK_C99(restrict))subjectsArray results:(unsigned char * const RK_C99(restrict))resultsBitmap ranges:(NSRange * const RK_C99(restrict))resultRanges options:(const RKMatchOption)options concurrent:(const BOOL)concurrent error:(NSError **)error
+{
+  RKUInteger subjectsCount = 0;
+  id        *subjectObjects = NULL;
+
+  if(RK_EXPECTED(subjectsArray == NULL, 0)) { [[NSException rkException:NSInvalidArgumentException for:self selector:_cmd localizeReason:@"The subjectsArray argument is NULL."] raise]; }
+
+#ifdef USE_CORE_FOUNDATION
+  subjectsCount = (RKUInteger)CFArrayGetCount((CFArrayRef)subjectsArray);
+#else
+  subjectsCount = [subjectsArray count];
+#endif
+
+  if(subjectsCount == 0) { if(error != NULL) { *error = NULL; } return(0); }
+  if(RK_EXPECTED((subjectObjects = alloca(sizeof(id *) * subjectsCount)) == NULL, 0)) { [[NSException rkException:NSMallocException for:self selector:_cmd localizeReason:@"Unable to allocate temporary stack space."] raise]; }
+
+#ifdef USE_CORE_FOUNDATION
+  CFArrayGetValues((CFArrayRef)subjectsArray, (CFRange){0, (CFIndex)subjectsCount}, (const void **)(&subjectObjects[0]));
+#else
+  [subjectsArray getObjects:&subjectObjects[0] range:NSMakeRange(0, subjectsCount)];
+#endif
+
+  return([self matchesSubjects:subjectObjects count:subjectsCount results:resultsBitmap ranges:resultRanges options:options concurrent:concurrent error:error]);
+}
+
+//
+// The batch match worker.  May be executed by several threads at once, each of which claims blocks of RK_BATCH_MATCH_BLOCK_SIZE
+// subjects until there are none left.  Every thread uses a single three int vector on its stack for all of its matches since
+// only the range of the entire match is needed.  PCRE returns 0 when the vector is too small to hold all of the captures, which
+// is still a successful match.
+//
+
+static int RKRegexBatchMatchFunction(void *batchMatchState) {
+  RKRegexBatchMatchState RK_STRONG_REF *batchState   = (RKRegexBatchMatchState RK_STRONG_REF *)batchMatchState;
+  RKRegex                              *self         = batchState->regex;
+  RKUInteger                            blocks       = ((batchState->count + (RK_BATCH_MATCH_BLOCK_SIZE - 1)) / RK_BATCH_MATCH_BLOCK_SIZE), matchedCount = 0, savedMatchedCount = 0;
+  Class                                 stringClass  = [NSString class];
+  int                                   vectors[3]   = {-1, -1, -1};
+
+  for(RKUInteger atBlock = (RKAtomicIncrementIntegerBarrier(&batchState->atBlock) - 1); atBlock < blocks; atBlock = (RKAtomicIncrementIntegerBarrier(&batchState->atBlock) - 1)) {
+    RKUInteger startIndex = (atBlock * RK_BATCH_MATCH_BLOCK_SIZE), endIndex = min((startIndex + RK_BATCH_MATCH_BLOCK_SIZE), batchState->count);
+
+    for(RKUInteger atIndex = startIndex; atIndex < endIndex; atIndex++) {
+      id             subject       = batchState->subjects[atIndex];
+      NSRange        matchRange    = NSMakeRange(NSNotFound, 0);
+      RKStringBuffer subjectBuffer;
+      int            errorCode     = RKMatchErrorNoMatch;
+
+      if(RK_EXPECTED(subject != NULL, 1)) {
+        subjectBuffer = RKStringBufferWithString(([subject isKindOfClass:stringClass] == YES) ? subject : [subject description]);
+        if(RK_EXPECTED(subjectBuffer.characters != NULL, 1) && RK_EXPECTED(subjectBuffer.length <= INT_MAX, 1)) {
+          errorCode = RKRegexWholeMatchExec(self, subjectBuffer.characters, (int)subjectBuffer.length, 0, (int)batchState->options, vectors, 3, (batchState->resultRanges == NULL) ? YES : NO);
+        }
+      }
+
+      if(errorCode >= 0) {
+        matchedCount++;
+        if(batchState->resultRanges  != NULL) { matchRange = RKConvertUTF8ToUTF16RangeForStringBuffer(&subjectBuffer, NSMakeRange(vectors[0], (vectors[1] - vectors[0]))); }
+        if(batchState->resultsBitmap != NULL) { batchState->resultsBitmap[atIndex >> 3] |=  (unsigned char)(1 << (atIndex & 7)); }
+      } else {
+        if(batchState->resultsBitmap != NULL) { batchState->resultsBitmap[atIndex >> 3] &= ~(unsigned char)(1 << (atIndex & 7)); }
+        if(RK_EXPECTED(errorCode < RKMatchErrorNoMatch, 0)) { RKAtomicCompareAndSwapInt(RKMatchErrorNoError, errorCode, (int32_t *)&batchState->firstErrorCode); }
+      }
+      if(batchState->resultRanges != NULL) { batchState->resultRanges[atIndex] = matchRange; }
+    }
+  }
+
+  do { savedMatchedCount = batchState->matchedCount; } while(RKAtomicCompareAndSwapInteger(savedMatchedCount, (savedMatchedCount + matchedCount), &batchState->matchedCount) == NO);
+
+  return(1);
+}
+
+// XXX WARNING: This code uses alloca().  If you do not -=COMPLETELY=- understand what alloca() does, you MUST NOT alter this code.
+- (RKUInteger)getCapturesFromSubjects:(id const * const RK_C99(restrict))subjects count:(const RKUInteger)count columns:(RKCaptureColumn * const RK_C99(restrict))columns columnCount:(const RKUInteger)columnCount options:(const RKMatchOption)options concurrent:(const BOOL)concurrent error:(NSError **)error
+{
+  RKUInteger *columnCaptureIndexes = NULL, columnIndex = 0;
+
+  if(error != NULL) { *error = NULL; }
+  if(RK_EXPECTED(columns == NULL, 0) && RK_EXPECTED(columnCount > 0, 0)) { [[NSException rkException:NSInvalidArgumentException for:self selector:_cmd localizeReason:@"The columns argument is NULL."] raise]; }
+  if(RK_EXPECTED(count == 0, 0) || RK_EXPECTED(columnCount == 0, 0)) { return(0); }
+  if(RK_EXPECTED(subjects == NULL, 0)) { [[NSException rkException:NSInvalidArgumentException for:self selector:_cmd localizeReason:@"The subjects argument is NULL."] raise]; }
+  if(RK_EXPECTED((columnCaptureIndexes = alloca(sizeof(RKUInteger) * columnCount)) == NULL, 0)) { [[NSException rkException:NSMallocException for:self selector:_cmd localizeReason:@"Unable to allocate temporary stack space."] raise]; }
+
+  // The schema is resolved once for the entire batch so the workers only deal with capture indexes.
+  for(columnIndex = 0; columnIndex < columnCount; columnIndex++) {
+    RKCaptureColumn *column = &columns[columnIndex];
+    
+    if(RK_EXPECTED(column->captureName == NULL, 0)) { [[NSException rkException:NSInvalidArgumentException for:self selector:_cmd localizeReason:@"The captureName of column %lu is NULL.", (unsigned long)columnIndex] raise]; }
+    if(RK_EXPECTED(column->values == NULL, 0)) { [[NSException rkException:NSInvalidArgumentException for:self selector:_cmd localizeReason:@"The values of column %lu is NULL.", (unsigned long)columnIndex] raise]; }
+    if(RK_EXPECTED(column->type > RKCaptureColumnRange, 0)) { [[NSException rkException:NSInvalidArgumentException for:self selector:_cmd localizeReason:@"The type of column %lu is not a valid RKCaptureColumnType.", (unsigned long)columnIndex] raise]; }
+    
+    RKStringBuffer captureNameBuffer = RKStringBufferWithString(column->captureName);
+    RKUInteger     captureIndex      = 0, atCharacter = 0;
+    
+    for(atCharacter = 0; (atCharacter < captureNameBuffer.length) && (captureNameBuffer.characters[atCharacter] >= '0') && (captureNameBuffer.characters[atCharacter] <= '9'); atCharacter++) { if(captureIndex < captureCount) { captureIndex = (captureIndex * 10) + (captureNameBuffer.characters[atCharacter] - '0'); } }
+    if((atCharacter == 0) || (atCharacter != captureNameBuffer.length)) { captureIndex = RKCaptureIndexForCaptureNameCharacters(self, _cmd, captureNameBuffer.characters, captureNameBuffer.length, NULL, YES); }
+    else if(RK_EXPECTED(captureIndex >= captureCount, 0)) { [[NSException rkException:NSInvalidArgumentException for:self selector:_cmd localizeReason:@"The capture index %@ of column %lu is greater than the regular expressions capture count of %lu.", column->captureName, (unsigned long)columnIndex, (unsigned long)(captureCount - 1)] raise]; }
+    
+    columnCaptureIndexes[columnIndex] = captureIndex;
+  }
+
+  RKRegexBatchExtractState RK_STRONG_REF batchExtractState;
+  memset(&batchExtractState, 0, sizeof(RKRegexBatchExtractState));
+
+  batchExtractState.regex                = self;
+  batchExtractState.subjects             = subjects;
+  batchExtractState.count                = count;
+  batchExtractState.columns              = columns;
+  batchExtractState.columnCaptureIndexes = columnCaptureIndexes;
+  batchExtractState.columnCount          = columnCount;
+  batchExtractState.options              = options;
+  batchExtractState.firstErrorCode       = RKMatchErrorNoError;
+
+  if((concurrent == NO) || (count <= RK_BATCH_MATCH_BLOCK_SIZE) || ([[RKThreadPool defaultThreadPool] threadFunction:RKRegexBatchExtractFunction argument:&batchExtractState] == NO)) {
+    RKRegexBatchExtractFunction(&batchExtractState);
+  }
+
+  if(RK_EXPECTED(batchExtractState.firstErrorCode != RKMatchErrorNoError, 0) && (error != NULL)) { *error = [NSError rkErrorWithDomain:RKRegexPCRELibraryErrorDomain code:batchExtractState.firstErrorCode localizeDescription:RKLocalizedStringForPCRECompileErrorCode(batchExtractState.firstErrorCode)]; }
+
+  return(batchExtractState.matchedCount);
+}
+
+// XXX WARNING: This code uses alloca().  If you do not -=COMPLETELY=- understand what alloca() does, you MUST NOT alter this code.
+- (RKUInteger)getCapturesFromSubjectsInArray:(NSArray * const RK_C99(restrict))subjectsArray columns:(RKCaptureColumn * const RK_C99(restrict))columns columnCount:(const RKUInteger)columnCount options:(const RKMatchOption)options concurrent:(const BOOL)concurrent error:(NSError **)error
+{
+  RKUInteger subjectsCount = 0;
+  id        *subjectObjects = NULL;
+
+  if(RK_EXPECTED(subjectsArray == NULL, 0)) { [[NSException rkException:NSInvalidArgumentException for:self selector:_cmd localizeReason:@"The subjectsArray argument is NULL."] raise]; }
+
+#ifdef USE_CORE_FOUNDATION
+  subjectsCount = (RKUInteger)CFArrayGetCount((CFArrayRef)subjectsArray);
+#else
+  subjectsCount = [subjectsArray count];
+#endif
+
+  if(subjectsCount == 0) { if(error != NULL) { *error = NULL; } return(0); }
+  if(RK_EXPECTED((subjectObjects = alloca(sizeof(id *) * subjectsCount)) == NULL, 0)) { [[NSException rkException:NSMallocException for:self selector:_cmd localizeReason:@"Unable to allocate temporary stack space."] raise]; }
+
+#ifdef USE_CORE_FOUNDATION
+  CFArrayGetValues((CFArrayRef)subjectsArray, (CFRange){0, (CFIndex)subjectsCount}, (const void **)(&subjectObjects[0]));
+#else
+  [subjectsArray getObjects:&subjectObjects[0] range:NSMakeRange(0, subjectsCount)];
+#endif
+
+  return([self getCapturesFromSubjects:subjectObjects count:subjectsCount columns:columns columnCount:columnCount options:options concurrent:concurrent error:error]);
+}
+
+//
+// Converts a single capture of a subject and stores it in row atIndex of column.  Returns NO if the capture could not be
+// converted, in which case the row is marked null by the caller.  Numeric captures take the same direct conversion path as the
+// %lld and %lf capture reference conversions and only fall back to sscanf() for the forms that path declines.
+//
+
+static BOOL RKRegexBatchExtractCapture(RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) subjectBuffer, const NSRange captureRange, RK_STRONG_REF const RKCaptureColumn * const RK_C99(restrict) column, const RKUInteger atIndex) {
+  const char RK_STRONG_REF *captureCharacters = subjectBuffer->characters + captureRange.location;
+  char                      scanfBuffer[RK_BATCH_EXTRACT_MAX_SCANF_LENGTH + 1];
+
+  switch(column->type) {
+    case RKCaptureColumnInt64: {
+      long long convertedValue = 0LL;
+      if(RKConvertNumericCharacters(captureCharacters, captureRange.length, "%lld", 4, &convertedValue) == NO) {
+        if(RK_EXPECTED((captureRange.length == 0) || (captureRange.length > RK_BATCH_EXTRACT_MAX_SCANF_LENGTH), 0)) { return(NO); }
+        memcpy(scanfBuffer, captureCharacters, captureRange.length); scanfBuffer[captureRange.length] = 0;
+        if(sscanf(scanfBuffer, "%lld", &convertedValue) != 1) { return(NO); }
+      }
+      ((int64_t *)column->values)[atIndex] = (int64_t)convertedValue;
+      return(YES);
+    }
+    case RKCaptureColumnDouble: {
+      double convertedValue = 0.0;
+      if(RKConvertNumericCharacters(captureCharacters, captureRange.length, "%lf", 3, &convertedValue) == NO) {
+        if(RK_EXPECTED((captureRange.length == 0) || (captureRange.length > RK_BATCH_EXTRACT_MAX_SCANF_LENGTH), 0)) { return(NO); }
+        memcpy(scanfBuffer, captureCharacters, captureRange.length); scanfBuffer[captureRange.length] = 0;
+        if(sscanf(scanfBuffer, "%lf", &convertedValue) != 1) { return(NO); }
+      }
+      ((double *)column->values)[atIndex] = convertedValue;
+      return(YES);
+    }
+    case RKCaptureColumnTimestamp: {
+      NSTimeInterval convertedValue = 0.0;
+      if(RKTimeIntervalFromFixedFormatCharacters(captureCharacters, captureRange.length, &convertedValue, NULL) == NO) { return(NO); }
+      ((NSTimeInterval *)column->values)[atIndex] = convertedValue;
+      return(YES);
+    }
+    case RKCaptureColumnRange:
+      ((NSRange *)column->values)[atIndex] = RKConvertUTF8ToUTF16RangeForStringBuffer((RKStringBuffer *)subjectBuffer, captureRange);
+      return(YES);
+    default: break;
+  }
+  
+  return(NO);
+}
+
+static void RKRegexBatchExtractNull(RK_STRONG_REF const RKCaptureColumn * const RK_C99(restrict) column, const RKUInteger atIndex) {
+  switch(column->type) {
+    case RKCaptureColumnInt64:     ((int64_t *)column->values)[atIndex]        = 0;                           break;
+    case RKCaptureColumnDouble:    ((double *)column->values)[atIndex]         = 0.0;                         break;
+    case RKCaptureColumnTimestamp: ((NSTimeInterval *)column->values)[atIndex] = 0.0;                         break;
+    case RKCaptureColumnRange:     ((NSRange *)column->values)[atIndex]        = NSMakeRange(NSNotFound, 0);  break;
+    default: break;
+  }
+  if(column->nullBitmap != NULL) { column->nullBitmap[atIndex >> 3] |= (unsigned char)(1 << (atIndex & 7)); }
+}
+
+//
+// The batch extract worker.  Divides the subjects in to blocks exactly like RKRegexBatchMatchFunction, which keeps each
+// thread writing whole bytes of every columns null bitmap.  Unlike a batch match, the full capture vector is needed, so
+// each thread allocates one on its stack that is sized for the receivers captures and reused for every subject.
+//
+
+// XXX WARNING: This code uses alloca().  If you do not -=COMPLETELY=- understand what alloca() does, you MUST NOT alter this code.
+static int RKRegexBatchExtractFunction(void *batchExtractState) {
+  RKRegexBatchExtractState RK_STRONG_REF *batchState   = (RKRegexBatchExtractState RK_STRONG_REF *)batchExtractState;
+  RKRegex                                *self         = batchState->regex;
+  RKUInteger                              blocks       = ((batchState->count + (RK_BATCH_MATCH_BLOCK_SIZE - 1)) / RK_BATCH_MATCH_BLOCK_SIZE), matchedCount = 0, savedMatchedCount = 0;
+  Class                                   stringClass  = [NSString class];
+  int                                     vectorsCount = (int)(self->captureCount * 3);
+  int                                    *vectors      = NULL;
+
+  if(RK_EXPECTED((vectors = alloca(sizeof(int) * vectorsCount)) == NULL, 0)) { RKAtomicCompareAndSwapInt(RKMatchErrorNoError, RKMatchErrorNoMemory, (int32_t *)&batchState->firstErrorCode); return(0); }
+
+  for(RKUInteger atBlock = (RKAtomicIncrementIntegerBarrier(&batchState->atBlock) - 1); atBlock < blocks; atBlock = (RKAtomicIncrementIntegerBarrier(&batchState->atBlock) - 1)) {
+    RKUInteger startIndex = (atBlock * RK_BATCH_MATCH_BLOCK_SIZE), endIndex = min((startIndex + RK_BATCH_MATCH_BLOCK_SIZE), batchState->count);
+
+    for(RKUInteger atIndex = startIndex; atIndex < endIndex; atIndex++) {
+      id             subject       = batchState->subjects[atIndex];
+      RKStringBuffer subjectBuffer;
+      int            errorCode     = RKMatchErrorNoMatch;
+
+      if(RK_EXPECTED(subject != NULL, 1)) {
+        subjectBuffer = RKStringBufferWithString(([subject isKindOfClass:stringClass] == YES) ? subject : [subject description]);
+        if(RK_EXPECTED(subjectBuffer.characters != NULL, 1) && RK_EXPECTED(subjectBuffer.length <= INT_MAX, 1)) {
+          errorCode = RKRegexPCREExec(self, NULL, subjectBuffer.characters, (int)subjectBuffer.length, 0, (int)batchState->options, vectors, vectorsCount);
+        }
+      }
+
+      if(errorCode >= 0) { matchedCount++; }
+      else if(RK_EXPECTED(errorCode < RKMatchErrorNoMatch, 0)) { RKAtomicCompareAndSwapInt(RKMatchErrorNoError, errorCode, (int32_t *)&batchState->firstErrorCode); }
+
+      for(RKUInteger columnIndex = 0; columnIndex < batchState->columnCount; columnIndex++) {
+        RKCaptureColumn RK_STRONG_REF *column       = &batchState->columns[columnIndex];
+        RKUInteger                     captureIndex = batchState->columnCaptureIndexes[columnIndex];
+
+        // A capture that did not participate in the match has a vector of -1, and one past the highest numbered capture that did is not set at all.
+        if((errorCode > 0) && (captureIndex < (RKUInteger)errorCode) && (vectors[captureIndex * 2] != -1) &&
+           (RKRegexBatchExtractCapture(&subjectBuffer, NSMakeRange(vectors[captureIndex * 2], (vectors[(captureIndex * 2) + 1] - vectors[captureIndex * 2])), column, atIndex) == YES)) {
+          if(column->nullBitmap != NULL) { column->nullBitmap[atIndex >> 3] &= ~(unsigned char)(1 << (atIndex & 7)); }
+        } else { RKRegexBatchExtractNull(column, atIndex); }
+      }
+    }
+  }
+
+  do { savedMatchedCount = batchState->matchedCount; } while(RKAtomicCompareAndSwapInteger(savedMatchedCount, (savedMatchedCount + matchedCount), &batchState->matchedCount) == NO);
+
+  return(1);
+}
+
 #pragma mark -
 #pragma mark Low level Interface to Regex Library
 
@@ -1087,10 +1773,41 @@ errorExit:
   return(matchErrorCode);
 }
 
+- (RKMatchErrorCode)getRangesInMatchContext:(RKMatchContext * const RK_C99(restrict))matchContext withCharacters:(const void * const RK_C99(restrict))charactersBuffer length:(const RKUInteger)length inRange:(const NSRange)searchRange options:(const RKMatchOption)options
+{
+  RKMatchErrorCode  matchErrorCode = RKMatchErrorNoError;
+  NSError          *getRangesError = NULL;
+  
+  matchErrorCode = [self getRangesInMatchContext:matchContext withCharacters:charactersBuffer length:length inRange:searchRange options:options error:&getRangesError];
+  if((getRangesError != NULL) && ([[getRangesError domain] isEqualToString:RKRegexPCRELibraryErrorDomain] == NO)) { [[NSException exceptionWithName:[[getRangesError domain] isEqualToString:NSPOSIXErrorDomain] ? NSMallocException : NSInvalidArgumentException reason:RKPrettyObjectMethodString([getRangesError localizedDescription]) userInfo:NULL] raise]; }
+
+  return(matchErrorCode);  
+}
+
+- (RKMatchErrorCode)getRangesInMatchContext:(RKMatchContext * const RK_C99(restrict))matchContext withCharacters:(const void * const RK_C99(restrict))charactersBuffer length:(const RKUInteger)length inRange:(const NSRange)searchRange options:(const RKMatchOption)options error:(NSError **)error
+{
+  RKMatchContext *useMatchContext = matchContext;
+  
+  if(useMatchContext == NULL) {
+    if(RK_EXPECTED((useMatchContext = [RKMatchContext currentThreadMatchContext]) == NULL, 0)) { if(error != NULL) { *error = [NSError rkErrorWithDomain:NSPOSIXErrorDomain code:0 localizeDescription:@"Unable to allocate additional memory."]; } return(RKMatchErrorNoMemory); }
+  }
+  
+  return(RKMatchContextGetRanges(useMatchContext, self, _cmd, charactersBuffer, length, searchRange, options, error));
+}
+
 @end
 
 @implementation RKRegex (Private)
 
+//
+// Thin wrapper around pcre_exec for the functions outside of this compile unit that need to match against a RKRegex.
+// matchLimits is passed by RKMatchContext, and supplies the match context callout function and the per call limits.
+//
+
+int RKRegexExec(RKRegex * const self, const char * const RK_C99(restrict) charactersBuffer, const int length, const int startOffset, const int options, int * const RK_C99(restrict) vectors, const int vectorsCount, const RKMatchLimits * const matchLimits) {
+  return(RKRegexPCREExec(self, matchLimits, charactersBuffer, length, startOffset, options, vectors, vectorsCount));
+}
+
 // This is a semi-private interface to the low level PCRE match function.
 // It assumes that the caller has correctly pre-sized an allocation according to the pcre_exec vector rules.
 //
@@ -1136,7 +1853,7 @@ throwException:
   
   RK_PROBE(BEGINMATCH, &((regexProbeObject){self, regexUTF8String(self), compileOption}), hash, ranges, rangeCount, (void *)charactersBuffer, length, (NSRange *)&searchRange, options);
 
-  errorCode = (RKMatchErrorCode)pcre_exec(_compiledPCRE, _extraPCRE, (const char *)charactersBuffer, (int)length, (int)searchRange.location, (int)options, (int *)vectors, (int)numberOfVectors);
+  errorCode = (RKMatchErrorCode)RKRegexPCREExec(self, NULL, (const char *)charactersBuffer, (int)length, (int)searchRange.location, (int)options, (int *)vectors, (int)numberOfVectors);
   
   // Convert PCRE vector format (start, end location) to NSRange format (start, length) on success
   if(errorCode > 0) {
@@ -1175,3 +1892,10 @@ throwException:
 }
 
 @end
+
+#pragma mark -
+#pragma mark Match Limit Functions
+
+RKUInteger RKAbortedMatchCount(void) {
+  return((RKUInteger)RKRegexAbortedMatchCount);
+}
@@ -0,0 +1,858 @@
+//
+//  RKRegexAnalysis.m
+//  RegexKit
+//  http://regexkit.sourceforge.net/
+//
+
+/*
+ Copyright © 2007-2008, John Engelhart
+ 
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+ notice, this list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright
+ notice, this list of conditions and the following disclaimer in the
+ documentation and/or other materials provided with the distribution.
+ 
+ * Neither the name of the Zang Industries nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#import <RegexKit/RegexKitPrivate.h>
+
+/*
+ A small recursive descent parser builds a tree of the pattern that is just detailed enough to find the constructs that make
+ a failing match backtrack exponentially or polynomially.  Nothing is compiled, so patterns can be checked before they are
+ handed to pcre_compile2().
+
+ Every node records the set of characters that can begin it, the set of characters it can consume, and whether it can
+ match the empty string.  Only code points < 256 are tracked individually, everything else is lumped together in 'other'.
+ Back references, recursion, conditional subpatterns, and lookaround assertions are 'opaque', anything next to them is
+ assumed to be able to match anything.  The \b, \B, \G and \K assertions depend on where the item before them stopped,
+ so a group that they follow is never made possessive.
+
+ A pattern that the parser does not understand is not analyzed at all, pcre_compile2() will report the error.
+*/
+
+#define RK_ANALYSIS_NONE      (RKUIntegerMax)
+#define RK_ANALYSIS_UNBOUNDED (RKUIntegerMax)
+#define RK_ANALYSIS_MAX_DEPTH (250)
+
+typedef struct {
+  uint32_t bits[8];
+  BOOL     other;
+} RKAnalysisCharSet;
+
+enum {
+  RKAnalysisAtomNode      = 0,
+  RKAnalysisAssertionNode = 1,
+  RKAnalysisOpaqueNode    = 2,
+  RKAnalysisGroupNode     = 3,
+  RKAnalysisSequenceNode  = 4
+};
+
+enum {
+  RKAnalysisCaptureGroup     = 0,
+  RKAnalysisAtomicGroup      = 1,
+  RKAnalysisLookaroundGroup  = 2,
+  RKAnalysisConditionalGroup = 3
+};
+
+typedef struct {
+  int               type, groupKind;
+  RKUInteger        parent, firstChild, lastChild, nextSibling, prevSibling, childCount;
+  RKUInteger        start, end, quantifierEnd, min, max;
+  BOOL              quantified, lazy, possessive, hasSuffix;
+  BOOL              nullable, restNullable, opaque, dollar, boundary, singleRun;
+  RKAnalysisCharSet first, all;
+} RKAnalysisNode;
+
+typedef struct {
+  const unichar  *characters;
+  RKUInteger      length, at, depth;
+  RKAnalysisNode *nodes;
+  RKUInteger      count, capacity;
+  BOOL            inQuote, failed;
+} RKAnalysisParser;
+
+static RKUInteger RKAnalysisParseItem(RKAnalysisParser * const parser, RKCompileOption * const options);
+static void       RKAnalysisParseSequences(RKAnalysisParser * const parser, const RKUInteger groupIndex, RKCompileOption options);
+
+#pragma mark Character Sets
+
+RKREGEX_STATIC_INLINE void RKAnalysisCharSetAdd(RKAnalysisCharSet * const set, const RKUInteger character, const BOOL caseless) {
+  if(character >= 256) { set->other = YES; return; }
+  set->bits[character >> 5] |= (1U << (character & 31));
+  if(caseless == YES) {
+    if((character >= 'a') && (character <= 'z')) { set->bits[(character - 32) >> 5] |= (1U << ((character - 32) & 31)); }
+    if((character >= 'A') && (character <= 'Z')) { set->bits[(character + 32) >> 5] |= (1U << ((character + 32) & 31)); }
+  }
+}
+
+RKREGEX_STATIC_INLINE void RKAnalysisCharSetAddRange(RKAnalysisCharSet * const set, RKUInteger low, const RKUInteger high, const BOOL caseless) {
+  if(high >= 256) { set->other = YES; }
+  for(; (low <= high) && (low < 256); low++) { RKAnalysisCharSetAdd(set, low, caseless); }
+}
+
+RKREGEX_STATIC_INLINE void RKAnalysisCharSetUnion(RKAnalysisCharSet * const set, const RKAnalysisCharSet * const otherSet) {
+  unsigned int x; for(x = 0; x < 8; x++) { set->bits[x] |= otherSet->bits[x]; }
+  if(otherSet->other == YES) { set->other = YES; }
+}
+
+RKREGEX_STATIC_INLINE void RKAnalysisCharSetInvert(RKAnalysisCharSet * const set) {
+  unsigned int x; for(x = 0; x < 8; x++) { set->bits[x] = ~set->bits[x]; }
+  set->other = YES;
+}
+
+RKREGEX_STATIC_INLINE void RKAnalysisCharSetAll(RKAnalysisCharSet * const set) {
+  memset(set->bits, 0xff, sizeof(set->bits));
+  set->other = YES;
+}
+
+RKREGEX_STATIC_INLINE BOOL RKAnalysisCharSetIntersects(const RKAnalysisCharSet * const set, const RKAnalysisCharSet * const otherSet) {
+  unsigned int x; for(x = 0; x < 8; x++) { if((set->bits[x] & otherSet->bits[x]) != 0) { return(YES); } }
+  return(((set->other == YES) && (otherSet->other == YES)) ? YES : NO);
+}
+
+RKREGEX_STATIC_INLINE BOOL RKAnalysisCharSetContains(const RKAnalysisCharSet * const set, const RKUInteger character) {
+  if(character >= 256) { return(set->other); }
+  return(((set->bits[character >> 5] & (1U << (character & 31))) != 0) ? YES : NO);
+}
+
+// Adds the characters matched by the escape at parser->at, which is just past the '\', and returns YES if it was a character type such as \d.
+// isdigit() and isxdigit() are undefined for values above 255, so unichars are range checked directly.
+RKREGEX_STATIC_INLINE BOOL RKAnalysisIsDigit(const unichar c) {
+  return(((c >= '0') && (c <= '9')) ? YES : NO);
+}
+
+RKREGEX_STATIC_INLINE BOOL RKAnalysisIsHexDigit(const unichar c) {
+  return((((c >= '0') && (c <= '9')) || ((c >= 'a') && (c <= 'f')) || ((c >= 'A') && (c <= 'F'))) ? YES : NO);
+}
+
+static BOOL RKAnalysisCharSetAddCharacterType(RKAnalysisParser * const parser, RKAnalysisCharSet * const set) {
+  RKAnalysisCharSet typeSet; memset(&typeSet, 0, sizeof(typeSet));
+  const unichar escape = parser->characters[parser->at];
+  BOOL invert = NO;
+
+  switch(escape) {
+    case 'D': invert = YES; case 'd': RKAnalysisCharSetAddRange(&typeSet, '0', '9', NO); break;
+    case 'W': invert = YES; case 'w': RKAnalysisCharSetAddRange(&typeSet, '0', '9', NO); RKAnalysisCharSetAddRange(&typeSet, 'a', 'z', YES); RKAnalysisCharSetAdd(&typeSet, '_', NO); break;
+    case 'S': invert = YES; case 's': RKAnalysisCharSetAddRange(&typeSet, '\t', '\n', NO); RKAnalysisCharSetAddRange(&typeSet, '\f', '\r', NO); RKAnalysisCharSetAdd(&typeSet, ' ', NO); break;
+    case 'H': invert = YES; case 'h': RKAnalysisCharSetAdd(&typeSet, '\t', NO); RKAnalysisCharSetAdd(&typeSet, ' ', NO); RKAnalysisCharSetAdd(&typeSet, 0xa0, NO); typeSet.other = YES; break;
+    case 'V': invert = YES; case 'v': case 'R': RKAnalysisCharSetAddRange(&typeSet, '\n', '\r', NO); RKAnalysisCharSetAdd(&typeSet, 0x85, NO); typeSet.other = YES; break;
+    case 'p': case 'P':
+      if(((parser->at + 1) < parser->length) && (parser->characters[parser->at + 1] == '{')) { while((parser->at < parser->length) && (parser->characters[parser->at] != '}')) { parser->at++; } }
+      else if((parser->at + 1) < parser->length) { parser->at++; }
+      // Fall through, Unicode properties are treated as matching anything.
+    case 'X': case 'C': RKAnalysisCharSetAll(&typeSet); break;
+    default: return(NO);
+  }
+
+  if(invert == YES) { RKAnalysisCharSetInvert(&typeSet); }
+  RKAnalysisCharSetUnion(set, &typeSet);
+  parser->at++;
+  return(YES);
+}
+
+// Parses the literal character escape at parser->at, which is just past the '\', and returns the character it matches.
+static RKUInteger RKAnalysisParseEscapedCharacter(RKAnalysisParser * const parser) {
+  const unichar escape = parser->characters[parser->at++];
+  RKUInteger character = 0, digits = 0;
+
+  switch(escape) {
+    case 'a': return(0x07);
+    case 'e': return(0x1b);
+    case 'f': return('\f');
+    case 'n': return('\n');
+    case 'r': return('\r');
+    case 't': return('\t');
+    case 'c': if(parser->at < parser->length) { return((parser->characters[parser->at++] & 0x5f) ^ 0x40); } return(0);
+    case '0':
+      while((digits++ < 2) && (parser->at < parser->length) && (parser->characters[parser->at] >= '0') && (parser->characters[parser->at] <= '7')) { character = (character * 8) + (parser->characters[parser->at++] - '0'); }
+      return(character);
+    case 'x':
+      if((parser->at < parser->length) && (parser->characters[parser->at] == '{')) {
+        while((++parser->at < parser->length) && (parser->characters[parser->at] != '}')) { unichar c = parser->characters[parser->at]; character = (character * 16) + ((c <= '9') ? (c - '0') : ((c | 0x20) - 'a' + 10)); }
+        if(parser->at < parser->length) { parser->at++; }
+        return(character);
+      }
+      while((digits++ < 2) && (parser->at < parser->length) && (RKAnalysisIsHexDigit(parser->characters[parser->at]) == YES)) { unichar c = parser->characters[parser->at++]; character = (character * 16) + ((c <= '9') ? (c - '0') : ((c | 0x20) - 'a' + 10)); }
+      return(character);
+    default: return(escape);
+  }
+}
+
+RKREGEX_STATIC_INLINE BOOL RKAnalysisIsClassName(const unichar * const name, const RKUInteger length, const char * const className) {
+  RKUInteger x;
+  for(x = 0; x < length; x++) { if((className[x] == 0) || (name[x] != (unichar)className[x])) { return(NO); } }
+  return((className[length] == 0) ? YES : NO);
+}
+
+// Parses the character class at parser->at, which is just past the '['.
+static void RKAnalysisParseCharacterClass(RKAnalysisParser * const parser, RKAnalysisCharSet * const set, const RKCompileOption options) {
+  const BOOL caseless = ((options & RKCompileCaseless) != 0) ? YES : NO;
+  RKAnalysisCharSet classSet; memset(&classSet, 0, sizeof(classSet));
+  BOOL negated = NO, firstCharacter = YES;
+
+  if((parser->at < parser->length) && (parser->characters[parser->at] == '^')) { negated = YES; parser->at++; }
+
+  while(parser->at < parser->length) {
+    unichar c = parser->characters[parser->at];
+    RKUInteger low = 0;
+
+    if((c == ']') && (firstCharacter == NO)) { parser->at++; goto finished; }
+    firstCharacter = NO;
+
+    if((c == '[') && ((parser->at + 1) < parser->length) && (parser->characters[parser->at + 1] == ':')) {
+      RKUInteger nameStart = parser->at + 2, nameEnd = nameStart;
+      while((nameEnd < parser->length) && (parser->characters[nameEnd] != ':')) { nameEnd++; }
+      if(((nameEnd + 1) < parser->length) && (parser->characters[nameEnd + 1] == ']')) {
+        const unichar * const className = &parser->characters[nameStart];
+        const RKUInteger      nameLength = nameEnd - nameStart;
+        if(RKAnalysisIsClassName(className, nameLength, "digit") == YES)      { RKAnalysisCharSetAddRange(&classSet, '0', '9', NO); }
+        else if(RKAnalysisIsClassName(className, nameLength, "lower") == YES) { RKAnalysisCharSetAddRange(&classSet, 'a', 'z', caseless); }
+        else if(RKAnalysisIsClassName(className, nameLength, "upper") == YES) { RKAnalysisCharSetAddRange(&classSet, 'A', 'Z', caseless); }
+        else if(RKAnalysisIsClassName(className, nameLength, "alpha") == YES) { RKAnalysisCharSetAddRange(&classSet, 'a', 'z', YES); }
+        else if(RKAnalysisIsClassName(className, nameLength, "alnum") == YES) { RKAnalysisCharSetAddRange(&classSet, 'a', 'z', YES); RKAnalysisCharSetAddRange(&classSet, '0', '9', NO); }
+        else if(RKAnalysisIsClassName(className, nameLength, "space") == YES) { RKAnalysisCharSetAddRange(&classSet, '\t', '\r', NO); RKAnalysisCharSetAdd(&classSet, ' ', NO); }
+        else { RKAnalysisCharSetAddRange(&classSet, 0, 255, NO); } // Everything else, including negated classes, is treated as matching anything.
+        parser->at = nameEnd + 2;
+        continue;
+      }
+    }
+
+    parser->at++;
+    if(c == '\\') {
+      if(parser->at >= parser->length) { parser->failed = YES; return; }
+      if((parser->characters[parser->at] == 'Q') || (parser->characters[parser->at] == 'E')) { parser->at++; continue; }
+      if(parser->characters[parser->at] == 'b') { parser->at++; low = 0x08; }
+      else if(RKAnalysisCharSetAddCharacterType(parser, &classSet) == YES) { continue; }
+      else { low = RKAnalysisParseEscapedCharacter(parser); }
+    } else { low = c; }
+
+    if(((parser->at + 1) < parser->length) && (parser->characters[parser->at] == '-') && (parser->characters[parser->at + 1] != ']')) {
+      RKUInteger high = parser->characters[parser->at + 1];
+      parser->at += 2;
+      if(high == '\\') {
+        if(parser->at >= parser->length) { parser->failed = YES; return; }
+        high = RKAnalysisParseEscapedCharacter(parser);
+      }
+      RKAnalysisCharSetAddRange(&classSet, low, high, caseless);
+    } else { RKAnalysisCharSetAdd(&classSet, low, caseless); }
+  }
+
+  parser->failed = YES; // Missing terminating ']'.
+  return;
+
+finished:
+  if(negated == YES) { RKAnalysisCharSetInvert(&classSet); }
+  RKAnalysisCharSetUnion(set, &classSet);
+}
+
+#pragma mark Parser
+
+static RKUInteger RKAnalysisNewNode(RKAnalysisParser * const parser, const int type, const RKUInteger start) {
+  if(parser->count == parser->capacity) {
+    RKUInteger      newCapacity = (parser->capacity == 0) ? 64 : (parser->capacity * 2);
+    RKAnalysisNode *newNodes    = NULL;
+    if((newNodes = realloc(parser->nodes, sizeof(RKAnalysisNode) * newCapacity)) == NULL) { parser->failed = YES; return(RK_ANALYSIS_NONE); }
+    parser->nodes    = newNodes;
+    parser->capacity = newCapacity;
+  }
+
+  RKAnalysisNode *node = &parser->nodes[parser->count];
+  memset(node, 0, sizeof(RKAnalysisNode));
+  node->type          = type;
+  node->parent        = node->firstChild = node->lastChild = node->nextSibling = node->prevSibling = RK_ANALYSIS_NONE;
+  node->start         = node->end = node->quantifierEnd = start;
+  node->min           = node->max = 1;
+  node->restNullable  = YES;
+  return(parser->count++);
+}
+
+static void RKAnalysisAppendChild(RKAnalysisParser * const parser, const RKUInteger parentIndex, const RKUInteger childIndex) {
+  RKAnalysisNode *parent = &parser->nodes[parentIndex], *child = &parser->nodes[childIndex];
+  child->parent      = parentIndex;
+  child->prevSibling = parent->lastChild;
+  if(parent->lastChild == RK_ANALYSIS_NONE) { parent->firstChild = childIndex; } else { parser->nodes[parent->lastChild].nextSibling = childIndex; }
+  parent->lastChild = childIndex;
+  parent->childCount++;
+}
+
+static void RKAnalysisSkipExtendedWhitespace(RKAnalysisParser * const parser, const RKCompileOption options) {
+  if(((options & RKCompileExtended) == 0) || (parser->inQuote == YES)) { return; }
+  while(parser->at < parser->length) {
+    unichar c = parser->characters[parser->at];
+    if((c == ' ') || (c == '\t') || (c == '\n') || (c == '\f') || (c == '\r')) { parser->at++; continue; }
+    if(c == '#') { while((parser->at < parser->length) && (parser->characters[parser->at] != '\n')) { parser->at++; } continue; }
+    break;
+  }
+}
+
+// Skips to just past the ')' that closes the parenthesis the parser is in, counting any nested parenthesis.
+static void RKAnalysisSkipParenthesis(RKAnalysisParser * const parser) {
+  RKUInteger nesting = 1;
+  while(parser->at < parser->length) {
+    unichar c = parser->characters[parser->at++];
+    if((c == '\\') && (parser->at < parser->length)) { parser->at++; }
+    else if(c == '(') { nesting++; }
+    else if((c == ')') && (--nesting == 0)) { return; }
+  }
+  parser->failed = YES;
+}
+
+static void RKAnalysisParseQuantifier(RKAnalysisParser * const parser, const RKUInteger nodeIndex, const RKCompileOption options) {
+  RKUInteger min = 0, max = 0, at = parser->at;
+
+  if(at >= parser->length) { return; }
+  switch(parser->characters[at]) {
+    case '*': min = 0; max = RK_ANALYSIS_UNBOUNDED; at++; break;
+    case '+': min = 1; max = RK_ANALYSIS_UNBOUNDED; at++; break;
+    case '?': min = 0; max = 1;                     at++; break;
+    case '{':
+      if((++at >= parser->length) || (RKAnalysisIsDigit(parser->characters[at]) == NO)) { return; }
+      while((at < parser->length) && (RKAnalysisIsDigit(parser->characters[at]) == YES)) { min = (min * 10) + (parser->characters[at++] - '0'); }
+      if((at < parser->length) && (parser->characters[at] == '}')) { max = min; at++; break; }
+      if((at >= parser->length) || (parser->characters[at++] != ',')) { return; }
+      if((at < parser->length) && (parser->characters[at] == '}')) { max = RK_ANALYSIS_UNBOUNDED; at++; break; }
+      if((at >= parser->length) || (RKAnalysisIsDigit(parser->characters[at]) == NO)) { return; }
+      while((at < parser->length) && (RKAnalysisIsDigit(parser->characters[at]) == YES)) { max = (max * 10) + (parser->characters[at++] - '0'); }
+      if((at >= parser->length) || (parser->characters[at++] != '}')) { return; }
+      break;
+    default: return;
+  }
+
+  RKAnalysisNode *node = &parser->nodes[nodeIndex];
+  node->quantified    = YES;
+  node->min           = min;
+  node->max           = max;
+  node->quantifierEnd = at;
+  node->lazy          = ((options & RKCompileUngreedy) != 0) ? YES : NO;
+  if((at < parser->length) && (parser->characters[at] == '?')) { node->lazy = (node->lazy == YES) ? NO : YES; node->hasSuffix = YES; at++; }
+  else if((at < parser->length) && (parser->characters[at] == '+')) { node->possessive = YES; node->lazy = NO; node->hasSuffix = YES; at++; }
+  node->end = parser->at = at;
+
+  if(min == 0) { node->nullable = YES; }
+  if(max == 0) { memset(&node->first, 0, sizeof(RKAnalysisCharSet)); memset(&node->all, 0, sizeof(RKAnalysisCharSet)); }
+}
+
+// Computes the properties of a sequence from its items.
+static void RKAnalysisFinishSequence(RKAnalysisParser * const parser, const RKUInteger sequenceIndex) {
+  RKAnalysisNode *sequence = &parser->nodes[sequenceIndex];
+  RKUInteger      itemIndex;
+  BOOL            restNullable = YES, firstOpen = YES;
+
+  sequence->nullable = YES;
+  for(itemIndex = sequence->lastChild; itemIndex != RK_ANALYSIS_NONE; itemIndex = parser->nodes[itemIndex].prevSibling) {
+    parser->nodes[itemIndex].restNullable = restNullable;
+    if(parser->nodes[itemIndex].nullable == NO) { restNullable = NO; }
+  }
+  for(itemIndex = sequence->firstChild; itemIndex != RK_ANALYSIS_NONE; itemIndex = parser->nodes[itemIndex].nextSibling) {
+    RKAnalysisNode *item = &parser->nodes[itemIndex];
+    if(firstOpen == YES) { RKAnalysisCharSetUnion(&sequence->first, &item->first); }
+    if((item->dollar == YES) && (firstOpen == YES)) { sequence->dollar = YES; }
+    if((item->opaque == YES) && (firstOpen == YES)) { sequence->opaque = YES; }
+    if(item->nullable == NO) { firstOpen = NO; sequence->nullable = NO; }
+    if(item->opaque == YES) { sequence->opaque = YES; }
+    RKAnalysisCharSetUnion(&sequence->all, &item->all);
+  }
+}
+
+// Computes the properties of a group from its alternatives.
+static void RKAnalysisFinishGroup(RKAnalysisParser * const parser, const RKUInteger groupIndex) {
+  RKAnalysisNode *group = &parser->nodes[groupIndex];
+  RKUInteger      sequenceIndex;
+  BOOL            anyNullable = NO;
+
+  group->singleRun = ((group->groupKind == RKAnalysisCaptureGroup) && (group->childCount > 0)) ? YES : NO;
+  for(sequenceIndex = group->firstChild; sequenceIndex != RK_ANALYSIS_NONE; sequenceIndex = parser->nodes[sequenceIndex].nextSibling) {
+    RKAnalysisNode *sequence = &parser->nodes[sequenceIndex];
+    RKAnalysisCharSetUnion(&group->first, &sequence->first);
+    RKAnalysisCharSetUnion(&group->all,   &sequence->all);
+    if(sequence->nullable == YES) { group->nullable = anyNullable = YES; }
+    if(sequence->opaque   == YES) { group->opaque   = YES; }
+    if(sequence->dollar   == YES) { group->dollar   = YES; }
+    if((sequence->childCount != 1) || (parser->nodes[sequence->firstChild].singleRun == NO)) { group->singleRun = NO; }
+  }
+  // With more than one alternative, an alternative that can match the empty string could end a repetition early.
+  if((anyNullable == YES) && (group->childCount > 1)) { group->singleRun = NO; }
+
+  if((group->groupKind == RKAnalysisLookaroundGroup) || (group->groupKind == RKAnalysisConditionalGroup)) {
+    memset(&group->first, 0, sizeof(RKAnalysisCharSet));
+    if(group->groupKind == RKAnalysisLookaroundGroup) { memset(&group->all, 0, sizeof(RKAnalysisCharSet)); group->nullable = YES; }
+    group->opaque = YES;
+  }
+}
+
+// Parses the group at parser->at, which is just past the '('.  Returns RK_ANALYSIS_NONE for comments, option settings, and verbs.
+static RKUInteger RKAnalysisParseGroup(RKAnalysisParser * const parser, RKCompileOption * const options, const RKUInteger start) {
+  RKCompileOption groupOptions = *options;
+  int             groupKind    = RKAnalysisCaptureGroup;
+  RKUInteger      groupIndex   = RK_ANALYSIS_NONE;
+
+  if((parser->at < parser->length) && (parser->characters[parser->at] == '*')) { RKAnalysisSkipParenthesis(parser); return(RK_ANALYSIS_NONE); }
+
+  if((parser->at < parser->length) && (parser->characters[parser->at] == '?')) {
+    if(++parser->at >= parser->length) { parser->failed = YES; return(RK_ANALYSIS_NONE); }
+    unichar c = parser->characters[parser->at], next = ((parser->at + 1) < parser->length) ? parser->characters[parser->at + 1] : 0;
+
+    switch(c) {
+      case '#': case 'C': RKAnalysisSkipParenthesis(parser); return(RK_ANALYSIS_NONE);
+      case ':': case '|': parser->at++; break;
+      case '>':           parser->at++; groupKind = RKAnalysisAtomicGroup;     break;
+      case '=': case '!': parser->at++; groupKind = RKAnalysisLookaroundGroup; break;
+      case '(':           parser->at++; RKAnalysisSkipParenthesis(parser); groupKind = RKAnalysisConditionalGroup; break;
+      case '<': case '\'':
+        if((c == '<') && ((next == '=') || (next == '!'))) { parser->at += 2; groupKind = RKAnalysisLookaroundGroup; break; }
+        parser->at++;
+        while((parser->at < parser->length) && (parser->characters[parser->at] != ((c == '<') ? '>' : '\''))) { parser->at++; }
+        parser->at++;
+        break;
+      case 'P':
+        if(next == '<') { while((parser->at < parser->length) && (parser->characters[parser->at] != '>')) { parser->at++; } parser->at++; break; }
+        // Fall through, (?P=name) and (?P>name) are a back reference and a recursion.
+      case 'R': case '&': case '+': case '-': case '0': case '1': case '2': case '3': case '4': case '5': case '6': case '7': case '8': case '9':
+        if((c == '-') && (RKAnalysisIsDigit(next) == NO)) { goto optionSetting; }
+        RKAnalysisSkipParenthesis(parser);
+        groupIndex = RKAnalysisNewNode(parser, RKAnalysisOpaqueNode, start);
+        if(groupIndex == RK_ANALYSIS_NONE) { return(RK_ANALYSIS_NONE); }
+        RKAnalysisCharSetAll(&parser->nodes[groupIndex].first);
+        RKAnalysisCharSetAll(&parser->nodes[groupIndex].all);
+        parser->nodes[groupIndex].nullable = parser->nodes[groupIndex].opaque = YES;
+        parser->nodes[groupIndex].end      = parser->nodes[groupIndex].quantifierEnd = parser->at;
+        return(groupIndex);
+      default:
+      optionSetting: {
+        BOOL unset = NO;
+        while(parser->at < parser->length) {
+          RKCompileOption option = 0;
+          switch(parser->characters[parser->at++]) {
+            case '-': unset = YES; continue;
+            case 'i': option = RKCompileCaseless;  break;
+            case 's': option = RKCompileDotAll;    break;
+            case 'x': option = RKCompileExtended;  break;
+            case 'U': option = RKCompileUngreedy;  break;
+            case 'm': case 'J': case 'X': break;
+            case ')': *options = groupOptions; return(RK_ANALYSIS_NONE); // The setting lasts until the end of the enclosing group.
+            case ':': goto parseGroup;
+            default: parser->failed = YES; return(RK_ANALYSIS_NONE);
+          }
+          groupOptions = (unset == YES) ? (groupOptions & ~option) : (groupOptions | option);
+        }
+        parser->failed = YES;
+        return(RK_ANALYSIS_NONE);
+      }
+    }
+  }
+
+parseGroup:
+  if(++parser->depth > RK_ANALYSIS_MAX_DEPTH) { parser->failed = YES; return(RK_ANALYSIS_NONE); }
+  if((groupIndex = RKAnalysisNewNode(parser, RKAnalysisGroupNode, start)) == RK_ANALYSIS_NONE) { return(RK_ANALYSIS_NONE); }
+  parser->nodes[groupIndex].groupKind = groupKind;
+
+  RKAnalysisParseSequences(parser, groupIndex, groupOptions);
+  if((parser->failed == YES) || (parser->at >= parser->length) || (parser->characters[parser->at] != ')')) { parser->failed = YES; return(RK_ANALYSIS_NONE); }
+  parser->at++;
+  parser->depth--;
+
+  RKAnalysisFinishGroup(parser, groupIndex);
+  parser->nodes[groupIndex].end = parser->nodes[groupIndex].quantifierEnd = parser->at;
+  return(groupIndex);
+}
+
+static RKUInteger RKAnalysisParseItem(RKAnalysisParser * const parser, RKCompileOption * const options) {
+  const RKUInteger start     = parser->at;
+  const BOOL       caseless  = ((*options & RKCompileCaseless) != 0) ? YES : NO;
+  unichar          c         = parser->characters[parser->at++];
+  RKUInteger       nodeIndex = RK_ANALYSIS_NONE;
+  RKAnalysisNode  *node      = NULL;
+
+  if(parser->inQuote == YES) {
+    if((c == '\\') && (parser->at < parser->length) && (parser->characters[parser->at] == 'E')) { parser->inQuote = NO; parser->at++; return(RK_ANALYSIS_NONE); }
+    goto literal;
+  }
+
+  switch(c) {
+    case '(': return(RKAnalysisParseGroup(parser, options, start));
+
+    case '^': case '$':
+      if((nodeIndex = RKAnalysisNewNode(parser, RKAnalysisAssertionNode, start)) == RK_ANALYSIS_NONE) { return(RK_ANALYSIS_NONE); }
+      parser->nodes[nodeIndex].nullable = YES;
+      parser->nodes[nodeIndex].dollar   = (c == '$') ? YES : NO;
+      goto finished;
+
+    case '.':
+      if((nodeIndex = RKAnalysisNewNode(parser, RKAnalysisAtomNode, start)) == RK_ANALYSIS_NONE) { return(RK_ANALYSIS_NONE); }
+      node = &parser->nodes[nodeIndex];
+      RKAnalysisCharSetAll(&node->first);
+      if((*options & RKCompileDotAll) == 0) { node->first.bits['\n' >> 5] &= ~(1U << ('\n' & 31)); }
+      goto atom;
+
+    case '[':
+      if((nodeIndex = RKAnalysisNewNode(parser, RKAnalysisAtomNode, start)) == RK_ANALYSIS_NONE) { return(RK_ANALYSIS_NONE); }
+      RKAnalysisParseCharacterClass(parser, &parser->nodes[nodeIndex].first, *options);
+      node = &parser->nodes[nodeIndex];
+      goto atom;
+
+    case '\\':
+      if(parser->at >= parser->length) { parser->failed = YES; return(RK_ANALYSIS_NONE); }
+      c = parser->characters[parser->at];
+      if(c == 'Q') { parser->inQuote = YES; parser->at++; return(RK_ANALYSIS_NONE); }
+      if(c == 'E') { parser->at++; return(RK_ANALYSIS_NONE); }
+      if((c == 'b') || (c == 'B') || (c == 'A') || (c == 'Z') || (c == 'z') || (c == 'G') || (c == 'K')) {
+        parser->at++;
+        if((nodeIndex = RKAnalysisNewNode(parser, RKAnalysisAssertionNode, start)) == RK_ANALYSIS_NONE) { return(RK_ANALYSIS_NONE); }
+        parser->nodes[nodeIndex].nullable = YES;
+        parser->nodes[nodeIndex].dollar   = ((c == 'Z') || (c == 'z')) ? YES : NO;
+        parser->nodes[nodeIndex].boundary = ((c == 'b') || (c == 'B') || (c == 'G') || (c == 'K')) ? YES : NO;
+        goto finished;
+      }
+      if(((c >= '1') && (c <= '9')) || (c == 'g') || (c == 'k')) {
+        parser->at++;
+        if((parser->at < parser->length) && ((parser->characters[parser->at] == '{') || (parser->characters[parser->at] == '<') || (parser->characters[parser->at] == '\''))) {
+          unichar close = (parser->characters[parser->at] == '{') ? '}' : ((parser->characters[parser->at] == '<') ? '>' : '\'');
+          while((parser->at < parser->length) && (parser->characters[parser->at] != close)) { parser->at++; }
+          parser->at++;
+        } else { while((parser->at < parser->length) && ((RKAnalysisIsDigit(parser->characters[parser->at]) == YES) || (parser->characters[parser->at] == '-'))) { parser->at++; } }
+        if((nodeIndex = RKAnalysisNewNode(parser, RKAnalysisOpaqueNode, start)) == RK_ANALYSIS_NONE) { return(RK_ANALYSIS_NONE); }
+        node = &parser->nodes[nodeIndex];
+        RKAnalysisCharSetAll(&node->first);
+        RKAnalysisCharSetAll(&node->all);
+        node->nullable = node->opaque = YES;
+        goto finished;
+      }
+      if((nodeIndex = RKAnalysisNewNode(parser, RKAnalysisAtomNode, start)) == RK_ANALYSIS_NONE) { return(RK_ANALYSIS_NONE); }
+      node = &parser->nodes[nodeIndex];
+      if(RKAnalysisCharSetAddCharacterType(parser, &node->first) == NO) { RKAnalysisCharSetAdd(&node->first, RKAnalysisParseEscapedCharacter(parser), caseless); }
+      goto atom;
+
+    case ')': case '|': parser->failed = YES; return(RK_ANALYSIS_NONE); // Handled by RKAnalysisParseSequences().
+
+    default: break;
+  }
+
+literal:
+  if((nodeIndex = RKAnalysisNewNode(parser, RKAnalysisAtomNode, start)) == RK_ANALYSIS_NONE) { return(RK_ANALYSIS_NONE); }
+  node = &parser->nodes[nodeIndex];
+  RKAnalysisCharSetAdd(&node->first, c, caseless);
+
+atom:
+  node->all       = node->first;
+  node->singleRun = YES;
+
+finished:
+  parser->nodes[nodeIndex].end = parser->nodes[nodeIndex].quantifierEnd = parser->at;
+  return(nodeIndex);
+}
+
+// Parses alternatives in to sequences of groupIndex until the ')' that closes the group, or the end of the pattern.
+static void RKAnalysisParseSequences(RKAnalysisParser * const parser, const RKUInteger groupIndex, RKCompileOption options) {
+  RKUInteger sequenceIndex = RKAnalysisNewNode(parser, RKAnalysisSequenceNode, parser->at);
+  if(sequenceIndex == RK_ANALYSIS_NONE) { return; }
+  RKAnalysisAppendChild(parser, groupIndex, sequenceIndex);
+
+  while(parser->failed == NO) {
+    RKAnalysisSkipExtendedWhitespace(parser, options);
+    if(parser->at >= parser->length) { break; }
+
+    unichar c = parser->characters[parser->at];
+    if((parser->inQuote == NO) && (c == ')')) { break; }
+    if((parser->inQuote == NO) && (c == '|')) {
+      RKAnalysisFinishSequence(parser, sequenceIndex);
+      parser->nodes[sequenceIndex].end = parser->at++;
+      if((sequenceIndex = RKAnalysisNewNode(parser, RKAnalysisSequenceNode, parser->at)) == RK_ANALYSIS_NONE) { return; }
+      RKAnalysisAppendChild(parser, groupIndex, sequenceIndex);
+      continue;
+    }
+
+    RKUInteger itemIndex = RKAnalysisParseItem(parser, &options);
+    if((itemIndex == RK_ANALYSIS_NONE) || (parser->failed == YES)) { continue; }
+
+    if(parser->inQuote == NO) {
+      RKAnalysisSkipExtendedWhitespace(parser, options);
+      if(parser->nodes[itemIndex].type != RKAnalysisAssertionNode) { RKAnalysisParseQuantifier(parser, itemIndex, options); }
+    }
+    RKAnalysisNode *item = &parser->nodes[itemIndex];
+    // A lazy or bounded quantifier can not make the item match exactly the runs of a set of characters.
+    if((item->quantified == YES) && ((item->lazy == YES) || ((item->max != 1) && (item->max != RK_ANALYSIS_UNBOUNDED)) || (item->min > 1))) { item->singleRun = NO; }
+    RKAnalysisAppendChild(parser, sequenceIndex, itemIndex);
+  }
+
+  RKAnalysisFinishSequence(parser, sequenceIndex);
+  parser->nodes[sequenceIndex].end = parser->at;
+}
+
+#pragma mark Hazards
+
+RKREGEX_STATIC_INLINE BOOL RKAnalysisNodeRepeats(const RKAnalysisNode * const node) {
+  return(((node->quantified == YES) && (node->max > 1) && (node->possessive == NO) && (node->type != RKAnalysisOpaqueNode) &&
+          ((node->type != RKAnalysisGroupNode) || (node->groupKind == RKAnalysisCaptureGroup))) ? YES : NO);
+}
+
+// Returns the repeated item in sequenceIndex, or in a group nested in it, that can consume characters in nextIteration and is followed only by items that can match the empty string.
+static RKUInteger RKAnalysisFindNestedQuantifier(const RKAnalysisParser * const parser, const RKUInteger sequenceIndex, const RKAnalysisCharSet * const nextIteration, const BOOL tailNullable) {
+  RKUInteger itemIndex, sequence, found;
+
+  for(itemIndex = parser->nodes[sequenceIndex].firstChild; itemIndex != RK_ANALYSIS_NONE; itemIndex = parser->nodes[itemIndex].nextSibling) {
+    const RKAnalysisNode *item = &parser->nodes[itemIndex];
+    const BOOL            tail = ((tailNullable == YES) && (item->restNullable == YES)) ? YES : NO;
+
+    if(RKAnalysisNodeRepeats(item) == YES) {
+      if((tail == YES) && (RKAnalysisCharSetIntersects(&item->all, nextIteration) == YES)) { return(itemIndex); }
+      continue;
+    }
+    if((item->type != RKAnalysisGroupNode) || (item->groupKind != RKAnalysisCaptureGroup) || (item->possessive == YES)) { continue; }
+    for(sequence = item->firstChild; sequence != RK_ANALYSIS_NONE; sequence = parser->nodes[sequence].nextSibling) {
+      if((found = RKAnalysisFindNestedQuantifier(parser, sequence, nextIteration, tail)) != RK_ANALYSIS_NONE) { return(found); }
+    }
+  }
+  return(RK_ANALYSIS_NONE);
+}
+
+// Returns YES if nothing that can follow nodeIndex can begin with a character in set, so that giving characters back to nodeIndex can never lead to a match.
+static BOOL RKAnalysisFollowIsDisjoint(const RKAnalysisParser * const parser, RKUInteger nodeIndex, const RKAnalysisCharSet * const set) {
+  while(nodeIndex != 0) {
+    RKUInteger siblingIndex;
+    for(siblingIndex = parser->nodes[nodeIndex].nextSibling; siblingIndex != RK_ANALYSIS_NONE; siblingIndex = parser->nodes[siblingIndex].nextSibling) {
+      const RKAnalysisNode *sibling = &parser->nodes[siblingIndex];
+      if((sibling->opaque == YES) || (sibling->boundary == YES)) { return(NO); } // The result of \b, \B, \G and \K depends on where the previous item stopped.
+      if((sibling->dollar == YES) && (RKAnalysisCharSetContains(set, '\n') == YES)) { return(NO); }
+      if(RKAnalysisCharSetIntersects(&sibling->first, set) == YES) { return(NO); }
+      if(sibling->nullable == NO) { return(YES); }
+    }
+
+    const RKAnalysisNode *group = &parser->nodes[parser->nodes[parser->nodes[nodeIndex].parent].parent];
+    if((group->groupKind == RKAnalysisAtomicGroup) || (group->groupKind == RKAnalysisLookaroundGroup) || (group->possessive == YES)) { return(YES); }
+    if(group->groupKind == RKAnalysisConditionalGroup) { return(NO); }
+    if((group->quantified == YES) && (group->max > 1) && (RKAnalysisCharSetIntersects(&group->first, set) == YES)) { return(NO); }
+    nodeIndex = parser->nodes[nodeIndex].parent;
+    nodeIndex = parser->nodes[nodeIndex].parent;
+  }
+  return(YES);
+}
+
+static BOOL RKAnalysisIsHardenable(const RKAnalysisParser * const parser, const RKUInteger groupIndex) {
+  const RKAnalysisNode *group = &parser->nodes[groupIndex];
+  if((group->singleRun == NO) || (group->opaque == YES) || (group->lazy == YES) || (group->hasSuffix == YES) || (group->max != RK_ANALYSIS_UNBOUNDED)) { return(NO); }
+  return(RKAnalysisFollowIsDisjoint(parser, groupIndex, &group->all));
+}
+
+static void RKAnalysisAddHazard(NSMutableArray * const hazards, NSString * const regexString, const RKRegexHazard hazardType, const NSRange hazardRange, const BOOL exponential, const BOOL hardenable) {
+  NSString *hazardString = [regexString substringWithRange:hazardRange], *descriptionString = NULL;
+
+  switch(hazardType) {
+    case RKRegexHazardNestedQuantifier:       descriptionString = RKLocalizedFormat(@"The repeated group '%@' contains a repeated item that can match the characters that begin the next repetition.", hazardString); break;
+    case RKRegexHazardOverlappingAlternation: descriptionString = RKLocalizedFormat(@"The repeated group '%@' contains alternatives that can begin with the same character.", hazardString); break;
+    case RKRegexHazardAdjacentQuantifiers:    descriptionString = RKLocalizedFormat(@"The repeated items in '%@' can match the same characters.", hazardString); break;
+    default: break;
+  }
+
+  [hazards addObject:[NSDictionary dictionaryWithObjectsAndKeys:
+                      [NSNumber numberWithInt:hazardType],  RKRegexHazardTypeKey,
+                      [NSValue valueWithRange:hazardRange], RKRegexHazardRangeKey,
+                      [NSNumber numberWithBool:exponential], RKRegexHazardExponentialKey,
+                      [NSNumber numberWithBool:hardenable],  RKRegexHazardHardenableKey,
+                      descriptionString,                     RKRegexHazardDescriptionKey,
+                      NULL]];
+}
+
+static RKInteger RKAnalysisCompareHazards(id hazard, id otherHazard, void *context RK_ATTRIBUTES(unused)) {
+  RKUInteger location = [[hazard objectForKey:RKRegexHazardRangeKey] rangeValue].location, otherLocation = [[otherHazard objectForKey:RKRegexHazardRangeKey] rangeValue].location;
+  return((location < otherLocation) ? NSOrderedAscending : ((location > otherLocation) ? NSOrderedDescending : NSOrderedSame));
+}
+
+// Returns the hazards in regexString, and if hardenIndexes is not NULL, the indexes of the pattern where a '+' makes a hardenable hazards quantifier possessive.
+static NSArray *RKAnalysisHazards(NSString * const regexString, const RKCompileOption options, NSMutableIndexSet * const hardenIndexes) {
+  NSMutableArray   *hazards    = [NSMutableArray array];
+  RKAnalysisParser  parser;
+  RKUInteger        nodeIndex, rootIndex;
+
+  memset(&parser, 0, sizeof(parser));
+  if((parser.length = [regexString length]) == 0) { return(hazards); }
+  if((parser.characters = RKAutoreleasedMallocNoGC(sizeof(unichar) * parser.length)) == NULL) { return(hazards); }
+  [regexString getCharacters:(unichar *)parser.characters range:NSMakeRange(0, parser.length)];
+
+  if((rootIndex = RKAnalysisNewNode(&parser, RKAnalysisGroupNode, 0)) == RK_ANALYSIS_NONE) { goto exitNow; }
+  RKAnalysisParseSequences(&parser, rootIndex, options);
+  if((parser.failed == YES) || (parser.at != parser.length)) { goto exitNow; }
+  RKAnalysisFinishGroup(&parser, rootIndex);
+
+  for(nodeIndex = 1; nodeIndex < parser.count; nodeIndex++) {
+    const RKAnalysisNode *node = &parser.nodes[nodeIndex];
+    RKUInteger            sequenceIndex, otherIndex;
+
+    if(node->type == RKAnalysisSequenceNode) {
+      RKUInteger itemIndex, previousIndex = RK_ANALYSIS_NONE;
+      for(itemIndex = node->firstChild; itemIndex != RK_ANALYSIS_NONE; itemIndex = parser.nodes[itemIndex].nextSibling) {
+        const RKAnalysisNode *item = &parser.nodes[itemIndex];
+        if((RKAnalysisNodeRepeats(item) == YES) && (item->max == RK_ANALYSIS_UNBOUNDED)) {
+          if((previousIndex != RK_ANALYSIS_NONE) && (RKAnalysisCharSetIntersects(&parser.nodes[previousIndex].all, &item->first) == YES)) {
+            RKAnalysisAddHazard(hazards, regexString, RKRegexHazardAdjacentQuantifiers, NSMakeRange(parser.nodes[previousIndex].start, item->end - parser.nodes[previousIndex].start), NO, NO);
+          }
+          previousIndex = itemIndex;
+        } else if(item->nullable == NO) { previousIndex = RK_ANALYSIS_NONE; }
+      }
+      continue;
+    }
+
+    if((node->type != RKAnalysisGroupNode) || (RKAnalysisNodeRepeats(node) == NO)) { continue; }
+
+    const NSRange groupRange = NSMakeRange(node->start, node->end - node->start);
+    const BOOL    hardenable = RKAnalysisIsHardenable(&parser, nodeIndex);
+    BOOL          foundNested = NO;
+
+    for(sequenceIndex = node->firstChild; (sequenceIndex != RK_ANALYSIS_NONE) && (foundNested == NO); sequenceIndex = parser.nodes[sequenceIndex].nextSibling) {
+      if(RKAnalysisFindNestedQuantifier(&parser, sequenceIndex, &node->first, YES) != RK_ANALYSIS_NONE) { foundNested = YES; }
+    }
+    if(foundNested == YES) {
+      RKAnalysisAddHazard(hazards, regexString, RKRegexHazardNestedQuantifier, groupRange, YES, hardenable);
+      if(hardenable == YES) { [hardenIndexes addIndex:node->quantifierEnd]; }
+      continue;
+    }
+
+    for(sequenceIndex = node->firstChild; sequenceIndex != RK_ANALYSIS_NONE; sequenceIndex = parser.nodes[sequenceIndex].nextSibling) {
+      for(otherIndex = parser.nodes[sequenceIndex].nextSibling; otherIndex != RK_ANALYSIS_NONE; otherIndex = parser.nodes[otherIndex].nextSibling) {
+        const RKAnalysisNode *sequence = &parser.nodes[sequenceIndex], *other = &parser.nodes[otherIndex];
+        if(RKAnalysisCharSetIntersects(&sequence->first, &other->first) == NO) { continue; }
+        const BOOL exponential = ((sequence->childCount == 1) && (other->childCount == 1) && (parser.nodes[sequence->firstChild].type == RKAnalysisAtomNode) && (parser.nodes[other->firstChild].type == RKAnalysisAtomNode)) ? YES : NO;
+        RKAnalysisAddHazard(hazards, regexString, RKRegexHazardOverlappingAlternation, groupRange, exponential, hardenable);
+        if(hardenable == YES) { [hardenIndexes addIndex:node->quantifierEnd]; }
+        goto nextNode;
+      }
+    }
+  nextNode:
+    continue;
+  }
+
+  [hazards sortUsingFunction:RKAnalysisCompareHazards context:NULL];
+
+exitNow:
+  if(parser.nodes != NULL) { RKFreeAndNULLNoGC(parser.nodes); }
+  return(hazards);
+}
+
+// Returns YES if regexString contains an atomic group or a possessive quantifier.  pcre_dfa_exec() treats them as if they were ordinary
+// groups and quantifiers, so it can find a match where the backtracking algorithm does not, ie (?>a|ab)c matches "abc".  Both require
+// a '+' right after a quantifier or a "(?>", so most patterns are ruled out without being parsed.  A pattern that the parser does not
+// understand is assumed to contain one.
+BOOL RKAnalysisHasAtomicItems(NSString * const regexString, const RKCompileOption options) {
+  RKAnalysisParser  parser;
+  RKUInteger        nodeIndex, rootIndex, atCharacter;
+  BOOL              mayHaveAtomicItems = NO, hasAtomicItems = YES;
+
+  memset(&parser, 0, sizeof(parser));
+  if((parser.length = [regexString length]) < 3) { return(NO); }
+  if((parser.characters = RKAutoreleasedMallocNoGC(sizeof(unichar) * parser.length)) == NULL) { return(YES); }
+  [regexString getCharacters:(unichar *)parser.characters range:NSMakeRange(0, parser.length)];
+
+  for(atCharacter = 2; (atCharacter < parser.length) && (mayHaveAtomicItems == NO); atCharacter++) {
+    const unichar c = parser.characters[atCharacter], previous = parser.characters[atCharacter - 1];
+    if((c == '+') && ((previous == '*') || (previous == '+') || (previous == '?') || (previous == '}'))) { mayHaveAtomicItems = YES; }
+    if((c == '>') && (previous == '?') && (parser.characters[atCharacter - 2] == '('))                  { mayHaveAtomicItems = YES; }
+  }
+  if(mayHaveAtomicItems == NO) { return(NO); }
+
+  if((rootIndex = RKAnalysisNewNode(&parser, RKAnalysisGroupNode, 0)) == RK_ANALYSIS_NONE) { goto exitNow; }
+  RKAnalysisParseSequences(&parser, rootIndex, options);
+  if((parser.failed == YES) || (parser.at != parser.length)) { goto exitNow; }
+
+  for(nodeIndex = 1, hasAtomicItems = NO; (nodeIndex < parser.count) && (hasAtomicItems == NO); nodeIndex++) {
+    const RKAnalysisNode *node = &parser.nodes[nodeIndex];
+    if((node->possessive == YES) || ((node->type == RKAnalysisGroupNode) && (node->groupKind == RKAnalysisAtomicGroup))) { hasAtomicItems = YES; }
+  }
+
+exitNow:
+  if(parser.nodes != NULL) { RKFreeAndNULLNoGC(parser.nodes); }
+  return(hasAtomicItems);
+}
+
+#pragma mark -
+
+@implementation RKRegex (HazardAnalysis)
+
++ (NSArray *)hazardsForRegexString:(NSString * const)regexString options:(const RKCompileOption)options
+{
+  if(RK_EXPECTED(regexString == NULL, 0)) { [[NSException rkException:NSInvalidArgumentException for:self selector:_cmd localizeReason:@"The regexString argument is NULL."] raise]; }
+  return([NSArray arrayWithArray:RKAnalysisHazards(regexString, options, NULL)]);
+}
+
++ (NSString *)hardenedRegexString:(NSString * const)regexString options:(const RKCompileOption)options hazards:(NSArray **)hazards
+{
+  if(RK_EXPECTED(regexString == NULL, 0)) { [[NSException rkException:NSInvalidArgumentException for:self selector:_cmd localizeReason:@"The regexString argument is NULL."] raise]; }
+
+  NSMutableIndexSet *hardenIndexes     = [NSMutableIndexSet indexSet];
+  NSArray           *remainingHazards  = RKAnalysisHazards(regexString, options, hardenIndexes);
+  NSString          *hardenedString    = regexString;
+
+  if([hardenIndexes count] > 0) {
+    NSMutableString *mutableString = [NSMutableString stringWithString:regexString];
+    RKUInteger       atIndex       = [hardenIndexes lastIndex];
+    // Insert from the end so the earlier indexes are not moved.
+    while(atIndex != NSNotFound) { [mutableString insertString:@"+" atIndex:atIndex]; atIndex = [hardenIndexes indexLessThanIndex:atIndex]; }
+    hardenedString   = [NSString stringWithString:mutableString];
+    remainingHazards = RKAnalysisHazards(hardenedString, options, NULL);
+  }
+
+  if(hazards != NULL) { *hazards = [NSArray arrayWithArray:remainingHazards]; }
+  return(hardenedString);
+}
+
++ (id)regexWithRegexString:(NSString * const)regexString options:(const RKCompileOption)options analysis:(const RKRegexAnalysisOption)analysisOptions error:(NSError **)error
+{
+  if(error != NULL) { *error = NULL; }
+  if(RK_EXPECTED(regexString == NULL, 0)) { [[NSException rkException:NSInvalidArgumentException for:self selector:_cmd localizeReason:@"The regexString argument is NULL."] raise]; }
+
+  NSString       *analyzedRegexString = regexString;
+  NSArray        *hazards             = NULL;
+  NSMutableArray *rejectedHazards     = [NSMutableArray array];
+  NSEnumerator   *hazardEnumerator    = NULL;
+  NSDictionary   *hazard              = NULL;
+
+  if((analysisOptions & RKRegexAnalysisHarden) != 0) { analyzedRegexString = [self hardenedRegexString:regexString options:options hazards:&hazards]; }
+  else if((analysisOptions & RKRegexAnalysisReject) != 0) { hazards = RKAnalysisHazards(regexString, options, NULL); }
+
+  hazardEnumerator = [hazards objectEnumerator];
+  while((hazard = [hazardEnumerator nextObject]) != NULL) {
+    RKRegexAnalysisOption rejectOption = ([[hazard objectForKey:RKRegexHazardExponentialKey] boolValue] == YES) ? RKRegexAnalysisRejectExponential : RKRegexAnalysisRejectPolynomial;
+    if((analysisOptions & rejectOption) != 0) { [rejectedHazards addObject:hazard]; }
+  }
+
+  if([rejectedHazards count] > 0) {
+    if(error != NULL) {
+      NSDictionary *firstHazard = [rejectedHazards objectAtIndex:0];
+      NSDictionary *errorInfoDictionary = [NSDictionary dictionaryWithObjectsAndKeys:
+                                           RKLocalizedFormat(@"The regular expression contains %lu backtracking hazards.", (unsigned long)[rejectedHazards count]), NSLocalizedDescriptionKey,
+                                           [firstHazard objectForKey:RKRegexHazardDescriptionKey],                                                                 NSLocalizedFailureReasonErrorKey,
+                                           analyzedRegexString,                                                                                                   RKRegexStringErrorKey,
+                                           [firstHazard objectForKey:RKRegexHazardRangeKey],                                                                      RKRegexStringErrorRangeErrorKey,
+                                           [NSNumber numberWithInt:options],                                                                                      RKCompileOptionErrorKey,
+                                           [NSArray arrayWithArray:rejectedHazards],                                                                              RKRegexHazardsErrorKey,
+                                           NULL];
+      *error = [NSError errorWithDomain:RKRegexErrorDomain code:0 userInfo:errorInfoDictionary];
+    }
+    return(NULL);
+  }
+
+  return([self regexWithRegexString:analyzedRegexString library:RKRegexPCRELibrary options:options error:error]);
+}
+
+@end
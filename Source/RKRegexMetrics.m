@@ -0,0 +1,486 @@
+//
+//  RKRegexMetrics.m
+//  RegexKit
+//  http://regexkit.sourceforge.net/
+//
+
+/*
+ Copyright © 2007-2008, John Engelhart
+ 
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+ notice, this list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright
+ notice, this list of conditions and the following disclaimer in the
+ documentation and/or other materials provided with the distribution.
+ 
+ * Neither the name of the Zang Industries nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#import <RegexKit/RegexKitPrivate.h>
+#import <RegexKit/RKUtility.h>
+#ifdef __MACOSX_RUNTIME__
+#import <mach/mach_time.h>
+#else
+#import <time.h>
+#endif
+
+/*
+ Match metrics are recorded by RKRegexPCREExec() in RKRegex.m, but only while RKRegexMetricsCollect is set.
+ 
+ The first time a regex matches while metrics are enabled it is given a metrics index.  Regexes with the same pattern and
+ compile options share an index, so a regex that is evicted from the cache and compiled again picks up where it left off.
+ 
+ Each thread that matches gets a __RKRegexMetricsThread, hung off of its thread local data, which holds an array of
+ counters indexed by the metrics index less one.  The counters for a regex are allocated the first time that the thread
+ matches it.  Only the owning thread writes to its counters, so no atomic operations are needed on the match path.  Readers
+ take globalRegexMetricsMutex and add up the counters of every thread, and the owning thread also holds it whenever it
+ grows its array.  When a thread exits its counters are folded in to the retired counters.
+*/
+
+// Latency histogram buckets are log-linear: each power of two from 2^RK_REGEX_METRICS_MIN_SHIFT to 2^RK_REGEX_METRICS_MAX_SHIFT
+// nanoseconds is split in to 2^RK_REGEX_METRICS_SUB_BUCKET_BITS equal width buckets.  Bucket 0 counts everything faster than
+// the first power of two, and the last bucket also counts everything slower than the last one.
+
+#define RK_REGEX_METRICS_MIN_SHIFT         (6)
+#define RK_REGEX_METRICS_MAX_SHIFT         (35)
+#define RK_REGEX_METRICS_SUB_BUCKET_BITS   (2)
+#define RK_REGEX_METRICS_HISTOGRAM_BUCKETS (1 + ((RK_REGEX_METRICS_MAX_SHIFT - RK_REGEX_METRICS_MIN_SHIFT + 1) << RK_REGEX_METRICS_SUB_BUCKET_BITS))
+
+typedef struct {
+  RKUInteger matchCount;
+  RKUInteger successfulMatchCount;
+  RKUInteger errorCount;
+  RKUInteger abortedCount;
+  uint64_t   bytesScanned;
+  uint64_t   matchNanoseconds;
+  RKUInteger latencyHistogram[RK_REGEX_METRICS_HISTOGRAM_BUCKETS];
+} RKRegexMetricsCounters;
+
+typedef struct {
+  NSString        *regexString;
+  RKCompileOption  compileOption;
+  RKUInteger       regexHash;
+} RKRegexMetricsEntry;
+
+struct __RKRegexMetricsThread {
+  struct __RKRegexMetricsThread  *nextThread;
+  struct __RKRegexMetricsThread  *previousThread;
+  RKUInteger                      countersCapacity;
+  RKRegexMetricsCounters        **counters;
+};
+
+       int32_t                        RKRegexMetricsCollect             = 0;
+static pthread_mutex_t                globalRegexMetricsMutex           = PTHREAD_MUTEX_INITIALIZER;
+static RKRegexMetricsEntry           *globalRegexMetricsEntries         = NULL;
+static RKUInteger                     globalRegexMetricsEntriesCount    = 0;
+static RKUInteger                     globalRegexMetricsEntriesCapacity = 0;
+static RKUInteger                    *globalRegexMetricsHashTable       = NULL; // Open addressed, holds metrics indexes.  Always twice globalRegexMetricsEntriesCapacity.
+static RKRegexMetricsCounters        *globalRegexMetricsRetired         = NULL; // Counters from threads that have exited.  globalRegexMetricsEntriesCapacity entries.
+static struct __RKRegexMetricsThread *globalRegexMetricsThreads         = NULL;
+
+#pragma mark -
+#pragma mark Prototypes
+
+static BOOL                    RKRegexMetricsGrowEntries(void)                                                                                          RK_ATTRIBUTES(used);
+static RKRegexMetricsCounters *RKRegexMetricsThreadCounters(struct __RKRegexMetricsThread * const threadMetrics, const RKUInteger metricsIndex)        RK_ATTRIBUTES(used, nonnull(1));
+static void                    RKRegexMetricsAddCounters(RKRegexMetricsCounters * const RK_C99(restrict) toCounters, const RKRegexMetricsCounters * const RK_C99(restrict) fromCounters) RK_ATTRIBUTES(used, nonnull);
+static NSMutableArray         *RKRegexMetricsArray(RKRegexMetricsCounters * const totalCounters)                                                      RK_ATTRIBUTES(used);
+
+#pragma mark -
+#pragma mark Recording
+
+RKREGEX_STATIC_INLINE RKUInteger RKRegexMetricsBucket(const uint64_t nanoseconds) {
+  RKUInteger shift = 0;
+  
+  if(nanoseconds < (1ULL << RK_REGEX_METRICS_MIN_SHIFT)) { return(0); }
+  shift = 63 - __builtin_clzll(nanoseconds);
+  if(shift > RK_REGEX_METRICS_MAX_SHIFT) { return(RK_REGEX_METRICS_HISTOGRAM_BUCKETS - 1); }
+  return(1 + ((shift - RK_REGEX_METRICS_MIN_SHIFT) << RK_REGEX_METRICS_SUB_BUCKET_BITS) + ((RKUInteger)(nanoseconds >> (shift - RK_REGEX_METRICS_SUB_BUCKET_BITS)) & ((1 << RK_REGEX_METRICS_SUB_BUCKET_BITS) - 1)));
+}
+
+RKREGEX_STATIC_INLINE uint64_t RKRegexMetricsBucketNanoseconds(const RKUInteger bucket) {
+  RKUInteger shift = 0;
+  
+  if(bucket == 0) { return(0); }
+  shift = RK_REGEX_METRICS_MIN_SHIFT + ((bucket - 1) >> RK_REGEX_METRICS_SUB_BUCKET_BITS);
+  return((1ULL << shift) + ((uint64_t)((bucket - 1) & ((1 << RK_REGEX_METRICS_SUB_BUCKET_BITS) - 1)) << (shift - RK_REGEX_METRICS_SUB_BUCKET_BITS)));
+}
+
+uint64_t RKRegexMetricsNanoseconds(void) {
+#ifdef __MACOSX_RUNTIME__
+  static mach_timebase_info_data_t timebaseInfo;
+  if(RK_EXPECTED(timebaseInfo.denom == 0, 0)) { mach_timebase_info(&timebaseInfo); }
+  return((mach_absolute_time() * timebaseInfo.numer) / timebaseInfo.denom);
+#else
+  struct timespec monotonicTime;
+  clock_gettime(CLOCK_MONOTONIC, &monotonicTime);
+  return(((uint64_t)monotonicTime.tv_sec * 1000000000ULL) + (uint64_t)monotonicTime.tv_nsec);
+#endif
+}
+
+// Returns the metrics index for the pattern and compile options, or 0 if one could not be allocated.
+
+RKUInteger RKRegexMetricsRegister(NSString * const regexString, const RKCompileOption compileOption, const RKUInteger regexHash) {
+  RKRegexMetricsEntry *entry = NULL;
+  RKUInteger metricsIndex = 0, atSlot = 0, slotMask = 0;
+  
+  if(regexString == NULL) { return(0); }
+  
+  pthread_mutex_lock(&globalRegexMetricsMutex);
+  
+  if(globalRegexMetricsHashTable != NULL) {
+    slotMask = (globalRegexMetricsEntriesCapacity * 2) - 1;
+    for(atSlot = regexHash & slotMask; globalRegexMetricsHashTable[atSlot] != 0; atSlot = (atSlot + 1) & slotMask) {
+      entry = &globalRegexMetricsEntries[globalRegexMetricsHashTable[atSlot] - 1];
+      if((entry->regexHash == regexHash) && (entry->compileOption == compileOption) && ([entry->regexString isEqualToString:regexString] == YES)) { metricsIndex = globalRegexMetricsHashTable[atSlot]; goto exitNow; }
+    }
+  }
+  
+  if(RKRegexMetricsGrowEntries() == NO) { goto exitNow; }
+  
+  entry                = &globalRegexMetricsEntries[globalRegexMetricsEntriesCount];
+  entry->regexString   = [regexString copy];
+  entry->compileOption = compileOption;
+  entry->regexHash     = regexHash;
+  RKDisableCollectorForPointer(entry->regexString);
+  metricsIndex         = ++globalRegexMetricsEntriesCount;
+  
+  slotMask = (globalRegexMetricsEntriesCapacity * 2) - 1;
+  for(atSlot = regexHash & slotMask; globalRegexMetricsHashTable[atSlot] != 0; atSlot = (atSlot + 1) & slotMask) { /* Find an empty slot */ }
+  globalRegexMetricsHashTable[atSlot] = metricsIndex;
+  
+exitNow:
+  pthread_mutex_unlock(&globalRegexMetricsMutex);
+  return(metricsIndex);
+}
+
+// Called with globalRegexMetricsMutex held.  The entries, the retired counters, and the hash table all grow together.
+
+static BOOL RKRegexMetricsGrowEntries(void) {
+  RKUInteger newCapacity = 0, atEntry = 0, atSlot = 0, slotMask = 0, *newHashTable = NULL;
+  RKRegexMetricsEntry    *newEntries = NULL;
+  RKRegexMetricsCounters *newRetired = NULL;
+  
+  if(globalRegexMetricsEntriesCount < globalRegexMetricsEntriesCapacity) { return(YES); }
+  
+  newCapacity = (globalRegexMetricsEntriesCapacity == 0) ? 64 : (globalRegexMetricsEntriesCapacity * 2);
+  
+  if((newHashTable = RKCallocNoGC(sizeof(RKUInteger) * newCapacity * 2))                                   == NULL) { return(NO); }
+  if((newEntries   = realloc(globalRegexMetricsEntries, sizeof(RKRegexMetricsEntry)    * newCapacity)) == NULL) { RKFreeAndNULLNoGC(newHashTable); return(NO); }
+  globalRegexMetricsEntries = newEntries;
+  if((newRetired   = realloc(globalRegexMetricsRetired, sizeof(RKRegexMetricsCounters) * newCapacity)) == NULL) { RKFreeAndNULLNoGC(newHashTable); return(NO); }
+  globalRegexMetricsRetired = newRetired;
+  memset(&globalRegexMetricsRetired[globalRegexMetricsEntriesCapacity], 0, sizeof(RKRegexMetricsCounters) * (newCapacity - globalRegexMetricsEntriesCapacity));
+  
+  slotMask = (newCapacity * 2) - 1;
+  for(atEntry = 0; atEntry < globalRegexMetricsEntriesCount; atEntry++) {
+    for(atSlot = globalRegexMetricsEntries[atEntry].regexHash & slotMask; newHashTable[atSlot] != 0; atSlot = (atSlot + 1) & slotMask) { /* Find an empty slot */ }
+    newHashTable[atSlot] = atEntry + 1;
+  }
+  
+  if(globalRegexMetricsHashTable != NULL) { RKFreeAndNULLNoGC(globalRegexMetricsHashTable); }
+  globalRegexMetricsHashTable       = newHashTable;
+  globalRegexMetricsEntriesCapacity = newCapacity;
+  
+  return(YES);
+}
+
+void RKRegexMetricsRecord(const RKUInteger metricsIndex, const RKUInteger bytesScanned, const uint64_t matchNanoseconds, const int errorCode) {
+  struct __RKThreadLocalData    *tld           = NULL;
+  struct __RKRegexMetricsThread *threadMetrics = NULL;
+  RKRegexMetricsCounters        *counters      = NULL;
+  
+  if(RK_EXPECTED(metricsIndex == 0, 0) || RK_EXPECTED((tld = RKGetThreadLocalData()) == NULL, 0)) { return; }
+  
+  if(RK_EXPECTED((threadMetrics = tld->_regexMetrics) == NULL, 0)) {
+    if((threadMetrics = RKCallocNoGC(sizeof(struct __RKRegexMetricsThread))) == NULL) { return; }
+    pthread_mutex_lock(&globalRegexMetricsMutex);
+    if((threadMetrics->nextThread = globalRegexMetricsThreads) != NULL) { globalRegexMetricsThreads->previousThread = threadMetrics; }
+    globalRegexMetricsThreads = threadMetrics;
+    pthread_mutex_unlock(&globalRegexMetricsMutex);
+    tld->_regexMetrics = threadMetrics;
+  }
+  
+  if(RK_EXPECTED(metricsIndex > threadMetrics->countersCapacity, 0) || RK_EXPECTED((counters = threadMetrics->counters[metricsIndex - 1]) == NULL, 0)) {
+    if((counters = RKRegexMetricsThreadCounters(threadMetrics, metricsIndex)) == NULL) { return; }
+  }
+  
+  counters->matchCount++;
+  counters->bytesScanned     += bytesScanned;
+  counters->matchNanoseconds += matchNanoseconds;
+  counters->latencyHistogram[RKRegexMetricsBucket(matchNanoseconds)]++;
+  if(errorCode >= 0) { counters->successfulMatchCount++; } else if(errorCode != RKMatchErrorNoMatch) {
+    counters->errorCount++;
+    if((errorCode == RKMatchErrorMatchLimit) || (errorCode == RKMatchErrorRecursionLimit) || (errorCode == RKMatchErrorTimeLimit)) { counters->abortedCount++; }
+  }
+}
+
+static RKRegexMetricsCounters *RKRegexMetricsThreadCounters(struct __RKRegexMetricsThread * const threadMetrics, const RKUInteger metricsIndex) {
+  RKRegexMetricsCounters **newCounters = NULL, *counters = NULL;
+  RKUInteger newCapacity = 0;
+  
+  pthread_mutex_lock(&globalRegexMetricsMutex);
+  
+  if(metricsIndex > threadMetrics->countersCapacity) {
+    newCapacity = (threadMetrics->countersCapacity == 0) ? 16 : (threadMetrics->countersCapacity * 2);
+    if(newCapacity < globalRegexMetricsEntriesCount) { newCapacity = globalRegexMetricsEntriesCount; }
+    if(newCapacity < metricsIndex)                   { newCapacity = metricsIndex;                   }
+    if((newCounters = realloc(threadMetrics->counters, sizeof(RKRegexMetricsCounters *) * newCapacity)) == NULL) { goto exitNow; }
+    memset(&newCounters[threadMetrics->countersCapacity], 0, sizeof(RKRegexMetricsCounters *) * (newCapacity - threadMetrics->countersCapacity));
+    threadMetrics->counters         = newCounters;
+    threadMetrics->countersCapacity = newCapacity;
+  }
+  
+  if((counters = threadMetrics->counters[metricsIndex - 1]) == NULL) { counters = threadMetrics->counters[metricsIndex - 1] = RKCallocNoGC(sizeof(RKRegexMetricsCounters)); }
+  
+exitNow:
+  pthread_mutex_unlock(&globalRegexMetricsMutex);
+  return(counters);
+}
+
+// Called by __RKThreadIsExiting in RKRegex.m.
+
+void RKRegexMetricsThreadIsExiting(struct __RKRegexMetricsThread * const threadMetrics) {
+  RKUInteger atIndex = 0;
+  
+  if(threadMetrics == NULL) { return; }
+  
+  pthread_mutex_lock(&globalRegexMetricsMutex);
+  
+  for(atIndex = 0; atIndex < threadMetrics->countersCapacity; atIndex++) {
+    if(threadMetrics->counters[atIndex] == NULL) { continue; }
+    RKRegexMetricsAddCounters(&globalRegexMetricsRetired[atIndex], threadMetrics->counters[atIndex]);
+    RKFreeAndNULLNoGC(threadMetrics->counters[atIndex]);
+  }
+  
+  if(threadMetrics->previousThread != NULL) { threadMetrics->previousThread->nextThread = threadMetrics->nextThread; } else { globalRegexMetricsThreads = threadMetrics->nextThread; }
+  if(threadMetrics->nextThread     != NULL) { threadMetrics->nextThread->previousThread = threadMetrics->previousThread; }
+  
+  pthread_mutex_unlock(&globalRegexMetricsMutex);
+  
+  if(threadMetrics->counters != NULL) { RKFreeAndNULLNoGC(threadMetrics->counters); }
+  free(threadMetrics);
+}
+
+static void RKRegexMetricsAddCounters(RKRegexMetricsCounters * const RK_C99(restrict) toCounters, const RKRegexMetricsCounters * const RK_C99(restrict) fromCounters) {
+  RKUInteger atBucket = 0;
+  
+  toCounters->matchCount           += fromCounters->matchCount;
+  toCounters->successfulMatchCount += fromCounters->successfulMatchCount;
+  toCounters->errorCount           += fromCounters->errorCount;
+  toCounters->abortedCount         += fromCounters->abortedCount;
+  toCounters->bytesScanned         += fromCounters->bytesScanned;
+  toCounters->matchNanoseconds     += fromCounters->matchNanoseconds;
+  for(atBucket = 0; atBucket < RK_REGEX_METRICS_HISTOGRAM_BUCKETS; atBucket++) { toCounters->latencyHistogram[atBucket] += fromCounters->latencyHistogram[atBucket]; }
+}
+
+#pragma mark -
+#pragma mark Reading
+
+static NSMutableDictionary *RKRegexMetricsCountersDictionary(const RKRegexMetricsCounters * const counters, NSString * const regexString, const RKCompileOption compileOption) {
+  NSMutableArray      *latencyHistogram = [NSMutableArray array];
+  NSMutableDictionary *dictionary       = NULL;
+  RKUInteger           atBucket         = 0;
+  
+  for(atBucket = 0; atBucket < RK_REGEX_METRICS_HISTOGRAM_BUCKETS; atBucket++) {
+    if(counters->latencyHistogram[atBucket] == 0) { continue; }
+    [latencyHistogram addObject:[NSDictionary dictionaryWithObjectsAndKeys:
+                                 [NSNumber numberWithUnsignedLongLong:RKRegexMetricsBucketNanoseconds(atBucket)],          @"nanoseconds",
+                                 [NSNumber numberWithUnsignedLong:(unsigned long)counters->latencyHistogram[atBucket]],  @"count",
+                                 NULL]];
+  }
+  
+  dictionary = [NSMutableDictionary dictionaryWithObjectsAndKeys:
+                [NSNumber numberWithUnsignedLong:(unsigned long)counters->matchCount],           @"matchCount",
+                [NSNumber numberWithUnsignedLong:(unsigned long)counters->successfulMatchCount], @"successfulMatchCount",
+                [NSNumber numberWithUnsignedLong:(unsigned long)counters->errorCount],           @"errorCount",
+                [NSNumber numberWithUnsignedLong:(unsigned long)counters->abortedCount],         @"abortedCount",
+                [NSNumber numberWithUnsignedLongLong:counters->bytesScanned],                    @"bytesScanned",
+                [NSNumber numberWithUnsignedLongLong:counters->matchNanoseconds],                @"matchNanoseconds",
+                latencyHistogram,                                                                @"latencyHistogram",
+                NULL];
+  
+  if(regexString != NULL) {
+    [dictionary setObject:regexString                              forKey:@"regex"];
+    [dictionary setObject:RKArrayFromCompileOption(compileOption) forKey:@"compileOptions"];
+  }
+  
+  return(dictionary);
+}
+
+// Returns a dictionary for every regex that has matched since the metrics were last cleared, and adds them all up in totalCounters.
+
+static NSMutableArray *RKRegexMetricsArray(RKRegexMetricsCounters * const totalCounters) {
+  struct __RKRegexMetricsThread *threadMetrics = NULL;
+  RKRegexMetricsCounters        *mergedCounters = NULL;
+  RKRegexMetricsEntry           *entries = NULL;
+  RKUInteger                     entriesCount = 0, atIndex = 0;
+  NSMutableArray                *regexMetrics = [NSMutableArray array];
+  
+  if(totalCounters != NULL) { memset(totalCounters, 0, sizeof(RKRegexMetricsCounters)); }
+  
+  pthread_mutex_lock(&globalRegexMetricsMutex);
+  
+  if((entriesCount = globalRegexMetricsEntriesCount) == 0) { pthread_mutex_unlock(&globalRegexMetricsMutex); return(regexMetrics); }
+  
+  // Entries are never removed and their strings are never released, so a copy of the entries remains valid after unlocking.
+  if(((mergedCounters = RKMallocNoGC(sizeof(RKRegexMetricsCounters) * entriesCount)) == NULL) || ((entries = RKMallocNoGC(sizeof(RKRegexMetricsEntry) * entriesCount)) == NULL)) { pthread_mutex_unlock(&globalRegexMetricsMutex); goto exitNow; }
+  
+  memcpy(entries,        globalRegexMetricsEntries, sizeof(RKRegexMetricsEntry)    * entriesCount);
+  memcpy(mergedCounters, globalRegexMetricsRetired, sizeof(RKRegexMetricsCounters) * entriesCount);
+  for(threadMetrics = globalRegexMetricsThreads; threadMetrics != NULL; threadMetrics = threadMetrics->nextThread) {
+    for(atIndex = 0; (atIndex < threadMetrics->countersCapacity) && (atIndex < entriesCount); atIndex++) {
+      if(threadMetrics->counters[atIndex] != NULL) { RKRegexMetricsAddCounters(&mergedCounters[atIndex], threadMetrics->counters[atIndex]); }
+    }
+  }
+  
+  pthread_mutex_unlock(&globalRegexMetricsMutex);
+  
+  for(atIndex = 0; atIndex < entriesCount; atIndex++) {
+    if(mergedCounters[atIndex].matchCount == 0) { continue; }
+    [regexMetrics addObject:RKRegexMetricsCountersDictionary(&mergedCounters[atIndex], entries[atIndex].regexString, entries[atIndex].compileOption)];
+    if(totalCounters != NULL) { RKRegexMetricsAddCounters(totalCounters, &mergedCounters[atIndex]); }
+  }
+  
+exitNow:
+  if(mergedCounters != NULL) { RKFreeAndNULLNoGC(mergedCounters); }
+  if(entries        != NULL) { RKFreeAndNULLNoGC(entries);        }
+  return(regexMetrics);
+}
+
+static void RKRegexMetricsAppendJSON(NSMutableString * const jsonString, id const object) {
+  NSEnumerator *keyEnumerator = NULL;
+  id            key = NULL, element = NULL;
+  BOOL          isFirst = YES;
+  RKUInteger    atCharacter = 0, length = 0;
+  unichar       character = 0;
+  
+  if([object isKindOfClass:[NSDictionary class]] == YES) {
+    [jsonString appendString:@"{"];
+    keyEnumerator = [[[object allKeys] sortedArrayUsingSelector:@selector(compare:)] objectEnumerator];
+    while((key = [keyEnumerator nextObject]) != NULL) {
+      if(isFirst == NO) { [jsonString appendString:@","]; }
+      RKRegexMetricsAppendJSON(jsonString, key);
+      [jsonString appendString:@":"];
+      RKRegexMetricsAppendJSON(jsonString, [object objectForKey:key]);
+      isFirst = NO;
+    }
+    [jsonString appendString:@"}"];
+  }
+  else if([object isKindOfClass:[NSArray class]] == YES) {
+    [jsonString appendString:@"["];
+    keyEnumerator = [object objectEnumerator];
+    while((element = [keyEnumerator nextObject]) != NULL) {
+      if(isFirst == NO) { [jsonString appendString:@","]; }
+      RKRegexMetricsAppendJSON(jsonString, element);
+      isFirst = NO;
+    }
+    [jsonString appendString:@"]"];
+  }
+  else if([object isKindOfClass:[NSString class]] == YES) {
+    [jsonString appendString:@"\""];
+    for(atCharacter = 0, length = [object length]; atCharacter < length; atCharacter++) {
+      switch((character = [object characterAtIndex:atCharacter])) {
+        case '"':  [jsonString appendString:@"\\\""]; break;
+        case '\\': [jsonString appendString:@"\\\\"]; break;
+        case '\n': [jsonString appendString:@"\\n"];  break;
+        case '\r': [jsonString appendString:@"\\r"];  break;
+        case '\t': [jsonString appendString:@"\\t"];  break;
+        default:
+          if(character < 0x20) { [jsonString appendFormat:@"\\u%04x", (unsigned int)character]; }
+          else                 { [jsonString appendFormat:@"%C", character];                     }
+          break;
+      }
+    }
+    [jsonString appendString:@"\""];
+  }
+  else { [jsonString appendString:[object description]]; }
+}
+
+static RKInteger RKRegexMetricsCompareMatchNanoseconds(id firstMetrics, id secondMetrics, void *context RK_ATTRIBUTES(unused)) {
+  return([[secondMetrics objectForKey:@"matchNanoseconds"] compare:[firstMetrics objectForKey:@"matchNanoseconds"]]);
+}
+
+#pragma mark -
+#pragma mark Regex Metrics Functions
+
+void RKSetRegexMetricsEnabled(const BOOL enableMetrics) {
+  RKRegexMetricsCollect = (enableMetrics == YES) ? 1 : 0;
+  RKAtomicMemoryBarrier();
+}
+
+BOOL RKRegexMetricsEnabled(void) {
+  return((RKRegexMetricsCollect != 0) ? YES : NO);
+}
+
+void RKClearRegexMetrics(void) {
+  struct __RKRegexMetricsThread *threadMetrics = NULL;
+  RKUInteger atIndex = 0;
+  
+  pthread_mutex_lock(&globalRegexMetricsMutex);
+  if(globalRegexMetricsRetired != NULL) { memset(globalRegexMetricsRetired, 0, sizeof(RKRegexMetricsCounters) * globalRegexMetricsEntriesCapacity); }
+  for(threadMetrics = globalRegexMetricsThreads; threadMetrics != NULL; threadMetrics = threadMetrics->nextThread) {
+    for(atIndex = 0; atIndex < threadMetrics->countersCapacity; atIndex++) {
+      if(threadMetrics->counters[atIndex] != NULL) { memset(threadMetrics->counters[atIndex], 0, sizeof(RKRegexMetricsCounters)); }
+    }
+  }
+  pthread_mutex_unlock(&globalRegexMetricsMutex);
+}
+
+NSDictionary *RKRegexMetricsSnapshot(void) {
+  RKRegexMetricsCounters  totalCounters;
+  NSArray                *regexMetrics = RKRegexMetricsArray(&totalCounters);
+  NSMutableDictionary    *snapshot     = RKRegexMetricsCountersDictionary(&totalCounters, NULL, 0);
+  
+  [snapshot setObject:regexMetrics forKey:@"regexes"];
+  return(snapshot);
+}
+
+NSArray *RKRegexMetricsTopRegexesByMatchTime(const RKUInteger count) {
+  NSMutableArray *regexMetrics = RKRegexMetricsArray(NULL);
+  
+  [regexMetrics sortUsingFunction:RKRegexMetricsCompareMatchNanoseconds context:NULL];
+  if([regexMetrics count] > count) { [regexMetrics removeObjectsInRange:NSMakeRange(count, [regexMetrics count] - count)]; }
+  return(regexMetrics);
+}
+
+NSString *RKRegexMetricsJSONString(void) {
+  NSMutableString *jsonString = [NSMutableString string];
+  RKRegexMetricsAppendJSON(jsonString, RKRegexMetricsSnapshot());
+  return(jsonString);
+}
+
+BOOL RKWriteRegexMetricsJSON(int fileDescriptor) {
+  const char *jsonCharacters = [RKRegexMetricsJSONString() UTF8String];
+  RKUInteger  length = 0, written = 0;
+  ssize_t     writeResult = 0;
+  
+  if(jsonCharacters == NULL) { return(NO); }
+  length = strlen(jsonCharacters);
+  
+  while(written < length) {
+    if((writeResult = write(fileDescriptor, &jsonCharacters[written], length - written)) < 0) { if(errno == EINTR) { continue; } return(NO); }
+    written += (RKUInteger)writeResult;
+  }
+  return(YES);
+}
@@ -0,0 +1,251 @@
+//
+//  RKReplacementTemplate.m
+//  RegexKit
+//  http://regexkit.sourceforge.net/
+//
+
+/*
+ Copyright © 2007-2008, John Engelhart
+ 
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+ notice, this list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright
+ notice, this list of conditions and the following disclaimer in the
+ documentation and/or other materials provided with the distribution.
+ 
+ * Neither the name of the Zang Industries nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#import <RegexKit/RKReplacementTemplate.h>
+#import <RegexKit/RegexKitPrivate.h>
+
+#define RKReplacementTemplateHashForRegexAndReferenceString(regex, referenceString) ((RKUInteger)([(regex) hash] ^ ((RKUInteger)[(referenceString) hash] << 1) ^ (RKUInteger)0x5a5a5a5a))
+
+static RKCache *RKReplacementTemplateCache = NULL;
+
+static void releaseRKReplacementTemplateResources(RKReplacementTemplate * const self) RK_ATTRIBUTES(nonnull(1), used);
+
+@implementation RKReplacementTemplate
+
++ (void)initialize
+{
+  RKAtomicMemoryBarrier(); // Extra cautious
+  
+  if(RKReplacementTemplateCache == NULL) {
+    RKCache *tmpCache = RKAutorelease([[RKCache alloc] initWithDescription:RKLocalizedString(@"Replacement Template Cache")]);
+    if(RKAtomicCompareAndSwapPtr(NULL, tmpCache, &RKReplacementTemplateCache)) { RKRetain(RKReplacementTemplateCache); RKDisableCollectorForPointer(RKReplacementTemplateCache); }
+  }
+}
+
++ (RKCache *)replacementTemplateCache
+{
+  return(RKAutorelease(RKRetain(RKReplacementTemplateCache)));
+}
+
++ (RKReplacementTemplate *)replacementTemplateWithRegex:(id)aRegex referenceString:(NSString * const)referenceString
+{
+  RKReplacementTemplate *replacementTemplate = NULL;
+  NSError               *initError           = NULL;
+  
+  replacementTemplate = [self replacementTemplateWithRegex:aRegex referenceString:referenceString error:&initError];
+  if(RK_EXPECTED(initError != NULL, 0)) {
+    if(([[initError domain] isEqualToString:RKRegexErrorDomain] == YES) && ([initError userInfo] != NULL)) { [RKExceptionFromInitFailureForOlderAPI(self, _cmd, initError) raise]; }
+    [[NSException exceptionWithName:RKRegexCaptureReferenceException reason:[initError localizedDescription] userInfo:NULL] raise];
+  }
+  
+  return(replacementTemplate);
+}
+
++ (RKReplacementTemplate *)replacementTemplateWithRegex:(id)aRegex referenceString:(NSString * const)referenceString error:(NSError **)error
+{
+  return(RKAutorelease([[self alloc] initWithRegex:aRegex referenceString:referenceString error:error]));
+}
+
+- (id)initWithRegex:(id)aRegex referenceString:(NSString * const)initReferenceString error:(NSError **)error
+{
+  RKReplacementTemplate         *cachedReplacementTemplate = NULL;
+  RKReferenceInstruction         stackReferenceInstructions[RK_DEFAULT_STACK_INSTRUCTIONS];
+  RKReferenceInstructionsBuffer  referenceInstructionsBuffer;
+  RKStringBuffer                 referenceStringBuffer;
+  RKUInteger                     atInstruction = 0;
+  NSError                       *initError     = NULL;
+  
+  if(error != NULL) { *error = NULL; }
+
+  if((self = [self init]) == NULL) { goto errorExit; }
+  RKAutorelease(self);
+  
+  if(RK_EXPECTED(initReferenceString == NULL, 0)) { [[NSException rkException:NSInvalidArgumentException for:self selector:_cmd localizeReason:@"The referenceString argument is NULL."] raise]; goto errorExit; }
+  
+  if((regex = RKRegexFromStringOrRegexWithError(self, _cmd, aRegex, RKRegexPCRELibrary, (RKCompileUTF8 | RKCompileNoUTF8Check), &initError, NO)) == NULL) { NSCParameterAssert(initError != NULL); goto errorExit; }
+
+  replacementTemplateHash = RKReplacementTemplateHashForRegexAndReferenceString(regex, initReferenceString);
+
+  if(RK_EXPECTED((cachedReplacementTemplate = RKFastCacheLookup(RKReplacementTemplateCache, _cmd, replacementTemplateHash, initReferenceString, NO)) != NULL, 1)) {
+    if(([cachedReplacementTemplate->regex isEqual:regex] == YES) && ([cachedReplacementTemplate->referenceString isEqualToString:initReferenceString] == YES)) { return(cachedReplacementTemplate); }
+    RKRelease(cachedReplacementTemplate); // Hash collision.  Compile a new template, it just won't be able to replace the cached one.
+    cachedReplacementTemplate = NULL;
+  }
+  
+  referenceString       = [initReferenceString copy];
+  referenceStringBuffer = RKStringBufferWithString(referenceString);
+  if(RK_EXPECTED(referenceStringBuffer.characters == NULL, 0)) { initError = [NSError rkErrorWithDomain:NSCocoaErrorDomain code:0 localizeDescription:@"Unable to convert the reference string to UTF8."]; goto errorExit; }
+
+  // The compiled instructions point directly in to the reference string characters, so we keep our own copy that lives as long as we do.
+  if(RK_EXPECTED((referenceCharacters = RKMallocNotScanned(referenceStringBuffer.length + 1)) == NULL, 0)) { initError = [NSError rkErrorWithDomain:NSPOSIXErrorDomain code:0 localizeDescription:@"Unable to allocate memory for the reference string."]; goto errorExit; }
+  memcpy(referenceCharacters, referenceStringBuffer.characters, referenceStringBuffer.length);
+  referenceCharacters[referenceStringBuffer.length] = 0;
+  referenceStringBuffer.characters = referenceCharacters;
+  
+  referenceInstructionsBuffer = RKMakeReferenceInstructionsBuffer(0, RK_DEFAULT_STACK_INSTRUCTIONS, &stackReferenceInstructions[0], NULL);
+  if(RKCompileReferenceStringX(self, _cmd, &referenceStringBuffer, regex, &referenceInstructionsBuffer, &initError) == NO) {
+    if(initError == NULL) { initError = [NSError rkErrorWithDomain:NSPOSIXErrorDomain code:0 localizeDescription:@"Unable to allocate memory for the reference instructions."]; }
+    goto errorExit;
+  }
+  
+  instructionsCount = referenceInstructionsBuffer.length;
+  if(RK_EXPECTED((instructions = RKMallocNotScanned(sizeof(RKReferenceInstruction) * instructionsCount)) == NULL, 0)) { initError = [NSError rkErrorWithDomain:NSPOSIXErrorDomain code:0 localizeDescription:@"Unable to allocate memory for the reference instructions."]; goto errorExit; }
+  memcpy(instructions, referenceInstructionsBuffer.instructions, sizeof(RKReferenceInstruction) * instructionsCount);
+  
+  // Named capture references are looked up for every match.  If a name can only ever refer to a single capture, resolve it now.
+  if(RKRegexCaptureNamesMayBeDuplicated(regex) == NO) {
+    for(atInstruction = 0; atInstruction < instructionsCount; atInstruction++) {
+      RKReferenceInstruction * RK_C99(restrict) instruction = &((RKReferenceInstruction *)instructions)[atInstruction];
+      RKUInteger captureIndex = NSNotFound;
+      
+      if(instruction->op != OP_COPY_CAPTURENAME) { continue; }
+      if((captureIndex = RKCaptureIndexForCaptureNameCharactersWithError(regex, _cmd, instruction->ptr + instruction->range.location, instruction->range.length, NULL, &initError)) == NSNotFound) { goto errorExit; }
+      *instruction = (RKReferenceInstruction){OP_COPY_CAPTUREINDEX, NULL, NSMakeRange(captureIndex, 0)};
+    }
+  }
+  
+  [RKReplacementTemplateCache addObjectToCache:self withHash:replacementTemplateHash];
+  
+  return(RKRetain(self));
+  
+errorExit:
+  if(RK_EXPECTED(initError != NULL, 0) && (error != NULL)) { *error = initError; }
+  return(NULL);
+}
+
+- (void)dealloc
+{
+  releaseRKReplacementTemplateResources(self);
+  [super dealloc];
+}
+
+#ifdef    ENABLE_MACOSX_GARBAGE_COLLECTION
+- (void)finalize
+{
+  releaseRKReplacementTemplateResources(self);
+  [super finalize];
+}
+#endif // ENABLE_MACOSX_GARBAGE_COLLECTION
+
+static void releaseRKReplacementTemplateResources(RKReplacementTemplate * const self) {
+  if(self->regex               != NULL) { RKRelease(self->regex);           self->regex           = NULL; }
+  if(self->referenceString     != NULL) { RKRelease(self->referenceString); self->referenceString = NULL; }
+  if(self->referenceCharacters != NULL) { RKFreeAndNULL(self->referenceCharacters);                       }
+  if(self->instructions        != NULL) { RKFreeAndNULL(self->instructions);                              }
+  self->instructionsCount = 0;
+}
+
+- (RKUInteger)hash
+{
+  return(replacementTemplateHash);
+}
+
+- (BOOL)isEqual:(id)anObject
+{
+  BOOL equal = NO;
+  RKReplacementTemplate *replacementTemplateObject = anObject;
+  if(self == anObject)                                                                    { equal = YES; goto exitNow; }
+  if([anObject isKindOfClass:[RKReplacementTemplate class]] == NO)                        { equal = NO;  goto exitNow; }
+  if(replacementTemplateHash != replacementTemplateObject->replacementTemplateHash)        { equal = NO;  goto exitNow; }
+  if([regex isEqual:replacementTemplateObject->regex] == NO)                              { equal = NO;  goto exitNow; }
+  if([referenceString isEqualToString:replacementTemplateObject->referenceString] == NO) { equal = NO;  goto exitNow; }
+  equal = YES;
+  
+exitNow:
+  return(equal);
+}
+
+- (NSString *)description
+{
+  return(RKLocalizedFormat(@"<%@: %p> Regular expression = '%@', Reference string = '%@', Instructions = %lu", [self className], self, [regex regexString], referenceString, (unsigned long)instructionsCount));
+}
+
+- (RKRegex *)regex
+{
+  return(RKAutorelease(RKRetain(regex)));
+}
+
+- (NSString *)referenceString
+{
+  return(RKAutorelease(RKRetain(referenceString)));
+}
+
+- (NSString *)stringByMatching:(NSString * const)subjectString replace:(const RKUInteger)count
+{
+  NSString *replacedString = NULL;
+  NSError  *replaceError   = NULL;
+  
+  if(RK_EXPECTED(subjectString == NULL, 0)) { [[NSException rkException:NSInvalidArgumentException for:self selector:_cmd localizeReason:@"The subjectString argument is NULL."] raise]; }
+  
+  replacedString = [self stringByMatching:subjectString inRange:NSMakeRange(0, [subjectString length]) replace:count error:&replaceError];
+  if(replaceError != NULL) { [[NSException exceptionWithName:NSGenericException reason:[replaceError localizedDescription] userInfo:NULL] raise]; }
+  
+  return(replacedString);
+}
+
+- (NSString *)stringByMatching:(NSString * const)subjectString inRange:(const NSRange)range replace:(const RKUInteger)count error:(NSError **)error
+{
+  if(RK_EXPECTED(subjectString == NULL, 0)) { [[NSException rkException:NSInvalidArgumentException for:self selector:_cmd localizeReason:@"The subjectString argument is NULL."] raise]; }
+  
+  RKStringBuffer                subjectStringBuffer         = RKStringBufferWithString(subjectString);
+  RKReferenceInstructionsBuffer referenceInstructionsBuffer = RKMakeReferenceInstructionsBuffer(instructionsCount, instructionsCount, instructions, NULL);
+  
+  if(RK_EXPECTED(subjectStringBuffer.characters == NULL, 0)) { if(error != NULL) { *error = [NSError rkErrorWithDomain:NSCocoaErrorDomain code:0 localizeDescription:@"Unable to convert the subject string to UTF8."]; } return(NULL); }
+  
+  return(RKStringByApplyingReferenceInstructionsX(self, _cmd, subjectString, &subjectStringBuffer, RKutf16to8(subjectString, range), count, regex, &referenceInstructionsBuffer, YES, NULL, error));
+}
+
+- (RKUInteger)appendStringByMatching:(NSString * const)subjectString inRange:(const NSRange)range replace:(const RKUInteger)count toMutableData:(NSMutableData * const)destination error:(NSError **)error
+{
+  if(RK_EXPECTED(subjectString == NULL, 0)) { [[NSException rkException:NSInvalidArgumentException for:self selector:_cmd localizeReason:@"The subjectString argument is NULL."] raise]; }
+  if(RK_EXPECTED(destination   == NULL, 0)) { [[NSException rkException:NSInvalidArgumentException for:self selector:_cmd localizeReason:@"The destination argument is NULL."]   raise]; }
+  
+  RKStringBuffer                subjectStringBuffer         = RKStringBufferWithString(subjectString);
+  RKReferenceInstructionsBuffer referenceInstructionsBuffer = RKMakeReferenceInstructionsBuffer(instructionsCount, instructionsCount, instructions, NULL);
+  RKOutputBuffer                outputBuffer                = RKMakeOutputBuffer(NULL, 0, destination);
+  RKUInteger                    replacedCount               = 0;
+  
+  if(error != NULL) { *error = NULL; }
+  if(RK_EXPECTED(subjectStringBuffer.characters == NULL, 0)) { if(error != NULL) { *error = [NSError rkErrorWithDomain:NSCocoaErrorDomain code:0 localizeDescription:@"Unable to convert the subject string to UTF8."]; } return(NSNotFound); }
+  
+  if(RKMatchAndApplyReferenceInstructionsX(self, _cmd, &subjectStringBuffer, RKutf16to8(subjectString, range), count, regex, &referenceInstructionsBuffer, YES, &outputBuffer, &replacedCount, error) == NO) { return(NSNotFound); }
+  
+  return(replacedCount);
+}
+
+@end
@@ -48,8 +48,24 @@
 
 static int sortRegexCollectionItems(const void *a, const void *b) RK_ATTRIBUTES(used, nonnull);
 static int threadMatchEntryFunction(void *startState) RK_ATTRIBUTES(used, nonnull);
+static BOOL RKSortedRegexCollectionCanUnionRegex(RKRegex * const regex, const RKCompileOption compileOption) RK_ATTRIBUTES(used, nonnull(1));
+static RKUInteger RKSortedRegexCollectionSortedIndex(RKSortedRegexCollection * const self, const RKUInteger collectionIndex) RK_ATTRIBUTES(used, nonnull(1));
 
 static RKCache *RKSortedRegexCollectionCache = NULL;
+static volatile int RKSortedRegexCollectionUnionMatching = 0;
+
+// The collections used by the NSArray and NSSet matching methods follow RKCollectionUnionMatchingEnabled().  A cached collection that
+// was created before the default was changed is brought up to date the next time it is looked up.
+RKREGEX_STATIC_INLINE RKSortedRegexCollection *RKSortedRegexCollectionApplyUnionMatchingDefault(RKSortedRegexCollection * const self) {
+  const BOOL unionMatchingDefault = (RKSortedRegexCollectionUnionMatching != 0) ? YES : NO;
+  if((self != NULL) && RK_EXPECTED([self unionMatching] != unionMatchingDefault, 0)) { [self setUnionMatching:unionMatchingDefault]; }
+  return(self);
+}
+
+RKREGEX_STATIC_INLINE BOOL RKSortedRegexCollectionStartBytesInSubject(const uint32_t * const RK_C99(restrict) startBytes, const uint32_t * const RK_C99(restrict) subjectBytes) {
+  return((((startBytes[0] & subjectBytes[0]) | (startBytes[1] & subjectBytes[1]) | (startBytes[2] & subjectBytes[2]) | (startBytes[3] & subjectBytes[3]) |
+           (startBytes[4] & subjectBytes[4]) | (startBytes[5] & subjectBytes[5]) | (startBytes[6] & subjectBytes[6]) | (startBytes[7] & subjectBytes[7])) == 0) ? NO : YES);
+}
 
 NSString *RKStringFromCollectionType(RKCollectionType collectionType) {
   NSString *collectionTypeString = NULL;
@@ -65,6 +81,15 @@ NSString *RKStringFromCollectionType(RKCollectionType collectionType) {
 
 //static RKThreadPool *threadPool = NULL;
 
+void RKSetCollectionUnionMatchingEnabled(const BOOL enableUnionMatching) {
+  RKSortedRegexCollectionUnionMatching = (enableUnionMatching == YES) ? 1 : 0;
+  RKAtomicMemoryBarrier();
+}
+
+BOOL RKCollectionUnionMatchingEnabled(void) {
+  return((RKSortedRegexCollectionUnionMatching != 0) ? YES : NO);
+}
+
 @implementation RKSortedRegexCollection
 
 
@@ -94,7 +119,7 @@ NSString *RKStringFromCollectionType(RKCollectionType collectionType) {
   
   RKFastReadWriteLockWithStrategy(sortedRegexCollection->readWriteLock, RKLockForReading, NULL);
   for(RKUInteger atIndex = 0; atIndex < sortedRegexCollection->collectionCount; atIndex++) {
-    regexObjects[atIndex] = [NSDictionary dictionaryWithObjectsAndKeys:sortedRegexCollection->sortedElements[atIndex]->regex, @"element", [NSNumber numberWithUnsignedLong:(unsigned long)sortedRegexCollection->sortedElements[atIndex]->hitCount], @"count", NULL];
+    regexObjects[atIndex] = [NSDictionary dictionaryWithObjectsAndKeys:sortedRegexCollection->sortedElements[atIndex]->regex, @"element", [NSNumber numberWithUnsignedLong:(unsigned long)sortedRegexCollection->hitCounters[sortedRegexCollection->sortedElements[atIndex] - sortedRegexCollection->elements].hitCount], @"count", NULL];
   }
   RKFastReadWriteUnlock(sortedRegexCollection->readWriteLock);
   
@@ -121,7 +146,7 @@ errorExit:
     sortedRegexCollection = [[[self alloc] initWithCollection:initCollection library:initRegexLibraryString options:initRegexLibraryOptions error:error] autorelease];
   }
   
-  return(sortedRegexCollection);
+  return(RKSortedRegexCollectionApplyUnionMatchingDefault(sortedRegexCollection));
 }
 
 
@@ -147,13 +172,14 @@ errorExit:
   sortedRegexCollectionHash = RKSortedRegexCollectionHashForCollection(initCollection, initRegexLibraryString, initRegexLibraryOptions);
   RKSortedRegexCollection *cachedSortedRegexCollection = NULL;
   
-  if(RK_EXPECTED((cachedSortedRegexCollection = RKFastCacheLookup(RKSortedRegexCollectionCache, _cmd, sortedRegexCollectionHash, @"bulk matcher", NO)) != NULL, 1)) { return(cachedSortedRegexCollection); }
+  if(RK_EXPECTED((cachedSortedRegexCollection = RKFastCacheLookup(RKSortedRegexCollectionCache, _cmd, sortedRegexCollectionHash, @"bulk matcher", NO)) != NULL, 1)) { return(RKSortedRegexCollectionApplyUnionMatchingDefault(cachedSortedRegexCollection)); }
 
   if(     [initCollection isKindOfClass:[NSArray class]]) { collectionType = RKArrayCollection; }
   else if([initCollection isKindOfClass:[NSSet class]])   { collectionType = RKSetCollection;   }
   else { [[NSException rkException:NSInvalidArgumentException for:self selector:_cmd localizeReason:@"Supported collection types are NSArray and NSSet.  initCollection class = '%@'.", [initCollection className]] raise]; goto errorExit; }
   
-  if((readWriteLock = [[RKReadWriteLock alloc] init]) == NULL) { initError = [NSError rkErrorWithDomain:NSCocoaErrorDomain code:-1 localizeDescription:@"Unable to instantiate multithreading lock."]; goto errorExit; }
+  if((readWriteLock = [[RKReadWriteLock alloc] initWithDistributedReaders:YES]) == NULL) { initError = [NSError rkErrorWithDomain:NSCocoaErrorDomain code:-1 localizeDescription:@"Unable to instantiate multithreading lock."]; goto errorExit; }
+  [readWriteLock setProfileName:@"Sorted Regex Collection"];
 
   if(RK_EXPECTED((missedObjectHashCache = RKCallocNotScanned(sizeof(RKUInteger) * RK_SORTED_REGEX_COLLECTION_CACHE_BUCKETS)) == NULL, 0)) { [[NSException rkException:NSMallocException for:self selector:_cmd localizeReason:@"Unable to allocate memory for missedObjectHashCache."] raise]; goto errorExit; }
 
@@ -173,6 +199,8 @@ errorExit:
 
   if(RK_EXPECTED((elements       = RKCallocScanned(sizeof(RKCollectionElement)   * collectionCount)) == NULL, 0)) { [[NSException rkException:NSMallocException for:self selector:_cmd localizeReason:@"Unable to allocate memory for elements."] raise]; goto errorExit; }
   if(RK_EXPECTED((sortedElements = RKCallocScanned(sizeof(RKCollectionElement *) * collectionCount)) == NULL, 0)) { [[NSException rkException:NSMallocException for:self selector:_cmd localizeReason:@"Unable to allocate memory for sortedElements."] raise]; goto errorExit; }
+  if(RK_EXPECTED((hitCountersAllocation = RKCallocNotScanned((sizeof(RKCollectionHitCounter) * collectionCount) + RK_SORTED_REGEX_COLLECTION_CACHE_LINE)) == NULL, 0)) { [[NSException rkException:NSMallocException for:self selector:_cmd localizeReason:@"Unable to allocate memory for hitCounters."] raise]; goto errorExit; }
+  hitCounters = (RKCollectionHitCounter *)(((uintptr_t)hitCountersAllocation + (RK_SORTED_REGEX_COLLECTION_CACHE_LINE - 1)) & ~((uintptr_t)RK_SORTED_REGEX_COLLECTION_CACHE_LINE - 1));
   
 #ifdef USE_CORE_FOUNDATION
   if(collectionType == RKArrayCollection) { CFArrayGetValues((CFArrayRef)collection, (CFRange){0, (CFIndex)collectionCount}, (const void **)(&regexObjects[0])); }
@@ -206,10 +234,13 @@ errorExit:
     }
     elements[atIndex].regex = regexObjects[atIndex];
     sortedElements[atIndex] = &elements[atIndex];
+    if((elements[atIndex].hasStartBytes = RKRegexGetStartBytes(elements[atIndex].regex, elements[atIndex].startBytes)) == YES) { startBytesElementsCount++; }
   }
   
   // The following simplifies memory management.  The array retains all the RKRegex objects, and on dealloc we only need to release the array.
   collectionRegexArray = [[NSArray alloc] initWithObjects:(id *)&regexObjects[0] count:collectionCount];
+  
+  if(RKSortedRegexCollectionUnionMatching != 0) { [self setUnionMatching:YES]; }
 
   [RKSortedRegexCollectionCache addObjectToCache:self withHash:sortedRegexCollectionHash];
 
@@ -230,6 +261,8 @@ errorExit:
   if(elements              != NULL) { RKFreeAndNULL(elements);                                      }
   if(sortedElements        != NULL) { RKFreeAndNULL(sortedElements);                                }
   if(missedObjectHashCache != NULL) { RKFreeAndNULL(missedObjectHashCache);                         }
+  if(hitCountersAllocation != NULL) { RKFreeAndNULL(hitCountersAllocation); hitCounters = NULL;     }
+  if(unionRegex            != NULL) { RKRelease(unionRegex);           unionRegex           = NULL; }
   
   [super dealloc];
 }
@@ -266,25 +299,137 @@ exitNow:
 }
 
 
-- (RKRegex *)regexMatching:(id const RK_C99(restrict))matchObject lowestIndexInCollection:(const BOOL)lowestIndex
-{
-  RKReadWriteLockStrategy tryForLockLevel = 0, acquiredLockLevel = 0;
-  
-  if(resortRequired == NO) {
-    tryForLockLevel = RKLockForReading;
-    if(RK_EXPECTED(RKFastReadWriteLockWithStrategy(readWriteLock, tryForLockLevel, &acquiredLockLevel) == NO, 0)) { [[NSException rkException:NSInternalInconsistencyException for:self selector:_cmd localizeReason:@"Unable to acquire lock."] raise]; }
-  } else {
-    RK_PROBE(BEGINSORTEDREGEXSORT, self, sortedRegexCollectionHash, collectionCount);
-    tryForLockLevel = RKLockTryForWritingThenForReading;
-    if(RK_EXPECTED(RKFastReadWriteLockWithStrategy(readWriteLock, tryForLockLevel, &acquiredLockLevel) == NO, 0)) { [[NSException rkException:NSInternalInconsistencyException for:self selector:_cmd localizeReason:@"Unable to acquire lock."] raise]; }
-    if(acquiredLockLevel == RKLockForWriting) {
-      mergesort(sortedElements, collectionCount, sizeof(RKCollectionElement *), sortRegexCollectionItems);
-      resortRequired = 0;
-      RK_PROBE(ENDSORTEDREGEXSORT, self, sortedRegexCollectionHash, collectionCount, 1);
-    } else {
-      RK_PROBE(ENDSORTEDREGEXSORT, self, sortedRegexCollectionHash, collectionCount, 0);
+//
+// Union matching compiles the regexes in the collection that can safely be combined in to a single regex, so that one
+// pcre_exec() call can check all of them.  Each regex becomes a branch of the form (?=[\s\S]*?(regex)), and the branches are
+// joined, in collection order, in a group anchored at the start of the subject.  Since every branch starts at the same
+// position, the first branch that matches is the lowest index in the collection that matches anywhere in the subject.
+// The capture around each regex identifies which branch matched.
+//
+// (*MARK:n) would identify the branch without the extra captures, but it requires PCRE 8.0 or later.  The capture
+// works with every PCRE version.
+//
+// Regexes that use anything that depends on the numbering or names of their captures, or that affects the match as a
+// whole, keep being matched on their own.
+//
+
+static BOOL RKSortedRegexCollectionCanUnionRegex(RKRegex * const regex, const RKCompileOption compileOption) {
+  const char *regexCharacters = NULL, *atCharacter = NULL;
+  BOOL        mayHaveComment  = ((compileOption & RKCompileExtended) != 0) ? YES : NO;
+
+  if([regex compileOption] != compileOption) { return(NO); }
+  if(RK_EXPECTED((regexCharacters = [[regex regexString] UTF8String]) == NULL, 0)) { return(NO); }
+
+  for(atCharacter = regexCharacters; *atCharacter != 0; atCharacter++) {
+    switch(*atCharacter) {
+      case '\\':
+        atCharacter++;
+        if((*atCharacter >= '1') && (*atCharacter <= '9')) { return(NO); } // Back reference.
+        switch(*atCharacter) {
+          case 0:   return(NO);
+          case 'g': // Back reference, or (with PCRE 7.7 and later) subroutine call.
+          case 'k': // Named back reference.
+          case 'G': // Depends on the start of the match, which is always the start of the subject in the union.
+          case 'Q': // A \Q without a \E would quote the rest of the union.
+            return(NO);
+          default:  break;
+        }
+        break;
+        
+      case '[':
+        atCharacter++;
+        if(*atCharacter == '^') { atCharacter++; }
+        if(*atCharacter == ']') { atCharacter++; }
+        for(; (*atCharacter != 0) && (*atCharacter != ']'); atCharacter++) {
+          if(*atCharacter == '\\') { if(*(++atCharacter) == 0) { return(NO); } }
+          else if((*atCharacter == '[') && (*(atCharacter + 1) == ':')) { const char *endCharacter = strstr(atCharacter + 2, ":]"); if(endCharacter != NULL) { atCharacter = endCharacter + 1; } }
+        }
+        if(*atCharacter == 0) { return(NO); }
+        break;
+        
+      case '#':
+        if(mayHaveComment == YES) { return(NO); } // A comment would extend past the end of the branch.
+        break;
+        
+      case '(':
+        if(*(atCharacter + 1) == '*') { return(NO); } // Verbs and start of pattern settings apply to the whole match.
+        if(*(atCharacter + 1) != '?') { break; }
+        switch(*(atCharacter + 2)) {
+          case ':': case '=': case '!': case '>': case '|': break;
+          case '<': if((*(atCharacter + 3) == '=') || (*(atCharacter + 3) == '!')) { break; } return(NO); // Named capture.
+          case '#': break;
+          case 'P': case '\'': case '(': case '&': case 'R': case '+': case '-': return(NO); // Named captures, recursion, conditions.
+          default:
+            if((*(atCharacter + 2) >= '0') && (*(atCharacter + 2) <= '9')) { return(NO); } // Recursion.
+            mayHaveComment = YES; // An option setting, which may be (?x).
+            break;
+        }
+        break;
+        
+      default: break;
     }
   }
+  
+  return(YES);
+}
+
+- (void)setUnionMatching:(const BOOL)enableUnionMatching
+{
+  NSMutableString *unionRegexString  = NULL;
+  RKRegex         *newUnionRegex     = NULL;
+  RKUInteger       atIndex           = 0, atCaptureIndex = 1, newUnionElementsCount = 0;
+  NSError         *unionError        = NULL;
+  
+  if(RK_EXPECTED(RKFastReadWriteLockWithStrategy(readWriteLock, RKLockForWriting, NULL) == NO, 0)) { [[NSException rkException:NSInternalInconsistencyException for:self selector:_cmd localizeReason:@"Unable to acquire lock."] raise]; }
+  
+  if(unionRegex != NULL) { RKRelease(unionRegex); unionRegex = NULL; }
+  for(atIndex = 0; atIndex < collectionCount; atIndex++) { elements[atIndex].unionCaptureIndex = 0; }
+  unionElementsCount = 0;
+  unionMatching      = enableUnionMatching;
+  
+  // RKCompileFirstLine and RKCompileNoAutoCapture change the meaning of the union itself, so those collections are never combined.
+  if((enableUnionMatching == NO) || ((regexLibraryCompileOptions & (RKCompileFirstLine | RKCompileNoAutoCapture)) != 0) || ([regexLibraryString isEqualToString:RKRegexPCRELibrary] == NO)) { goto exitNow; }
+  
+  unionRegexString = [NSMutableString stringWithString:@"\\A(?:"];
+  for(atIndex = 0; atIndex < collectionCount; atIndex++) {
+    if(RKSortedRegexCollectionCanUnionRegex(elements[atIndex].regex, regexLibraryCompileOptions) == NO) { continue; }
+    [unionRegexString appendFormat:@"%@(?=%@(%@))", (newUnionElementsCount == 0) ? @"" : @"|", ((regexLibraryCompileOptions & RKCompileAnchored) != 0) ? @"" : @"[\\s\\S]*?", [elements[atIndex].regex regexString]];
+    elements[atIndex].unionCaptureIndex = atCaptureIndex;
+    atCaptureIndex                     += [elements[atIndex].regex captureCount];
+    newUnionElementsCount++;
+  }
+  [unionRegexString appendString:@")"];
+  
+  // A single element gains nothing from the union.
+  if(newUnionElementsCount < 2) { goto clearUnion; }
+  
+  if((newUnionRegex = [[RKRegex alloc] initWithRegexString:unionRegexString library:regexLibraryString options:regexLibraryCompileOptions error:&unionError]) == NULL) { goto clearUnion; }
+  unionRegex         = newUnionRegex;
+  unionElementsCount = newUnionElementsCount;
+  goto exitNow;
+  
+clearUnion:
+  for(atIndex = 0; atIndex < collectionCount; atIndex++) { elements[atIndex].unionCaptureIndex = 0; }
+  
+exitNow:
+  RKFastReadWriteUnlock(readWriteLock);
+}
+
+- (BOOL)unionMatching
+{
+  return(unionMatching);
+}
+
+static RKUInteger RKSortedRegexCollectionSortedIndex(RKSortedRegexCollection * const self, const RKUInteger collectionIndex) {
+  RKUInteger atSortedIndex = 0;
+  for(atSortedIndex = 0; atSortedIndex < self->collectionCount; atSortedIndex++) { if(self->sortedElements[atSortedIndex] == &self->elements[collectionIndex]) { break; } }
+  return(atSortedIndex);
+}
+
+- (RKRegex *)regexMatching:(id const RK_C99(restrict))matchObject lowestIndexInCollection:(const BOOL)lowestIndex
+{
+  // Resorting is done by -resortInBackground: in its own thread, so matching only ever needs to lock for reading.
+  if(RK_EXPECTED(RKFastReadWriteLockWithStrategy(readWriteLock, RKLockForReading, NULL) == NO, 0)) { [[NSException rkException:NSInternalInconsistencyException for:self selector:_cmd localizeReason:@"Unable to acquire lock."] raise]; }
 
 #ifdef    ENABLE_DTRACE_INSTRUMENTATION
   char matchObjectCString[64];
@@ -325,24 +470,85 @@ exitNow:
   if([matchObject isMemberOfClass:[NSString class]]) { threadMatchState.matchStringBuffer = RKStringBufferWithString(matchObject); }
   else {                                               threadMatchState.matchStringBuffer = RKStringBufferWithString([matchObject description]); }
   
-  if([[RKThreadPool defaultThreadPool] threadFunction:threadMatchEntryFunction argument:&threadMatchState] == NO) {
+  // The set of bytes in the subject.  A regex whose match must start with a byte that is not in the subject can not match.
+  if(startBytesElementsCount > 0) {
+    const unsigned char *characters = (const unsigned char *)threadMatchState.matchStringBuffer.characters;
+    RKUInteger           atCharacter = 0, length = threadMatchState.matchStringBuffer.length;
+    
+    for(atCharacter = 0; atCharacter < length; atCharacter++) { threadMatchState.subjectBytes[characters[atCharacter] >> 5] |= (1U << (characters[atCharacter] & 0x1f)); }
+    threadMatchState.hasSubjectBytes = YES;
+  }
+  
+  if(unionRegex != NULL) {
+    NSRange    *unionRanges     = NULL;
+    RKUInteger  unionMatchIndex = RKUIntegerMax, atIndex = 0;
+    RKMatchErrorCode unionErrorCode = RKMatchErrorNoMatch;
+    
+    if(RK_EXPECTED((unionRanges = alloca(sizeof(NSRange) * [unionRegex captureCount])) == NULL, 0)) { RKFastReadWriteUnlock(readWriteLock); [[NSException rkException:NSMallocException for:self selector:_cmd localizeReason:@"Unable to allocate temporary stack space."] raise]; }
+    
+    // The union is only matched if at least one of its elements can start with a byte in the subject.
+    for(atIndex = 0; atIndex < collectionCount; atIndex++) {
+      if(elements[atIndex].unionCaptureIndex == 0) { continue; }
+      if((threadMatchState.hasSubjectBytes == NO) || (elements[atIndex].hasStartBytes == NO) || (RKSortedRegexCollectionStartBytesInSubject(elements[atIndex].startBytes, threadMatchState.subjectBytes) == YES)) {
+        unionErrorCode = [unionRegex getRanges:unionRanges withCharacters:threadMatchState.matchStringBuffer.characters length:threadMatchState.matchStringBuffer.length inRange:NSMakeRange(0, threadMatchState.matchStringBuffer.length) options:RKMatchNoUTF8Check error:NULL];
+        break;
+      }
+    }
+    
+    if(unionErrorCode > 0) {
+      for(atIndex = 0; atIndex < collectionCount; atIndex++) { if((elements[atIndex].unionCaptureIndex != 0) && (unionRanges[elements[atIndex].unionCaptureIndex].location != NSNotFound)) { unionMatchIndex = atIndex; break; } }
+    }
+    
+    // If the union could not be matched, for example because it reached a match limit, every element is matched on its own.
+    if(unionErrorCode >= RKMatchErrorNoMatch) { threadMatchState.skipUnionElements = YES; }
+    
+    if(unionMatchIndex != RKUIntegerMax) {
+      if((lowestIndex == NO) || (collectionType == RKSetCollection) || (unionMatchIndex == 0) || (unionElementsCount == collectionCount)) {
+        threadMatchState.matchedRegex            = elements[unionMatchIndex].regex;
+        threadMatchState.matchingCollectionIndex = unionMatchIndex;
+        threadMatchState.matchingSortedIndex     = RKSortedRegexCollectionSortedIndex(self, unionMatchIndex);
+        threadMatchState.finished                = YES;
+      } else {
+        threadMatchState.highestMatchingArrayIndex = unionMatchIndex; // Only the elements before it that are matched on their own need to be checked.
+      }
+    } else if((threadMatchState.skipUnionElements == YES) && (unionElementsCount == collectionCount)) { threadMatchState.finished = YES; }
+  }
+  
+  if(threadMatchState.finished == NO) {
+    if([[RKThreadPool defaultThreadPool] threadFunction:threadMatchEntryFunction argument:&threadMatchState] == NO) {
 #ifndef   NS_BLOCK_ASSERTIONS
-    static BOOL didPrint = NO;
-    if(didPrint == NO) { NSLog(@"threadFunction returned NO? Executing in-line within the current thread."); didPrint = YES; }
+      static BOOL didPrint = NO;
+      if(didPrint == NO) { NSLog(@"threadFunction returned NO? Executing in-line within the current thread."); didPrint = YES; }
 #endif // NS_BLOCK_ASSERTIONS
-    threadMatchEntryFunction(&threadMatchState);
+      threadMatchEntryFunction(&threadMatchState);
+    }
+  }
+  
+  // When looking for the lowest index, a match that was not at index 0 only lowered highestMatchingArrayIndex.
+  if((threadMatchState.matchedRegex == NULL) && (threadMatchState.highestMatchingArrayIndex != RKUIntegerMax)) {
+    threadMatchState.matchedRegex            = elements[threadMatchState.highestMatchingArrayIndex].regex;
+    threadMatchState.matchingCollectionIndex = threadMatchState.highestMatchingArrayIndex;
+    threadMatchState.matchingSortedIndex     = RKSortedRegexCollectionSortedIndex(self, threadMatchState.highestMatchingArrayIndex);
   }
   
   BOOL matchHit = (threadMatchState.matchedRegex == NULL) ? NO : YES;
 
+  RKUInteger matchHitCount = 0;
+  
   if(matchHit == YES) {
-    RKAtomicIncrementInteger(&sortedElements[threadMatchState.matchingSortedIndex]->hitCount);
-    if((threadMatchState.matchingSortedIndex > 0) && (sortedElements[threadMatchState.matchingSortedIndex]->hitCount > sortedElements[threadMatchState.matchingSortedIndex - 1]->hitCount)) { resortRequired = 1; }
+    // The sorted order is compared against the hit count snapshots taken at the last resort, so a resort is only started once
+    // an element has more hits than the snapshot of the element before it.
+    matchHitCount = RKAtomicIncrementInteger(&hitCounters[threadMatchState.matchingCollectionIndex].hitCount);
+    if((threadMatchState.matchingSortedIndex > 0) && (matchHitCount > sortedElements[threadMatchState.matchingSortedIndex - 1]->hitCount)) { resortRequired = 1; }
   }
   
   RKFastReadWriteUnlock(readWriteLock);
   
-  RK_PROBE(ENDSORTEDREGEXMATCH, self, sortedRegexCollectionHash, (matchHit == YES) ? threadMatchState.matchedRegex : NULL, (matchHit == YES) ? [threadMatchState.matchedRegex hash] : 0, (matchHit == YES) ? (char *)regexUTF8String(threadMatchState.matchedRegex) : "", (matchHit == YES) ? threadMatchState.matchingSortedIndex : 0, collectionCount, (matchHit == YES) ? sortedElements[threadMatchState.matchingSortedIndex]->hitCount : 0, (matchHit == YES) ? threadMatchState.matchingCollectionIndex : 0, (((resortRequired == NO) ? 0x00 : 0x01) | (((matchHit == YES) && (lowestIndex == YES)) ? 0x04 : 0x00)));
+  if(RK_EXPECTED(resortRequired != 0, 0) && (resortInProgress == 0) && ((RKRegexMetricsNanoseconds() - lastResortNanoseconds) >= RK_SORTED_REGEX_COLLECTION_RESORT_INTERVAL)) {
+    if(RKAtomicCompareAndSwapInteger(0, 1, &resortInProgress)) { [NSThread detachNewThreadSelector:@selector(resortInBackground:) toTarget:self withObject:NULL]; }
+  }
+  
+  RK_PROBE(ENDSORTEDREGEXMATCH, self, sortedRegexCollectionHash, (matchHit == YES) ? threadMatchState.matchedRegex : NULL, (matchHit == YES) ? [threadMatchState.matchedRegex hash] : 0, (matchHit == YES) ? (char *)regexUTF8String(threadMatchState.matchedRegex) : "", (matchHit == YES) ? threadMatchState.matchingSortedIndex : 0, collectionCount, matchHitCount, (matchHit == YES) ? threadMatchState.matchingCollectionIndex : 0, (((resortRequired == NO) ? 0x00 : 0x01) | (((matchHit == YES) && (lowestIndex == YES)) ? 0x04 : 0x00)));
 
   if(matchHit == NO) { missedObjectHashCache[matchObjectCacheHash] = matchObjectHash; }
 
@@ -366,6 +572,9 @@ static int threadMatchEntryFunction(void *startState) {
       RKUInteger threadMatchingCollectionIndex = (((RKCollectionElement *)(self->sortedElements[threadAtSortedIndex]) - self->elements));
       RKRegex   *threadAtRegex                 = self->sortedElements[threadAtSortedIndex]->regex;
       
+      if((threadMatchState->skipUnionElements == YES) && (self->sortedElements[threadAtSortedIndex]->unionCaptureIndex != 0)) { continue; }
+      if((threadMatchState->hasSubjectBytes == YES) && (self->sortedElements[threadAtSortedIndex]->hasStartBytes == YES) && (RKSortedRegexCollectionStartBytesInSubject(self->sortedElements[threadAtSortedIndex]->startBytes, threadMatchState->subjectBytes) == NO)) { continue; }
+
       if(threadMatchingCollectionIndex > threadMatchState->highestMatchingArrayIndex) {
         RK_PROBE(SORTEDREGEXCOMPARE, self, self->sortedRegexCollectionHash, threadAtRegex, [threadAtRegex hash], (char *)regexUTF8String(threadAtRegex), threadAtSortedIndex, self->collectionCount, self->sortedElements[threadAtSortedIndex]->hitCount, threadMatchingCollectionIndex, 2);
         continue;
@@ -398,6 +607,28 @@ static int threadMatchEntryFunction(void *startState) {
 }
 
 
+// Runs in its own thread, started by regexMatching:lowestIndexInCollection:.  NSThread retains the receiver until this returns.
+- (void)resortInBackground:(id)unused
+{
+  NSAutoreleasePool *resortPool = [[NSAutoreleasePool alloc] init];
+  RKUInteger         atIndex    = 0;
+  
+  RK_PROBE(BEGINSORTEDREGEXSORT, self, sortedRegexCollectionHash, collectionCount);
+  if(RK_EXPECTED(RKFastReadWriteLockWithStrategy(readWriteLock, RKLockForWriting, NULL) == NO, 0)) { RK_PROBE(ENDSORTEDREGEXSORT, self, sortedRegexCollectionHash, collectionCount, 0); goto exitNow; }
+  
+  resortRequired = 0;
+  for(atIndex = 0; atIndex < collectionCount; atIndex++) { elements[atIndex].hitCount = hitCounters[atIndex].hitCount; }
+  mergesort(sortedElements, collectionCount, sizeof(RKCollectionElement *), sortRegexCollectionItems);
+  lastResortNanoseconds = RKRegexMetricsNanoseconds();
+  
+  RKFastReadWriteUnlock(readWriteLock);
+  RK_PROBE(ENDSORTEDREGEXSORT, self, sortedRegexCollectionHash, collectionCount, 1);
+  
+exitNow:
+  RKAtomicCompareAndSwapInteger(1, 0, &resortInProgress);
+  [resortPool release];
+}
+
 - (BOOL)isMatchedByAnyRegex:(id const RK_C99(restrict))matchObject
 {
   return(([self regexMatching:matchObject lowestIndexInCollection:NO] == NULL) ? NO : YES);
@@ -0,0 +1,210 @@
+//
+//  RKSubstring.m
+//  RegexKit
+//  http://regexkit.sourceforge.net/
+//
+
+/*
+ Copyright © 2007-2008, John Engelhart
+ 
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright
+ notice, this list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright
+ notice, this list of conditions and the following disclaimer in the
+ documentation and/or other materials provided with the distribution.
+ 
+ * Neither the name of the Zang Industries nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#import <RegexKit/RKSubstring.h>
+#import <RegexKit/RegexKitPrivate.h>
+
+static NSString *RKSubstringCreateString(RKSubstring * const self, const BOOL noCopy) RK_ATTRIBUTES(nonnull(1), used);
+static NSString *RKSubstringCharacterString(RKSubstring * const self) RK_ATTRIBUTES(nonnull(1), used);
+static void      releaseRKSubstringResources(RKSubstring * const self) RK_ATTRIBUTES(nonnull(1), used);
+
+@implementation RKSubstring
+
++ (id)substringWithString:(NSString * const)string range:(const NSRange)range
+{
+  if(RK_EXPECTED(string == NULL, 0)) { [[NSException rkException:NSInvalidArgumentException for:self selector:_cmd localizeReason:@"The string argument is NULL."] raise]; }
+  if(RK_EXPECTED(NSMaxRange(range) > [string length], 0)) { [[NSException rkException:NSRangeException for:self selector:_cmd localizeReason:@"The range {%lu, %lu} is beyond the end of the string, which has a length of %lu.", (unsigned long)range.location, (unsigned long)range.length, (unsigned long)[string length]] raise]; }
+
+  RKStringBuffer stringBuffer = RKStringBufferWithString(string);
+  if(RK_EXPECTED(stringBuffer.characters == NULL, 0)) { [[NSException rkException:NSInvalidArgumentException for:self selector:_cmd localizeReason:@"Unable to convert the string to UTF8."] raise]; }
+  
+  return(RKAutorelease(RKSubstringCreateWithStringBuffer(&stringBuffer, RKConvertUTF16ToUTF8RangeForStringBuffer(&stringBuffer, range))));
+}
+
+//
+// Creates a substring of the UTF8 byte range of stringBuffer.  Used by the capture extraction @s conversion and RKEnumerator.
+// Returns a retained substring.
+//
+
+RKSubstring *RKSubstringCreateWithStringBuffer(RK_STRONG_REF const RKStringBuffer * const RK_C99(restrict) stringBuffer, const NSRange range) {
+  RKSubstring *self = NULL;
+  RKUInteger   x    = 0;
+
+  NSCParameterAssert(stringBuffer->characters != NULL); NSCParameterAssert(NSMaxRange(range) <= stringBuffer->length);
+  
+  if(RK_EXPECTED((self = [[RKSubstring alloc] init]) == NULL, 0)) { return(NULL); }
+  
+  self->charactersLength   = range.length;
+  self->charactersEncoding = stringBuffer->encoding;
+
+#ifdef USE_CORE_FOUNDATION
+  // An immutable string returns itself for copy, and its characters can not move for as long as we hold on to it.
+  // Anything else, such as a mutable string or the autoreleased buffer of a UTF8String conversion, could change or go away.
+  // The copy is only tried when the characters are the strings own C string pointer.  A mutable string normally has no C string
+  // pointer, its characters come from a UTF8String conversion, so it skips the copy and only the characters of the substring are copied.
+  if((stringBuffer->string != NULL) && (CFStringGetCStringPtr((CFStringRef)stringBuffer->string, stringBuffer->encoding) == stringBuffer->characters)) {
+    NSString *immutableString = [stringBuffer->string copy];
+    if(immutableString == stringBuffer->string) {
+      self->subjectString = immutableString;
+      self->characters    = (stringBuffer->characters + range.location);
+    } else { RKRelease(immutableString); immutableString = NULL; }
+  }
+#else  // USE_CORE_FOUNDATION is not defined
+  // Without Core Foundation the characters always come from -cStringUsingEncoding: or -UTF8String, which return an autoreleased
+  // private buffer that is not owned by the string.  There is nothing that can be retained to keep it valid, so the range is copied.
+#endif // USE_CORE_FOUNDATION
+  
+  if(self->characters == NULL) {
+    if(RK_EXPECTED((self->ownedCharacters = RKMallocNotScanned(range.length + 1)) == NULL, 0)) { RKRelease(self); return(NULL); }
+    memcpy(self->ownedCharacters, (stringBuffer->characters + range.location), range.length);
+    self->ownedCharacters[range.length] = 0;
+    self->characters = self->ownedCharacters;
+  }
+  
+#ifdef USE_CORE_FOUNDATION
+  if(stringBuffer->encoding == kCFStringEncodingASCII) { self->isASCII = 1; return(self); }
+#else  // USE_CORE_FOUNDATION is not defined
+  if(stringBuffer->encoding == NSASCIIStringEncoding)  { self->isASCII = 1; return(self); }
+#endif // USE_CORE_FOUNDATION
+  
+  for(x = 0; x < range.length; x++) { if(RK_EXPECTED(((unsigned char)self->characters[x]) > 127, 0)) { break; } }
+  self->isASCII = (x == range.length) ? 1 : 0;
+  
+  return(self);
+}
+
+static NSString *RKSubstringCreateString(RKSubstring * const self, const BOOL noCopy) {
+#ifdef USE_CORE_FOUNDATION
+  if(noCopy == YES) { return(RKMakeCollectable(CFStringCreateWithBytesNoCopy(NULL, (const UInt8 *)self->characters, (CFIndex)self->charactersLength, (CFStringEncoding)self->charactersEncoding, NO, kCFAllocatorNull))); }
+  else              { return(RKMakeCollectable(CFStringCreateWithBytes(      NULL, (const UInt8 *)self->characters, (CFIndex)self->charactersLength, (CFStringEncoding)self->charactersEncoding, NO))); }
+#else  // USE_CORE_FOUNDATION is not defined
+  if(noCopy == YES) { return([[NSString alloc] initWithBytesNoCopy:(void *)self->characters length:self->charactersLength encoding:(NSStringEncoding)self->charactersEncoding freeWhenDone:NO]); }
+  else              { return([[NSString alloc] initWithBytes:             self->characters length:self->charactersLength encoding:(NSStringEncoding)self->charactersEncoding]); }
+#endif // USE_CORE_FOUNDATION
+}
+
+// Only needed for non-ASCII characters.  Created once, the first time it is needed, and then used for the life of the substring.
+static NSString *RKSubstringCharacterString(RKSubstring * const self) {
+  NSString *createdString = NULL;
+  
+  if(RK_EXPECTED(self->characterString != NULL, 1)) { return(self->characterString); }
+  
+  RK_PROBE(PERFORMANCENOTE, NULL, 0, NULL, self->charactersLength, -1, 0, "Non-ASCII substring requires a UTF16 conversion.");
+  if(RK_EXPECTED((createdString = RKSubstringCreateString(self, NO)) == NULL, 0)) { [[NSException rkException:NSInternalInconsistencyException localizeReason:@"Unable to convert the characters of the substring."] raise]; }
+  if(RKAtomicCompareAndSwapPtr(NULL, createdString, &self->characterString) == NO) { RKRelease(createdString); }
+  
+  return(self->characterString);
+}
+
+- (void)dealloc
+{
+  releaseRKSubstringResources(self);
+  [super dealloc];
+}
+
+#ifdef    ENABLE_MACOSX_GARBAGE_COLLECTION
+- (void)finalize
+{
+  releaseRKSubstringResources(self);
+  [super finalize];
+}
+#endif // ENABLE_MACOSX_GARBAGE_COLLECTION
+
+static void releaseRKSubstringResources(RKSubstring * const self) {
+  if(self->subjectString   != NULL) { RKRelease(self->subjectString);   self->subjectString   = NULL; }
+  if(self->characterString != NULL) { RKRelease(self->characterString); self->characterString = NULL; }
+  if(self->ownedCharacters != NULL) { RKFreeAndNULL(self->ownedCharacters); }
+  self->characters = NULL;
+}
+
+- (RKUInteger)length
+{
+  if(RK_EXPECTED(isASCII == 1, 1)) { return(charactersLength); }
+  return([RKSubstringCharacterString(self) length]);
+}
+
+- (unichar)characterAtIndex:(RKUInteger)index
+{
+  if(RK_EXPECTED(isASCII == 0, 0)) { return([RKSubstringCharacterString(self) characterAtIndex:index]); }
+  if(RK_EXPECTED(index >= charactersLength, 0)) { [[NSException rkException:NSRangeException for:self selector:_cmd localizeReason:@"The index %lu is beyond the end of the string, which has a length of %lu.", (unsigned long)index, (unsigned long)charactersLength] raise]; }
+  return((unichar)((unsigned char)characters[index]));
+}
+
+- (void)getCharacters:(unichar *)buffer range:(NSRange)range
+{
+  if(RK_EXPECTED(isASCII == 0, 0)) { [RKSubstringCharacterString(self) getCharacters:buffer range:range]; return; }
+  if(RK_EXPECTED(NSMaxRange(range) > charactersLength, 0)) { [[NSException rkException:NSRangeException for:self selector:_cmd localizeReason:@"The range {%lu, %lu} is beyond the end of the string, which has a length of %lu.", (unsigned long)range.location, (unsigned long)range.length, (unsigned long)charactersLength] raise]; }
+  for(RKUInteger x = 0; x < range.length; x++) { buffer[x] = (unichar)((unsigned char)characters[range.location + x]); }
+}
+
+- (const char *)UTF8String
+{
+  // Only a private copy of the characters is NULL terminated.  ASCII is also valid UTF8.
+  if((ownedCharacters != NULL) && ((isASCII == 1) || (charactersEncoding == RKUTF8StringEncoding))) { return(ownedCharacters); }
+  return([super UTF8String]);
+}
+
+- (id)copyWithZone:(NSZone *)zone
+{
+  return(RKRetain(self));
+}
+
+- (id)mutableCopyWithZone:(NSZone *)zone
+{
+  NSString *copiedString = RKSubstringCreateString(self, NO);
+  id        mutableCopy  = [[NSMutableString allocWithZone:zone] initWithString:copiedString];
+  RKRelease(copiedString);
+  return(mutableCopy);
+}
+
+- (Class)classForCoder
+{
+  return([NSString class]);
+}
+
+- (NSString *)stringByCopyingCharacters
+{
+  return(RKAutorelease(RKSubstringCreateString(self, NO)));
+}
+
+- (NSString *)noCopyString
+{
+  return(RKAutorelease(RKSubstringCreateString(self, YES)));
+}
+
+@end
@@ -133,6 +133,182 @@ NSRange RKConvertUTF8ToUTF16RangeForStringBuffer(RKStringBuffer *stringBuffer, N
   return(utf16Range);
 }
 
+//
+// Converts all of the ranges in a single forward pass over the string buffer.  Converting each capture of a match with
+// RKConvertUTF8ToUTF16RangeForString means re-creating the string buffer (which for a non-ASCII string is a full UTF8 transcode)
+// and re-scanning it from the start for every range.
+//
+// If utf8Anchor and utf16Anchor are not NULL, they record a pair of equivalent locations from a previous conversion.  The scan
+// resumes from them when all of the ranges lie after the anchor, and they are updated to the furthest location converted that is not
+// past the end of the first range, the whole match.  This turns converting every match of a sequential scan from O(N^2) in to O(N).
+//
+
+// XXX WARNING: This code uses alloca().  If you do not -=COMPLETELY=- understand what alloca() does, you MUST NOT alter this code.
+void RKConvertUTF8ToUTF16RangesForStringBuffer(RKStringBuffer *stringBuffer, NSRange *ranges, RKUInteger count, RKUInteger *utf8Anchor, RKUInteger *utf16Anchor) {
+  if(stringBuffer == NULL) { [[NSException rkException:NSInvalidArgumentException localizeReason:@"The stringBuffer parameter is NULL."] raise]; }
+  if(ranges       == NULL) { [[NSException rkException:NSInvalidArgumentException localizeReason:@"The ranges parameter is NULL."]       raise]; }
+  if(count        == 0)    { return; }
+
+#ifdef USE_CORE_FOUNDATION
+  if((stringBuffer->encoding == kCFStringEncodingMacRoman) || (stringBuffer->encoding == kCFStringEncodingASCII)) { return; }
+#else
+  if((stringBuffer->encoding == NSMacOSRomanStringEncoding) || (stringBuffer->encoding == NSASCIIStringEncoding)) { return; }
+#endif
+
+  RKUInteger * RK_C99(restrict) utf8Locations = alloca(sizeof(RKUInteger) * count * 2), * RK_C99(restrict) utf16Locations = alloca(sizeof(RKUInteger) * count * 2);
+  RKUInteger                    locationsCount = 0, atLocation = 0, utf16len = 0, x = 0;
+  
+  // Gather the unique end points of all the ranges, in ascending order.  count is the number of captures, so an insertion sort is fine.
+  for(x = 0; x < count; x++) {
+    if(ranges[x].location == NSNotFound) { continue; }
+    if((ranges[x].location > stringBuffer->length) || (NSMaxRange(ranges[x]) > stringBuffer->length)) { [[NSException rkException:NSRangeException localizeReason:@"RKConvertUTF8ToUTF16RangesForStringBuffer: Range invalid. utf8Range: %@. MaxRange: %lu stringBuffer->length: %lu", NSStringFromRange(ranges[x]), (unsigned long)NSMaxRange(ranges[x]), (unsigned long)stringBuffer->length] raise]; }
+    
+    RKUInteger endPoints[2] = {ranges[x].location, NSMaxRange(ranges[x])}, endPointIndex = 0;
+    for(endPointIndex = 0; endPointIndex < 2; endPointIndex++) {
+      RKUInteger insertAt = locationsCount;
+      while((insertAt > 0) && (utf8Locations[insertAt - 1] > endPoints[endPointIndex])) { insertAt--; }
+      if((insertAt > 0) && (utf8Locations[insertAt - 1] == endPoints[endPointIndex])) { continue; }
+      if(insertAt < locationsCount) { memmove(&utf8Locations[insertAt + 1], &utf8Locations[insertAt], sizeof(RKUInteger) * (locationsCount - insertAt)); }
+      utf8Locations[insertAt] = endPoints[endPointIndex];
+      locationsCount++;
+    }
+  }
+  if(locationsCount == 0) { return; }
+
+  RK_PROBE(PERFORMANCENOTE, NULL, 0, NULL, 0, -1, 1, "UTF8 to UTF16 requires slow conversion.");
+  const unsigned char RK_STRONG_REF *basePtr = (const unsigned char *)stringBuffer->characters, RK_STRONG_REF *p = basePtr;
+
+  if((utf8Anchor != NULL) && (utf16Anchor != NULL) && (*utf8Anchor <= utf8Locations[0])) { p = basePtr + *utf8Anchor; utf16len = *utf16Anchor; }
+  
+  for(atLocation = 0; atLocation < locationsCount; atLocation++) {
+    while((RKUInteger)(p - basePtr) < utf8Locations[atLocation]) {
+      const unsigned char c = *p;
+      p++;
+      utf16len++;
+      if(c < 128) { continue; }
+      const unsigned char idx = c & 0x3f;
+      p += utf8ExtraBytes[idx];
+      utf16len += utf8ExtraUTF16Characters[idx];
+    }
+    utf16Locations[atLocation] = utf16len;
+  }
+
+  // The anchor stops at the end of the match.  A capture inside a lookahead can lie past it, and the next match can start before
+  // such a capture, which would force every following conversion to start over from the beginning of the string.
+  if((utf8Anchor != NULL) && (utf16Anchor != NULL)) {
+    RKUInteger anchorLimit = (ranges[0].location != NSNotFound) ? NSMaxRange(ranges[0]) : utf8Locations[locationsCount - 1];
+    for(atLocation = locationsCount; (atLocation > 1) && (utf8Locations[atLocation - 1] > anchorLimit); atLocation--) { }
+    *utf8Anchor = utf8Locations[atLocation - 1]; *utf16Anchor = utf16Locations[atLocation - 1];
+  }
+
+  for(x = 0; x < count; x++) {
+    if(ranges[x].location == NSNotFound) { continue; }
+    RKUInteger startIndex = 0, endIndex = 0, maxRange = NSMaxRange(ranges[x]);
+    while(utf8Locations[startIndex] != ranges[x].location) { startIndex++; }
+    endIndex = startIndex;
+    while(utf8Locations[endIndex] != maxRange)             { endIndex++;   }
+    ranges[x] = NSMakeRange(utf16Locations[startIndex], utf16Locations[endIndex] - utf16Locations[startIndex]);
+  }
+
+  RK_PROBE(PERFORMANCENOTE, NULL, 0, NULL, (RKUInteger)(p - basePtr), -1, 2, "UTF8 to UTF16 requires slow conversion.");
+}
+
+//
+// Simple (one to one) case mapping for the characters that are most commonly case converted by replacement templates: ASCII, Latin-1, Latin
+// Extended-A, and the basic Greek and Cyrillic alphabets.  This lets the case conversion operations write directly in to the output buffer
+// without creating temporary NSStrings.  Anything else, including characters whose mapping changes the number of characters (ie, U+00DF
+// LATIN SMALL LETTER SHARP S uppercases to "SS") or depends on context (ie, U+03A3 GREEK CAPITAL LETTER SIGMA), is left to Foundation.
+//
+// A range with a step of 2 maps only the characters with the same parity as first, the others in the range are already in the target case.
+//
+
+typedef struct _RKCaseMappingRange { uint16_t first, last; int16_t delta; uint8_t step; } RKCaseMappingRange;
+
+static const RKCaseMappingRange RKUppercaseMappingRanges[] = {
+  {0x00B5, 0x00B5,  743, 1}, {0x00E0, 0x00F6,  -32, 1}, {0x00F8, 0x00FE,  -32, 1}, {0x00FF, 0x00FF,  121, 1},
+  {0x0101, 0x012F,   -1, 2}, {0x0131, 0x0131, -232, 1}, {0x0133, 0x0137,   -1, 2}, {0x013A, 0x0148,   -1, 2},
+  {0x014B, 0x0177,   -1, 2}, {0x017A, 0x017E,   -1, 2}, {0x017F, 0x017F, -300, 1},
+  {0x03B1, 0x03C1,  -32, 1}, {0x03C2, 0x03C2,  -31, 1}, {0x03C3, 0x03CB,  -32, 1},
+  {0x0430, 0x044F,  -32, 1}, {0x0450, 0x045F,  -80, 1}
+};
+
+static const RKCaseMappingRange RKLowercaseMappingRanges[] = {
+  {0x00C0, 0x00D6,   32, 1}, {0x00D8, 0x00DE,   32, 1},
+  {0x0100, 0x012E,    1, 2}, {0x0132, 0x0136,    1, 2}, {0x0139, 0x0147,    1, 2}, {0x014A, 0x0176,    1, 2},
+  {0x0178, 0x0178, -121, 1}, {0x0179, 0x017D,    1, 2},
+  {0x0391, 0x03A1,   32, 1}, {0x03A4, 0x03AB,   32, 1},
+  {0x0400, 0x040F,   80, 1}, {0x0410, 0x042F,   32, 1}
+};
+
+// Returns the simple case mapping of character, or -1 if it must be converted by Foundation.
+static int32_t RKSimpleCaseMapping(const uint32_t character, const BOOL toUppercase) {
+  const RKCaseMappingRange *mappingRanges = (toUppercase == YES) ? RKUppercaseMappingRanges : RKLowercaseMappingRanges;
+  const RKUInteger          rangesCount   = (toUppercase == YES) ? (sizeof(RKUppercaseMappingRanges) / sizeof(RKCaseMappingRange)) : (sizeof(RKLowercaseMappingRanges) / sizeof(RKCaseMappingRange));
+  
+  for(RKUInteger x = 0; (x < rangesCount) && (character >= mappingRanges[x].first); x++) {
+    if(character > mappingRanges[x].last) { continue; }
+    if((mappingRanges[x].step == 2) && (((character - mappingRanges[x].first) & 1) != 0)) { return((int32_t)character); }
+    return((int32_t)character + mappingRanges[x].delta);
+  }
+  
+  // The characters that were not mapped above and are not listed here either have no case, or are already in the target case.
+  if(character < 0x0180) {
+    if((toUppercase == YES) && ((character == 0x00DF) || (character == 0x0149))) { return(-1); }
+    if((toUppercase == NO)  &&  (character == 0x0130))                           { return(-1); }
+    return((int32_t)character);
+  }
+  if((toUppercase == YES) && (((character >= 0x0391) && (character <= 0x03A9)) || ((character >= 0x0400) && (character <= 0x042F)))) { return((int32_t)character); }
+  if((toUppercase == NO)  && (((character >= 0x03B1) && (character <= 0x03C9)) || ((character >= 0x0430) && (character <= 0x045F)))) { return((int32_t)character); }
+  
+  return(-1);
+}
+
+//
+// Converts the case of the fromLength bytes of UTF8 at fromBuffer in to toBuffer, which must be at least fromLength bytes long.  The simple case
+// mappings never lengthen a character.  Returns the number of bytes written to toBuffer, or NSNotFound if fromBuffer contains a character that
+// must be converted by Foundation.  ASCII is converted eight bytes at a time.
+//
+
+RKUInteger RKSimpleCaseMapUTF8(const char *fromBuffer, RKUInteger fromLength, char *toBuffer, BOOL toUppercase) {
+  const unsigned char RK_STRONG_REF * RK_C99(restrict) fromPtr = (const unsigned char *)fromBuffer;
+  unsigned char       RK_STRONG_REF * RK_C99(restrict) toPtr   = (unsigned char *)toBuffer;
+  const uint64_t      onesMask  = 0x0101010101010101ULL, highBitsMask = 0x8080808080808080ULL;
+  const unsigned char firstChar = (toUppercase == YES) ? 'a' : 'A', lastChar = (toUppercase == YES) ? 'z' : 'Z';
+  RKUInteger          fromIndex = 0, toIndex = 0;
+  
+  while(fromIndex < fromLength) {
+    if((fromIndex + sizeof(uint64_t)) <= fromLength) {
+      uint64_t asciiWord;
+      memcpy(&asciiWord, fromPtr + fromIndex, sizeof(uint64_t));
+      if((asciiWord & highBitsMask) == 0) {
+        // Every byte is < 0x80, so none of the additions can carry in to the next byte.  The high bit of each byte in inRangeMask is set if
+        // firstChar <= byte <= lastChar, and shifting that down to 0x20 flips the case of just those bytes.
+        const uint64_t aboveFirst  = asciiWord + (onesMask * (0x80 - firstChar));
+        const uint64_t aboveLast   = asciiWord + (onesMask * (0x80 - (lastChar + 1)));
+        const uint64_t inRangeMask = (aboveFirst & ~aboveLast) & highBitsMask;
+        asciiWord ^= (inRangeMask >> 2);
+        memcpy(toPtr + toIndex, &asciiWord, sizeof(uint64_t));
+        fromIndex += sizeof(uint64_t);
+        toIndex   += sizeof(uint64_t);
+        continue;
+      }
+    }
+    
+    const unsigned char c = fromPtr[fromIndex];
+    if(c < 128) { toPtr[toIndex++] = ((c >= firstChar) && (c <= lastChar)) ? (c ^ 0x20) : c; fromIndex++; continue; }
+    if(((c & 0xe0) != 0xc0) || ((fromIndex + 1) >= fromLength)) { return(NSNotFound); } // Only two byte sequences (U+0080 - U+07FF) are mapped.
+    
+    const int32_t mapped = RKSimpleCaseMapping((((uint32_t)c & 0x1f) << 6) | ((uint32_t)fromPtr[fromIndex + 1] & 0x3f), toUppercase);
+    if(mapped < 0) { return(NSNotFound); }
+    
+    if(mapped < 0x80) { toPtr[toIndex++] = (unsigned char)mapped; }
+    else { toPtr[toIndex++] = (unsigned char)(0xc0 | (mapped >> 6)); toPtr[toIndex++] = (unsigned char)(0x80 | (mapped & 0x3f)); }
+    fromIndex += 2;
+  }
+  
+  return(toIndex);
+}
+
 NSRange RKConvertUTF16ToUTF8RangeForString(NSString *string, NSRange utf16Range) {
   if(string == NULL) { [[NSException rkException:NSInvalidArgumentException localizeReason:@"String parameter is NULL."] raise]; }
   RKStringBuffer stringBuffer = RKStringBufferWithString(string);
@@ -81,6 +81,8 @@ NSArray *RKArrayFromMatchOption(const RKMatchOption decodeMatchOption) {
   if(decodeMatchOption & RKMatchBackslashRAnyCRLR)  { strings[atString] = @"RKMatchBackslashRAnyCRLR";  atString++; decodedOptions |= RKMatchBackslashRAnyCRLR;  }
   if(decodeMatchOption & RKMatchBackslashRUnicode)  { strings[atString] = @"RKMatchBackslashRUnicode";  atString++; decodedOptions |= RKMatchBackslashRUnicode;  }
 #endif // PCRE_MAJOR >= 7 && PCRE_MINOR >= 4
+  if((decodeMatchOption & RKMatchDFAShortest) == RKMatchDFAShortest) { strings[atString] = @"RKMatchDFAShortest"; atString++; decodedOptions |= RKMatchDFAShortest; }
+  else if(decodeMatchOption & RKMatchDFA)           { strings[atString] = @"RKMatchDFA";                atString++; decodedOptions |= RKMatchDFA;                }
   
   if((decodeMatchOption & RKMatchNewlineMask) != RKMatchNewlineDefault) {
     strings[atString] = RKStringFromNewlineOption(decodeMatchOption, @"RKMatch"); if(strings[atString] != NULL) { atString++; }
@@ -268,9 +270,11 @@ NSString *RKStringFromMatchErrorCode(const RKMatchErrorCode decodeErrorCode) {
     case RKMatchErrorBadPartial:         errorCodeString = @"RKMatchErrorBadPartial";         break;
     case RKMatchErrorInternal:           errorCodeString = @"RKMatchErrorInternal";           break;
     case RKMatchErrorBadCount:           errorCodeString = @"RKMatchErrorBadCount";           break;
+    case RKMatchErrorDFAWorkspaceSize:   errorCodeString = @"RKMatchErrorDFAWorkspaceSize";   break;
     case RKMatchErrorRecursionLimit:     errorCodeString = @"RKMatchErrorRecursionLimit";     break;
     case RKMatchErrorNullWorkSpaceLimit: errorCodeString = @"RKMatchErrorNullWorkSpaceLimit"; break;
     case RKMatchErrorBadNewline:         errorCodeString = @"RKMatchErrorBadNewline";         break;
+    case RKMatchErrorTimeLimit:          errorCodeString = @"RKMatchErrorTimeLimit";          break;
     default:                             errorCodeString = RKLocalizedFormat(@"Unknown error code (#%d)", (int)decodeErrorCode); break;
   }
   
@@ -366,9 +370,11 @@ const char *RKCharactersFromMatchErrorCode(const RKMatchErrorCode decodeErrorCod
     case RKMatchErrorBadPartial:         errorCodeCharacters = "RKMatchErrorBadPartial";         break;
     case RKMatchErrorInternal:           errorCodeCharacters = "RKMatchErrorInternal";           break;
     case RKMatchErrorBadCount:           errorCodeCharacters = "RKMatchErrorBadCount";           break;
+    case RKMatchErrorDFAWorkspaceSize:   errorCodeCharacters = "RKMatchErrorDFAWorkspaceSize";   break;
     case RKMatchErrorRecursionLimit:     errorCodeCharacters = "RKMatchErrorRecursionLimit";     break;
     case RKMatchErrorNullWorkSpaceLimit: errorCodeCharacters = "RKMatchErrorNullWorkSpaceLimit"; break;
     case RKMatchErrorBadNewline:         errorCodeCharacters = "RKMatchErrorBadNewline";         break;
+    case RKMatchErrorTimeLimit:          errorCodeCharacters = "RKMatchErrorTimeLimit";          break;
     default:                             errorCodeCharacters = "Unknown error code";             break;
   }
   
@@ -90,7 +90,45 @@ void (*objc_collect_function)(unsigned long);
 
 @interface RKSortedRegexCollection : NSObject
 + (RKCache *)sortedRegexCollectionCache;
++ (NSArray *)sortedArrayForSortedRegexCollection:(RKSortedRegexCollection *)sortedRegexCollection;
 + (RKSortedRegexCollection *)sortedRegexCollectionForCollection:(id const RK_C99(restrict))collection;
 + (RKSortedRegexCollection *)sortedRegexCollectionForCollection:(id const RK_C99(restrict))collection library:(NSString * const RK_C99(restrict))initRegexLibraryString options:(const RKCompileOption)initRegexLibraryOptions error:(NSError ** const RK_C99(restrict))error;
+- (id)initWithCollection:(id const RK_C99(restrict))initCollection;
+- (void)setUnionMatching:(const BOOL)enableUnionMatching;
+- (BOOL)unionMatching;
+- (RKRegex *)anyRegexMatching:(id const RK_C99(restrict))matchObject;
+- (RKRegex *)firstRegexMatching:(id const RK_C99(restrict))matchObject;
+@end
+
+// From RKLock.h, which is not a public header.
+enum {
+  RKLockDidNotLock                     = -1,
+  RKLockForReading                     = 0,
+  RKLockForWriting                     = 1,
+  RKLockTryForReading                  = 2,
+  RKLockTryForWriting                  = 3,
+  RKLockTryForWritingThenForReading    = 4,
+  RKLockTryForWritingThenTryForReading = 5
+};
+
+typedef RKInteger RKReadWriteLockStrategy;
+
+@interface RKReadWriteLock : NSObject <NSLocking>
++ (void)setMultithreaded:(const BOOL)enable;
+- (id)initWithDistributedReaders:(const BOOL)distributeReaders;
+- (BOOL)hasDistributedReaders;
+- (BOOL)readLock;
+- (BOOL)writeLock;
+- (BOOL)lockWithStrategy:(const RKReadWriteLockStrategy)lockStrategy lockLevelAcquired:(RKReadWriteLockStrategy *)lockLevelAcquired;
+- (void)setDebug:(const BOOL)enable;
+- (RKUInteger)readBusyCount;
+- (RKUInteger)readSpinCount;
+- (RKUInteger)readDowngradedFromWriteCount;
+- (RKUInteger)writeBusyCount;
+- (RKUInteger)writeSpinCount;
+- (void)clearCounters;
+- (void)setProfileName:(NSString * const)name;
+- (NSDictionary *)profile;
+- (void)clearProfile;
 @end
 
@@ -135,4 +135,10 @@
 - (void)mt_sortedRegex_wl1;
 - (void)mt_sortedRegex_wl2;
 
+- (void)readWriteLockWorker:(NSValue *)stateValue;
+- (void)readWriteLockHolder:(NSValue *)stateValue;
+- (void)readWriteLockConcurrency:(const BOOL)distributeReaders;
+- (void)readWriteLockTryStrategies:(const BOOL)distributeReaders;
+- (void)readWriteLockProfile:(const BOOL)distributeReaders;
+
 @end
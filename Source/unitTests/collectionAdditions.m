@@ -38,6 +38,24 @@
 
 #import "collectionAdditions.h"
 
+// Used by testStringMatchAndReplaceUsingFunction.  Replaces "key=value" with "value:KEY", and stops after *info replacements.
+static BOOL swapKeyValueReplaceFunction(RKReplaceContext *replaceContext, void *info) {
+  RKUInteger *remaining = (RKUInteger *)info;
+  
+  if(RKReplaceContextAppendCapture(replaceContext, 2) == NO) { return(NO); }
+  if(RKReplaceContextAppendUTF8Characters(replaceContext, ":", 1) == NO) { return(NO); }
+  if(RKReplaceContextAppendString(replaceContext, [RKReplaceContextSubstringOfCapture(replaceContext, 1) uppercaseString]) == NO) { return(NO); }
+  
+  *remaining = *remaining - 1;
+  return((*remaining > 0) ? YES : NO);
+}
+
+// Used by testStringMatchAndReplaceUsingFunction.  Appends a lone surrogate, which can not be converted to UTF8.
+static BOOL unconvertibleReplaceFunction(RKReplaceContext *replaceContext, void *info RK_ATTRIBUTES(unused)) {
+  unichar loneSurrogate = 0xD800;
+  return(RKReplaceContextAppendString(replaceContext, [NSString stringWithCharacters:&loneSurrogate length:1]));
+}
+
 @implementation collectionAdditions
 
 + (void)setUp
@@ -826,6 +844,199 @@
   STAssertTrue([searchAndReplacedString isEqualToString:[NSString stringWithUTF8String:"Stra\\Z\xc3\x9f" "e"]], @"String: %@", searchAndReplacedString);
 }
 
+- (void)testReplacementTemplate
+{
+  RKReplacementTemplate *replacementTemplate = nil;
+  NSString *searchAndReplacedString = nil;
+  NSError *error = nil;
+
+  STAssertNoThrow(replacementTemplate = [RKReplacementTemplate replacementTemplateWithRegex:@"<(\\d+):\\s+(?<what>\\w+)[^>]*>" referenceString:@"<\\U${what}\\E :\\l$1>"], nil);
+  STAssertNotNil(replacementTemplate, nil); if(replacementTemplate == nil) { return; }
+  STAssertTrue([RKReplacementTemplate replacementTemplateWithRegex:@"<(\\d+):\\s+(?<what>\\w+)[^>]*>" referenceString:@"<\\U${what}\\E :\\l$1>"] == replacementTemplate, nil);
+
+  STAssertNoThrow(searchAndReplacedString = [replacementTemplate stringByMatching:@"<1: Neato!>, <2: Wahoo!>, <3: Zoinks>" replace:RKReplaceAll], nil);
+  STAssertTrue([searchAndReplacedString isEqualToString:@"<NEATO :1>, <WAHOO :2>, <ZOINKS :3>"], @"String: %@", searchAndReplacedString);
+
+  STAssertNoThrow(searchAndReplacedString = [replacementTemplate stringByMatching:@"<4: Yikes>" replace:RKReplaceAll], nil);
+  STAssertTrue([searchAndReplacedString isEqualToString:@"<YIKES :4>"], @"String: %@", searchAndReplacedString);
+
+  STAssertNoThrow(searchAndReplacedString = [replacementTemplate stringByMatching:@"<1: Neato!>, <2: Wahoo!>" inRange:NSMakeRange(11, 13) replace:1 error:&error], nil);
+  STAssertNil(error, nil);
+  STAssertTrue([searchAndReplacedString isEqualToString:@"<1: Neato!>, <WAHOO :2>"], @"String: %@", searchAndReplacedString);
+
+  NSString *noMatchString = @"Nothing to see here";
+  STAssertTrue([[replacementTemplate stringByMatching:noMatchString replace:RKReplaceAll] isEqualToString:noMatchString], nil);
+
+  STAssertThrowsSpecificNamed([RKReplacementTemplate replacementTemplateWithRegex:@"(\\d+)" referenceString:@"${nope}"], NSException, RKRegexCaptureReferenceException, nil);
+  STAssertNil([RKReplacementTemplate replacementTemplateWithRegex:@"(\\d+)" referenceString:@"${nope}" error:&error], nil);
+  STAssertNotNil(error, nil);
+}
+
+- (void)testReplacementTemplateOutputBuffer
+{
+  RKReplacementTemplate *replacementTemplate = nil;
+  NSMutableData *destinationData = [NSMutableData data];
+  NSMutableString *longString = [NSMutableString string], *expectedString = [NSMutableString string];
+  NSString *searchAndReplacedString = nil;
+  NSError *error = nil;
+  RKUInteger replacedCount = 0;
+
+  STAssertNoThrow(replacementTemplate = [RKReplacementTemplate replacementTemplateWithRegex:@"(\\d+)" referenceString:@"[$1]"], nil);
+  STAssertNotNil(replacementTemplate, nil); if(replacementTemplate == nil) { return; }
+
+  STAssertNoThrow(replacedCount = [replacementTemplate appendStringByMatching:@"a 1 b 22" inRange:NSMakeRange(0, 8) replace:RKReplaceAll toMutableData:destinationData error:&error], nil);
+  STAssertNil(error, nil);
+  STAssertTrue(replacedCount == 2, @"Count: %lu", (unsigned long)replacedCount);
+  STAssertNoThrow(replacedCount = [replacementTemplate appendStringByMatching:@", none" inRange:NSMakeRange(0, 6) replace:RKReplaceAll toMutableData:destinationData error:&error], nil);
+  STAssertTrue(replacedCount == 0, @"Count: %lu", (unsigned long)replacedCount);
+  searchAndReplacedString = [[[NSString alloc] initWithData:destinationData encoding:NSUTF8StringEncoding] autorelease];
+  STAssertTrue([searchAndReplacedString isEqualToString:@"a [1] b [22], none"], @"String: %@", searchAndReplacedString);
+
+  // Large enough to force the output buffer off the stack and to grow it on the heap several times.
+  for(int x = 0; x < 2000; x++) { [longString appendFormat:@"%d ", x]; [expectedString appendFormat:@"[%d] ", x]; }
+  STAssertNoThrow(searchAndReplacedString = [replacementTemplate stringByMatching:longString replace:RKReplaceAll], nil);
+  STAssertTrue([searchAndReplacedString isEqualToString:expectedString], nil);
+  STAssertNoThrow(searchAndReplacedString = [longString stringByMatching:@"(\\d+)" replace:RKReplaceAll withReferenceString:@"[$1]"], nil);
+  STAssertTrue([searchAndReplacedString isEqualToString:expectedString], nil);
+
+  // When nothing matches the result must not be the mutable receiver itself.
+  NSMutableString *mutableString = [NSMutableString stringWithString:@"no digits"];
+  STAssertNoThrow(searchAndReplacedString = [mutableString stringByMatching:@"(\\d+)" replace:RKReplaceAll withReferenceString:@"[$1]"], nil);
+  [mutableString appendString:@" 42"];
+  STAssertTrue([searchAndReplacedString isEqualToString:@"no digits"], @"String: %@", searchAndReplacedString);
+}
+
+- (void)testCaptureExtractor
+{
+  RKCaptureExtractor *captureExtractor = nil;
+  NSArray *references = [NSArray arrayWithObjects:@"${what}", @"${1:%d}", nil];
+  NSString *whatString = nil;
+  int intValue = 0;
+  NSError *error = nil;
+
+  STAssertNoThrow(captureExtractor = [RKCaptureExtractor captureExtractorWithRegex:@"<(\\d+):\\s+(?<what>\\w+)[^>]*>" references:references], nil);
+  STAssertNotNil(captureExtractor, nil); if(captureExtractor == nil) { return; }
+  STAssertTrue([RKCaptureExtractor captureExtractorWithRegex:@"<(\\d+):\\s+(?<what>\\w+)[^>]*>" references:references] == captureExtractor, nil);
+
+  STAssertTrueNoThrow([captureExtractor getCapturesFromString:@"<42: Neato!>" pointers:&whatString, &intValue, NULL], nil);
+  STAssertTrue([whatString isEqualToString:@"Neato"], @"String: %@", whatString);
+  STAssertTrue(intValue == 42, @"int: %d", intValue);
+
+  STAssertFalseNoThrow([captureExtractor getCapturesFromString:@"Nothing to see here" pointers:&whatString, &intValue, NULL], nil);
+
+  // The same references passed to getCaptures are parsed once and then served from the extractor cache.
+  for(int x = 0; x < 3; x++) {
+    whatString = nil; intValue = 0;
+    STAssertTrueNoThrow(([[NSString stringWithFormat:@"<%d: Wahoo>", x] getCapturesWithRegexAndReferences:@"<(\\d+):\\s+(?<what>\\w+)[^>]*>", @"${what}", &whatString, @"${1:%d}", &intValue, nil]), nil);
+    STAssertTrue([whatString isEqualToString:@"Wahoo"], @"String: %@", whatString);
+    STAssertTrue(intValue == x, @"int: %d", intValue);
+  }
+
+  STAssertThrowsSpecificNamed([RKCaptureExtractor captureExtractorWithRegex:@"(\\d+)" references:[NSArray arrayWithObject:@"${nope}"]], NSException, RKRegexCaptureReferenceException, nil);
+  STAssertNil([RKCaptureExtractor captureExtractorWithRegex:@"(\\d+)" references:[NSArray arrayWithObject:@"${nope}"] error:&error], nil);
+  STAssertNotNil(error, nil);
+}
+
+- (void)testStringMatchAndReplaceUsingFunction
+{
+  NSString *searchString = [NSString stringWithUTF8String:"a=1, b\xC3\xA4r=22, c=333"], *searchAndReplacedString = nil;
+  NSError *error = nil;
+  RKUInteger remaining = 0;
+  
+  remaining = 100;
+  STAssertNoThrow(searchAndReplacedString = [searchString stringByMatching:@"([^\\s=,]+)=(\\d+)" replace:RKReplaceAll usingFunction:swapKeyValueReplaceFunction info:&remaining], nil);
+  STAssertTrue([searchAndReplacedString isEqualToString:[NSString stringWithUTF8String:"1:A, 22:B\xC3\x84R, 333:C"]], @"String: %@", searchAndReplacedString);
+  STAssertTrue(remaining == 97, @"remaining: %lu", (unsigned long)remaining);
+  
+  // Returning NO leaves the rest of the matches unchanged.
+  remaining = 1;
+  STAssertNoThrow(searchAndReplacedString = [searchString stringByMatching:@"([^\\s=,]+)=(\\d+)" inRange:NSMakeRange(3, [searchString length] - 3) replace:RKReplaceAll usingFunction:swapKeyValueReplaceFunction info:&remaining error:&error], nil);
+  STAssertNil(error, nil);
+  STAssertTrue([searchAndReplacedString isEqualToString:[NSString stringWithUTF8String:"a=1, 22:B\xC3\x84R, c=333"]], @"String: %@", searchAndReplacedString);
+  
+  remaining = 100;
+  STAssertTrue([[searchString stringByMatching:@"nothing" replace:RKReplaceAll usingFunction:swapKeyValueReplaceFunction info:&remaining] isEqualToString:searchString], nil);
+  
+  // A mutable receiver that is not matched gives an immutable copy, not the receiver.
+  NSMutableString *mutableSearchString = [NSMutableString stringWithString:searchString];
+  STAssertNoThrow(searchAndReplacedString = [mutableSearchString stringByMatching:@"nothing" replace:RKReplaceAll usingFunction:swapKeyValueReplaceFunction info:&remaining], nil);
+  STAssertTrue(searchAndReplacedString != mutableSearchString, nil);
+  STAssertTrue([searchAndReplacedString isEqualToString:searchString], @"String: %@", searchAndReplacedString);
+  
+  // A replacement that can not be converted to UTF8 fails the replace instead of silently dropping it.
+  error = nil;
+  STAssertNoThrow(searchAndReplacedString = [searchString stringByMatching:@"(\\d+)" inRange:NSMakeRange(0, [searchString length]) replace:RKReplaceAll usingFunction:unconvertibleReplaceFunction info:NULL error:&error], nil);
+  STAssertNil(searchAndReplacedString, @"String: %@", searchAndReplacedString);
+  STAssertNotNil(error, nil);
+  STAssertThrowsSpecificNamed([searchString stringByMatching:@"(\\w+)" replace:RKReplaceAll usingFunction:NULL info:NULL], NSException, NSInvalidArgumentException, nil);
+  
+#ifdef __BLOCKS__
+  __block RKUInteger matchedCount = 0;
+  RKReplaceBlock replaceBlock = ^BOOL(RKReplaceContext *replaceContext) {
+    NSRange valueRange = RKReplaceContextRangeOfCapture(replaceContext, 2);
+    matchedCount++;
+    return(RKReplaceContextAppendString(replaceContext, [NSString stringWithFormat:@"%lu@%lu", (unsigned long)valueRange.length, (unsigned long)valueRange.location]));
+  };
+  STAssertNoThrow(searchAndReplacedString = [searchString stringByMatching:@"([^\\s=,]+)=(\\d+)" replace:RKReplaceAll usingBlock:replaceBlock], nil);
+  STAssertTrue(matchedCount == 3, @"matchedCount: %lu", (unsigned long)matchedCount);
+  STAssertTrue([searchAndReplacedString isEqualToString:@"1@2, 2@9, 3@15"], @"String: %@", searchAndReplacedString);
+#endif // __BLOCKS__
+}
+
+- (void)testMutableStringMatchReplace
+{
+  NSMutableString *mutableString = [NSMutableString stringWithUTF8String:"B\xC3\xA4r one, B\xC3\xA4r two, B\xC3\xA4r three"];
+  NSMutableString *longString = [NSMutableString string], *expectedString = [NSMutableString string];
+  NSError *error = nil;
+  RKUInteger replacedCount = 0;
+
+  // A handful of replacements are made directly to the mutable string.
+  STAssertNoThrow(replacedCount = [mutableString match:@"(\\w+)(,|$)" replace:RKReplaceAll withString:@"<\\U$1\\E>$2"], nil);
+  STAssertTrue((replacedCount == 3), @"Count: %lu", (unsigned long)replacedCount);
+  STAssertTrue([mutableString isEqualToString:[NSString stringWithUTF8String:"B\xC3\xA4r <ONE>, B\xC3\xA4r <TWO>, B\xC3\xA4r <THREE>"]], @"String: %@", mutableString);
+
+  STAssertNoThrow(replacedCount = [mutableString match:@"<(\\w+)>" inRange:NSMakeRange(12, [mutableString length] - 12) replace:1 withString:@"$1"], nil);
+  STAssertTrue((replacedCount == 1), @"Count: %lu", (unsigned long)replacedCount);
+  STAssertTrue([mutableString isEqualToString:[NSString stringWithUTF8String:"B\xC3\xA4r <ONE>, B\xC3\xA4r TWO, B\xC3\xA4r <THREE>"]], @"String: %@", mutableString);
+
+  // Replacements that keep the UTF8 length, and replacements with the same UTF8 length but a different UTF16 length.
+  STAssertNoThrow(replacedCount = [mutableString match:@"<(\\w+)>" replace:RKReplaceAll withString:@"[$1]"], nil);
+  STAssertTrue((replacedCount == 2), @"Count: %lu", (unsigned long)replacedCount);
+  STAssertNoThrow(replacedCount = [mutableString match:[NSString stringWithUTF8String:"\xC3\xA4"] replace:RKReplaceAll withString:@"ae"], nil);
+  STAssertTrue((replacedCount == 3), @"Count: %lu", (unsigned long)replacedCount);
+  STAssertTrue([mutableString isEqualToString:@"Baer [ONE], Baer TWO, Baer [THREE]"], @"String: %@", mutableString);
+
+  STAssertNoThrow(replacedCount = [mutableString match:@"nothing" replace:RKReplaceAll withString:@"x" error:&error], nil);
+  STAssertTrue((replacedCount == 0), @"Count: %lu", (unsigned long)replacedCount);
+  STAssertNil(error, nil);
+
+  // More replacements than RK_MAX_IN_PLACE_EDITS rebuild the string instead.
+  for(int x = 0; x < 500; x++) { [longString appendFormat:@"%d%C", x, (unichar)0x00A0]; [expectedString appendFormat:@"(%d)%C", x, (unichar)0x00A0]; }
+  STAssertNoThrow(replacedCount = [longString match:@"(\\d+)" replace:RKReplaceAll withString:@"($1)"], nil);
+  STAssertTrue((replacedCount == 500), @"Count: %lu", (unsigned long)replacedCount);
+  STAssertTrue([longString isEqualToString:expectedString], nil);
+
+  // A few replacements that change the length are made in place, last to first, and more than RK_MAX_IN_PLACE_RESIZES rebuild the string.
+  NSString *sparseString = nil;
+  [longString setString:@""];
+  for(int x = 0; x < 2000; x++) {
+    if((x == 2) || (x == 1000)) { [longString appendFormat:@"<mark%d> ", x]; }
+    [longString appendFormat:@"%C w%d ", (unichar)0x00E9, x];
+  }
+  [longString appendString:@"<last>"];
+  sparseString = [NSString stringWithString:longString];
+  STAssertNoThrow(replacedCount = [longString match:@"<(\\w+)>" replace:RKReplaceAll withString:@"[[$1]]"], nil);
+  STAssertTrue((replacedCount == 3), @"Count: %lu", (unsigned long)replacedCount);
+  STAssertTrue([longString isEqualToString:[sparseString stringByMatching:@"<(\\w+)>" replace:RKReplaceAll withReferenceString:@"[[$1]]"]], nil);
+  STAssertTrue([longString hasSuffix:@"w1999 [[last]]"], @"String suffix: %@", [longString substringFromIndex:[longString length] - 14]);
+
+  STAssertNoThrow(replacedCount = [longString match:@"w(1\\d) " replace:RKReplaceAll withString:@"$1 "], nil);
+  STAssertTrue((replacedCount == 10), @"Count: %lu", (unsigned long)replacedCount);
+  STAssertNoThrow(replacedCount = [longString match:@"\\[\\[(\\w+)\\]\\]" replace:RKReplaceAll withString:@"$1"], nil);
+  STAssertTrue((replacedCount == 3), @"Count: %lu", (unsigned long)replacedCount);
+  STAssertTrue([longString isEqualToString:[[sparseString stringByMatching:@"w(1\\d) " replace:RKReplaceAll withReferenceString:@"$1 "] stringByMatching:@"<(\\w+)>" replace:RKReplaceAll withReferenceString:@"$1"]], nil);
+}
+
 - (void)testStringMatchAndReplaceCaseConversionBackslashRef
 {
   NSString *searchString = @"one two three four five";
@@ -907,6 +1118,23 @@
   STAssertTrue([searchAndReplacedString isEqualToString:[NSString stringWithUTF8String:"one two C\xC3\xA4n iT UC this stuff? two, three four C\xC3\xA4n iT UC this stuff? four, five"]], @"String: %@", searchAndReplacedString);  
 }
 
+- (void)testStringMatchAndReplaceCaseConversionUnicode
+{
+  // Latin-1, Latin Extended-A, Greek, and Cyrillic are converted directly, the 'ß' -> "SS" and 'Σ' cases are converted by Foundation.
+  NSString *searchString = [NSString stringWithUTF8String:"<stra\xC3\x9F\x65> <\xC3\xA9t\xC3\xA9 \xC5\x82\xC3\xB3" "d\xC5\xBA> <\xCE\xB1\xCE\xB2\xCE\xB3> <\xD0\xBC\xD0\xB8\xD1\x80> <ABCDEFGHIJKLMNOPQRSTUVWXYZ>"];
+  NSString *searchAndReplacedString = nil;
+
+  STAssertNoThrow(searchAndReplacedString = [searchString stringByMatching:@"<([^>]*)>" replace:RKReplaceAll withReferenceString:@"<\\U$1\\E>"], NULL);
+  STAssertTrue([searchAndReplacedString isEqualToString:[searchString uppercaseString]], @"String: %@", searchAndReplacedString);
+
+  STAssertNoThrow(searchAndReplacedString = [searchAndReplacedString stringByMatching:@"<([^>]*)>" replace:RKReplaceAll withReferenceString:@"<\\L$1\\E>"], NULL);
+  STAssertTrue([searchAndReplacedString isEqualToString:[[searchString uppercaseString] lowercaseString]], @"String: %@", searchAndReplacedString);
+
+  STAssertNoThrow(searchAndReplacedString = [[NSString stringWithUTF8String:"\xC3\xA9t\xC3\xA9 \xCE\xA3\xCE\x9F\xCE\xA6\xCE\x99\xCE\x91"] stringByMatching:@"(\\S+) (\\S+)" replace:RKReplaceAll withReferenceString:@"\\u$1 \\L$2"], NULL);
+  STAssertTrue([[searchAndReplacedString substringToIndex:4] isEqualToString:[NSString stringWithUTF8String:"\xC3\x89t\xC3\xA9 "]], @"String: %@", searchAndReplacedString);
+  STAssertTrue([[searchAndReplacedString substringFromIndex:4] isEqualToString:[[NSString stringWithUTF8String:"\xCE\xA3\xCE\x9F\xCE\xA6\xCE\x99\xCE\x91"] lowercaseString]], @"String: %@", searchAndReplacedString);
+}
+
 - (void)testStringMatchAndReplace
 {
   NSString *searchString = @"<1: Neato!>, <2: Wahoo!>, <3: Zoinks>", *searchRegexString = @"<(\\d+):\\s+(?<what>\\w+)[^>]*>", *replaceString = @"<${what} :$1>";
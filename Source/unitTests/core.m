@@ -393,6 +393,347 @@
   STAssertThrowsSpecificNamed((resultRanges = [regex rangesForCharacters:NULL length:subjectLength inRange:NSMakeRange(0, 100) options:RKMatchNoOptions]), NSException, NSInvalidArgumentException, nil);
 }
 
+- (void)testMatchesSubjects
+{
+  NSArray *subjectsArray = [NSArray arrayWithObjects:@"Match the MAGIC", @"No match here", @"xx Match is MAGIC", @"", @"Match or MAGIC", NULL];
+  id subjects[5] = { @"Match the MAGIC", @"No match here", @"xx Match is MAGIC", @"", @"Match or MAGIC" };
+  unsigned char resultsBitmap[RKMatchResultsBitmapSize(5)];
+  NSRange resultRanges[5];
+  RKUInteger matchedCount = 0, x = 0;
+
+  RKRegex *regex = [RKRegex regexWithRegexString:@"(Match)\\s+(?<huh>the|or|is)\\s+(MAGIC)" options:0];
+  STAssertNotNil(regex, nil); if(regex == nil) { return; }
+
+  memset(resultsBitmap, 0xff, sizeof(resultsBitmap));
+  STAssertNoThrow((matchedCount = [regex matchesSubjects:subjects count:5 results:resultsBitmap]), nil);
+  STAssertTrue(matchedCount == 3, @"matchedCount is %u", matchedCount);
+  STAssertTrue(RKMatchResultsBitmapIsSet(resultsBitmap, 0) != 0, nil);
+  STAssertTrue(RKMatchResultsBitmapIsSet(resultsBitmap, 1) == 0, nil);
+  STAssertTrue(RKMatchResultsBitmapIsSet(resultsBitmap, 2) != 0, nil);
+  STAssertTrue(RKMatchResultsBitmapIsSet(resultsBitmap, 3) == 0, nil);
+  STAssertTrue(RKMatchResultsBitmapIsSet(resultsBitmap, 4) != 0, nil);
+
+  for(x = 0; x < 5; x++) { resultRanges[x] = NSMakeRange(0xdeadbeef, 0x0badc0de); }
+  STAssertNoThrow((matchedCount = [regex matchesSubjectsInArray:subjectsArray results:NULL ranges:resultRanges options:RKMatchNoOptions concurrent:YES error:NULL]), nil);
+  STAssertTrue(matchedCount == 3, @"matchedCount is %u", matchedCount);
+  STAssertTrue(NSEqualRanges(NSMakeRange(0, 15), resultRanges[0]), nil);
+  STAssertTrue(NSEqualRanges(NSMakeRange(NSNotFound, 0), resultRanges[1]), nil);
+  STAssertTrue(NSEqualRanges(NSMakeRange(3, 14), resultRanges[2]), nil);
+  STAssertTrue(NSEqualRanges(NSMakeRange(NSNotFound, 0), resultRanges[3]), nil);
+  STAssertTrue(NSEqualRanges(NSMakeRange(0, 14), resultRanges[4]), nil);
+
+  STAssertThrowsSpecificNamed([regex matchesSubjects:NULL count:5 results:resultsBitmap], NSException, NSInvalidArgumentException, nil);
+  STAssertThrowsSpecificNamed([regex matchesSubjects:subjects count:5 results:NULL], NSException, NSInvalidArgumentException, nil);
+}
+
+- (void)testGetCapturesFromSubjects
+{
+  NSArray *subjectsArray = [NSArray arrayWithObjects:@"id=42 load=0.75 at=2008-01-15T10:30:00Z", @"no fields here", @"id=-7 load=x at=2008-01-15T10:31:30Z", @"id=9223372036854775807 load=1e3 at=yesterday", NULL];
+  int64_t idValues[4];
+  double loadValues[4];
+  NSTimeInterval atValues[4];
+  NSRange loadRanges[4];
+  unsigned char idNulls[RKMatchResultsBitmapSize(4)], loadNulls[RKMatchResultsBitmapSize(4)], atNulls[RKMatchResultsBitmapSize(4)];
+  RKUInteger matchedCount = 0;
+
+  RKRegex *regex = [RKRegex regexWithRegexString:@"id=(?<id>-?\\d+) load=(?<load>[^ ]+) at=(?<at>\\S+)" options:0];
+  STAssertNotNil(regex, nil); if(regex == nil) { return; }
+
+  RKCaptureColumn columns[4] = {
+    { @"id",   RKCaptureColumnInt64,     idValues,   idNulls   },
+    { @"load", RKCaptureColumnDouble,    loadValues, loadNulls },
+    { @"at",   RKCaptureColumnTimestamp, atValues,   atNulls   },
+    { @"2",    RKCaptureColumnRange,     loadRanges, NULL      }
+  };
+
+  memset(idNulls, 0, sizeof(idNulls)); memset(loadNulls, 0, sizeof(loadNulls)); memset(atNulls, 0, sizeof(atNulls));
+  STAssertNoThrow((matchedCount = [regex getCapturesFromSubjectsInArray:subjectsArray columns:columns columnCount:4 options:RKMatchNoOptions concurrent:YES error:NULL]), nil);
+  STAssertTrue(matchedCount == 3, @"matchedCount is %u", matchedCount);
+
+  STAssertTrue(RKMatchResultsBitmapIsSet(idNulls, 0) == 0 && idValues[0] == 42LL, nil);
+  STAssertTrue(RKMatchResultsBitmapIsSet(idNulls, 1) != 0 && idValues[1] == 0LL, nil);
+  STAssertTrue(RKMatchResultsBitmapIsSet(idNulls, 2) == 0 && idValues[2] == -7LL, nil);
+  STAssertTrue(RKMatchResultsBitmapIsSet(idNulls, 3) == 0 && idValues[3] == 9223372036854775807LL, nil);
+
+  STAssertTrue(RKMatchResultsBitmapIsSet(loadNulls, 0) == 0 && loadValues[0] == 0.75, nil);
+  STAssertTrue(RKMatchResultsBitmapIsSet(loadNulls, 1) != 0, nil);
+  STAssertTrue(RKMatchResultsBitmapIsSet(loadNulls, 2) != 0, nil);
+  STAssertTrue(RKMatchResultsBitmapIsSet(loadNulls, 3) == 0 && loadValues[3] == 1000.0, nil);
+
+  STAssertTrue(RKMatchResultsBitmapIsSet(atNulls, 0) == 0 && atValues[0] == 222085800.0, @"atValues[0] is %f", atValues[0]);
+  STAssertTrue(RKMatchResultsBitmapIsSet(atNulls, 2) == 0 && (atValues[2] - atValues[0]) == 90.0, nil);
+  STAssertTrue(RKMatchResultsBitmapIsSet(atNulls, 3) != 0, nil);
+
+  STAssertTrue(NSEqualRanges(NSMakeRange(11, 4), loadRanges[0]), nil);
+  STAssertTrue(NSEqualRanges(NSMakeRange(NSNotFound, 0), loadRanges[1]), nil);
+  STAssertTrue(NSEqualRanges(NSMakeRange(11, 1), loadRanges[2]), nil);
+
+  columns[0].captureName = @"missing";
+  STAssertThrowsSpecificNamed([regex getCapturesFromSubjectsInArray:subjectsArray columns:columns columnCount:4 options:RKMatchNoOptions concurrent:NO error:NULL], NSException, RKRegexCaptureReferenceException, nil);
+  columns[0].captureName = @"id"; columns[0].values = NULL;
+  STAssertThrowsSpecificNamed([regex getCapturesFromSubjectsInArray:subjectsArray columns:columns columnCount:4 options:RKMatchNoOptions concurrent:NO error:NULL], NSException, NSInvalidArgumentException, nil);
+  STAssertThrowsSpecificNamed([regex getCapturesFromSubjectsInArray:subjectsArray columns:NULL columnCount:4 options:RKMatchNoOptions concurrent:NO error:NULL], NSException, NSInvalidArgumentException, nil);
+}
+
+- (void)testGetCapturesFromSubjectsConcurrent
+{
+  // Enough subjects to span several batch blocks, so the thread pool path is used, and the results must be the same as the serial path.
+  NSMutableArray *subjectsArray = [NSMutableArray array];
+  int64_t concurrentIDs[300], serialIDs[300];
+  NSRange concurrentRanges[300], serialRanges[300];
+  unsigned char concurrentNulls[RKMatchResultsBitmapSize(300)], serialNulls[RKMatchResultsBitmapSize(300)];
+  RKUInteger concurrentCount = 0, serialCount = 0, x = 0;
+
+  for(x = 0; x < 300; x++) {
+    if((x % 3) == 1) { [subjectsArray addObject:[NSString stringWithFormat:@"row %lu has no id", (unsigned long)x]]; }
+    else             { [subjectsArray addObject:[NSString stringWithFormat:@"%@id=%lu load=%lu", ((x % 2) == 0) ? @"" : @"    ", (unsigned long)(x * 7), (unsigned long)x]]; }
+  }
+
+  RKRegex *regex = [RKRegex regexWithRegexString:@"id=(?<id>\\d+) load=(?<load>\\d+)" options:0];
+  STAssertNotNil(regex, nil); if(regex == nil) { return; }
+
+  RKCaptureColumn concurrentColumns[2] = { { @"id", RKCaptureColumnInt64, concurrentIDs, concurrentNulls }, { @"load", RKCaptureColumnRange, concurrentRanges, NULL } };
+  RKCaptureColumn serialColumns[2]     = { { @"id", RKCaptureColumnInt64, serialIDs,     serialNulls     }, { @"load", RKCaptureColumnRange, serialRanges,     NULL } };
+
+  memset(concurrentNulls, 0, sizeof(concurrentNulls)); memset(serialNulls, 0, sizeof(serialNulls));
+  STAssertNoThrow((concurrentCount = [regex getCapturesFromSubjectsInArray:subjectsArray columns:concurrentColumns columnCount:2 options:RKMatchNoOptions concurrent:YES error:NULL]), nil);
+  STAssertNoThrow((serialCount     = [regex getCapturesFromSubjectsInArray:subjectsArray columns:serialColumns     columnCount:2 options:RKMatchNoOptions concurrent:NO  error:NULL]), nil);
+  STAssertTrue(concurrentCount == 200, @"concurrentCount is %u", concurrentCount);
+  STAssertTrue(concurrentCount == serialCount, @"concurrentCount is %u, serialCount is %u", concurrentCount, serialCount);
+
+  for(x = 0; x < 300; x++) {
+    STAssertTrue(RKMatchResultsBitmapIsSet(concurrentNulls, x) == RKMatchResultsBitmapIsSet(serialNulls, x), @"x = %u", x);
+    STAssertTrue(NSEqualRanges(concurrentRanges[x], serialRanges[x]), @"x = %u concurrent = %@ serial = %@", x, NSStringFromRange(concurrentRanges[x]), NSStringFromRange(serialRanges[x]));
+    if((x % 3) == 1) { STAssertTrue(RKMatchResultsBitmapIsSet(concurrentNulls, x) != 0, @"x = %u", x); continue; }
+    STAssertTrue((concurrentIDs[x] == (int64_t)(x * 7)) && (concurrentIDs[x] == serialIDs[x]), @"x = %u concurrent = %lld serial = %lld", x, (long long)concurrentIDs[x], (long long)serialIDs[x]);
+  }
+}
+
+- (void)testRangeForCharactersCaptureSubset
+{
+  const char *matchCharacters = "xx Match is MAGIC";
+  RKRegex *regex = [RKRegex regexWithRegexString:@"(Match)\\s+(?<huh>the|or|is)\\s+(MAGIC)(x)?" options:0];
+  STAssertNotNil(regex, nil); if(regex == nil) { return; }
+
+  STAssertTrue([regex matchesCharacters:matchCharacters length:strlen(matchCharacters) inRange:NSMakeRange(0, strlen(matchCharacters)) options:RKMatchNoOptions], nil);
+  STAssertFalse([regex matchesCharacters:matchCharacters length:strlen(matchCharacters) inRange:NSMakeRange(0, 16) options:RKMatchNoOptions], nil);
+  STAssertTrue(NSEqualRanges(NSMakeRange(3, 14), [regex rangeForCharacters:matchCharacters length:strlen(matchCharacters) inRange:NSMakeRange(0, strlen(matchCharacters)) captureIndex:0 options:RKMatchNoOptions]), nil);
+  STAssertTrue(NSEqualRanges(NSMakeRange(9, 2), [regex rangeForCharacters:matchCharacters length:strlen(matchCharacters) inRange:NSMakeRange(0, strlen(matchCharacters)) captureIndex:2 options:RKMatchNoOptions]), nil);
+  STAssertTrue(NSEqualRanges(NSMakeRange(NSNotFound, 0), [regex rangeForCharacters:matchCharacters length:strlen(matchCharacters) inRange:NSMakeRange(0, strlen(matchCharacters)) captureIndex:4 options:RKMatchNoOptions]), nil);
+}
+
+static int coreTestCountCallouts(RKMatchContext *matchContext RK_ATTRIBUTES(unused), pcre_callout_block *calloutBlock, void *calloutContext) {
+  if(calloutBlock->callout_number == 7) { (*((int *)calloutContext))++; }
+  return(0);
+}
+
+// Starts a DFA match of its own from inside the callout of another DFA match on the same thread.
+static int coreTestNestedDFAMatch(RKMatchContext *matchContext RK_ATTRIBUTES(unused), pcre_callout_block *calloutBlock RK_ATTRIBUTES(unused), void *calloutContext) {
+  const char *nestedCharacters = "zzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzy";
+  NSRange nestedRange;
+  
+  if([[RKRegex regexWithRegexString:@"(z|zz|zzz)+y" options:RKCompileNoOptions] getRanges:&nestedRange withCharacters:nestedCharacters length:strlen(nestedCharacters) inRange:NSMakeRange(0, strlen(nestedCharacters)) options:RKMatchDFA] == 1) { (*((int *)calloutContext))++; }
+  return(0);
+}
+
+- (void)testMatchContext
+{
+  const char *matchCharacters = "xx Match is MAGIC";
+  RKMatchContext *matchContext = [RKMatchContext matchContext];
+  RKMatchErrorCode matchErrorCode = RKMatchErrorNoError;
+  int calloutCount = 0;
+
+  RKRegex *regex = [RKRegex regexWithRegexString:@"(Match)\\s+(?<huh>the|or|is)\\s+(MAGIC)" options:0];
+  STAssertNotNil(regex, nil); if(regex == nil) { return; }
+  STAssertNotNil(matchContext, nil); if(matchContext == nil) { return; }
+
+  STAssertNoThrow((matchErrorCode = [regex getRangesInMatchContext:matchContext withCharacters:matchCharacters length:strlen(matchCharacters) inRange:NSMakeRange(0, strlen(matchCharacters)) options:RKMatchNoOptions]), nil);
+  STAssertTrue(matchErrorCode == 4, @"matchErrorCode is %d", matchErrorCode);
+  STAssertTrue([matchContext regex] == regex, nil);
+  STAssertTrue([matchContext captureCount] == 4, nil);
+  STAssertTrue(NSEqualRanges(NSMakeRange(3, 14), [matchContext rangeForCaptureIndex:0]), nil);
+  STAssertTrue(NSEqualRanges(NSMakeRange(9, 2),  [matchContext rangeForCaptureIndex:2]), nil);
+  STAssertThrowsSpecificNamed([matchContext rangeForCaptureIndex:4], NSException, NSInvalidArgumentException, nil);
+
+  STAssertNoThrow((matchErrorCode = [regex getRangesInMatchContext:matchContext withCharacters:matchCharacters length:strlen(matchCharacters) inRange:NSMakeRange(0, 8) options:RKMatchNoOptions]), nil);
+  STAssertTrue(matchErrorCode == RKMatchErrorNoMatch, @"matchErrorCode is %d", matchErrorCode);
+  STAssertTrue(NSEqualRanges(NSMakeRange(NSNotFound, 0), [matchContext rangeForCaptureIndex:0]), nil);
+
+  STAssertNoThrow((matchErrorCode = [regex getRangesInMatchContext:NULL withCharacters:matchCharacters length:strlen(matchCharacters) inRange:NSMakeRange(0, strlen(matchCharacters)) options:RKMatchNoOptions]), nil);
+  STAssertTrue(matchErrorCode == 4, @"matchErrorCode is %d", matchErrorCode);
+  STAssertTrue([[RKMatchContext currentThreadMatchContext] regex] == regex, nil);
+
+  regex = [RKRegex regexWithRegexString:@"a(?C7)b" options:0];
+  STAssertNotNil(regex, nil); if(regex == nil) { return; }
+  [matchContext setCalloutFunction:coreTestCountCallouts context:&calloutCount];
+  STAssertNoThrow((matchErrorCode = [regex getRangesInMatchContext:matchContext withCharacters:"aacab" length:5 inRange:NSMakeRange(0, 5) options:RKMatchNoOptions]), nil);
+  STAssertTrue(matchErrorCode == 1, @"matchErrorCode is %d", matchErrorCode);
+  STAssertTrue(calloutCount == 3, @"calloutCount is %d", calloutCount);
+  STAssertTrue(NSEqualRanges(NSMakeRange(3, 2), [matchContext rangeForCaptureIndex:0]), nil);
+}
+
+- (void)testMatchLimits
+{
+  const char *matchCharacters = "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxzy"; // The trailing y defeats the PCRE required character optimization.
+  RKMatchContext *matchContext = [RKMatchContext matchContext];
+  RKMatchErrorCode matchErrorCode = RKMatchErrorNoError;
+  RKUInteger abortedMatchCount = RKAbortedMatchCount();
+  NSError *matchError = nil;
+  
+  // Time limits are only checked at callout points, so timeRegex is compiled with automatic callouts.
+  RKRegex *regex     = [RKRegex regexWithRegexString:@"^(x+x+)+y$" options:RKCompileNoOptions];
+  RKRegex *timeRegex = [RKRegex regexWithRegexString:@"^(x+x+)+y$" options:RKCompileAutoCallout];
+  STAssertNotNil(regex, nil); if(regex == nil) { return; }
+  STAssertNotNil(timeRegex, nil); if(timeRegex == nil) { return; }
+  
+  [matchContext setMatchLimit:1000];
+  STAssertTrue([matchContext matchLimit] == 1000, nil);
+  STAssertNoThrow((matchErrorCode = [regex getRangesInMatchContext:matchContext withCharacters:matchCharacters length:strlen(matchCharacters) inRange:NSMakeRange(0, strlen(matchCharacters)) options:RKMatchNoOptions error:&matchError]), nil);
+  STAssertTrue(matchErrorCode == RKMatchErrorMatchLimit, @"matchErrorCode is %d", matchErrorCode);
+  STAssertTrue([matchError code] == RKMatchErrorMatchLimit, @"matchError is %@", matchError);
+  STAssertTrue(RKAbortedMatchCount() == (abortedMatchCount + 1), nil);
+  [matchContext setMatchLimit:0];
+  
+  [matchContext setMatchTimeLimit:0.01];
+  STAssertNoThrow((matchErrorCode = [timeRegex getRangesInMatchContext:matchContext withCharacters:matchCharacters length:strlen(matchCharacters) inRange:NSMakeRange(0, strlen(matchCharacters)) options:RKMatchNoOptions]), nil);
+  STAssertTrue(matchErrorCode == RKMatchErrorTimeLimit, @"matchErrorCode is %d", matchErrorCode);
+  STAssertTrue(RKAbortedMatchCount() == (abortedMatchCount + 2), nil);
+  STAssertThrowsSpecificNamed([matchContext setMatchTimeLimit:-1.0], NSException, NSInvalidArgumentException, nil);
+  
+  [regex setMatchLimit:1000];
+  STAssertTrue([regex matchLimit] == 1000, nil);
+  STAssertTrue(NSEqualRanges(NSMakeRange(NSNotFound, 0), [regex rangeForCharacters:matchCharacters length:strlen(matchCharacters) inRange:NSMakeRange(0, strlen(matchCharacters)) captureIndex:0 options:RKMatchNoOptions]), nil);
+  STAssertTrue(RKAbortedMatchCount() == (abortedMatchCount + 3), nil);
+  [regex setMatchLimit:0];
+  
+  [timeRegex setMatchTimeLimit:0.01];
+  STAssertTrue([timeRegex matchTimeLimit] > 0.0099, nil);
+  STAssertTrue(NSEqualRanges(NSMakeRange(NSNotFound, 0), [timeRegex rangeForCharacters:matchCharacters length:strlen(matchCharacters) inRange:NSMakeRange(0, strlen(matchCharacters)) captureIndex:0 options:RKMatchNoOptions]), nil);
+  STAssertTrue(RKAbortedMatchCount() == (abortedMatchCount + 4), nil);
+  STAssertTrue([timeRegex rangeForCharacters:"xxy" length:3 inRange:NSMakeRange(0, 3) captureIndex:0 options:RKMatchNoOptions].location == 0, nil);
+  [timeRegex setMatchTimeLimit:0.0];
+}
+
+- (void)testHazardAnalysis
+{
+  NSArray *hazards = nil;
+  NSError *analysisError = nil;
+  RKRegex *regex = nil;
+  
+  STAssertTrue([[RKRegex hazardsForRegexString:@"^[a-z]+@[a-z]+\\.com$" options:RKCompileNoOptions] count] == 0, nil);
+  STAssertTrue([[RKRegex hazardsForRegexString:@"(ab+)+" options:RKCompileNoOptions] count] == 0, nil);
+  STAssertTrue([[RKRegex hazardsForRegexString:@"(a++)+|(?>a+)+" options:RKCompileNoOptions] count] == 0, nil);
+  
+  STAssertNoThrow((hazards = [RKRegex hazardsForRegexString:@"^(x+x+)+y$" options:RKCompileNoOptions]), nil);
+  STAssertTrue([hazards count] == 2, @"hazards is %@", hazards);
+  STAssertTrue([[[hazards objectAtIndex:0] objectForKey:RKRegexHazardTypeKey] intValue] == RKRegexHazardNestedQuantifier, nil);
+  STAssertTrue(NSEqualRanges([[[hazards objectAtIndex:0] objectForKey:RKRegexHazardRangeKey] rangeValue], NSMakeRange(1, 7)), nil);
+  STAssertTrue([[[hazards objectAtIndex:0] objectForKey:RKRegexHazardExponentialKey] boolValue] == YES, nil);
+  STAssertTrue([[[hazards objectAtIndex:0] objectForKey:RKRegexHazardHardenableKey] boolValue] == NO, nil);
+  STAssertTrue([[[hazards objectAtIndex:1] objectForKey:RKRegexHazardTypeKey] intValue] == RKRegexHazardAdjacentQuantifiers, nil);
+  STAssertTrue([[[hazards objectAtIndex:1] objectForKey:RKRegexHazardExponentialKey] boolValue] == NO, nil);
+  
+  STAssertTrue([[[[RKRegex hazardsForRegexString:@"(a|ab)*c" options:RKCompileNoOptions] lastObject] objectForKey:RKRegexHazardTypeKey] intValue] == RKRegexHazardOverlappingAlternation, nil);
+  STAssertTrue([[RKRegex hazardsForRegexString:@"(?x) ( \\w+ \\s? )+ $ # comment" options:RKCompileNoOptions] count] == 1, nil);
+  STAssertTrue([[RKRegex hazardsForRegexString:@"(A+)+a" options:RKCompileNoOptions] count] == 1, nil);
+  
+  STAssertTrue([[RKRegex hardenedRegexString:@"^(a+)+b" options:RKCompileNoOptions hazards:&hazards] isEqualToString:@"^(a+)++b"], nil);
+  STAssertTrue([hazards count] == 0, @"hazards is %@", hazards);
+  STAssertTrue([[RKRegex hardenedRegexString:@"(\\w|\\d)*-" options:RKCompileNoOptions hazards:NULL] isEqualToString:@"(\\w|\\d)*+-"], nil);
+  // Giving back an 'a' could let the trailing 'a' match, so the group can not be made possessive.
+  STAssertTrue([[RKRegex hardenedRegexString:@"(a+)+a" options:RKCompileNoOptions hazards:&hazards] isEqualToString:@"(a+)+a"], nil);
+  STAssertTrue([hazards count] == 1, @"hazards is %@", hazards);
+  STAssertTrue([[RKRegex hardenedRegexString:@"(A+)+a" options:RKCompileCaseless hazards:NULL] isEqualToString:@"(A+)+a"], nil);
+  // Giving back characters changes where \\b and \\B are tested, so groups followed by them are left alone.
+  STAssertTrue([[RKRegex hardenedRegexString:@"([a-]+)+\\b" options:RKCompileNoOptions hazards:NULL] isEqualToString:@"([a-]+)+\\b"], nil);
+  STAssertTrue([[RKRegex hardenedRegexString:@"(a+)+\\B" options:RKCompileNoOptions hazards:NULL] isEqualToString:@"(a+)+\\B"], nil);
+  STAssertTrue([[RKRegex regexWithRegexString:[RKRegex hardenedRegexString:@"([a-]+)+\\b" options:RKCompileNoOptions hazards:NULL] options:RKCompileNoOptions] matchesCharacters:"a--" length:3 inRange:NSMakeRange(0, 3) options:RKMatchNoOptions], nil);
+  STAssertTrue([[RKRegex regexWithRegexString:[RKRegex hardenedRegexString:@"(a+)+\\B" options:RKCompileNoOptions hazards:NULL] options:RKCompileNoOptions] matchesCharacters:"aa" length:2 inRange:NSMakeRange(0, 2) options:RKMatchNoOptions], nil);
+  
+  STAssertNil((regex = [RKRegex regexWithRegexString:@"(a+)+a" options:RKCompileNoOptions analysis:(RKRegexAnalysisHarden | RKRegexAnalysisRejectExponential) error:&analysisError]), nil);
+  STAssertTrue([[analysisError domain] isEqualToString:RKRegexErrorDomain], nil);
+  STAssertTrue([[[analysisError userInfo] objectForKey:RKRegexHazardsErrorKey] count] == 1, @"analysisError is %@", analysisError);
+  
+  analysisError = nil;
+  STAssertNotNil((regex = [RKRegex regexWithRegexString:@"^(a+)+b" options:RKCompileNoOptions analysis:RKRegexAnalysisHarden | RKRegexAnalysisReject error:&analysisError]), @"analysisError is %@", analysisError);
+  STAssertTrue([[regex regexString] isEqualToString:@"^(a+)++b"], nil);
+  STAssertTrue([regex matchesCharacters:"aaab" length:4 inRange:NSMakeRange(0, 4) options:RKMatchNoOptions], nil);
+  STAssertNotNil([RKRegex regexWithRegexString:@"\\d+\\d+" options:RKCompileNoOptions analysis:RKRegexAnalysisRejectExponential error:NULL], nil);
+  STAssertNil([RKRegex regexWithRegexString:@"\\d+\\d+" options:RKCompileNoOptions analysis:RKRegexAnalysisRejectPolynomial error:NULL], nil);
+}
+
+- (void)testMatchEngine
+{
+  const char *matchCharacters = "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxzy";
+  NSRange matchRanges[2];
+  NSError *matchError = nil;
+  RKUInteger abortedMatchCount = RKAbortedMatchCount(), sample = 0;
+  
+  RKRegex *regex = [RKRegex regexWithRegexString:@"^(x+x+)+y$" options:RKCompileNoOptions];
+  STAssertNotNil(regex, nil); if(regex == nil) { return; }
+  STAssertTrue([regex matchEngine] == RKMatchEngineBacktracking, nil);
+  
+  // The DFA algorithm never backtracks, so the match limit is never reached.
+  [regex setMatchLimit:1000];
+  [regex setMatchEngine:RKMatchEngineDFA];
+  STAssertTrue([regex matchEngine] == RKMatchEngineDFA, nil);
+  STAssertFalse([regex matchesCharacters:matchCharacters length:strlen(matchCharacters) inRange:NSMakeRange(0, strlen(matchCharacters)) options:RKMatchNoOptions error:&matchError], nil);
+  STAssertNil(matchError, @"matchError is %@", matchError);
+  STAssertTrue(RKAbortedMatchCount() == abortedMatchCount, nil);
+  STAssertTrue([regex matchesCharacters:"xxxxy" length:5 inRange:NSMakeRange(0, 5) options:RKMatchNoOptions], nil);
+  [regex setMatchLimit:0];
+  STAssertThrowsSpecificNamed([regex setMatchEngine:(RKMatchEngine)42], NSException, NSInvalidArgumentException, nil);
+  
+  // RKMatchDFA finds the longest match, and the captures are not set.
+  RKRegex *captureRegex = [RKRegex regexWithRegexString:@"(a)b+" options:RKCompileNoOptions];
+  STAssertNotNil(captureRegex, nil); if(captureRegex == nil) { return; }
+  STAssertTrue([captureRegex getRanges:matchRanges withCharacters:"abbb" length:4 inRange:NSMakeRange(0, 4) options:RKMatchDFA] == 1, nil);
+  STAssertTrue(NSEqualRanges(matchRanges[0], NSMakeRange(0, 4)), nil);
+  STAssertTrue(matchRanges[1].location == NSNotFound, nil);
+  STAssertTrue([captureRegex getRanges:matchRanges withCharacters:"abbb" length:4 inRange:NSMakeRange(0, 4) options:RKMatchDFAShortest] == 1, nil);
+  STAssertTrue(NSEqualRanges(matchRanges[0], NSMakeRange(0, 2)), nil);
+  
+  // Regexes with items the DFA algorithm does not support quietly use the backtracking algorithm.
+  RKRegex *backreferenceRegex = [RKRegex regexWithRegexString:@"(a)\\1" options:RKCompileNoOptions];
+  STAssertNotNil(backreferenceRegex, nil); if(backreferenceRegex == nil) { return; }
+  [backreferenceRegex setMatchEngine:RKMatchEngineDFA];
+  STAssertTrue([backreferenceRegex matchesCharacters:"xaa" length:3 inRange:NSMakeRange(0, 3) options:RKMatchNoOptions], nil);
+  STAssertFalse([backreferenceRegex matchesCharacters:"xab" length:3 inRange:NSMakeRange(0, 3) options:RKMatchNoOptions], nil);
+  
+  // RKMatchEngineAutomatic always gives the same answers as the backtracking algorithm, while sampling and after.
+  RKRegex *automaticRegex = [RKRegex regexWithRegexString:@"b+c" options:RKCompileNoOptions];
+  STAssertNotNil(automaticRegex, nil); if(automaticRegex == nil) { return; }
+  [automaticRegex setMatchEngine:RKMatchEngineAutomatic];
+  for(sample = 0; sample < 100; sample++) {
+    STAssertTrue([automaticRegex matchesCharacters:"abbbc" length:5 inRange:NSMakeRange(0, 5) options:RKMatchNoOptions], nil);
+    STAssertFalse([automaticRegex matchesCharacters:"abbbd" length:5 inRange:NSMakeRange(0, 5) options:RKMatchNoOptions], nil);
+    STAssertTrue(NSEqualRanges([automaticRegex rangeForCharacters:"abbbcbc" length:7 inRange:NSMakeRange(0, 7) captureIndex:0 options:RKMatchNoOptions], NSMakeRange(1, 4)), nil);
+  }
+  
+  // The DFA algorithm treats atomic groups and possessive quantifiers as ordinary ones, so regexes with them always backtrack.
+  RKRegex *atomicRegex = [RKRegex regexWithRegexString:@"(?>a|ab)c" options:RKCompileNoOptions], *possessiveRegex = [RKRegex regexWithRegexString:@"xa++a" options:RKCompileNoOptions];
+  STAssertNotNil(atomicRegex, nil); if(atomicRegex == nil) { return; }
+  STAssertNotNil(possessiveRegex, nil); if(possessiveRegex == nil) { return; }
+  [atomicRegex setMatchEngine:RKMatchEngineAutomatic];
+  [possessiveRegex setMatchEngine:RKMatchEngineAutomatic];
+  for(sample = 0; sample < 100; sample++) {
+    STAssertFalse([atomicRegex matchesCharacters:"abc" length:3 inRange:NSMakeRange(0, 3) options:RKMatchNoOptions], @"sample = %u", sample);
+    STAssertTrue([atomicRegex matchesCharacters:"xac" length:3 inRange:NSMakeRange(0, 3) options:RKMatchNoOptions], @"sample = %u", sample);
+    STAssertFalse([possessiveRegex matchesCharacters:"xaaa" length:4 inRange:NSMakeRange(0, 4) options:RKMatchNoOptions], @"sample = %u", sample);
+  }
+  STAssertTrue([atomicRegex getRanges:matchRanges withCharacters:"abc" length:3 inRange:NSMakeRange(0, 3) options:RKMatchDFA] == RKMatchErrorNoMatch, nil);
+  
+  // A DFA match started from a callout of another DFA match must not use, or free, the workspace of the outer match.
+  RKMatchContext *matchContext = [RKMatchContext matchContext];
+  RKRegex *calloutRegex = [RKRegex regexWithRegexString:@"a+(?C1)b+" options:RKCompileNoOptions];
+  int nestedCount = 0;
+  STAssertNotNil(calloutRegex, nil); if(calloutRegex == nil) { return; }
+  [matchContext setCalloutFunction:coreTestNestedDFAMatch context:&nestedCount];
+  STAssertTrue([calloutRegex getRangesInMatchContext:matchContext withCharacters:"xaaabbbx" length:8 inRange:NSMakeRange(0, 8) options:RKMatchDFA] == 1, nil);
+  STAssertTrue(NSEqualRanges([matchContext rangeForCaptureIndex:0], NSMakeRange(1, 6)), @"range: %@", NSStringFromRange([matchContext rangeForCaptureIndex:0]));
+  STAssertTrue(nestedCount > 0, nil);
+}
+
 
 
 - (void)testCaptureNameCornerCases
@@ -1060,4 +1401,36 @@
   STAssertNoThrow([unarchiver finishDecoding], nil);
 }
 
+- (void)testRegexMetrics
+{
+  NSEnumerator *metricsEnumerator = nil;
+  NSDictionary *regexMetrics = nil, *foundMetrics = nil;
+  NSString *regexString = @"metrics(\\d+)test";
+  
+  RKClearRegexMetrics();
+  RKSetRegexMetricsEnabled(YES);
+  STAssertTrue(RKRegexMetricsEnabled(), nil);
+  STAssertTrue([@"a metrics42test" isMatchedByRegex:regexString], nil);
+  STAssertTrue([@"b metrics23test" isMatchedByRegex:regexString], nil);
+  STAssertFalse([@"c metricstest" isMatchedByRegex:regexString], nil);
+  RKSetRegexMetricsEnabled(NO);
+  STAssertFalse(RKRegexMetricsEnabled(), nil);
+  STAssertTrue([@"d metrics5test" isMatchedByRegex:regexString], nil);
+
+  metricsEnumerator = [[RKRegexMetricsSnapshot() objectForKey:@"regexes"] objectEnumerator];
+  while((regexMetrics = [metricsEnumerator nextObject]) != nil) { if([[regexMetrics objectForKey:@"regex"] isEqualToString:regexString]) { foundMetrics = regexMetrics; } }
+  STAssertNotNil(foundMetrics, nil);
+  STAssertTrue([[foundMetrics objectForKey:@"matchCount"] unsignedIntValue] == 3, @"matchCount: %@", [foundMetrics objectForKey:@"matchCount"]);
+  STAssertTrue([[foundMetrics objectForKey:@"successfulMatchCount"] unsignedIntValue] == 2, @"successfulMatchCount: %@", [foundMetrics objectForKey:@"successfulMatchCount"]);
+  STAssertTrue([[foundMetrics objectForKey:@"errorCount"] unsignedIntValue] == 0, nil);
+  STAssertTrue([[foundMetrics objectForKey:@"bytesScanned"] unsignedIntValue] == 43, @"bytesScanned: %@", [foundMetrics objectForKey:@"bytesScanned"]);
+  STAssertTrue([[foundMetrics objectForKey:@"latencyHistogram"] count] > 0, nil);
+  
+  STAssertTrue([RKRegexMetricsTopRegexesByMatchTime(1) count] == 1, nil);
+  STAssertTrue([RKRegexMetricsJSONString() rangeOfString:@"\"regex\":\"metrics(\\\\d+)test\""].location != NSNotFound, @"%@", RKRegexMetricsJSONString());
+  
+  RKClearRegexMetrics();
+  STAssertTrue([[RKRegexMetricsSnapshot() objectForKey:@"regexes"] count] == 0, nil);
+}
+
 @end
@@ -312,6 +312,42 @@
   STAssertTrue(matchRanges == NULL, nil);
 }
 
-
+- (void)testComponentsSeparatedByRegex
+{
+  NSString *unicodeString = [NSString stringWithUTF8String:"\xC3\xA9t\xC3\xA9 \xE2\x80\x94 hiver"], *unicodeRegex = [NSString stringWithUTF8String:"\\s*\xE2\x80\x94\\s*"];
+  NSArray *components = nil, *concurrentComponents = nil;
+  NSRange *componentRanges = NULL;
+  RKUInteger componentsCount = 0;
+  
+  STAssertNoThrow(components = [@"a, b,,c ,d" componentsSeparatedByRegex:@"\\s*,\\s*"], nil);
+  STAssertTrue([components isEqualToArray:[NSArray arrayWithObjects:@"a", @"b", @"c", @"d", NULL]], @"components = %@", components);
+  STAssertNoThrow(components = [@",a,,b," componentsSeparatedByRegex:@"," limit:0 options:RKSplitKeepEmptyComponents], nil);
+  STAssertTrue([components isEqualToArray:[NSArray arrayWithObjects:@"", @"a", @"", @"b", @"", NULL]], @"components = %@", components);
+  STAssertNoThrow(components = [@"a:b:c:d" componentsSeparatedByRegex:@":" limit:2 options:RKSplitNoOptions], nil);
+  STAssertTrue([components isEqualToArray:[NSArray arrayWithObjects:@"a", @"b:c:d", NULL]], @"components = %@", components);
+  STAssertNoThrow(components = [@"abc" componentsSeparatedByRegex:@""], nil);
+  STAssertTrue([components isEqualToArray:[NSArray arrayWithObjects:@"a", @"b", @"c", NULL]], @"components = %@", components);
+  STAssertNoThrow(components = [@"" componentsSeparatedByRegex:@","], nil);
+  STAssertTrue([components count] == 0, @"components = %@", components);
+  
+  STAssertNoThrow(components = [unicodeString componentsSeparatedByRegex:unicodeRegex limit:0 options:RKSplitSubstringComponents], nil);
+  STAssertTrue([components count] == 2, @"components = %@", components);
+  STAssertTrue([[components objectAtIndex:0] isKindOfClass:[RKSubstring class]], nil);
+  STAssertTrue([[components objectAtIndex:0] isEqualToString:[NSString stringWithUTF8String:"\xC3\xA9t\xC3\xA9"]] && [[components objectAtIndex:1] isEqualToString:@"hiver"], @"components = %@", components);
+  
+  STAssertNoThrow(componentRanges = [unicodeString rangesOfComponentsSeparatedByRegex:unicodeRegex inRange:NSMakeRange(0, 11) limit:0 options:RKSplitNoOptions count:&componentsCount concurrent:NO error:NULL], nil);
+  STAssertTrue((componentRanges != NULL) && (componentsCount == 2), @"componentsCount = %u", componentsCount); if(componentRanges == NULL) { return; }
+  STAssertTrue(NSEqualRanges(componentRanges[0], NSMakeRange(0, 3)) && NSEqualRanges(componentRanges[1], NSMakeRange(6, 5)), @"%@ %@", NSStringFromRange(componentRanges[0]), NSStringFromRange(componentRanges[1]));
+  
+  NSMutableString *largeString = [NSMutableString string];
+  for(RKUInteger x = 0; x < 40000; x++) { [largeString appendFormat:@"field%u%@", (unsigned int)x, ((x % 7) == 0) ? @" ;; " : @";"]; }
+  STAssertNoThrow(components = [largeString componentsSeparatedByRegex:@"\\s*;+\\s*" inRange:NSMakeRange(0, [largeString length]) limit:0 options:RKSplitNoOptions concurrent:NO error:NULL], nil);
+  STAssertNoThrow(concurrentComponents = [largeString componentsSeparatedByRegex:@"\\s*;+\\s*" inRange:NSMakeRange(0, [largeString length]) limit:0 options:RKSplitNoOptions concurrent:YES error:NULL], nil);
+  STAssertTrue([components count] == 40000, @"count = %u", [components count]);
+  STAssertTrue([components isEqualToArray:concurrentComponents], nil);
+  
+  STAssertThrowsSpecificNamed([@"a,b" componentsSeparatedByRegex:@"," inRange:NSMakeRange(2, 16) limit:0 options:RKSplitNoOptions concurrent:NO error:NULL], NSException, NSRangeException, nil);
+  STAssertThrowsSpecificNamed([@"a,b" rangesOfComponentsSeparatedByRegex:@"," inRange:NSMakeRange(0, 3) limit:0 options:RKSplitNoOptions count:NULL concurrent:NO error:NULL], NSException, NSInvalidArgumentException, nil);
+}
 
 @end
@@ -40,6 +40,31 @@
 
 #import "multithreading.h"
 #import "RegexKitPrivateAtomic.h"
+#import <dlfcn.h>
+
+// Shared by the RKReadWriteLock tests and the threads they start.
+typedef struct {
+  RKReadWriteLock         *lock;
+  RKReadWriteLockStrategy  holdStrategy;
+  unsigned int             iterations;
+  unsigned int             writerEvery;
+  volatile RKInteger       startedThreads;
+  volatile RKInteger       finishedThreads;
+  volatile RKInteger       readersInside;
+  volatile RKInteger       writersInside;
+  volatile RKInteger       violations;
+  volatile RKInteger       held;
+  volatile RKInteger       release;
+  unsigned int             holdMicroseconds;
+  RKInteger                writes;
+} RKReadWriteLockTestState;
+
+// Polls until *count reaches waitForCount, returns NO if that takes longer than timeout seconds.
+static BOOL RKWaitForCount(volatile RKInteger *count, const RKInteger waitForCount, const NSTimeInterval timeout) {
+  NSTimeInterval giveUpAt = [NSDate timeIntervalSinceReferenceDate] + timeout;
+  while(*count != waitForCount) { if([NSDate timeIntervalSinceReferenceDate] > giveUpAt) { return(NO); } usleep(1000); }
+  return(YES);
+}
 
 @implementation multithreading
 
@@ -2402,5 +2427,218 @@ exitNow:
 }
 
 
+- (void)readWriteLockWorker:(NSValue *)stateValue
+{
+  NSAutoreleasePool *threadPool = [[NSAutoreleasePool alloc] init];
+  RKReadWriteLockTestState *state = [stateValue pointerValue];
+  RKInteger threadNumber = RKAtomicIncrementInteger(&state->startedThreads);
+  unsigned int x = 0;
+
+  for(x = 0; x < state->iterations; x++) {
+    if(((x + (unsigned int)threadNumber) % state->writerEvery) == 0) {
+      [state->lock writeLock];
+      if((RKAtomicIncrementIntegerBarrier(&state->writersInside) != 1) || (state->readersInside != 0)) { RKAtomicIncrementInteger(&state->violations); }
+      state->writes++;
+      RKAtomicDecrementIntegerBarrier(&state->writersInside);
+      [state->lock unlock];
+    } else {
+      [state->lock readLock];
+      RKAtomicIncrementIntegerBarrier(&state->readersInside);
+      if(state->writersInside != 0) { RKAtomicIncrementInteger(&state->violations); }
+      RKAtomicDecrementIntegerBarrier(&state->readersInside);
+      [state->lock unlock];
+    }
+  }
+
+  RKAtomicIncrementIntegerBarrier(&state->finishedThreads);
+  [threadPool release];
+}
+
+- (void)readWriteLockHolder:(NSValue *)stateValue
+{
+  NSAutoreleasePool *threadPool = [[NSAutoreleasePool alloc] init];
+  RKReadWriteLockTestState *state = [stateValue pointerValue];
+  
+  [state->lock lockWithStrategy:state->holdStrategy lockLevelAcquired:NULL];
+  RKAtomicIncrementIntegerBarrier(&state->held);
+  if(state->holdMicroseconds != 0) { usleep(state->holdMicroseconds); } else { while(state->release == 0) { usleep(1000); } }
+  [state->lock unlock];
+  RKAtomicDecrementIntegerBarrier(&state->held);
+  
+  [threadPool release];
+}
+
+- (void)readWriteLockConcurrency:(const BOOL)distributeReaders
+{
+  RKReadWriteLockTestState state;
+  RKInteger totalThreads = 8, x = 0;
+
+  memset(&state, 0, sizeof(RKReadWriteLockTestState));
+  state.lock        = [[[objc_getClass("RKReadWriteLock") alloc] initWithDistributedReaders:distributeReaders] autorelease];
+  state.iterations  = 20000;
+  state.writerEvery = 16;
+
+  STAssertNotNil(state.lock, nil);
+  STAssertTrue([state.lock hasDistributedReaders] == distributeReaders, nil);
+
+  for(x = 0; x < totalThreads; x++) { [NSThread detachNewThreadSelector:@selector(readWriteLockWorker:) toTarget:self withObject:[NSValue valueWithPointer:&state]]; }
+
+  // A timeout here is most likely a writer that never woke up after the readers drained.
+  STAssertTrue(RKWaitForCount(&state.finishedThreads, totalThreads, 60.0), @"Only %ld of %ld threads finished.", (long)state.finishedThreads, (long)totalThreads);
+  if(state.finishedThreads != totalThreads) { return; } // The threads are still using state, leaking it is the lesser evil.
+  STAssertTrue(state.violations == 0, @"violations: %ld", (long)state.violations);
+  STAssertTrue(state.writes == ((RKInteger)(state.iterations / state.writerEvery) * totalThreads), @"writes: %ld", (long)state.writes);
+}
+
+- (void)readWriteLockTryStrategies:(const BOOL)distributeReaders
+{
+  RKReadWriteLockTestState state;
+  RKReadWriteLockStrategy lockLevelAcquired = RKLockDidNotLock;
+
+  memset(&state, 0, sizeof(RKReadWriteLockTestState));
+  state.lock = [[[objc_getClass("RKReadWriteLock") alloc] initWithDistributedReaders:distributeReaders] autorelease];
+  STAssertNotNil(state.lock, nil);
+  [state.lock setDebug:YES];
+
+  // Uncontended, every strategy gets the level it asked for first.
+  STAssertTrue([state.lock lockWithStrategy:RKLockTryForWriting lockLevelAcquired:&lockLevelAcquired], nil);
+  STAssertTrue(lockLevelAcquired == RKLockForWriting, @"lockLevelAcquired: %ld", (long)lockLevelAcquired);
+  [state.lock unlock];
+  STAssertTrue([state.lock lockWithStrategy:RKLockTryForWritingThenForReading lockLevelAcquired:&lockLevelAcquired], nil);
+  STAssertTrue(lockLevelAcquired == RKLockForWriting, @"lockLevelAcquired: %ld", (long)lockLevelAcquired);
+  [state.lock unlock];
+  STAssertTrue([state.lock lockWithStrategy:RKLockTryForReading lockLevelAcquired:&lockLevelAcquired], nil);
+  STAssertTrue(lockLevelAcquired == RKLockForReading, @"lockLevelAcquired: %ld", (long)lockLevelAcquired);
+  [state.lock unlock];
+  STAssertTrue([state.lock writeBusyCount] == 0, nil);
+  STAssertTrue([state.lock readBusyCount]  == 0, nil);
+
+  // Another thread holds a read lock, writing is refused but reading is not.
+  state.holdStrategy = RKLockForReading;
+  [NSThread detachNewThreadSelector:@selector(readWriteLockHolder:) toTarget:self withObject:[NSValue valueWithPointer:&state]];
+  STAssertTrue(RKWaitForCount(&state.held, 1, 10.0), nil);
+  [state.lock clearCounters];
+
+  STAssertFalse([state.lock lockWithStrategy:RKLockTryForWriting lockLevelAcquired:&lockLevelAcquired], nil);
+  STAssertTrue(lockLevelAcquired == RKLockDidNotLock, @"lockLevelAcquired: %ld", (long)lockLevelAcquired);
+  STAssertTrue([state.lock writeBusyCount] >= 1, nil);
+  STAssertTrue([state.lock lockWithStrategy:RKLockTryForWritingThenForReading lockLevelAcquired:&lockLevelAcquired], nil);
+  STAssertTrue(lockLevelAcquired == RKLockForReading, @"lockLevelAcquired: %ld", (long)lockLevelAcquired);
+  [state.lock unlock];
+  STAssertTrue([state.lock lockWithStrategy:RKLockTryForWritingThenTryForReading lockLevelAcquired:&lockLevelAcquired], nil);
+  STAssertTrue(lockLevelAcquired == RKLockForReading, @"lockLevelAcquired: %ld", (long)lockLevelAcquired);
+  [state.lock unlock];
+  STAssertTrue([state.lock lockWithStrategy:RKLockTryForReading lockLevelAcquired:&lockLevelAcquired], nil);
+  STAssertTrue(lockLevelAcquired == RKLockForReading, @"lockLevelAcquired: %ld", (long)lockLevelAcquired);
+  [state.lock unlock];
+  STAssertTrue([state.lock readDowngradedFromWriteCount] == 2, @"readDowngradedFromWriteCount: %lu", (unsigned long)[state.lock readDowngradedFromWriteCount]);
+
+  state.release = 1;
+  STAssertTrue(RKWaitForCount(&state.held, 0, 10.0), nil);
+  state.release = 0;
+
+  // Another thread holds a write lock, nothing can be acquired without waiting.
+  state.holdStrategy = RKLockForWriting;
+  [NSThread detachNewThreadSelector:@selector(readWriteLockHolder:) toTarget:self withObject:[NSValue valueWithPointer:&state]];
+  STAssertTrue(RKWaitForCount(&state.held, 1, 10.0), nil);
+  [state.lock clearCounters];
+
+  STAssertFalse([state.lock lockWithStrategy:RKLockTryForReading lockLevelAcquired:&lockLevelAcquired], nil);
+  STAssertTrue(lockLevelAcquired == RKLockDidNotLock, @"lockLevelAcquired: %ld", (long)lockLevelAcquired);
+  STAssertTrue([state.lock readBusyCount] >= 1, nil);
+  STAssertFalse([state.lock lockWithStrategy:RKLockTryForWriting lockLevelAcquired:&lockLevelAcquired], nil);
+  STAssertFalse([state.lock lockWithStrategy:RKLockTryForWritingThenTryForReading lockLevelAcquired:&lockLevelAcquired], nil);
+  STAssertTrue(lockLevelAcquired == RKLockDidNotLock, @"lockLevelAcquired: %ld", (long)lockLevelAcquired);
+  STAssertTrue([state.lock writeBusyCount] >= 2, nil);
+
+  state.release = 1;
+  STAssertTrue(RKWaitForCount(&state.held, 0, 10.0), nil);
+  state.release = 0;
+  
+  // With this thread holding a read lock, a writer in another thread has to wait for it to drain before it can continue.
+  [state.lock clearCounters];
+  STAssertTrue([state.lock readLock], nil);
+  [NSThread detachNewThreadSelector:@selector(readWriteLockHolder:) toTarget:self withObject:[NSValue valueWithPointer:&state]];
+  usleep(100000);
+  STAssertTrue(state.held == 0, nil);
+  [state.lock unlock];
+  STAssertTrue(RKWaitForCount(&state.held, 1, 10.0), nil);
+  if(distributeReaders == YES) { STAssertTrue([state.lock writeSpinCount] >= 1, @"writeSpinCount: %lu", (unsigned long)[state.lock writeSpinCount]); }
+  else                         { STAssertTrue([state.lock writeBusyCount] >= 1, @"writeBusyCount: %lu", (unsigned long)[state.lock writeBusyCount]); }
+  state.release = 1;
+  STAssertTrue(RKWaitForCount(&state.held, 0, 10.0), nil);
+}
+
+- (void)readWriteLockProfile:(const BOOL)distributeReaders
+{
+  RKReadWriteLockTestState state;
+  BOOL wasEnabled = RKLockProfilingEnabled(), foundProfile = NO;
+  NSString *sixtyOneString = [@"" stringByPaddingToLength:61 withString:@"a" startingAtIndex:0], *profileName = NULL;
+  NSDictionary *profile = NULL, *callSiteProfile = NULL;
+  NSEnumerator *profileEnumerator = NULL;
+  unsigned long long callSite = 0;
+  Dl_info callSiteInfo;
+
+  memset(&state, 0, sizeof(RKReadWriteLockTestState));
+  state.lock = [[[objc_getClass("RKReadWriteLock") alloc] initWithDistributedReaders:distributeReaders] autorelease];
+  STAssertNotNil(state.lock, nil);
+  RKSetLockProfilingEnabled(YES);
+
+  // The name is limited to 63 UTF8 bytes.  A two byte character that fits is kept, one that would be cut in half is dropped.
+  profileName = [NSString stringWithFormat:@"%@%C", sixtyOneString, (unichar)0x00E9];
+  [state.lock setProfileName:profileName];
+  STAssertTrue([[[state.lock profile] objectForKey:@"name"] isEqualToString:profileName], @"name: %@", [[state.lock profile] objectForKey:@"name"]);
+  [state.lock setProfileName:[NSString stringWithFormat:@"a%@", profileName]];
+  STAssertTrue([[[state.lock profile] objectForKey:@"name"] isEqualToString:[NSString stringWithFormat:@"a%@", sixtyOneString]], @"name: %@", [[state.lock profile] objectForKey:@"name"]);
+  [state.lock setProfileName:@"readWriteLockProfile"];
+
+  profileEnumerator = [RKLockProfiles() objectEnumerator];
+  while((profile = [profileEnumerator nextObject]) != NULL) { if([[profile objectForKey:@"name"] isEqualToString:@"readWriteLockProfile"]) { foundProfile = YES; } }
+  STAssertTrue(foundProfile == YES, nil);
+
+  // Another thread holds the write lock for a tenth of a second, so the read lock below has to wait for it.
+  [state.lock clearProfile];
+  state.holdStrategy     = RKLockForWriting;
+  state.holdMicroseconds = 100000;
+  [NSThread detachNewThreadSelector:@selector(readWriteLockHolder:) toTarget:self withObject:[NSValue valueWithPointer:&state]];
+  STAssertTrue(RKWaitForCount(&state.held, 1, 10.0), nil);
+  STAssertTrue([state.lock readLock], nil);
+  [state.lock unlock];
+  STAssertTrue(RKWaitForCount(&state.held, 0, 10.0), nil);
+
+  profile = [state.lock profile];
+  RKSetLockProfilingEnabled(wasEnabled);
+  STAssertTrue([[profile objectForKey:@"acquiredCount"]  unsignedLongValue] >= 2, @"profile: %@", profile);
+  STAssertTrue([[profile objectForKey:@"contendedCount"] unsignedLongValue] >= 1, @"profile: %@", profile);
+  STAssertTrue([[profile objectForKey:@"callSites"] count] >= 1, @"profile: %@", profile);
+  if([[profile objectForKey:@"callSites"] count] < 1) { return; }
+
+  // The call site is the code that asked for the lock, -readLock or this method if -readLock was a tail call, and not a helper in RKLock.m.
+  callSiteProfile = [[profile objectForKey:@"callSites"] objectAtIndex:0];
+  [[NSScanner scannerWithString:[[callSiteProfile objectForKey:@"callSite"] substringFromIndex:[[callSiteProfile objectForKey:@"callSite"] rangeOfString:@"0x" options:NSBackwardsSearch].location]] scanHexLongLong:&callSite];
+  STAssertTrue(dladdr((void *)(uintptr_t)callSite, &callSiteInfo) != 0, @"callSite: %@", callSiteProfile);
+  STAssertTrue((callSiteInfo.dli_saddr == (void *)[state.lock methodForSelector:@selector(readLock)]) || (callSiteInfo.dli_saddr == (void *)[self methodForSelector:_cmd]), @"callSite: %@", callSiteProfile);
+}
+
+- (void)testLockProfile
+{
+  [objc_getClass("RKReadWriteLock") setMultithreaded:YES];
+  [self readWriteLockProfile:NO];
+  [self readWriteLockProfile:YES];
+}
+
+- (void)testReadWriteLock
+{
+  [objc_getClass("RKReadWriteLock") setMultithreaded:YES];
+  [self readWriteLockConcurrency:NO];
+  [self readWriteLockTryStrategies:NO];
+}
+
+- (void)testDistributedReadWriteLock
+{
+  [objc_getClass("RKReadWriteLock") setMultithreaded:YES];
+  [self readWriteLockConcurrency:YES];
+  [self readWriteLockTryStrategies:YES];
+}
 
 @end
@@ -64,6 +64,90 @@
   //if(error) { NSLog(@"Error: %@", error); NSLog(@"userInfo: %@", [error userInfo]); } else { NSLog(@"No error."); }
 }
 
+- (void)testRKSortedRegexCollectionBackgroundResort
+{
+  NSArray *regexArray = [NSArray arrayWithObjects:@"cold", @"hot", NULL];
+  id sortedRegexCollectionClass = objc_getClass("RKSortedRegexCollection");
+  id sortedRegexCollection = [[[sortedRegexCollectionClass alloc] initWithCollection:regexArray] autorelease];
+  STAssertNotNil(sortedRegexCollection, nil); if(sortedRegexCollection == NULL) { return; }
+  
+  for(int x = 0; x < 200; x++) { STAssertNotNil([sortedRegexCollection anyRegexMatching:@"a hot one"], nil); }
+  
+  // The hit counts are exact, the resort happens in its own thread shortly after.
+  NSArray *sortedArray = [sortedRegexCollectionClass sortedArrayForSortedRegexCollection:sortedRegexCollection];
+  STAssertTrue([[sortedArray valueForKey:@"count"] containsObject:[NSNumber numberWithUnsignedLong:200]], @"sortedArray: %@", sortedArray);
+  
+  for(int x = 0; (x < 100) && ([[[[sortedArray objectAtIndex:0] objectForKey:@"element"] regexString] isEqualToString:@"hot"] == NO); x++) {
+    [NSThread sleepUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    [sortedRegexCollection anyRegexMatching:@"a hot one"];
+    sortedArray = [sortedRegexCollectionClass sortedArrayForSortedRegexCollection:sortedRegexCollection];
+  }
+  STAssertEqualObjects([[[sortedArray objectAtIndex:0] objectForKey:@"element"] regexString], @"hot", @"sortedArray: %@", sortedArray);
+}
+
+- (void)testRKSortedRegexCollectionStartBytes
+{
+  // Regexes that must start with a byte that is not in the subject are skipped.  The skipped regexes must never change the answer.
+  NSArray *regexArray = [NSArray arrayWithObjects:@"xyz", @"(?i)q", @"[0-9]+b", @"a*", @"^\\s*c", NULL];
+  id sortedRegexCollection = [[[objc_getClass("RKSortedRegexCollection") alloc] initWithCollection:regexArray] autorelease];
+  STAssertNotNil(sortedRegexCollection, nil); if(sortedRegexCollection == NULL) { return; }
+  
+  STAssertEqualObjects([[sortedRegexCollection firstRegexMatching:@"--Q--"] regexString], @"(?i)q", nil);
+  STAssertEqualObjects([[sortedRegexCollection firstRegexMatching:@"12b"] regexString], @"[0-9]+b", nil);
+  STAssertEqualObjects([[sortedRegexCollection firstRegexMatching:@"wxyz"] regexString], @"xyz", nil);
+  STAssertEqualObjects([[sortedRegexCollection firstRegexMatching:@"z"] regexString], @"a*", nil); // a* matches the empty string.
+  
+  NSArray *startArray = [NSArray arrayWithObjects:@"xyz", @"^\\s*c", NULL];
+  id startRegexCollection = [[[objc_getClass("RKSortedRegexCollection") alloc] initWithCollection:startArray] autorelease];
+  STAssertNotNil(startRegexCollection, nil); if(startRegexCollection == NULL) { return; }
+  STAssertEqualObjects([[startRegexCollection firstRegexMatching:@"  c"] regexString], @"^\\s*c", nil);
+  STAssertNil([startRegexCollection firstRegexMatching:@"yz"], nil);
+}
+
+- (void)testRKSortedRegexCollectionUnionMatching
+{
+  // The back reference in (a)\\1 can not be combined with the other regexes, so it is matched on its own.
+  NSArray *regexArray = [NSArray arrayWithObjects:@"zzz", @"(a)\\1", @"b+c", @"a", @"(?<name>q)", NULL];
+  id sortedRegexCollection = [[[objc_getClass("RKSortedRegexCollection") alloc] initWithCollection:regexArray] autorelease];
+  STAssertNotNil(sortedRegexCollection, nil); if(sortedRegexCollection == NULL) { return; }
+  
+  STAssertFalse([sortedRegexCollection unionMatching], nil);
+  [sortedRegexCollection setUnionMatching:YES];
+  STAssertTrue([sortedRegexCollection unionMatching], nil);
+  
+  // The lowest index in the collection wins, not the regex that matches earliest in the subject.
+  STAssertEqualObjects([[sortedRegexCollection firstRegexMatching:@"a bbc"] regexString], @"b+c", nil);
+  STAssertEqualObjects([[sortedRegexCollection firstRegexMatching:@"bbc aa"] regexString], @"(a)\\1", nil);
+  STAssertEqualObjects([[sortedRegexCollection firstRegexMatching:@"xzzzx"] regexString], @"zzz", nil);
+  STAssertEqualObjects([[sortedRegexCollection firstRegexMatching:@"xqx"] regexString], @"(?<name>q)", nil);
+  STAssertNotNil([sortedRegexCollection anyRegexMatching:@"-a-"], nil);
+  STAssertNil([sortedRegexCollection anyRegexMatching:@"xyz"], nil);
+  
+  [sortedRegexCollection setUnionMatching:NO];
+  STAssertEqualObjects([[sortedRegexCollection firstRegexMatching:@"a bbc"] regexString], @"b+c", nil);
+  STAssertNil([sortedRegexCollection anyRegexMatching:@"xyz"], nil);
+}
+
+- (void)testRKSortedRegexCollectionUnionMatchingDefault
+{
+  NSArray *regexArray = [NSArray arrayWithObjects:@"zzz", @"(a)\\1", @"b+c", @"a", NULL];
+  BOOL savedUnionMatching = RKCollectionUnionMatchingEnabled();
+  
+  RKSetCollectionUnionMatchingEnabled(YES);
+  STAssertTrue(RKCollectionUnionMatchingEnabled(), nil);
+  STAssertTrue([@"a bbc" isMatchedByAnyRegexInArray:regexArray], nil);
+  STAssertEqualObjects([[@"a bbc" firstMatchingRegexInArray:regexArray] regexString], @"b+c", nil);
+  STAssertTrue([[objc_getClass("RKSortedRegexCollection") sortedRegexCollectionForCollection:regexArray library:RKRegexPCRELibrary options:RKPCREDefaultOptions error:NULL] unionMatching], nil);
+  
+  // The cached collection follows the default the next time it is used.
+  RKSetCollectionUnionMatchingEnabled(NO);
+  STAssertFalse(RKCollectionUnionMatchingEnabled(), nil);
+  STAssertEqualObjects([[@"bbc aa" firstMatchingRegexInArray:regexArray] regexString], @"(a)\\1", nil);
+  STAssertFalse([[objc_getClass("RKSortedRegexCollection") sortedRegexCollectionForCollection:regexArray library:RKRegexPCRELibrary options:RKPCREDefaultOptions error:NULL] unionMatching], nil);
+  
+  RKSetCollectionUnionMatchingEnabled(savedUnionMatching);
+}
+
 - (void)testRKSortedRegexCollectionSimple
 {
   return;
@@ -108,6 +108,34 @@
   STAssertTrue(doubleValue == 140519025143472.0, @"double: %f", doubleValue);
 }
 
+- (void)testStringParseWideAndFloatingPointConversions
+{
+  long long longLongValue = 0;
+  longLongValue = 1; STAssertTrueNoThrow(([@"-9223372036854775808" getCapturesWithRegexAndReferences:@"(\\-?[0-9]+)", @"${1:%lld}", &longLongValue, nil] == YES), nil); STAssertTrue(longLongValue == (-9223372036854775807LL - 1LL), @"long long: %lld", longLongValue);
+  longLongValue = 1; STAssertTrueNoThrow(([@"1234567890123456789" getCapturesWithRegexAndReferences:@"(\\-?[0-9]+)", @"${1:%lld}", &longLongValue, nil] == YES), nil); STAssertTrue(longLongValue == 1234567890123456789LL, @"long long: %lld", longLongValue);
+  longLongValue = 1; STAssertTrueNoThrow(([@"99999999999999999999" getCapturesWithRegexAndReferences:@"(\\-?[0-9]+)", @"${1:%lld}", &longLongValue, nil] == YES), nil); STAssertTrue(longLongValue == 9223372036854775807LL, @"long long: %lld", longLongValue);
+  longLongValue = 1; STAssertTrueNoThrow(([@"0x7fffffffffffffff" getCapturesWithRegexAndReferences:@"(0x[0-9a-fA-F]+)", @"${1:%llx}", &longLongValue, nil] == YES), nil); STAssertTrue(longLongValue == 0x7fffffffffffffffLL, @"long long: %llx", longLongValue);
+  longLongValue = 1; STAssertTrueNoThrow(([@"0x10" getCapturesWithRegexAndReferences:@"(0x[0-9a-fA-F]+)", @"${1:%lli}", &longLongValue, nil] == YES), nil); STAssertTrue(longLongValue == 16LL, @"long long: %lld", longLongValue);
+  longLongValue = 1; STAssertTrueNoThrow(([@"017" getCapturesWithRegexAndReferences:@"([0-9]+)", @"${1:%qi}", &longLongValue, nil] == YES), nil); STAssertTrue(longLongValue == 15LL, @"long long: %lld", longLongValue);
+
+  short shortValue = 0;
+  shortValue = 1; STAssertTrueNoThrow(([@"-1234" getCapturesWithRegexAndReferences:@"(\\-?[0-9]+)", @"${1:%hd}", &shortValue, nil] == YES), nil); STAssertTrue(shortValue == -1234, @"short: %hd", shortValue);
+
+  double doubleValue = 0.0;
+  doubleValue = 1.0; STAssertTrueNoThrow(([@"-0.000125" getCapturesWithRegexAndReferences:@"(.*)", @"${1:%lf}", &doubleValue, nil] == YES), nil); STAssertTrue(doubleValue == -0.000125, @"double: %f", doubleValue);
+  doubleValue = 1.0; STAssertTrueNoThrow(([@"6.02214e23" getCapturesWithRegexAndReferences:@"(.*)", @"${1:%lf}", &doubleValue, nil] == YES), nil); STAssertTrue(doubleValue == 6.02214e23, @"double: %g", doubleValue);
+  doubleValue = 1.0; STAssertTrueNoThrow(([@"3.14159265358979323846264338327950288" getCapturesWithRegexAndReferences:@"(.*)", @"${1:%lf}", &doubleValue, nil] == YES), nil); STAssertTrue(doubleValue == 3.14159265358979323846264338327950288, @"double: %.17g", doubleValue);
+  doubleValue = 1.0; STAssertTrueNoThrow(([@"1.5e" getCapturesWithRegexAndReferences:@"(.*)", @"${1:%lf}", &doubleValue, nil] == YES), nil); STAssertTrue(doubleValue == 1.5, @"double: %f", doubleValue);
+  doubleValue = 1.0; STAssertTrueNoThrow(([@"-inf" getCapturesWithRegexAndReferences:@"(.*)", @"${1:%lf}", &doubleValue, nil] == YES), nil); STAssertTrue(doubleValue < -1.0e308, @"double: %f", doubleValue);
+
+  float floatValue = 0.0f;
+  floatValue = 1.0f; STAssertTrueNoThrow(([@"0.1" getCapturesWithRegexAndReferences:@"(.*)", @"${1:%f}", &floatValue, nil] == YES), nil); STAssertTrue(floatValue == 0.1f, @"float: %f", floatValue);
+  floatValue = 1.0f; STAssertTrueNoThrow(([@"16777217" getCapturesWithRegexAndReferences:@"(.*)", @"${1:%f}", &floatValue, nil] == YES), nil); STAssertTrue(floatValue == 16777216.0f, @"float: %f", floatValue);
+
+  NSNumber *numberValue = nil;
+  STAssertTrueNoThrow(([@"123456789012345" getCapturesWithRegexAndReferences:@"(.*)", @"${1:@n}", &numberValue, nil] == YES), nil); STAssertTrue([numberValue isEqualToNumber:[NSNumber numberWithLongLong:123456789012345LL]], @"number: %@", numberValue);
+}
+
 - (void)testStringParseBasicSyntax
 {
   NSString *subjectString = nil, *regexString = nil, *captured0String = nil, *captured1String = nil, *captured2String = nil;
@@ -469,6 +497,41 @@
 
 }
 
+- (void)testStringParseFixedFormatConvertToDate
+{
+  id dateCapture = nil, secondDateCapture = nil;
+  
+  STAssertNoThrow(([@"2008-01-31T12:34:56Z" getCapturesWithRegexAndReferences:@"(.*)", @"${1:@d}", &dateCapture, nil]), nil);
+  STAssertTrue(dateCapture != nil, nil);
+  STAssertTrue([dateCapture timeIntervalSince1970] == 1201782896.0, [NSString stringWithFormat:@"timeIntervalSince1970 == %f", [dateCapture timeIntervalSince1970]]);
+  STAssertTrue([dateCapture hourOfDay] == 12, [NSString stringWithFormat:@"hourOfDay == %d", [dateCapture hourOfDay]]);
+  
+  dateCapture = nil;
+  STAssertNoThrow(([@"2008-01-31T12:34:56.5+05:30" getCapturesWithRegexAndReferences:@"(.*)", @"${1:@d}", &dateCapture, nil]), nil);
+  STAssertTrue(dateCapture != nil, nil);
+  STAssertTrue([dateCapture timeIntervalSince1970] == 1201763096.5, [NSString stringWithFormat:@"timeIntervalSince1970 == %f", [dateCapture timeIntervalSince1970]]);
+  STAssertTrue([dateCapture minuteOfHour] == 34, [NSString stringWithFormat:@"minuteOfHour == %d", [dateCapture minuteOfHour]]);
+
+  // Same minute, so the second conversion comes from the per thread cache.
+  dateCapture = nil;
+  STAssertNoThrow(([@"[31/Jan/2008:12:34:56 -0800] [31/Jan/2008:12:34:58 -0800]" getCapturesWithRegexAndReferences:@"\\[([^\\]]*)\\] \\[([^\\]]*)\\]", @"${1:@d}", &dateCapture, @"${2:@d}", &secondDateCapture, nil]), nil);
+  STAssertTrue((dateCapture != nil) && (secondDateCapture != nil), nil);
+  STAssertTrue([dateCapture timeIntervalSince1970] == 1201811696.0, [NSString stringWithFormat:@"timeIntervalSince1970 == %f", [dateCapture timeIntervalSince1970]]);
+  STAssertTrue([secondDateCapture timeIntervalSinceDate:dateCapture] == 2.0, [NSString stringWithFormat:@"timeIntervalSinceDate == %f", [secondDateCapture timeIntervalSinceDate:dateCapture]]);
+  STAssertTrue([[dateCapture timeZone] secondsFromGMT] == -28800, [NSString stringWithFormat:@"secondsFromGMT == %d", [[dateCapture timeZone] secondsFromGMT]]);
+  
+  dateCapture = nil;
+  STAssertNoThrow(([@"Feb  5 01:02:03" getCapturesWithRegexAndReferences:@"(.*)", @"${1:@d}", &dateCapture, nil]), nil);
+  STAssertTrue(dateCapture != nil, nil);
+  STAssertTrue([dateCapture monthOfYear] == 2, [NSString stringWithFormat:@"monthOfYear == %d", [dateCapture monthOfYear]]);
+  STAssertTrue([dateCapture dayOfMonth] == 5, [NSString stringWithFormat:@"dayOfMonth == %d", [dateCapture dayOfMonth]]);
+  STAssertTrue([dateCapture hourOfDay] == 1, [NSString stringWithFormat:@"hourOfDay == %d", [dateCapture hourOfDay]]);
+  STAssertTrue([dateCapture secondOfMinute] == 3, [NSString stringWithFormat:@"secondOfMinute == %d", [dateCapture secondOfMinute]]);
+  STAssertTrue([dateCapture yearOfCommonEra] == [[NSCalendarDate calendarDate] yearOfCommonEra], [NSString stringWithFormat:@"yearOfCommonEra == %d", [dateCapture yearOfCommonEra]]);
+
+}
+
+
 - (void)testStringParseNamedConvertToDate
 {
   id dateCapture = nil;
@@ -502,4 +565,40 @@
   STAssertTrue([[dateCapture timeZone] isEqualToTimeZone:[NSTimeZone timeZoneWithAbbreviation:@"EDT"]] == YES, [NSString stringWithFormat:@"timeZone name: %@, abbreviation: %@", [[dateCapture timeZone] name], [[dateCapture timeZone] abbreviation]]);
 }
 
+- (void)testStringParseConvertToSubstring
+{
+  NSString *subjectString = @"name: alpha, value: 42", *mutableSubjectString = [NSMutableString stringWithString:subjectString];
+  RKSubstring *nameSubstring = nil, *valueSubstring = nil;
+
+  STAssertTrueNoThrow(([subjectString getCapturesWithRegexAndReferences:@"name: (?<name>\\w+), value: (\\d+)", @"${name:@s}", &nameSubstring, @"${2:@s}", &valueSubstring, nil] == YES), nil);
+  STAssertTrue([nameSubstring isKindOfClass:[RKSubstring class]], @"class: %@", [nameSubstring class]);
+  STAssertTrue([nameSubstring isEqualToString:@"alpha"], @"String: %@", nameSubstring);
+  STAssertTrue([valueSubstring isEqualToString:@"42"], @"String: %@", valueSubstring);
+  STAssertTrue([valueSubstring intValue] == 42, nil);
+  STAssertTrue([nameSubstring hash] == [@"alpha" hash], nil);
+  STAssertTrue([nameSubstring copy] == nameSubstring, nil); [nameSubstring release];
+  STAssertTrue([[nameSubstring stringByCopyingCharacters] isEqualToString:@"alpha"], nil);
+  STAssertTrue([[nameSubstring noCopyString] isEqualToString:@"alpha"], nil);
+
+  // The characters of a mutable subject are copied, so mutating it does not change the substring.
+  STAssertTrueNoThrow(([mutableSubjectString getCapturesWithRegexAndReferences:@"name: (?<name>\\w+)", @"${name:@s}", &nameSubstring, nil] == YES), nil);
+  [(NSMutableString *)mutableSubjectString setString:@"name: omega"];
+  STAssertTrue([nameSubstring isEqualToString:@"alpha"], @"String: %@", nameSubstring);
+
+  NSMutableString *mutableCopy = [[nameSubstring mutableCopy] autorelease];
+  [mutableCopy appendString:@"bet"];
+  STAssertTrue([mutableCopy isEqualToString:@"alphabet"], @"String: %@", mutableCopy);
+
+  subjectString = [NSString stringWithUTF8String:"caf\xC3\xA9 cr\xC3\xA8me"];
+  STAssertTrueNoThrow(([subjectString getCapturesWithRegexAndReferences:@"(\\S+) (\\S+)", @"${2:@s}", &nameSubstring, nil] == YES), nil);
+  STAssertTrue([nameSubstring length] == 5, @"length: %lu", (unsigned long)[nameSubstring length]);
+  STAssertTrue([nameSubstring isEqualToString:[NSString stringWithUTF8String:"cr\xC3\xA8me"]], @"String: %@", nameSubstring);
+  STAssertTrue([[RKSubstring substringWithString:subjectString range:NSMakeRange(5, 5)] isEqualToString:nameSubstring], nil);
+  STAssertThrowsSpecificNamed([RKSubstring substringWithString:subjectString range:NSMakeRange(5, 6)], NSException, NSRangeException, nil);
+
+  RKEnumerator *matchEnumerator = [subjectString matchEnumeratorWithRegex:@"(\\S+)"];
+  STAssertNotNil([matchEnumerator nextRanges], nil);
+  STAssertTrue([[matchEnumerator currentSubstringForCapture:1] isEqualToString:[NSString stringWithUTF8String:"caf\xC3\xA9"]], nil);
+}
+
 @end
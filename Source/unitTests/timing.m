@@ -582,6 +582,140 @@ exitNow:
   [timingResultsArray addObject:[NSString stringWithFormat:@"%-45.45s | CPU: %@  %u iterations, per: U %9.5fus, S %9.5fus, U+S %9.5fus", [NSStringFromSelector(_cmd) UTF8String], [NSDate stringFromCPUTime:elapsedTime], x, ((elapsedTime.userCPUTime / (double)x)), ((elapsedTime.systemCPUTime / (double)x)), ((elapsedTime.CPUTime / (double)x))]];
 }
 
+- (void)testConvertLongLongRegexConversion
+{
+  if([timingEnvString intValue] < 1) { return; }
+  RKCPUTime startTime = [NSDate cpuTimeUsed];
+  unsigned int x = 0;
+  NSString *regexString = @"(\\d+)";
+  NSString *subjectString = @"1234567890123";
+  RKRegex *regex = [RKRegex regexWithRegexString:regexString options:(RKCompileUTF8 | RKCompileNoUTF8Check)];
+  
+  for(x = 0; x < iterations; x++) {
+    long long converted = 0;
+    [subjectString getCapturesWithRegexAndReferences:regex, @"${1:%lld}", &converted, nil];
+    if(converted != 1234567890123LL) {
+      NSLog(@"Converted value not expected value of 1234567890123, is %lld", converted);
+      break;
+    }
+  }
+  
+  RKCPUTime elapsedTime = [NSDate differenceOfStartingTime:startTime endingTime:[NSDate cpuTimeUsed]];
+  [timingResultsArray addObject:[NSString stringWithFormat:@"%-45.45s | CPU: %@  %u iterations, per: U %9.5fus, S %9.5fus, U+S %9.5fus", [NSStringFromSelector(_cmd) UTF8String], [NSDate stringFromCPUTime:elapsedTime], x, ((elapsedTime.userCPUTime / (double)x)), ((elapsedTime.systemCPUTime / (double)x)), ((elapsedTime.CPUTime / (double)x))]];
+}
+
+- (void)testConvertHexLongLongRegexConversion
+{
+  if([timingEnvString intValue] < 1) { return; }
+  RKCPUTime startTime = [NSDate cpuTimeUsed];
+  unsigned int x = 0;
+  NSString *regexString = @"(0x[0-9a-fA-F]+)";
+  NSString *subjectString = @"0x1234abcd5678";
+  RKRegex *regex = [RKRegex regexWithRegexString:regexString options:(RKCompileUTF8 | RKCompileNoUTF8Check)];
+  
+  for(x = 0; x < iterations; x++) {
+    unsigned long long converted = 0;
+    [subjectString getCapturesWithRegexAndReferences:regex, @"${1:%llx}", &converted, nil];
+    if(converted != 0x1234abcd5678ULL) {
+      NSLog(@"Converted value not expected value of 0x1234abcd5678, is %llx", converted);
+      break;
+    }
+  }
+  
+  RKCPUTime elapsedTime = [NSDate differenceOfStartingTime:startTime endingTime:[NSDate cpuTimeUsed]];
+  [timingResultsArray addObject:[NSString stringWithFormat:@"%-45.45s | CPU: %@  %u iterations, per: U %9.5fus, S %9.5fus, U+S %9.5fus", [NSStringFromSelector(_cmd) UTF8String], [NSDate stringFromCPUTime:elapsedTime], x, ((elapsedTime.userCPUTime / (double)x)), ((elapsedTime.systemCPUTime / (double)x)), ((elapsedTime.CPUTime / (double)x))]];
+}
+
+- (void)testConvertDoubleRegexConversion
+{
+  if([timingEnvString intValue] < 1) { return; }
+  RKCPUTime startTime = [NSDate cpuTimeUsed];
+  unsigned int x = 0;
+  NSString *regexString = @"(\\d+\\.\\d+)";
+  NSString *subjectString = @"12345.678";
+  RKRegex *regex = [RKRegex regexWithRegexString:regexString options:(RKCompileUTF8 | RKCompileNoUTF8Check)];
+  
+  for(x = 0; x < iterations; x++) {
+    double converted = 0;
+    [subjectString getCapturesWithRegexAndReferences:regex, @"${1:%lf}", &converted, nil];
+    if(converted != 12345.678) {
+      NSLog(@"Converted value not expected value of 12345.678, is %f", converted);
+      break;
+    }
+  }
+  
+  RKCPUTime elapsedTime = [NSDate differenceOfStartingTime:startTime endingTime:[NSDate cpuTimeUsed]];
+  [timingResultsArray addObject:[NSString stringWithFormat:@"%-45.45s | CPU: %@  %u iterations, per: U %9.5fus, S %9.5fus, U+S %9.5fus", [NSStringFromSelector(_cmd) UTF8String], [NSDate stringFromCPUTime:elapsedTime], x, ((elapsedTime.userCPUTime / (double)x)), ((elapsedTime.systemCPUTime / (double)x)), ((elapsedTime.CPUTime / (double)x))]];
+}
+
+- (void)testConvertFloatRegexConversion
+{
+  if([timingEnvString intValue] < 1) { return; }
+  RKCPUTime startTime = [NSDate cpuTimeUsed];
+  unsigned int x = 0;
+  NSString *regexString = @"(\\d+\\.\\d+)";
+  NSString *subjectString = @"234335.125";
+  RKRegex *regex = [RKRegex regexWithRegexString:regexString options:(RKCompileUTF8 | RKCompileNoUTF8Check)];
+  
+  for(x = 0; x < iterations; x++) {
+    float converted = 0;
+    [subjectString getCapturesWithRegexAndReferences:regex, @"${1:%f}", &converted, nil];
+    if(converted != 234335.125f) {
+      NSLog(@"Converted value not expected value of 234335.125, is %f", converted);
+      break;
+    }
+  }
+  
+  RKCPUTime elapsedTime = [NSDate differenceOfStartingTime:startTime endingTime:[NSDate cpuTimeUsed]];
+  [timingResultsArray addObject:[NSString stringWithFormat:@"%-45.45s | CPU: %@  %u iterations, per: U %9.5fus, S %9.5fus, U+S %9.5fus", [NSStringFromSelector(_cmd) UTF8String], [NSDate stringFromCPUTime:elapsedTime], x, ((elapsedTime.userCPUTime / (double)x)), ((elapsedTime.systemCPUTime / (double)x)), ((elapsedTime.CPUTime / (double)x))]];
+}
+
+- (void)testConvertDoublesscanfBase
+{
+  if([timingEnvString intValue] < 1) { return; }
+  RKCPUTime startTime = [NSDate cpuTimeUsed];
+  unsigned int x = 0;
+  const char *subjectString = [[NSString stringWithString:@"12345.678"] UTF8String];
+  
+  for(x = 0; x < iterations; x++) {
+    double convertedDouble = 0.0;
+    sscanf(subjectString, "%lf", &convertedDouble);
+    if(convertedDouble != 12345.678) {
+      NSLog(@"Converted double not expected value of 12345.678, is %f", convertedDouble);
+      break;
+    }
+  }
+  
+  RKCPUTime elapsedTime = [NSDate differenceOfStartingTime:startTime endingTime:[NSDate cpuTimeUsed]];
+  [timingResultsArray addObject:[NSString stringWithFormat:@"%-45.45s | CPU: %@  %u iterations, per: U %9.5fus, S %9.5fus, U+S %9.5fus", [NSStringFromSelector(_cmd) UTF8String], [NSDate stringFromCPUTime:elapsedTime], x, ((elapsedTime.userCPUTime / (double)x)), ((elapsedTime.systemCPUTime / (double)x)), ((elapsedTime.CPUTime / (double)x))]];
+}
+
+- (void)testConvertNSNumberRegexConversion
+{
+  if([timingEnvString intValue] < 1) { return; }
+  RKCPUTime startTime = [NSDate cpuTimeUsed];
+  unsigned int x = 0;
+  NSString *regexString = @"(\\d+)";
+  NSString *subjectString = @"12345";
+  RKRegex *regex = [RKRegex regexWithRegexString:regexString options:(RKCompileUTF8 | RKCompileNoUTF8Check)];
+  
+  for(x = 0; x < iterations; x++) {
+    NSAutoreleasePool *loopPool = NULL;
+    if(garbageCollectorEnabled == NO) { loopPool = [[NSAutoreleasePool alloc] init]; }
+    NSNumber *convertedNumber = nil;
+    [subjectString getCapturesWithRegexAndReferences:regex, @"${1:@n}", &convertedNumber, nil];
+    if([convertedNumber intValue] != 12345) {
+      NSLog(@"Converted number not expected value of 12345, is %@", convertedNumber);
+      if(garbageCollectorEnabled == NO) { [loopPool release]; }
+      break;
+    }
+    if(garbageCollectorEnabled == NO) { [loopPool release]; }
+  }
+  
+  RKCPUTime elapsedTime = [NSDate differenceOfStartingTime:startTime endingTime:[NSDate cpuTimeUsed]];
+  [timingResultsArray addObject:[NSString stringWithFormat:@"%-45.45s | CPU: %@  %u iterations, per: U %9.5fus, S %9.5fus, U+S %9.5fus", [NSStringFromSelector(_cmd) UTF8String], [NSDate stringFromCPUTime:elapsedTime], x, ((elapsedTime.userCPUTime / (double)x)), ((elapsedTime.systemCPUTime / (double)x)), ((elapsedTime.CPUTime / (double)x))]];
+}
+
 - (void)testConvertIntatoiBase
 {
   if([timingEnvString intValue] < 1) { return; }
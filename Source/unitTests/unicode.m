@@ -195,6 +195,50 @@ static NSMutableArray *unicodeStringsArray = NULL;
   STAssertTrue((NSEqualRanges([replacedString rangeOfRegex:@"2008"], NSMakeRange(12, 4))), @"range: %@", NSStringFromRange([replacedString rangeOfRegex:@"2008"]));
 }
 
+- (void)testSequentialRangeConversion
+{
+  // The UTF8 to UTF16 conversion of each enumerated match resumes from where the previous match left off.  This string contains
+  // characters that are 2, 3, and 4 bytes long in UTF8 form, the latter being surrogate pairs in UTF16.
+  NSString *unicodeString = [unicodeStringsArray objectAtIndex:6];
+  NSArray *words = [unicodeString componentsSeparatedByString:@" "];
+  RKEnumerator *wordEnumerator = [unicodeString matchEnumeratorWithRegex:@"\\S+"];
+  NSRange *matchRanges = NULL;
+  RKUInteger wordIndex = 0;
+
+  while((matchRanges = [wordEnumerator nextRanges]) != NULL) {
+    STAssertTrue((wordIndex < [words count]), @"wordIndex = %lu", (unsigned long)wordIndex); if(wordIndex >= [words count]) { break; }
+    STAssertTrue([[unicodeString substringWithRange:matchRanges[0]] isEqualToString:[words objectAtIndex:wordIndex]], @"range = %@ word = %@", NSStringFromRange(matchRanges[0]), [words objectAtIndex:wordIndex]);
+    wordIndex++;
+  }
+  STAssertTrue((wordIndex == [words count]), @"wordIndex = %lu", (unsigned long)wordIndex);
+
+  // The lookahead capture of the next word is converted past the start of the following match.  The conversion must still resume
+  // from the end of each match, rather than from the end of the lookahead capture, which would force it to start over every time.
+  wordEnumerator = [unicodeString matchEnumeratorWithRegex:@"(\\S+)(?=\\s+(\\S+))"];
+  wordIndex = 0;
+  while((matchRanges = [wordEnumerator nextRanges]) != NULL) {
+    void *conversionUTF8Location = NULL, *conversionUTF16Location = NULL;
+    object_getInstanceVariable(wordEnumerator, "conversionUTF8Location",  &conversionUTF8Location);
+    object_getInstanceVariable(wordEnumerator, "conversionUTF16Location", &conversionUTF16Location);
+    STAssertTrue(((RKUInteger)conversionUTF16Location == NSMaxRange(matchRanges[0])), @"conversionUTF16Location = %lu range = %@", (unsigned long)conversionUTF16Location, NSStringFromRange(matchRanges[0]));
+    STAssertTrue(((RKUInteger)conversionUTF8Location == [[unicodeString substringToIndex:NSMaxRange(matchRanges[0])] lengthOfBytesUsingEncoding:NSUTF8StringEncoding]), @"conversionUTF8Location = %lu range = %@", (unsigned long)conversionUTF8Location, NSStringFromRange(matchRanges[0]));
+    STAssertTrue(((wordIndex + 1) < [words count]), @"wordIndex = %lu", (unsigned long)wordIndex); if((wordIndex + 1) >= [words count]) { break; }
+    STAssertTrue([[unicodeString substringWithRange:matchRanges[1]] isEqualToString:[words objectAtIndex:wordIndex]], @"range = %@ word = %@", NSStringFromRange(matchRanges[1]), [words objectAtIndex:wordIndex]);
+    STAssertTrue([[unicodeString substringWithRange:matchRanges[2]] isEqualToString:[words objectAtIndex:(wordIndex + 1)]], @"range = %@ word = %@", NSStringFromRange(matchRanges[2]), [words objectAtIndex:(wordIndex + 1)]);
+    STAssertTrue((NSMaxRange(matchRanges[0]) + 1 == matchRanges[2].location), @"range0 = %@ range2 = %@", NSStringFromRange(matchRanges[0]), NSStringFromRange(matchRanges[2]));
+    wordIndex++;
+  }
+  STAssertTrue(((wordIndex + 1) == [words count]), @"wordIndex = %lu", (unsigned long)wordIndex);
+
+  NSRange *regexRanges = [unicodeString rangesOfRegex:@"(\\S+) (\\S+) (\\S+)$"];
+  STAssertTrue((regexRanges != NULL), NULL);
+  if(regexRanges != NULL) {
+    STAssertTrue([[unicodeString substringWithRange:regexRanges[1]] isEqualToString:[words objectAtIndex:3]], @"range = %@", NSStringFromRange(regexRanges[1]));
+    STAssertTrue([[unicodeString substringWithRange:regexRanges[3]] isEqualToString:[words objectAtIndex:5]], @"range = %@", NSStringFromRange(regexRanges[3]));
+    STAssertTrue((NSMaxRange(regexRanges[0]) == [unicodeString length]), @"range = %@", NSStringFromRange(regexRanges[0]));
+  }
+}
+
 - (void)testBrownBear
 {
   // Gerriet M. Denkmann gerriet (at) mdenkmann (dot) de